@@ -2,15 +2,32 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
 #include "oscilloscope.h"
 #include "gui.h"
 #include "arpeggiator.h"
+#include "platform.h"
+
+static void toggle_chord_progression(Synth *synth);
+
+// The engine logs through the platform shim; route it to SDL's log so
+// messages reach the browser console and Android logcat too
+static void app_log(void *userdata, const char *message) {
+  (void)userdata;
+  SDL_Log("%s", message);
+}
 
-static App *g_app_for_toggle = NULL;
-static void toggle_chord_progression(void);
-static void generate_random_chord_progression(App *app);
-static void play_chord(App *app, int root_note, float velocity);
-static void stop_active_notes(App *app);
+// Hand SDL's buffer to the engine, then the finished block to the
+// oscilloscope in one copy
+static void app_audio_callback(void *userdata, Uint8 *stream, int len) {
+  Synth *synth = (Synth *)userdata;
+  const int frames = len / (sizeof(float) * 2);
+  synth_render(synth, (float *)stream, frames);
+  oscilloscope_feed_block((const float *)stream, frames);
+}
 
 int app_init(App *app) {
 
@@ -21,24 +38,14 @@ int app_init(App *app) {
   app->last_frame_time = SDL_GetTicks();
   app->frame_count = 0;
   app->fps = 0.0f;
+  app->idle_mode = 1;
+  app->scope_fps = 30.0f;
+  app->redraw_frames = 1;
   
-  // Initialize chord progression
-  app->chord_progression_enabled = 0;
-  app->current_chord_index = 0;
-  app->chord_progression_timer = 0.0f;
-  app->chord_duration = 2.0f;
-  app->chord_progression_length = 0;
-  app->rhythm_pattern_length = 0;
-  app->current_rhythm_step = 0;
-  app->rhythm_step_timer = 0.0f;
-  app->active_chord_note_count = 0;
-  app->humanize_velocity_amount = 0.15f;
-  app->humanize_timing_amount = 0.03f;
-  app->bpm = 120.0f;
-
   if (SDL_Init(SDL_INIT_AUDIO | SDL_INIT_VIDEO) < 0) {
     return 0;
   }
+  platform_set_log(app_log, NULL);
 
   // GL 3.0 + GLSL 130 (desktop), WebGL2/OpenGL ES 3.0 for Emscripten
 #ifdef __EMSCRIPTEN__
@@ -84,19 +91,26 @@ int app_init(App *app) {
   if (!synth_init(&app->synth, 48000, 1024, 16)) {
     return 0;
   }
+#ifndef __EMSCRIPTEN__
+  // Load default config at startup
+  synth_load_default_config(&app->synth);
+#endif
+  synth_load_programs(&app->synth, SYNTH_PROGRAMS_FILE);
+  midi_init(&app->midi, &app->synth);
 
   gui_init(app->window, app->gl_context);
-  g_app_for_toggle = app;
-  gui_set_humanize_vars(&app->chord_progression_enabled, &app->humanize_velocity_amount, &app->humanize_timing_amount, &app->bpm, toggle_chord_progression, &app->synth);
+  gui_set_humanize_vars(&app->synth.seq.humanize_velocity, &app->synth.seq.humanize_timing, &app->synth.transport.bpm, toggle_chord_progression, &app->synth);
+  gui_set_frame_vars(&app->idle_mode, &app->scope_fps, &app->ui_cpu);
 
   oscilloscope_init();
+  oscilloscope_set_sample_rate(app->synth.sample_rate);
 
   SDL_AudioSpec want = {0}, got = {0};
   want.freq = 48000;
   want.format = AUDIO_F32SYS;
   want.channels = 2;
   want.samples = 1024;
-  want.callback = synth_audio_callback;
+  want.callback = app_audio_callback;
   want.userdata = &app->synth;
   app->audio = SDL_OpenAudioDevice(NULL, 0, &want, &got, 0);
   if (!app->audio) {
@@ -147,233 +161,185 @@ static void handle_keyboard_note(App *app, SDL_Keycode key, int is_down) {
     case SDLK_k: base_note = 2; break; // D (third octave)
   }
   
+  // The computer keyboard plays the edit part
+  Part *part = synth_edit_part(&app->synth);
+
   // Apply octave offset (octave 0-4 corresponds to MIDI octaves 1-5)
   if (base_note != -1) {
-    note = base_note + (app->synth.arp.octave * 12);
+    note = base_note + (part->arp.octave * 12);
   }
 
   if (note != -1) {
     if (is_down) {
-      if (app->synth.arp.enabled) {
-        arpeggiator_note_on(&app->synth.arp, note);
+      if (part->arp.enabled) {
+        arpeggiator_note_on(&part->arp, note);
       } else {
-        synth_note_on(&app->synth, note, 0.8f);
+        part_note_on(part, note, 0.8f);
       }
       gui_set_key_pressed(note, 1);
     } else {
-      if (app->synth.arp.enabled) {
-        arpeggiator_note_off(&app->synth.arp, note);
+      if (part->arp.enabled) {
+        arpeggiator_note_off(&part->arp, note);
       } else {
-        synth_note_off(&app->synth, note);
+        part_note_off(part, note);
       }
       gui_set_key_pressed(note, 0);
     }
   }
 }
 
-static void toggle_chord_progression(void) {
-  if (g_app_for_toggle) {
-    g_app_for_toggle->chord_progression_enabled = !g_app_for_toggle->chord_progression_enabled;
-    if (g_app_for_toggle->chord_progression_enabled) {
-      generate_random_chord_progression(g_app_for_toggle);
-      play_chord(g_app_for_toggle, g_app_for_toggle->chord_progression[0], 
-                 g_app_for_toggle->rhythm_pattern[0]);
-    } else {
-      stop_active_notes(g_app_for_toggle);
-    }
-  }
-}
-
-static void generate_random_chord_progression(App *app) {
-  int scale[] = {0, 2, 4, 5, 7, 9, 11};
-  int progression_patterns[][8] = {
-    {0, 5, 3, 4, 2, 6, 1, 0},
-    {0, 3, 5, 4, 2, 1, 6, 5},
-    {0, 4, 5, 3, 1, 6, 2, 0},
-    {0, 5, 3, 4, 0, 5, 3, 6},
-    {0, 3, 4, 5, 1, 2, 6, 0},
-    {0, 4, 3, 5, 6, 1, 2, 4},
-    {0, 6, 3, 5, 4, 1, 2, 0},
-    {0, 2, 5, 3, 6, 4, 1, 0},
-  };
-  
-  int pattern_idx = rand() % 8;
-  int root = 48 + (rand() % 12);
-  
-  app->chord_progression_length = 8;
-  for (int i = 0; i < 8; i++) {
-    app->chord_progression[i] = root + scale[progression_patterns[pattern_idx][i]];
-  }
-  
-  // Generate 128-step rhythm pattern by repeating 16-step patterns
-  float base_patterns[][16] = {
-    {1.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.0f, 0.5f, 0.0f, 1.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.0f, 0.5f, 0.0f},
-    {1.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.5f, 0.0f, 1.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.5f, 0.0f, 0.0f},
-    {1.0f, 0.5f, 0.5f, 0.0f, 0.75f, 0.0f, 0.5f, 0.5f, 1.0f, 0.0f, 0.5f, 0.5f, 0.75f, 0.0f, 0.5f, 0.0f},
-    {1.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.0f, 1.0f, 0.0f, 0.5f, 0.0f, 0.5f, 0.75f, 0.0f, 0.0f},
-    {1.0f, 0.5f, 0.0f, 0.5f, 0.75f, 0.5f, 0.0f, 0.5f, 1.0f, 0.5f, 0.0f, 0.5f, 0.75f, 0.5f, 0.0f, 0.5f},
-  };
-  
-  int rhythm_idx = rand() % 5;
-  app->rhythm_pattern_length = 128;
-  
-  // Fill 128 steps by repeating the 16-step pattern 8 times
-  for (int i = 0; i < 128; i++) {
-    app->rhythm_pattern[i] = base_patterns[rhythm_idx][i % 16];
-  }
-  
-  app->current_chord_index = 0;
-  app->chord_progression_timer = 0.0f;
-  app->current_rhythm_step = 0;
-  app->rhythm_step_timer = 0.0f;
-}
-
-static float humanize_velocity(float velocity, float amount) {
-  float random = ((float)rand() / RAND_MAX) * 2.0f - 1.0f;
-  velocity += random * amount;
-  if (velocity < 0.1f) velocity = 0.1f;
-  if (velocity > 1.0f) velocity = 1.0f;
-  return velocity;
+// The sequencer starts and stops on the audio thread at its next block
+static void toggle_chord_progression(Synth *synth) {
+  sequencer_toggle(&synth->seq);
 }
 
-static void stop_active_notes(App *app) {
-  for (int i = 0; i < app->active_chord_note_count; i++) {
-    synth_note_off(&app->synth, app->active_chord_notes[i]);
+static void app_handle_event(App *app, const SDL_Event *e) {
+  gui_handle_event(e);
+  if (e->type == SDL_QUIT) {
+    app->quit = 1;
   }
-  app->active_chord_note_count = 0;
-}
+  if (e->type == SDL_KEYDOWN) {
+    if (e->key.keysym.sym == SDLK_F1) {
+      sequencer_toggle(&app->synth.seq);
+    } else if (app->show_help) {
+      app->show_help = 0;
+    }
 
-static void play_chord(App *app, int root_note, float velocity) {
-  if (velocity <= 0.0f) {
-    return;
+    if (e->key.keysym.sym == SDLK_ESCAPE) {
+      app->quit = 1;
+    }
+    if (e->key.keysym.sym == SDLK_SPACE) {
+      Part *part = synth_edit_part(&app->synth);
+      arpeggiator_set_param(&part->arp, "enabled", !part->arp.enabled, part);
+    }
+    handle_keyboard_note(app, e->key.keysym.sym, 1);
   }
-  
-  velocity = humanize_velocity(velocity, app->humanize_velocity_amount);
-  
-  int chord_notes[8];
-  chord_notes[0] = root_note;
-  chord_notes[1] = root_note + 3;
-  chord_notes[2] = root_note + 4;
-  chord_notes[3] = root_note + 7;
-  chord_notes[4] = root_note + 10;
-  chord_notes[5] = root_note + 12;
-  chord_notes[6] = root_note + 15;
-  chord_notes[7] = root_note + 16;
-  
-  app->active_chord_note_count = 0;
-  for (int i = 0; i < 8; i++) {
-    float note_velocity = humanize_velocity(velocity, app->humanize_velocity_amount);
-    synth_note_on(&app->synth, chord_notes[i], note_velocity);
-    app->active_chord_notes[app->active_chord_note_count++] = chord_notes[i];
+  if (e->type == SDL_KEYUP) {
+    handle_keyboard_note(app, e->key.keysym.sym, 0);
   }
 }
 
 void app_poll_events(App *app) {
   SDL_Event e;
-  int event_count = 0;
   while (SDL_PollEvent(&e)) {
-    event_count++;
-    gui_handle_event(&e);
-    if (e.type == SDL_QUIT) {
-      app->quit = 1;
-    }
-    if (e.type == SDL_KEYDOWN) {
-      if (e.key.keysym.sym == SDLK_F1) {
-        app->chord_progression_enabled = !app->chord_progression_enabled;
-        if (app->chord_progression_enabled) {
-          generate_random_chord_progression(app);
-          play_chord(app, app->chord_progression[0], app->rhythm_pattern[0]);
-        } else {
-          stop_active_notes(app);
-        }
-      } else if (app->show_help) {
-        app->show_help = 0;
-      }
+    app_handle_event(app, &e);
+    app->redraw_frames = 2; // ImGui settles hover and clicks over two frames
+  }
+}
 
-      if (e.key.keysym.sym == SDLK_ESCAPE) {
-        app->quit = 1;
-      }
-      if (e.key.keysym.sym == SDLK_SPACE) {
-        arpeggiator_set_param(&app->synth.arp, "enabled",
-                              !app->synth.arp.enabled, &app->synth);
-      }
-      handle_keyboard_note(app, e.key.keysym.sym, 1);
+// Something on screen keeps changing: sound is playing (meters, scope,
+// voice ticks) or the chord progression's position display is moving
+static int app_is_animating(App *app) {
+  midi_queue_report(&app->synth.midi_in);
+
+  const SynthSnapshot *snap = snapshot_read(&app->synth.snapshot);
+  return snap->seq_running || snap->active_voices > 0 || snap->peak_level > -90.0f;
+}
+
+// Idle mode: block in SDL_WaitEventTimeout until there is a reason to
+// draw. Input redraws at once, moving audio at scope_fps, and otherwise a
+// once-per-second redraw keeps the title and CPU readouts current.
+void app_wait_events(App *app) {
+  const Uint32 heartbeat = 1000;
+  const Uint32 snapshot_poll = 50; // MIDI notes start sound without UI input; scope ring drain
+  for (;;) {
+    Uint32 since = SDL_GetTicks() - app->last_render_time;
+    if (app->redraw_frames > 0 || since >= heartbeat)
+      return;
+
+    Uint32 wait;
+    if (app_is_animating(app)) {
+      Uint32 interval = (Uint32)(1000.0f / app->scope_fps);
+      if (since >= interval)
+        return;
+      wait = interval - since;
+    } else {
+      wait = heartbeat - since;
     }
-    if (e.type == SDL_KEYUP) {
-      handle_keyboard_note(app, e.key.keysym.sym, 0);
+
+    // Slow refresh rates would otherwise let the scope ring overflow between draws
+    if (wait > snapshot_poll)
+      wait = snapshot_poll;
+    oscilloscope_drain();
+
+    SDL_Event e;
+    if (SDL_WaitEventTimeout(&e, (int)wait)) {
+      app_handle_event(app, &e);
+      app->redraw_frames = 2;
     }
   }
-  if (event_count > 0) {
-  }
+}
+
+// CPU time used by the calling thread, in seconds
+static double thread_cpu_seconds(void) {
+#if defined(_WIN32)
+  FILETIME created, exited, kernel, user;
+  if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user))
+    return 0.0;
+  ULARGE_INTEGER k, u;
+  k.LowPart = kernel.dwLowDateTime;
+  k.HighPart = kernel.dwHighDateTime;
+  u.LowPart = user.dwLowDateTime;
+  u.HighPart = user.dwHighDateTime;
+  return (double)(k.QuadPart + u.QuadPart) * 1e-7;
+#elif defined(CLOCK_THREAD_CPUTIME_ID) && !defined(__EMSCRIPTEN__)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    return 0.0;
+  return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+  // Single-threaded builds: process time is the closest measure
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
 }
 
 void app_update(App *app) {
-  
-  // Update chord progression with rhythm
-  if (app->chord_progression_enabled && app->chord_progression_length > 0 && app->rhythm_pattern_length > 0) {
-    float delta_time = app->target_frame_time / 1000.0f;
-    float seconds_per_beat = 60.0f / app->bpm;
-    float step_duration = seconds_per_beat * 4.0f / app->rhythm_pattern_length;
-    
-    float timing_variation = ((float)rand() / RAND_MAX - 0.5f) * 2.0f * app->humanize_timing_amount;
-    step_duration += timing_variation;
-    if (step_duration < 0.01f) step_duration = 0.01f;
-    
-    app->rhythm_step_timer += delta_time;
-    
-    if (app->rhythm_step_timer >= step_duration) {
-      app->rhythm_step_timer -= step_duration;
-      
-      stop_active_notes(app);
-      
-      app->current_rhythm_step = (app->current_rhythm_step + 1) % app->rhythm_pattern_length;
-      
-      if (app->current_rhythm_step == 0) {
-        app->current_chord_index = (app->current_chord_index + 1) % app->chord_progression_length;
-      }
-      
-      float velocity = app->rhythm_pattern[app->current_rhythm_step];
-      play_chord(app, app->chord_progression[app->current_chord_index], velocity);
-    }
-  }
-  
-  // Sync FX BPM with chord progression BPM
-  synth_set_bpm(&app->synth, app->bpm);
-  
   // Calculate FPS
   app->frame_count++;
   Uint32 current_time = SDL_GetTicks();
   static Uint32 fps_last_time = 0;
   static Uint32 fps_frame_count = 0;
+  static double cpu_last_time = 0.0;
   
   if (fps_last_time == 0) {
     fps_last_time = current_time;
+    cpu_last_time = thread_cpu_seconds();
   }
   
   fps_frame_count++;
   if (current_time - fps_last_time >= 1000) { // Update FPS every second
+    double cpu_now = thread_cpu_seconds();
     app->fps = fps_frame_count * 1000.0f / (current_time - fps_last_time);
+    app->ui_cpu = (float)(100.0 * (cpu_now - cpu_last_time) * 1000.0 / (current_time - fps_last_time));
     fps_last_time = current_time;
     fps_frame_count = 0;
+    cpu_last_time = cpu_now;
   }
   
+  // An impulse response the audio thread swapped out is freed here, and
+  // one still waiting behind it can then be taken
+  convolver_collect(&app->synth.fx.conv);
+
+  const SynthSnapshot *snap = snapshot_read(&app->synth.snapshot);
+  const Part *part = synth_edit_part(&app->synth);
   char title[256];
    snprintf(title, sizeof(title),
-            "Voices %d/%d | CPU %.1f%% | FPS %.1f | Comp: %.1fdB | Arp: %s | Oct: %d | Octaves: %d",
-            synth_active_voices(&app->synth), app->synth.max_voices,
-            synth_cpu_usage(&app->synth), app->fps, 
-            app->synth.mixer.compressor.gain_reduction,
-            arpeggiator_mode_str(&app->synth.arp), app->synth.arp.octave + 1, app->synth.arp.octaves);
+            "Part %d | Voices %d/%d | CPU %.1f%% | UI %.1f%% | FPS %.1f | Comp: %.1fdB | Lim: %.1fdB | Arp: %s | Oct: %d | Octaves: %d",
+            app->synth.edit_part + 1, snap->active_voices, part->max_voices,
+            snap->cpu_usage, app->ui_cpu, app->fps,
+            snap->comp_gain_reduction,
+            snap->limiter_gain_reduction,
+            arpeggiator_mode_str(&part->arp), part->arp.octave + 1, part->arp.octaves);
   SDL_SetWindowTitle(app->window, title);
   
 }
 
 void app_render(App *app) {
-    gui_draw(&app->synth, app->window, app->gl_context, 
-             app->chord_progression_enabled, app->current_chord_index, 
-             app->chord_progression_length, app->current_rhythm_step, 
-             app->rhythm_pattern_length);
+    gui_draw(&app->synth, app->window, app->gl_context);
     SDL_GL_SwapWindow(app->window);
+    app->last_render_time = SDL_GetTicks();
+    if (app->redraw_frames > 0)
+      app->redraw_frames--;
 }
 
 void app_shutdown(App *app) {
@@ -385,6 +351,11 @@ void app_shutdown(App *app) {
   // Then shutdown other components
   gui_shutdown();
   oscilloscope_shutdown();
+  midi_shutdown(&app->midi);
+#ifndef __EMSCRIPTEN__
+  // Save current settings to default config before shutdown
+  synth_save_default_config(&app->synth);
+#endif
   synth_shutdown(&app->synth);
   SDL_GL_DeleteContext(app->gl_context);
   if (app->window)
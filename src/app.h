@@ -1,4 +1,5 @@
 #pragma once
+#include "midi.h"
 #include "synth.h"
 #include <SDL2/SDL.h>
 
@@ -7,6 +8,7 @@ typedef struct {
   SDL_GLContext gl_context;
   SDL_AudioDeviceID audio;
   Synth synth;
+  Midi midi;                // Device inputs, feeding synth
   int quit;
   int show_help;
 
@@ -15,27 +17,18 @@ typedef struct {
   Uint32 frame_count;
   float fps;
   Uint32 target_frame_time; // 1000ms / 60fps = ~16.67ms
-  
-  // Chord progression
-  int chord_progression_enabled;
-  int current_chord_index;
-  float chord_progression_timer;
-  float chord_duration;
-  int chord_progression[8];
-  int chord_progression_length;
-  float rhythm_pattern[128];
-  int rhythm_pattern_length;
-  int current_rhythm_step;
-  float rhythm_step_timer;
-  int active_chord_notes[16];
-  int active_chord_note_count;
-  float humanize_velocity_amount;
-  float humanize_timing_amount;
-  float bpm;
+
+  // Demand-driven redraw
+  int idle_mode;            // Sleep in SDL_WaitEventTimeout between redraws
+  float scope_fps;          // Redraw rate while meters and scope are moving
+  int redraw_frames;        // Frames still owed after input
+  Uint32 last_render_time;
+  float ui_cpu;             // UI thread CPU time (% of wall clock)
 } App;
 
 int app_init(App *app);
 void app_poll_events(App *app);
+void app_wait_events(App *app);
 void app_update(App *app);
 void app_render(App *app);
 void app_shutdown(App *app);
\ No newline at end of file
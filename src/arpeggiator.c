@@ -1,16 +1,29 @@
 #include "arpeggiator.h"
-#include "synth.h" // Include synth.h for synth_note_on/off declarations
+#include "part.h" // part_note_on/off
+#include "utils.h"
 #include <stdlib.h>
 #include <string.h>
 
 void arpeggiator_init(Arpeggiator *arp) {
   arp->enabled = 0;
   arp->mode = ARP_UP;
-  memset(arp->pattern, 0, sizeof(arp->pattern)); // Initialize pattern to all zeros
+  arp->rng = rng_seed(0);
+  for (int i = 0; i < ARP_PATTERN_LEN; ++i) {
+    arp->lanes[i].velocity = 0.8f;
+    arp->lanes[i].gate = 1.0f;
+    arp->lanes[i].ratchet = 1;
+    arp->lanes[i].tie = 0;
+    arp->lanes[i].probability = 1.0f;
+  }
+  arp->pattern_length = ARP_PATTERN_LEN;
+  arp->swing = 0.5f;
+  arp->ratchets_left = 0;
+  arp->ratchet_held = 0;
   arp->step = 0;
-  arp->tempo = 120.0f;
   arp->rate = RATE_EIGHTH;
-  arp->step_phase = 0.0f;
+  arp->next_step_beat = -1.0;
+  arp->sequence_len = 0;
+  arp->sequence_dirty = 1;
   arp->held_count = 0;
   memset(arp->held_notes, 0, sizeof(arp->held_notes));
   arp->last_step_time = 0.0f;
@@ -35,19 +48,17 @@ void arpeggiator_init(Arpeggiator *arp) {
   }
 }
 
-void arpeggiator_set_param(Arpeggiator *arp, const char *param, float value, struct Synth *synth) {
+void arpeggiator_set_param(Arpeggiator *arp, const char *param, float value, struct Part *part) {
   if (!strcmp(param, "enabled")) {
     int old_enabled = arp->enabled;
     arp->enabled = (int)value;
     // If arpeggiator is being turned off, clear all playing notes
     if (old_enabled && !arp->enabled) {
-      arpeggiator_clear_notes_with_synth(arp, synth);
+      arpeggiator_clear_notes_with_part(arp, part);
     }
   }
   else if (!strcmp(param, "mode"))
     arp->mode = (ArpMode)((int)value);
-  else if (!strcmp(param, "tempo"))
-    arp->tempo = value;
   else if (!strcmp(param, "rate"))
     arp->rate = (ArpRate)((int)value);
   else if (!strcmp(param, "polyphonic"))
@@ -84,8 +95,10 @@ void arpeggiator_note_on(Arpeggiator *arp, int note) {
   for (int i = 0; i < arp->held_count; ++i)
     if (arp->held_notes[i] == note)
       return;
-  if (arp->held_count < 16)
+  if (arp->held_count < 16) {
     arp->held_notes[arp->held_count++] = note;
+    arp->sequence_dirty = 1;
+  }
 }
 
 void arpeggiator_note_off(Arpeggiator *arp, int note) {
@@ -99,6 +112,7 @@ void arpeggiator_note_off(Arpeggiator *arp, int note) {
       for (int j = i; j < arp->held_count - 1; ++j)
         arp->held_notes[j] = arp->held_notes[j + 1];
       arp->held_count--;
+      arp->sequence_dirty = 1;
       break;
     }
   }
@@ -106,6 +120,7 @@ void arpeggiator_note_off(Arpeggiator *arp, int note) {
 
 void arpeggiator_clear_notes(Arpeggiator *arp) {
   arp->held_count = 0;
+  arp->sequence_dirty = 1;
   memset(arp->held_notes, 0, sizeof(arp->held_notes));
   
   // Turn off all currently playing arpeggiated notes
@@ -116,183 +131,241 @@ void arpeggiator_clear_notes(Arpeggiator *arp) {
   }
 }
 
-void arpeggiator_clear_notes_with_synth(Arpeggiator *arp, struct Synth *synth) {
+void arpeggiator_clear_notes_with_part(Arpeggiator *arp, struct Part *part) {
   arp->held_count = 0;
+  arp->sequence_dirty = 1;
   memset(arp->held_notes, 0, sizeof(arp->held_notes));
   
-  // Turn off all currently playing arpeggiated notes with synth
+  // Turn off all currently playing arpeggiated notes with the part
+  for (int i = 0; i < 16; ++i) {
+    if (arp->active_arpeggiated_notes[i].active) {
+      part_note_off(part, arp->active_arpeggiated_notes[i].note);
+      arp->active_arpeggiated_notes[i].active = 0;
+    }
+  }
+}
+
+void arpeggiator_locate(Arpeggiator *arp, struct Part *part) {
   for (int i = 0; i < 16; ++i) {
     if (arp->active_arpeggiated_notes[i].active) {
-      synth_note_off(synth, arp->active_arpeggiated_notes[i].note);
+      part_note_off(part, arp->active_arpeggiated_notes[i].note);
       arp->active_arpeggiated_notes[i].active = 0;
     }
   }
+  arp->ratchets_left = 0;
+  arp->next_step_beat = -1.0;
 }
 
 static int order_compare(const void *a, const void *b) {
   return (*(int *)a) - (*(int *)b);
 }
 
-int arpeggiator_step(Arpeggiator *arp, float samplerate, struct Synth *synth) {
-  if (!arp->enabled || arp->held_count == 0)
-    return -1;
-
-  // Calculate step time based on rate
-  float rate_divisor = 1.0f;
+double arpeggiator_step_beats(const Arpeggiator *arp) {
   switch (arp->rate) {
-    case RATE_QUARTER:   rate_divisor = 1.0f; break;  // 1/4 notes
-    case RATE_EIGHTH:    rate_divisor = 2.0f; break;  // 1/8 notes (default)
-    case RATE_SIXTEENTH: rate_divisor = 4.0f; break;  // 1/16 notes
-    case RATE_THIRTYSECOND: rate_divisor = 8.0f; break; // 1/32 notes
+    case RATE_QUARTER:   return 1.0;    // 1/4 notes
+    case RATE_EIGHTH:    return 0.5;    // 1/8 notes (default)
+    case RATE_SIXTEENTH: return 0.25;   // 1/16 notes
+    case RATE_THIRTYSECOND: return 0.125; // 1/32 notes
+    case RATE_SIXTYFOURTH: return 0.0625; // 1/64 notes
   }
-  float step_time = 60.0f / arp->tempo / rate_divisor;
+  return 0.5;
+}
 
-  // Turn off all notes from previous step before playing new ones
+// Expand the held notes into the order the current mode plays them. Runs
+// only when the held notes or a setting that shapes the order changed.
+static void arpeggiator_build_sequence(Arpeggiator *arp) {
+  int notes[16];
+  int count = arp->held_count;
+  memcpy(notes, arp->held_notes, sizeof(int) * count);
+
+  arp->sequence_len = 0;
+  arp->sequence_chord = 0;
+  if (count == 0)
+    return;
+
+  if (arp->polyphonic) {
+    // Every held note (in play order) across the octave spread
+    for (int h = 0; h < count; ++h)
+      for (int oct = 0; oct < arp->octaves && arp->sequence_len < ARP_MAX_SEQUENCE; ++oct)
+        arp->sequence[arp->sequence_len++] = notes[h] + (arp->octave * 12) + (oct * 12);
+    return;
+  }
+
+  switch (arp->mode) {
+  case ARP_CHORD: {
+    // Chord from the first held note (root), spread over the octaves and
+    // played all at once on every step
+    int chord_notes[8];
+    int note_count = arpeggiator_generate_chord(arp, notes[0], chord_notes, 8);
+    for (int i = 0; i < note_count && arp->sequence_len < 8; ++i)
+      for (int oct = 0; oct < arp->octaves && arp->sequence_len < 8; ++oct)
+        arp->sequence[arp->sequence_len++] = chord_notes[i] + (arp->octave * 12) + (oct * 12);
+    arp->sequence_chord = 1;
+    break;
+  }
+  case ARP_UP:
+    qsort(notes, count, sizeof(int), order_compare);
+    memcpy(arp->sequence, notes, sizeof(int) * count);
+    arp->sequence_len = count;
+    break;
+  case ARP_DOWN:
+    qsort(notes, count, sizeof(int), order_compare);
+    for (int i = 0; i < count; ++i)
+      arp->sequence[i] = notes[count - 1 - i];
+    arp->sequence_len = count;
+    break;
+  case ARP_ORDER:
+  case ARP_RANDOM: // Picked from at random on each step
+    memcpy(arp->sequence, notes, sizeof(int) * count);
+    arp->sequence_len = count;
+    break;
+  case ARP_PENDULUM:
+    // Up then down without repeating the ends: n0, n1, n2, n3, n2, n1
+    qsort(notes, count, sizeof(int), order_compare);
+    for (int i = 0; i < count; ++i)
+      arp->sequence[arp->sequence_len++] = notes[i];
+    for (int i = count - 2; i > 0; --i)
+      arp->sequence[arp->sequence_len++] = notes[i];
+    break;
+  default:
+    arp->sequence[arp->sequence_len++] = notes[0];
+    break;
+  }
+}
+
+static void arpeggiator_refresh_sequence(Arpeggiator *arp) {
+  ArpSequenceKey key;
+  memset(&key, 0, sizeof(key)); // Padding takes part in the memcmp
+  key.mode = arp->mode;
+  key.polyphonic = arp->polyphonic;
+  key.octave = arp->octave;
+  key.octaves = arp->octaves;
+  key.chord_type = arp->chord_type;
+  key.add_6 = arp->add_6;
+  key.add_m7 = arp->add_m7;
+  key.add_M7 = arp->add_M7;
+  key.add_9 = arp->add_9;
+  key.voicing = arp->voicing;
+
+  // The GUI writes settings directly, so compare instead of relying on
+  // every writer to mark the cache stale
+  if (!arp->sequence_dirty && memcmp(&key, &arp->sequence_key, sizeof(key)) == 0)
+    return;
+  arp->sequence_key = key;
+  arp->sequence_dirty = 0;
+  arpeggiator_build_sequence(arp);
+}
+
+static void arpeggiator_play(Arpeggiator *arp, struct Part *part, int note, double off_beat, float velocity) {
+  for (int j = 0; j < 16; ++j) {
+    if (!arp->active_arpeggiated_notes[j].active) {
+      arp->active_arpeggiated_notes[j].note = note;
+      arp->active_arpeggiated_notes[j].off_beat = off_beat;
+      arp->active_arpeggiated_notes[j].active = 1;
+      part_note_on(part, note, velocity);
+      return;
+    }
+  }
+}
+
+static void arpeggiator_release_all(Arpeggiator *arp, struct Part *part) {
   for (int i = 0; i < 16; ++i) {
       if (arp->active_arpeggiated_notes[i].active) {
-          synth_note_off(synth, arp->active_arpeggiated_notes[i].note);
+          part_note_off(part, arp->active_arpeggiated_notes[i].note);
           arp->active_arpeggiated_notes[i].active = 0;
       }
   }
+}
 
-  int idx = 0;
-  int notes[16];
-  memcpy(notes, arp->held_notes, sizeof(int) * arp->held_count);
+// Odd steps start late by up to half a step (swing 0.75)
+static double arpeggiator_swing_delay(const Arpeggiator *arp, int step) {
+  if (!(step & 1))
+    return 0.0;
+  float swing = arp->swing < 0.5f ? 0.5f : (arp->swing > 0.75f ? 0.75f : arp->swing);
+  return (swing - 0.5f) * 2.0 * arpeggiator_step_beats(arp);
+}
 
-  if (arp->polyphonic) {
-      // Play notes cycling through octaves in polyphonic mode
-      int total_notes = arp->held_count * arp->octaves;
-      int notes_to_play[16];
-      int note_count = 0;
-      
-      // Calculate which note to play this step based on current arpeggiator step
-      // We cycle through all (held_notes × octaves) combinations
-      int note_index = arp->step % total_notes;
-      
-      // Calculate which held note and octave this should be
-      int held_note_index = note_index / arp->octaves;
-      int octave_index = note_index % arp->octaves;
-      
-      if (held_note_index < arp->held_count) {
-          int base_note = notes[held_note_index];
-          int note_to_play = base_note + (arp->octave * 12) + (octave_index * 12);
-          
-          // Find a free slot for the new note
-          int free_slot = -1;
-          for (int j = 0; j < 16; ++j) {
-              if (!arp->active_arpeggiated_notes[j].active) {
-                  free_slot = j;
-                  break;
-              }
-          }
-           if (free_slot != -1) {
-               arp->active_arpeggiated_notes[free_slot].note = note_to_play;
-               arp->active_arpeggiated_notes[free_slot].remaining_duration = step_time * arp->gate_length; // Gate length controls note duration
-               arp->active_arpeggiated_notes[free_slot].active = 1;
-               synth_note_on(synth, note_to_play, 0.8f);
-               note_count++;
-          }
-      }
+double arpeggiator_swing_offset(const Arpeggiator *arp) {
+  return arpeggiator_swing_delay(arp, arp->step);
+}
+
+int arpeggiator_step(Arpeggiator *arp, double beat, struct Part *part) {
+  if (!arp->enabled || arp->held_count == 0)
+    return -1;
+
+  // Where this step really starts and how long it lasts once swung
+  double start = beat + arpeggiator_swing_delay(arp, arp->step);
+  double length = arpeggiator_step_beats(arp) + arpeggiator_swing_delay(arp, arp->step + 1) -
+                  arpeggiator_swing_delay(arp, arp->step);
+  int pattern_length = arp->pattern_length < 1 ? 1 :
+                       (arp->pattern_length > ARP_PATTERN_LEN ? ARP_PATTERN_LEN : arp->pattern_length);
+  const ArpStep *lane = &arp->lanes[arp->step % pattern_length];
+  // Gate length controls note duration, in beats so it follows the tempo
+  double gate = arp->gate_length * lane->gate;
+  // A step followed by a tie keeps sounding into the next step, which then
+  // sets the real note off
+  int held = arp->lanes[(arp->step + 1) % pattern_length].tie;
+  arp->step++;
+  arp->ratchets_left = 0;
+
+  if (lane->tie) {
+    // Carry whatever is sounding through this step; a rest if nothing is
+    for (int i = 0; i < 16; ++i) {
+      if (arp->active_arpeggiated_notes[i].active)
+        arp->active_arpeggiated_notes[i].off_beat = start + (held ? 2.0 * length : length * gate);
+    }
+    return 0;
+  }
+
+  // Turn off all notes from previous step before playing new ones
+  arpeggiator_release_all(arp, part);
+
+  arpeggiator_refresh_sequence(arp);
+  if (arp->sequence_len == 0)
+    return 0;
+  if (lane->probability < 1.0f && rng_float(&arp->rng) >= lane->probability)
+    return 0;
+
+  int count = 0;
+  if (arp->sequence_chord) {
+    for (int i = 0; i < arp->sequence_len && count < ARP_STEP_NOTES; ++i)
+      arp->ratchet_notes[count++] = arp->sequence[i];
+  } else if (!arp->polyphonic && arp->mode == ARP_RANDOM) {
+    arp->ratchet_notes[count++] = arp->sequence[rng_next(&arp->rng) % arp->sequence_len];
   } else {
-      // Monophonic behavior (existing logic)
-      switch (arp->mode) {
-      case ARP_CHORD: {
-          // Generate chord from the first held note (root)
-          if (arp->held_count > 0) {
-              int chord_notes[8];
-              int note_count = arpeggiator_generate_chord(arp, notes[0], chord_notes, 8);
-              
-              // Apply octave spread if requested
-              int notes_to_play[8];
-              int actual_count = 0;
-              for (int i = 0; i < note_count && actual_count < 8; ++i) {
-                  int base_note = chord_notes[i];
-                  for (int oct = 0; oct < arp->octaves && actual_count < 8; ++oct) {
-                      notes_to_play[actual_count++] = base_note + (arp->octave * 12) + (oct * 12);
-                  }
-              }
-              
-              // Play all chord notes simultaneously
-              for (int i = 0; i < actual_count; ++i) {
-                  int free_slot = -1;
-                  for (int j = 0; j < 16; ++j) {
-                      if (!arp->active_arpeggiated_notes[j].active) {
-                          free_slot = j;
-                          break;
-                      }
-                  }
-                   if (free_slot != -1) {
-                       arp->active_arpeggiated_notes[free_slot].note = notes_to_play[i];
-                       arp->active_arpeggiated_notes[free_slot].remaining_duration = step_time * arp->gate_length;
-                       arp->active_arpeggiated_notes[free_slot].active = 1;
-                       synth_note_on(synth, notes_to_play[i], 0.8f);
-                   }
-              }
-          }
-          break;
-      }
-      case ARP_UP:
-        qsort(notes, arp->held_count, sizeof(int), order_compare);
-        idx = arp->step % arp->held_count;
-        break;
-      case ARP_DOWN:
-        qsort(notes, arp->held_count, sizeof(int), order_compare);
-        idx = arp->held_count - 1 - (arp->step % arp->held_count);
-        break;
-      case ARP_ORDER:
-        idx = arp->step % arp->held_count;
-        break;
-      case ARP_RANDOM:
-        idx = rand() % arp->held_count;
-        break;
-      case ARP_PENDULUM:
-        // Pendulum mode: play up then down, creating a bounce pattern
-        // For held notes [n0, n1, n2, n3], play: n0, n1, n2, n3, n2, n1, n0, n1, n2, n3...
-        qsort(notes, arp->held_count, sizeof(int), order_compare);
-        {
-          int cycle_length = (arp->held_count * 2) - 2; // n0,n1,n2,n3,n2,n1 = 5 for 4 notes
-          if (arp->held_count == 1) {
-            cycle_length = 1; // Single note just repeats
-          }
-          int step_in_cycle = arp->step % cycle_length;
-          
-          if (step_in_cycle < arp->held_count) {
-            // Ascending part
-            idx = step_in_cycle;
-          } else {
-            // Descending part
-            idx = (arp->held_count - 1) - (step_in_cycle - arp->held_count + 1);
-          }
-        }
-        break;
-      default:
-        idx = 0;
-      }
-      
-      if (arp->mode != ARP_CHORD) {
-          int note_to_play = notes[idx];
-          
-          // Find a free slot for the new note
-          int free_slot = -1;
-          for (int j = 0; j < 16; ++j) {
-              if (!arp->active_arpeggiated_notes[j].active) {
-                  free_slot = j;
-                  break;
-              }
-          }
-           if (free_slot != -1) {
-               arp->active_arpeggiated_notes[free_slot].note = note_to_play;
-               arp->active_arpeggiated_notes[free_slot].remaining_duration = step_time * arp->gate_length; // Gate length controls note duration
-               arp->active_arpeggiated_notes[free_slot].active = 1;
-               synth_note_on(synth, note_to_play, 0.8f);
-           }
-      }
+    arp->ratchet_notes[count++] = arp->sequence[(arp->step - 1) % arp->sequence_len];
   }
+  arp->ratchet_note_count = count;
+
+  // Ratchets split the step into equal hits, each with its own gate
+  int hits = lane->ratchet < 1 ? 1 : (lane->ratchet > ARP_MAX_RATCHET ? ARP_MAX_RATCHET : lane->ratchet);
+  arp->ratchet_beats = length / hits;
+  arp->ratchet_gate = arp->ratchet_beats * gate;
+  arp->ratchet_velocity = lane->velocity;
+  if (held)
+    arp->ratchet_gate = hits > 1 ? arp->ratchet_beats : 2.0 * length;
+  for (int i = 0; i < count; ++i)
+    arpeggiator_play(arp, part, arp->ratchet_notes[i], start + arp->ratchet_gate, lane->velocity);
+  arp->ratchets_left = hits - 1;
+  arp->ratchet_beat = start + arp->ratchet_beats;
+  arp->ratchet_held = held;
 
-  arp->step++;
   return 0; // Return 0 to indicate success
 }
 
+void arpeggiator_ratchet(Arpeggiator *arp, struct Part *part) {
+  if (arp->ratchets_left <= 0)
+    return;
+  arpeggiator_release_all(arp, part);
+  arp->ratchets_left--;
+  // The last hit before a tie rings on like an unratcheted step
+  double gate = arp->ratchet_held && arp->ratchets_left == 0 ? 2.0 * arp->ratchet_beats : arp->ratchet_gate;
+  for (int i = 0; i < arp->ratchet_note_count; ++i)
+    arpeggiator_play(arp, part, arp->ratchet_notes[i], arp->ratchet_beat + gate,
+                     arp->ratchet_velocity);
+  arp->ratchet_beat += arp->ratchet_beats;
+}
+
 int arpeggiator_generate_chord(const Arpeggiator *arp, int root_note, int *chord_notes, int max_notes) {
     if (!chord_notes || max_notes < 8) return 0;
     
@@ -453,6 +526,8 @@ const char *arpeggiator_rate_str(const Arpeggiator *arp) {
         return "1/16";
     case RATE_THIRTYSECOND:
         return "1/32";
+    case RATE_SIXTYFOURTH:
+        return "1/64";
     default:
         return "-";
     }
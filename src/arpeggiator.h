@@ -1,7 +1,7 @@
 #pragma once
 #include <stddef.h>
 
-struct Synth; // Forward declaration
+struct Part; // Forward declaration
 
 typedef enum {
   ARP_OFF,
@@ -29,6 +29,7 @@ typedef enum {
   RATE_EIGHTH = 1,   // 1/8 notes (default)
   RATE_SIXTEENTH = 2, // 1/16 notes
   RATE_THIRTYSECOND = 3, // 1/32 notes
+  RATE_SIXTYFOURTH = 4, // 1/64 notes
 } ArpRate;
 
 typedef enum {
@@ -39,22 +40,42 @@ typedef enum {
 } ChordType;
 
 #define ARP_PATTERN_LEN 16
+#define ARP_MAX_SEQUENCE 96 // 16 held notes across 6 octaves
+#define ARP_MAX_RATCHET 8
+#define ARP_STEP_NOTES 8    // Most notes one step plays (chord mode)
+
+// One column of the step lanes. The defaults play every step once at the
+// arpeggiator's gate length.
+typedef struct {
+  float velocity;               // 0-1
+  float gate;                   // Scales gate_length
+  int ratchet;                  // Evenly spaced hits within the step (1-ARP_MAX_RATCHET)
+  int tie;                      // Keep the previous notes sounding instead of retriggering
+  float probability;            // Chance the step plays (0-1)
+} ArpStep;
+
+// Settings that shape the expanded note order
+typedef struct {
+  int mode, polyphonic, octave, octaves;
+  int chord_type, add_6, add_m7, add_M7, add_9, voicing;
+} ArpSequenceKey;
 
 // Structure to track active arpeggiated notes
 typedef struct {
     int note;
-    float remaining_duration;
+    double off_beat; // Transport beat of the note off
     int active;
 } ActiveArpeggiatedNote;
 
 typedef struct {
   int enabled;
   ArpMode mode;
-  int pattern[ARP_PATTERN_LEN];
+  ArpStep lanes[ARP_PATTERN_LEN];
+  int pattern_length;           // Lane steps in use (1-ARP_PATTERN_LEN)
+  float swing;                  // Odd-step position: 0.5 = straight, 0.75 = hard shuffle
   int step;
-  float tempo;
-  ArpRate rate;
-  float step_phase;
+  ArpRate rate;                 // Tempo comes from the synth's transport
+  double next_step_beat;        // Transport beat of the next step, < 0 when stopped
   int held_count;
   int held_notes[16];
   float last_step_time;
@@ -75,10 +96,29 @@ typedef struct {
   float gate_length; // Gate length (0.0-1.0) - proportion of step time note should sound
   
   ActiveArpeggiatedNote active_arpeggiated_notes[16]; // Max 16 notes in a polyphonic step
+
+  // Held notes expanded into play order, rebuilt only when the notes or
+  // the key settings change, so a step is a table read
+  int sequence[ARP_MAX_SEQUENCE];
+  int sequence_len;
+  int sequence_chord;           // The whole sequence sounds on every step
+  int sequence_dirty;           // Held notes changed since the last build
+  ArpSequenceKey sequence_key;  // Settings of the last build
+
+  // Ratchet hits still to come in the current step, on transport beats
+  int ratchet_notes[ARP_STEP_NOTES];
+  int ratchet_note_count;
+  int ratchets_left;
+  double ratchet_beat;          // Next hit
+  double ratchet_beats;         // Spacing between hits
+  double ratchet_gate;          // Note length of each hit (beats)
+  float ratchet_velocity;
+  int ratchet_held;             // The next step is a tie
+  unsigned int rng;             // Step probability and random mode
 } Arpeggiator;
 
 void arpeggiator_init(Arpeggiator *arp);
-void arpeggiator_set_param(Arpeggiator *arp, const char *param, float value, struct Synth *synth);
+void arpeggiator_set_param(Arpeggiator *arp, const char *param, float value, struct Part *part);
 const char *arpeggiator_mode_str(const Arpeggiator *arp);
 const char *arpeggiator_rate_str(const Arpeggiator *arp);
 const char *arpeggiator_chord_str(const Arpeggiator *arp);
@@ -86,5 +126,16 @@ int arpeggiator_generate_chord(const Arpeggiator *arp, int root_note, int *chord
 void arpeggiator_note_on(Arpeggiator *arp, int note);
 void arpeggiator_note_off(Arpeggiator *arp, int note);
 void arpeggiator_clear_notes(Arpeggiator *arp);
-void arpeggiator_clear_notes_with_synth(Arpeggiator *arp, struct Synth *synth);
-int arpeggiator_step(Arpeggiator *arp, float samplerate, struct Synth *synth);
\ No newline at end of file
+void arpeggiator_clear_notes_with_part(Arpeggiator *arp, struct Part *part);
+// The transport jumped or stopped: end the notes in flight and start the
+// steps again from wherever it runs next. Held keys stay.
+void arpeggiator_locate(Arpeggiator *arp, struct Part *part);
+// Step length in quarter notes for the current rate
+double arpeggiator_step_beats(const Arpeggiator *arp);
+// Swing delay of the next step, in beats after its grid position
+double arpeggiator_swing_offset(const Arpeggiator *arp);
+// Play the next step, whose grid position is transport beat 'beat'. The
+// caller fires it at beat + arpeggiator_swing_offset().
+int arpeggiator_step(Arpeggiator *arp, double beat, struct Part *part);
+// Play the ratchet hit due at arp->ratchet_beat
+void arpeggiator_ratchet(Arpeggiator *arp, struct Part *part);
\ No newline at end of file
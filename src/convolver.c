@@ -0,0 +1,412 @@
+#include "convolver.h"
+#include "wav.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEAD_BINS (CONV_HEAD_BLOCK + 1)
+#define TAIL_BINS (CONV_TAIL_BLOCK + 1)
+#define HEAD_PER_TAIL (CONV_TAIL_BLOCK / CONV_HEAD_BLOCK)
+
+static void kernel_free(ConvKernel *k) {
+  if (!k)
+    return;
+  for (int ch = 0; ch < 2; ++ch) {
+    free(k->head_re[ch]);
+    free(k->head_im[ch]);
+    free(k->tail_re[ch]);
+    free(k->tail_im[ch]);
+    free(k->head_fdl_re[ch]);
+    free(k->head_fdl_im[ch]);
+    free(k->tail_fdl_re[ch]);
+    free(k->tail_fdl_im[ch]);
+    free(k->head_prev[ch]);
+    free(k->tail_prev[ch]);
+  }
+  free(k);
+}
+
+// Transform zero-padded partitions of ir[start, start + parts * block)
+static void kernel_partitions(Fft *fft, const float *ir, int ir_len, int start,
+                              int parts, int block, float *re, float *im) {
+  float *time = calloc((size_t)block * 2, sizeof(float));
+  int bins = block + 1;
+  for (int p = 0; p < parts; ++p) {
+    memset(time, 0, sizeof(float) * block * 2);
+    for (int i = 0; i < block; ++i) {
+      int idx = start + p * block + i;
+      if (idx < ir_len)
+        time[i] = ir[idx];
+    }
+    fft_real_forward(fft, time, re + (size_t)p * bins, im + (size_t)p * bins);
+  }
+  free(time);
+}
+
+// ir[ch] holds channel ch at the engine rate; runs on the loading thread
+static ConvKernel *kernel_create(float *const ir[2], int frames, int channels) {
+  ConvKernel *k = calloc(1, sizeof(ConvKernel));
+  if (!k)
+    return NULL;
+  k->channels = channels;
+
+  int head_len = frames < CONV_HEAD_LEN ? frames : CONV_HEAD_LEN;
+  int tail_len = frames - CONV_HEAD_LEN;
+  k->head_parts = (head_len + CONV_HEAD_BLOCK - 1) / CONV_HEAD_BLOCK;
+  if (k->head_parts < 1)
+    k->head_parts = 1;
+  k->tail_parts = tail_len > 0 ? (tail_len + CONV_TAIL_BLOCK - 1) / CONV_TAIL_BLOCK : 0;
+
+  size_t head_size = (size_t)k->head_parts * HEAD_BINS;
+  size_t tail_size = (size_t)k->tail_parts * TAIL_BINS;
+  int ok = 1;
+  for (int ch = 0; ch < 2; ++ch) {
+    k->head_fdl_re[ch] = calloc(head_size, sizeof(float));
+    k->head_fdl_im[ch] = calloc(head_size, sizeof(float));
+    k->head_prev[ch] = calloc(CONV_HEAD_BLOCK, sizeof(float));
+    k->tail_prev[ch] = calloc(CONV_TAIL_BLOCK, sizeof(float));
+    ok &= k->head_fdl_re[ch] && k->head_fdl_im[ch] && k->head_prev[ch] && k->tail_prev[ch];
+    if (tail_size) {
+      k->tail_fdl_re[ch] = calloc(tail_size, sizeof(float));
+      k->tail_fdl_im[ch] = calloc(tail_size, sizeof(float));
+      ok &= k->tail_fdl_re[ch] && k->tail_fdl_im[ch];
+    }
+    if (ch < channels) {
+      k->head_re[ch] = malloc(sizeof(float) * head_size);
+      k->head_im[ch] = malloc(sizeof(float) * head_size);
+      ok &= k->head_re[ch] && k->head_im[ch];
+      if (tail_size) {
+        k->tail_re[ch] = malloc(sizeof(float) * tail_size);
+        k->tail_im[ch] = malloc(sizeof(float) * tail_size);
+        ok &= k->tail_re[ch] && k->tail_im[ch];
+      }
+    }
+  }
+  if (!ok) {
+    kernel_free(k);
+    return NULL;
+  }
+
+  Fft head_fft, tail_fft;
+  fft_init(&head_fft, CONV_HEAD_BLOCK * 2);
+  fft_init(&tail_fft, CONV_TAIL_BLOCK * 2);
+  for (int ch = 0; ch < channels; ++ch) {
+    kernel_partitions(&head_fft, ir[ch], head_len, 0, k->head_parts,
+                      CONV_HEAD_BLOCK, k->head_re[ch], k->head_im[ch]);
+    if (k->tail_parts)
+      kernel_partitions(&tail_fft, ir[ch], frames, CONV_HEAD_LEN, k->tail_parts,
+                        CONV_TAIL_BLOCK, k->tail_re[ch], k->tail_im[ch]);
+  }
+  fft_cleanup(&head_fft);
+  fft_cleanup(&tail_fft);
+  return k;
+}
+
+// acc += x * h over all bins
+static void spectrum_mac(float *acc_re, float *acc_im, const float *x_re,
+                         const float *x_im, const float *h_re,
+                         const float *h_im, int bins) {
+  for (int i = 0; i < bins; ++i) {
+    acc_re[i] += x_re[i] * h_re[i] - x_im[i] * h_im[i];
+    acc_im[i] += x_re[i] * h_im[i] + x_im[i] * h_re[i];
+  }
+}
+
+// Overlap-save step for one channel: transforms [prev, in] into the newest
+// FDL slot, sums the partition products and writes the last block of the
+// inverse transform to out
+static void partition_convolve(Fft *fft, float *time, float *acc_re,
+                               float *acc_im, float *prev, const float *in,
+                               float *fdl_re, float *fdl_im, int fdl_pos,
+                               const float *h_re, const float *h_im,
+                               int parts, int block, float *out) {
+  int bins = block + 1;
+  memcpy(time, prev, sizeof(float) * block);
+  memcpy(time + block, in, sizeof(float) * block);
+  memcpy(prev, in, sizeof(float) * block);
+  fft_real_forward(fft, time, fdl_re + (size_t)fdl_pos * bins,
+                   fdl_im + (size_t)fdl_pos * bins);
+
+  memset(acc_re, 0, sizeof(float) * bins);
+  memset(acc_im, 0, sizeof(float) * bins);
+  for (int p = 0; p < parts; ++p) {
+    int slot = fdl_pos - p;
+    if (slot < 0)
+      slot += parts;
+    spectrum_mac(acc_re, acc_im, fdl_re + (size_t)slot * bins,
+                 fdl_im + (size_t)slot * bins, h_re + (size_t)p * bins,
+                 h_im + (size_t)p * bins, bins);
+  }
+
+  fft_real_inverse(fft, acc_re, acc_im, time);
+  memcpy(out, time + block, sizeof(float) * block);
+}
+
+// Tail block for one slot; runs on the worker (or the audio thread without one)
+static void tail_block(Convolver *c, int block) {
+  int slot = block & (CONV_TAIL_SLOTS - 1);
+  ConvKernel *k = c->tail_kernel[slot];
+
+  if (k->tail_parts == 0) {
+    memset(c->tail_out[slot][0], 0, sizeof(float) * CONV_TAIL_BLOCK);
+    memset(c->tail_out[slot][1], 0, sizeof(float) * CONV_TAIL_BLOCK);
+  } else {
+    if (++k->tail_fdl_pos >= k->tail_parts)
+      k->tail_fdl_pos = 0;
+    for (int ch = 0; ch < 2; ++ch) {
+      int ir = ch % k->channels;
+      partition_convolve(&c->tail_fft, c->tail_time, c->tail_acc_re,
+                         c->tail_acc_im, k->tail_prev[ch], c->tail_in[slot][ch],
+                         k->tail_fdl_re[ch], k->tail_fdl_im[ch], k->tail_fdl_pos,
+                         k->tail_re[ir], k->tail_im[ir], k->tail_parts,
+                         CONV_TAIL_BLOCK, c->tail_out[slot][ch]);
+    }
+  }
+
+  platform_atomic_set(&c->tail_ready[slot], block);
+  platform_atomic_set(&c->tail_done, block);
+}
+
+static int conv_worker(void *data) {
+  Convolver *c = (Convolver *)data;
+  int next = 0;
+
+  for (;;) {
+    platform_sem_wait(c->work_sem);
+    if (platform_atomic_get(&c->quit))
+      break;
+
+    int last = platform_atomic_get(&c->tail_submitted);
+    // Blocks older than the slot ring have been overwritten; skip them
+    if (last - next >= CONV_TAIL_SLOTS)
+      next = last - CONV_TAIL_SLOTS + 1;
+    for (; next <= last; ++next)
+      if (c->tail_job[next & (CONV_TAIL_SLOTS - 1)] == next)
+        tail_block(c, next);
+  }
+  return 0;
+}
+
+// Head block plus the matching slice of tail output; audio thread
+static void head_block(Convolver *c, ConvKernel *k) {
+  if (++k->head_fdl_pos >= k->head_parts)
+    k->head_fdl_pos = 0;
+  for (int ch = 0; ch < 2; ++ch) {
+    int ir = ch % k->channels;
+    partition_convolve(&c->head_fft, c->head_time, c->head_acc_re,
+                       c->head_acc_im, k->head_prev[ch], c->head_in[ch],
+                       k->head_fdl_re[ch], k->head_fdl_im[ch], k->head_fdl_pos,
+                       k->head_re[ir], k->head_im[ir], k->head_parts,
+                       CONV_HEAD_BLOCK, c->head_out[ch]);
+  }
+
+  // Feed the tail; a block is submitted once HEAD_PER_TAIL head blocks fill it
+  long long j = c->head_block++;
+  int sub = (int)(j % HEAD_PER_TAIL);
+  int block = (int)(j / HEAD_PER_TAIL);
+  int slot = block & (CONV_TAIL_SLOTS - 1);
+  for (int ch = 0; ch < 2; ++ch)
+    memcpy(c->tail_in[slot][ch] + sub * CONV_HEAD_BLOCK, c->head_in[ch],
+           sizeof(float) * CONV_HEAD_BLOCK);
+  if (sub == HEAD_PER_TAIL - 1) {
+    c->tail_kernel[slot] = k;
+    c->tail_job[slot] = block;
+    platform_atomic_set(&c->tail_submitted, block);
+    if (c->worker)
+      platform_sem_post(c->work_sem);
+    else
+      tail_block(c, block);
+  }
+
+  // The head covers CONV_HEAD_LEN = 2 tail blocks, so the tail output due
+  // next comes from the block submitted two blocks ago
+  int due = block - 2;
+  if (due < 0)
+    return;
+  int due_slot = due & (CONV_TAIL_SLOTS - 1);
+  if (c->tail_job[due_slot] != due)
+    return; // Not submitted (stage was bypassed)
+  if (platform_atomic_get(&c->tail_ready[due_slot]) != due) {
+    platform_atomic_add(&c->late_blocks, 1);
+    return;
+  }
+  for (int ch = 0; ch < 2; ++ch) {
+    const float *tail = c->tail_out[due_slot][ch] + sub * CONV_HEAD_BLOCK;
+    for (int i = 0; i < CONV_HEAD_BLOCK; ++i)
+      c->head_out[ch][i] += tail[i];
+  }
+}
+
+int convolver_init(Convolver *c, int sample_rate) {
+  memset(c, 0, sizeof(Convolver));
+  c->sample_rate = sample_rate;
+  platform_atomic_set(&c->tail_submitted, -1);
+  platform_atomic_set(&c->tail_done, -1);
+  platform_atomic_set(&c->retire_block, -1);
+
+  if (!fft_init(&c->head_fft, CONV_HEAD_BLOCK * 2) ||
+      !fft_init(&c->tail_fft, CONV_TAIL_BLOCK * 2))
+    return 0;
+  c->head_time = calloc(CONV_HEAD_BLOCK * 2, sizeof(float));
+  c->head_acc_re = calloc(HEAD_BINS, sizeof(float));
+  c->head_acc_im = calloc(HEAD_BINS, sizeof(float));
+  c->tail_time = calloc(CONV_TAIL_BLOCK * 2, sizeof(float));
+  c->tail_acc_re = calloc(TAIL_BINS, sizeof(float));
+  c->tail_acc_im = calloc(TAIL_BINS, sizeof(float));
+  for (int s = 0; s < CONV_TAIL_SLOTS; ++s) {
+    c->tail_job[s] = -1;
+    platform_atomic_set(&c->tail_ready[s], -1);
+    for (int ch = 0; ch < 2; ++ch) {
+      c->tail_in[s][ch] = calloc(CONV_TAIL_BLOCK, sizeof(float));
+      c->tail_out[s][ch] = calloc(CONV_TAIL_BLOCK, sizeof(float));
+    }
+  }
+
+  c->work_sem = platform_sem_create(0);
+  if (c->work_sem)
+    c->worker = platform_thread_create(conv_worker, "convolver", c);
+  if (!c->worker)
+    platform_log("Convolver worker unavailable, tail runs on the audio thread");
+  return 1;
+}
+
+// Frees the kernel the audio thread retired once the worker is past it
+static void collect_retired(Convolver *c, int wait_ms) {
+  ConvKernel *old = (ConvKernel *)platform_atomic_get_ptr(&c->retired);
+  if (!old)
+    return;
+  while (platform_atomic_get(&c->tail_done) < platform_atomic_get(&c->retire_block) &&
+         wait_ms-- > 0)
+    platform_sleep_ms(1);
+  if (platform_atomic_get(&c->tail_done) < platform_atomic_get(&c->retire_block))
+    return;
+  kernel_free(old);
+  platform_atomic_set_ptr(&c->retired, NULL);
+}
+
+void convolver_collect(Convolver *c) {
+  collect_retired(c, 0);
+}
+
+int convolver_load_ir(Convolver *c, const char *path) {
+  WavData wav;
+  if (!wav_load(path, &wav)) {
+    platform_log("Failed to load impulse response: %s", path);
+    return 0;
+  }
+
+  int channels = wav.channels >= 2 ? 2 : 1;
+  double ratio = (double)wav.sample_rate / c->sample_rate;
+  int frames = (int)(wav.frames / ratio);
+  int max_frames = (int)(CONV_MAX_SECONDS * c->sample_rate);
+  if (frames > max_frames)
+    frames = max_frames;
+  if (frames < 1) {
+    wav_free(&wav);
+    return 0;
+  }
+
+  // Resample to the engine rate with linear interpolation
+  float *ir[2] = {NULL, NULL};
+  double energy = 0.0;
+  for (int ch = 0; ch < channels; ++ch) {
+    ir[ch] = malloc(sizeof(float) * frames);
+    if (!ir[ch])
+      continue;
+    for (int i = 0; i < frames; ++i) {
+      double pos = i * ratio;
+      int i0 = (int)pos;
+      int i1 = i0 + 1 < wav.frames ? i0 + 1 : i0;
+      float frac = (float)(pos - i0);
+      float a = wav.samples[(size_t)i0 * wav.channels + ch];
+      float b = wav.samples[(size_t)i1 * wav.channels + ch];
+      ir[ch][i] = a + frac * (b - a);
+      energy += (double)ir[ch][i] * ir[ch][i];
+    }
+  }
+  wav_free(&wav);
+
+  ConvKernel *k = NULL;
+  if (ir[0] && (channels == 1 || ir[1])) {
+    // Unit energy per channel keeps the wet level independent of the IR
+    float scale = energy > 0.0 ? (float)(1.0 / sqrt(energy / channels)) : 0.0f;
+    for (int ch = 0; ch < channels; ++ch)
+      for (int i = 0; i < frames; ++i)
+        ir[ch][i] *= scale;
+    k = kernel_create(ir, frames, channels);
+  }
+  free(ir[0]);
+  free(ir[1]);
+  if (!k)
+    return 0;
+
+  // The audio thread only takes a pending kernel once the retired slot is empty
+  collect_retired(c, 500);
+  ConvKernel *unused = (ConvKernel *)platform_atomic_set_ptr(&c->pending, k);
+  kernel_free(unused);
+  platform_log("Loaded impulse response %s (%d frames, %d ch)", path, frames, channels);
+  return 1;
+}
+
+void convolver_process(Convolver *c, float *stereo, int frames, float mix) {
+  // Swap in a freshly prepared kernel; the old one is freed off this thread
+  if (!platform_atomic_get_ptr(&c->retired)) {
+    ConvKernel *next = (ConvKernel *)platform_atomic_set_ptr(&c->pending, NULL);
+    if (next) {
+      if (c->active) {
+        platform_atomic_set(&c->retire_block, platform_atomic_get(&c->tail_submitted));
+        platform_atomic_set_ptr(&c->retired, c->active);
+      }
+      c->active = next;
+    }
+  }
+
+  ConvKernel *k = c->active;
+  if (!k)
+    return;
+
+  for (int n = 0; n < frames; ++n) {
+    for (int ch = 0; ch < 2; ++ch) {
+      float in = stereo[n * 2 + ch];
+      c->head_in[ch][c->head_fill] = in;
+      stereo[n * 2 + ch] = in * (1.0f - mix) + c->head_out[ch][c->head_fill] * mix;
+    }
+    if (++c->head_fill == CONV_HEAD_BLOCK) {
+      c->head_fill = 0;
+      head_block(c, k);
+    }
+  }
+}
+
+void convolver_cleanup(Convolver *c) {
+  if (c->worker) {
+    platform_atomic_set(&c->quit, 1);
+    platform_sem_post(c->work_sem);
+    platform_thread_join(c->worker);
+    c->worker = NULL;
+  }
+  if (c->work_sem) {
+    platform_sem_destroy(c->work_sem);
+    c->work_sem = NULL;
+  }
+
+  kernel_free(c->active);
+  kernel_free((ConvKernel *)platform_atomic_set_ptr(&c->pending, NULL));
+  kernel_free((ConvKernel *)platform_atomic_set_ptr(&c->retired, NULL));
+  c->active = NULL;
+
+  fft_cleanup(&c->head_fft);
+  fft_cleanup(&c->tail_fft);
+  free(c->head_time);
+  free(c->head_acc_re);
+  free(c->head_acc_im);
+  free(c->tail_time);
+  free(c->tail_acc_re);
+  free(c->tail_acc_im);
+  for (int s = 0; s < CONV_TAIL_SLOTS; ++s)
+    for (int ch = 0; ch < 2; ++ch) {
+      free(c->tail_in[s][ch]);
+      free(c->tail_out[s][ch]);
+      c->tail_in[s][ch] = c->tail_out[s][ch] = NULL;
+    }
+}
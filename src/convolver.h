@@ -0,0 +1,83 @@
+#pragma once
+#include "platform.h"
+#include "fft.h"
+
+// Non-uniformly partitioned FFT convolution reverb (overlap-save).
+// The first CONV_HEAD_LEN samples of the IR run in small partitions on the
+// audio thread; the tail runs in large partitions on a worker thread, which
+// has a full tail block of slack before its output is due.
+#define CONV_HEAD_BLOCK 128                      // Head partition (wet latency)
+#define CONV_TAIL_BLOCK 2048                     // Tail partition
+#define CONV_HEAD_LEN (2 * CONV_TAIL_BLOCK)      // IR samples covered by the head
+#define CONV_TAIL_SLOTS 4                        // In-flight tail blocks
+#define CONV_MAX_SECONDS 10.0f                   // Longer IRs are truncated
+
+// Prepared IR spectra plus the per-kernel convolution state, built entirely
+// off the audio thread so a swap never allocates or runs an FFT there
+typedef struct ConvKernel {
+  int channels;                   // 1 (mono IR on both sides) or 2
+  int head_parts, tail_parts;
+  float *head_re[2], *head_im[2]; // head_parts * (CONV_HEAD_BLOCK + 1)
+  float *tail_re[2], *tail_im[2]; // tail_parts * (CONV_TAIL_BLOCK + 1)
+
+  // Frequency-domain delay lines of past input spectra
+  float *head_fdl_re[2], *head_fdl_im[2];
+  float *tail_fdl_re[2], *tail_fdl_im[2];
+  int head_fdl_pos, tail_fdl_pos;
+  float *head_prev[2];            // Previous input block (overlap-save history)
+  float *tail_prev[2];
+} ConvKernel;
+
+typedef struct {
+  int sample_rate;
+
+  ConvKernel *active;             // Audio thread only
+  PlatformAtomicPtr pending;      // Published by the loader, taken by the audio thread
+  PlatformAtomicPtr retired;      // Handed back by the audio thread for freeing
+  PlatformAtomic retire_block;    // Tail block the retired kernel was last used for
+
+  // Audio thread: head partition
+  Fft head_fft;
+  float head_in[2][CONV_HEAD_BLOCK];
+  float head_out[2][CONV_HEAD_BLOCK];
+  float *head_time;               // 2 * CONV_HEAD_BLOCK scratch
+  float *head_acc_re, *head_acc_im;
+  int head_fill;
+  long long head_block;           // Completed head blocks since init
+
+  // Tail blocks shared with the worker, indexed by block & (CONV_TAIL_SLOTS - 1)
+  float *tail_in[CONV_TAIL_SLOTS][2];
+  float *tail_out[CONV_TAIL_SLOTS][2];
+  ConvKernel *tail_kernel[CONV_TAIL_SLOTS];
+  int tail_job[CONV_TAIL_SLOTS];          // Block queued in each slot
+  PlatformAtomic tail_ready[CONV_TAIL_SLOTS]; // Block whose output each slot holds
+  PlatformAtomic tail_submitted;  // Newest block handed to the worker
+  PlatformAtomic tail_done;       // Newest block the worker finished
+  PlatformAtomic late_blocks;     // Tail blocks that missed their deadline
+
+  // Worker thread: tail partitions
+  Fft tail_fft;
+  float *tail_time;               // 2 * CONV_TAIL_BLOCK scratch
+  float *tail_acc_re, *tail_acc_im;
+  PlatformThread *worker;
+  PlatformSem *work_sem;
+  PlatformAtomic quit;
+} Convolver;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int convolver_init(Convolver *c, int sample_rate);
+// Loads and prepares a WAV IR; call from a non-audio thread. Returns 1 on success.
+int convolver_load_ir(Convolver *c, const char *path);
+// Host thread, now and then: frees a kernel the audio thread replaced once
+// the worker is past it, without waiting. A load whose wait timed out
+// leaves the new kernel pending until this runs.
+void convolver_collect(Convolver *c);
+void convolver_process(Convolver *c, float *stereo, int frames, float mix);
+void convolver_cleanup(Convolver *c);
+
+#ifdef __cplusplus
+}
+#endif
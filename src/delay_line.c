@@ -0,0 +1,97 @@
+#include "delay_line.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+int delay_line_init(DelayLine *d, int max_delay) {
+  // Headroom for the interpolation neighbours on both sides
+  int size = 1;
+  while (size < max_delay + 4)
+    size <<= 1;
+  d->size = size;
+  d->mask = size - 1;
+  d->pos = 0;
+  d->buf = calloc(d->size, sizeof(float));
+  return d->buf != NULL;
+}
+
+void delay_line_clear(DelayLine *d) {
+  if (d->buf)
+    memset(d->buf, 0, sizeof(float) * d->size);
+  d->pos = 0;
+}
+
+void delay_line_cleanup(DelayLine *d) {
+  if (d->buf) {
+    free(d->buf);
+    d->buf = NULL;
+  }
+}
+
+void delay_glide_init(DelayGlide *g, float delay, float glide_ms, float sample_rate) {
+  g->current = delay;
+  g->target = delay;
+  g->coeff = 1.0f - expf(-1.0f / (glide_ms * 0.001f * sample_rate));
+}
+
+const float *delay_line_span(const DelayLine *d, int delay, int n, float *scratch) {
+  int start = (d->pos - delay) & d->mask;
+  int first = d->size - start;
+  if (n <= first)
+    return d->buf + start;
+  memcpy(scratch, d->buf + start, sizeof(float) * first);
+  memcpy(scratch + first, d->buf, sizeof(float) * (n - first));
+  return scratch;
+}
+
+void delay_line_write_block(DelayLine *d, const float *in, int n) {
+  int first = d->size - d->pos;
+  if (n <= first) {
+    memcpy(d->buf + d->pos, in, sizeof(float) * n);
+  } else {
+    memcpy(d->buf + d->pos, in, sizeof(float) * first);
+    memcpy(d->buf, in + first, sizeof(float) * (n - first));
+  }
+  d->pos = (d->pos + n) & d->mask;
+}
+
+float delay_line_read_cubic(const DelayLine *d, float delay) {
+  float max_delay = (float)(d->size - 3);
+  if (delay < 2.0f)
+    delay = 2.0f;
+  else if (delay > max_delay)
+    delay = max_delay;
+
+  int di = (int)delay;
+  float t = delay - (float)di;
+  float xm1 = delay_line_read(d, di - 1); // Newer neighbour
+  float x0 = delay_line_read(d, di);
+  float x1 = delay_line_read(d, di + 1);
+  float x2 = delay_line_read(d, di + 2);
+
+  // Catmull-Rom / Hermite through x0..x1
+  float c1 = 0.5f * (x1 - xm1);
+  float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+  float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+  return ((c3 * t + c2) * t + c1) * t + x0;
+}
+
+float delay_line_read_allpass(const DelayLine *d, DelayTap *tap, float delay) {
+  float max_delay = (float)(d->size - 3);
+  if (delay < 1.5f)
+    delay = 1.5f;
+  else if (delay > max_delay)
+    delay = max_delay;
+
+  // Keep the fractional part in [0.5, 1.5) so the coefficient stays well
+  // away from the pole at -1
+  int di = (int)(delay - 0.5f);
+  float frac = delay - (float)di;
+  float a = (1.0f - frac) / (1.0f + frac);
+
+  float x0 = delay_line_read(d, di);
+  float x1 = delay_line_read(d, di + 1);
+  float y = a * (x0 - tap->y1) + x1;
+  tap->y1 = y;
+  return y;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// Mono delay line with fractional reads. Reads happen before the write of
+// the current sample, so a delay of d returns the input from d samples ago.
+// Capacity is a power of two so positions wrap with a mask.
+typedef struct {
+  float *buf;
+  int size;           // Capacity in samples (power of two)
+  int mask;           // size - 1
+  int pos;            // Next write position
+} DelayLine;
+
+// Per-tap state for allpass interpolation (one per modulated read)
+typedef struct {
+  float y1;
+} DelayTap;
+
+// One-pole glide toward a target delay, so time changes bend pitch like
+// tape instead of clicking
+typedef struct {
+  float current;      // Samples
+  float target;       // Samples
+  float coeff;        // Per-sample smoothing factor
+} DelayGlide;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int delay_line_init(DelayLine *d, int max_delay);
+void delay_line_clear(DelayLine *d);
+void delay_line_cleanup(DelayLine *d);
+
+void delay_glide_init(DelayGlide *g, float delay, float glide_ms, float sample_rate);
+
+// Contiguous view of the n samples starting 'delay' samples back (oldest
+// first). Points into the line when the span doesn't wrap, otherwise copies
+// into scratch. Requires n <= delay so every sample is already written.
+const float *delay_line_span(const DelayLine *d, int delay, int n, float *scratch);
+void delay_line_write_block(DelayLine *d, const float *in, int n);
+
+// Cubic (4-point Hermite) read; delay is clamped to [2, size - 3]
+float delay_line_read_cubic(const DelayLine *d, float delay);
+// First-order allpass read for modulated delays; flat magnitude response.
+// Delay is clamped to [1.5, size - 3].
+float delay_line_read_allpass(const DelayLine *d, DelayTap *tap, float delay);
+
+static inline float delay_line_read(const DelayLine *d, int delay) {
+  return d->buf[(d->pos - delay) & d->mask];
+}
+
+static inline void delay_line_write(DelayLine *d, float x) {
+  d->buf[d->pos] = x;
+  d->pos = (d->pos + 1) & d->mask;
+}
+
+static inline float delay_glide_next(DelayGlide *g) {
+  g->current += (g->target - g->current) * g->coeff;
+  return g->current;
+}
+
+#ifdef __cplusplus
+}
+#endif
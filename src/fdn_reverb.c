@@ -0,0 +1,141 @@
+#include "fdn_reverb.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Mutually prime-ish delay lengths (ms) to spread modal density
+static const float fdn_delay_ms[FDN_LINES] = {
+    29.7f, 37.1f, 41.1f, 43.7f, 53.3f, 59.9f, 67.1f, 73.3f};
+
+// Slightly detuned modulation rates (Hz) so the lines never move together
+static const float fdn_mod_rate[FDN_LINES] = {
+    0.31f, 0.37f, 0.41f, 0.47f, 0.53f, 0.59f, 0.61f, 0.67f};
+
+// Input injection and output tap signs keep L/R decorrelated
+static const float fdn_in_sign[FDN_LINES] = {1, -1, 1, -1, 1, -1, 1, -1};
+static const float fdn_out_l[FDN_LINES] = {1, 0, -1, 0, 1, 0, -1, 0};
+static const float fdn_out_r[FDN_LINES] = {0, 1, 0, -1, 0, 1, 0, -1};
+
+#define FDN_MOD_DEPTH_MS 0.25f
+#define FDN_MOD_BLOCK 16
+#define FDN_OUTPUT_GAIN 0.5f
+#define FDN_DENORMAL_GUARD 1e-20f
+
+void fdn_reverb_init(FdnReverb *r, float sample_rate) {
+  memset(r, 0, sizeof(FdnReverb));
+  r->sample_rate = sample_rate;
+  r->mod_depth = FDN_MOD_DEPTH_MS * 0.001f * sample_rate;
+
+  float max_delay = 0.0f;
+  for (int i = 0; i < FDN_LINES; ++i) {
+    r->delay[i] = fdn_delay_ms[i] * 0.001f * sample_rate;
+    r->lfo_phase[i] = (float)i / FDN_LINES;
+    r->lfo_inc[i] = fdn_mod_rate[i] / sample_rate;
+    if (r->delay[i] > max_delay)
+      max_delay = r->delay[i];
+  }
+
+  // Room for the longest line plus modulation swing and interpolation,
+  // rounded up to a power of two so positions wrap with a mask
+  int needed = (int)(max_delay + r->mod_depth) + 4;
+  r->length = 1;
+  while (r->length < needed)
+    r->length <<= 1;
+  r->mask = r->length - 1;
+  r->buf = calloc((size_t)r->length * FDN_LINES, sizeof(float));
+
+  fdn_reverb_set_params(r, 0.5f, 0.3f);
+}
+
+// Coefficients only change here, never in the per-sample loop
+void fdn_reverb_set_params(FdnReverb *r, float size, float damping) {
+  r->size = fmaxf(0.0f, fminf(1.0f, size));
+  r->damping = fmaxf(0.0f, fminf(1.0f, damping));
+
+  // Low frequencies decay over RT60, highs over a damping-shortened RT60
+  float rt60_low = 0.2f + r->size * 5.8f;
+  float rt60_high = rt60_low * (1.0f - 0.9f * r->damping);
+
+  for (int i = 0; i < FDN_LINES; ++i) {
+    float seconds = r->delay[i] / r->sample_rate;
+    float g_dc = powf(10.0f, -3.0f * seconds / rt60_low);
+    float g_nyq = powf(10.0f, -3.0f * seconds / rt60_high);
+
+    // One-pole H(z) = g (1 - b) / (1 - b z^-1): DC gain g_dc, Nyquist gain g_nyq
+    float b = (g_dc - g_nyq) / (g_dc + g_nyq);
+    r->damp_b0[i] = g_dc * (1.0f - b);
+    r->damp_a1[i] = b;
+  }
+}
+
+void fdn_reverb_process(FdnReverb *r, float *stereo, int frames, float mix) {
+  if (!r->buf)
+    return;
+
+  const int mask = r->mask;
+  int delay_int[FDN_LINES];
+  float delay_frac[FDN_LINES];
+  float taps[FDN_LINES];
+
+  for (int start = 0; start < frames; start += FDN_MOD_BLOCK) {
+    int end = start + FDN_MOD_BLOCK < frames ? start + FDN_MOD_BLOCK : frames;
+
+    // Modulation runs at control rate; the delay moves far less than a
+    // sample per sub-block so holding it constant is inaudible
+    for (int i = 0; i < FDN_LINES; ++i) {
+      float tri = 4.0f * fabsf(r->lfo_phase[i] - 0.5f) - 1.0f;
+      r->lfo_phase[i] += r->lfo_inc[i] * (float)(end - start);
+      if (r->lfo_phase[i] >= 1.0f)
+        r->lfo_phase[i] -= 1.0f;
+      float d = r->delay[i] + r->mod_depth * tri;
+      delay_int[i] = (int)d;
+      delay_frac[i] = d - (float)delay_int[i];
+    }
+
+    for (int n = start; n < end; ++n) {
+      float inL = stereo[n * 2 + 0];
+      float inR = stereo[n * 2 + 1];
+      float in = (inL + inR) * 0.5f;
+
+      // Read lines with linear interpolation, then apply frequency-dependent decay
+      for (int i = 0; i < FDN_LINES; ++i) {
+        int i0 = (r->pos - delay_int[i]) & mask;
+        int i1 = (i0 - 1) & mask;
+        float a = r->buf[i0 * FDN_LINES + i];
+        float b = r->buf[i1 * FDN_LINES + i];
+        float tap = a + delay_frac[i] * (b - a);
+        r->damp_state[i] = r->damp_b0[i] * tap +
+                           r->damp_a1[i] * r->damp_state[i] + FDN_DENORMAL_GUARD;
+        taps[i] = r->damp_state[i];
+      }
+
+      // Householder reflection: A = I - (2/N) * 1 * 1^T, O(N) and lossless
+      float sum = 0.0f;
+      for (int i = 0; i < FDN_LINES; ++i)
+        sum += taps[i];
+      sum *= 2.0f / FDN_LINES;
+
+      float *w = &r->buf[r->pos * FDN_LINES];
+      float outL = 0.0f, outR = 0.0f;
+      for (int i = 0; i < FDN_LINES; ++i) {
+        w[i] = taps[i] - sum + in * fdn_in_sign[i];
+        outL += taps[i] * fdn_out_l[i];
+        outR += taps[i] * fdn_out_r[i];
+      }
+
+      r->pos = (r->pos + 1) & mask;
+
+      outL *= FDN_OUTPUT_GAIN;
+      outR *= FDN_OUTPUT_GAIN;
+      stereo[n * 2 + 0] = inL * (1.0f - mix) + outL * mix;
+      stereo[n * 2 + 1] = inR * (1.0f - mix) + outR * mix;
+    }
+  }
+}
+
+void fdn_reverb_cleanup(FdnReverb *r) {
+  if (r->buf) {
+    free(r->buf);
+    r->buf = NULL;
+  }
+}
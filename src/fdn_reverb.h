@@ -0,0 +1,39 @@
+#pragma once
+
+// 8-line feedback delay network reverb with a Householder mixing matrix,
+// modulated delay lines and frequency-dependent decay (Jot absorption filters)
+#define FDN_LINES 8
+
+typedef struct {
+  float *buf;                   // Interleaved delay memory: buf[pos * FDN_LINES + line]
+  int length;                   // Frames per delay line, a power of two
+  int mask;                     // length - 1
+  int pos;                      // Shared write position
+
+  float delay[FDN_LINES];       // Base delay per line (samples)
+  float lfo_phase[FDN_LINES];   // Triangle LFO phase per line (0 to 1)
+  float lfo_inc[FDN_LINES];     // LFO phase increment per sample
+  float mod_depth;              // Delay modulation depth (samples)
+
+  // Absorption filters (one-pole lowpass with per-line loop gain)
+  float damp_b0[FDN_LINES];
+  float damp_a1[FDN_LINES];
+  float damp_state[FDN_LINES];
+
+  float size;                   // 0.0 to 1.0, maps to RT60
+  float damping;                // 0.0 (bright) to 1.0 (dark)
+  float sample_rate;
+} FdnReverb;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void fdn_reverb_init(FdnReverb *r, float sample_rate);
+void fdn_reverb_set_params(FdnReverb *r, float size, float damping);
+void fdn_reverb_process(FdnReverb *r, float *stereo, int frames, float mix);
+void fdn_reverb_cleanup(FdnReverb *r);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,153 @@
+#include "fft.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+int fft_init(Fft *fft, int size) {
+  memset(fft, 0, sizeof(Fft));
+  if (size < 4 || (size & (size - 1)) != 0)
+    return 0;
+
+  fft->size = size;
+  fft->half = size / 2;
+  int half = fft->half;
+
+  fft->bitrev = malloc(sizeof(int) * half);
+  fft->tw_re = malloc(sizeof(float) * (half / 2 + 1));
+  fft->tw_im = malloc(sizeof(float) * (half / 2 + 1));
+  fft->split_re = malloc(sizeof(float) * (half + 1));
+  fft->split_im = malloc(sizeof(float) * (half + 1));
+  fft->work_re = malloc(sizeof(float) * half);
+  fft->work_im = malloc(sizeof(float) * half);
+  if (!fft->bitrev || !fft->tw_re || !fft->tw_im || !fft->split_re ||
+      !fft->split_im || !fft->work_re || !fft->work_im) {
+    fft_cleanup(fft);
+    return 0;
+  }
+
+  int bits = 0;
+  while ((1 << bits) < half)
+    ++bits;
+  for (int i = 0; i < half; ++i) {
+    int r = 0;
+    for (int b = 0; b < bits; ++b)
+      if (i & (1 << b))
+        r |= 1 << (bits - 1 - b);
+    fft->bitrev[i] = r;
+  }
+
+  // Twiddles in double precision to keep large transforms accurate
+  for (int k = 0; k <= half / 2; ++k) {
+    double a = -2.0 * M_PI * k / half;
+    fft->tw_re[k] = (float)cos(a);
+    fft->tw_im[k] = (float)sin(a);
+  }
+  for (int k = 0; k <= half; ++k) {
+    double a = -2.0 * M_PI * k / size;
+    fft->split_re[k] = (float)cos(a);
+    fft->split_im[k] = (float)sin(a);
+  }
+  return 1;
+}
+
+// In-place iterative radix-2 DIT on split arrays (forward direction)
+static void fft_complex(const Fft *fft, float *re, float *im) {
+  const int n = fft->half;
+
+  for (int i = 0; i < n; ++i) {
+    int j = fft->bitrev[i];
+    if (j > i) {
+      float t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+
+  for (int len = 2; len <= n; len <<= 1) {
+    int step = n / len;
+    int halflen = len >> 1;
+    for (int start = 0; start < n; start += len) {
+      for (int k = 0; k < halflen; ++k) {
+        float wr = fft->tw_re[k * step];
+        float wi = fft->tw_im[k * step];
+        int a = start + k;
+        int b = a + halflen;
+        float xr = re[b] * wr - im[b] * wi;
+        float xi = re[b] * wi + im[b] * wr;
+        re[b] = re[a] - xr;
+        im[b] = im[a] - xi;
+        re[a] += xr;
+        im[a] += xi;
+      }
+    }
+  }
+}
+
+void fft_real_forward(Fft *fft, const float *in, float *re, float *im) {
+  const int half = fft->half;
+  float *zr = fft->work_re;
+  float *zi = fft->work_im;
+
+  // Pack even/odd samples as one complex sequence of half the length
+  for (int k = 0; k < half; ++k) {
+    zr[k] = in[2 * k];
+    zi[k] = in[2 * k + 1];
+  }
+  fft_complex(fft, zr, zi);
+
+  // Split into the spectrum of the real input
+  re[0] = zr[0] + zi[0];
+  im[0] = 0.0f;
+  re[half] = zr[0] - zi[0];
+  im[half] = 0.0f;
+  for (int k = 1; k < half; ++k) {
+    float ar = zr[k], ai = zi[k];
+    float br = zr[half - k], bi = -zi[half - k]; // conj(Z[half - k])
+    float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+    // O = (Z[k] - conj(Z[half - k])) / 2i
+    float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+    float wr = fft->split_re[k], wi = fft->split_im[k];
+    re[k] = er + (or_ * wr - oi * wi);
+    im[k] = ei + (or_ * wi + oi * wr);
+  }
+}
+
+void fft_real_inverse(Fft *fft, const float *re, const float *im, float *out) {
+  const int half = fft->half;
+  float *zr = fft->work_re;
+  float *zi = fft->work_im;
+
+  // Rebuild the packed complex spectrum Z = E + iO (conjugated for inverse)
+  for (int k = 0; k < half; ++k) {
+    float ar = re[k], ai = im[k];
+    float br = re[half - k], bi = -im[half - k]; // conj(X[half - k])
+    float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+    float dr = 0.5f * (ar - br), di = 0.5f * (ai - bi);
+    // O = D * W^-k
+    float wr = fft->split_re[k], wi = -fft->split_im[k];
+    float or_ = dr * wr - di * wi, oi = dr * wi + di * wr;
+    zr[k] = er - oi;
+    zi[k] = -(ei + or_);
+  }
+  fft_complex(fft, zr, zi);
+
+  float scale = 1.0f / half;
+  for (int k = 0; k < half; ++k) {
+    out[2 * k] = zr[k] * scale;
+    out[2 * k + 1] = -zi[k] * scale;
+  }
+}
+
+void fft_cleanup(Fft *fft) {
+  free(fft->bitrev);
+  free(fft->tw_re);
+  free(fft->tw_im);
+  free(fft->split_re);
+  free(fft->split_im);
+  free(fft->work_re);
+  free(fft->work_im);
+  memset(fft, 0, sizeof(Fft));
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Real-input radix-2 FFT with precomputed twiddles and bit-reversal table.
+// A real transform of length N runs as a complex transform of length N/2.
+// Each Fft owns scratch memory, so use one instance per thread.
+typedef struct {
+  int size;           // Real transform length (power of two, >= 4)
+  int half;           // size / 2, length of the inner complex transform
+  int *bitrev;        // Bit-reversal permutation for the complex transform
+  float *tw_re;       // e^(-2*pi*i*k/half), k < half/2
+  float *tw_im;
+  float *split_re;    // e^(-2*pi*i*k/size), k <= half, for the real split
+  float *split_im;
+  float *work_re;     // Scratch (half)
+  float *work_im;
+} Fft;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int fft_init(Fft *fft, int size);
+// in: size real samples -> re/im: size/2 + 1 bins (unscaled)
+void fft_real_forward(Fft *fft, const float *in, float *re, float *im);
+// re/im: size/2 + 1 bins -> out: size real samples (scaled by 1/size)
+void fft_real_inverse(Fft *fft, const float *re, const float *im, float *out);
+void fft_cleanup(Fft *fft);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,61 +2,84 @@
 #include "analog_filter.h"
 #include "utils.h"
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Freeverb-style reverb state
-#define REVERB_COMBS 4
-#define REVERB_ALLPASS 2
-
-typedef struct {
-  float *buf;
-  int size, pos;
-  float feedback;
-} Comb;
-
-typedef struct {
-  float *buf;
-  int size, pos;
-  float feedback;
-} Allpass;
+#define DELAY_MAX_SECONDS 2.0f
+#define DELAY_GLIDE_MS 80.0f     // Time constant for delay-time changes
+#define FLANGER_MAX_SECONDS 0.05f
+#define CHORUS_BASE_SECONDS 0.012f
+#define CHORUS_SWING_SECONDS 0.008f // Modulation swing at depth 1.0
+#define TWO_PI 6.28318531f
+#define FX_BLOCK 256            // Scratch size for block-processed stages
 
 static void comb_init(Comb *c, int size, float feedback) {
-  c->buf = calloc(size, sizeof(float));
-  c->size = size;
-  c->pos = 0;
+  delay_line_init(&c->line, size);
+  c->delay = size;
   c->feedback = feedback;
 }
 
 static void allpass_init(Allpass *a, int size, float feedback) {
-  a->buf = calloc(size, sizeof(float));
-  a->size = size;
-  a->pos = 0;
+  delay_line_init(&a->line, size);
+  a->delay = size;
   a->feedback = feedback;
 }
 
-static float comb_process(Comb *c, float inp) {
-  float out = c->buf[c->pos];
-  c->buf[c->pos] = inp + out * c->feedback;
-  c->pos = (c->pos + 1) % c->size;
-  return out;
+// Block comb: out += delayed, line <- in + delayed * feedback. Runs in spans
+// no longer than the delay so reads never see samples of the same span.
+static void comb_process_block(Comb *c, const float *in, float *out, int frames) {
+  float scratch[FX_BLOCK], next[FX_BLOCK];
+  for (int start = 0; start < frames;) {
+    int n = frames - start;
+    if (n > c->delay)
+      n = c->delay;
+    const float *past = delay_line_span(&c->line, c->delay, n, scratch);
+    for (int i = 0; i < n; ++i) {
+      out[start + i] += past[i];
+      next[i] = in[start + i] + past[i] * c->feedback;
+    }
+    delay_line_write_block(&c->line, next, n);
+    start += n;
+  }
 }
 
-static float allpass_process(Allpass *a, float inp) {
-  float bufout = a->buf[a->pos];
-  float out = -inp + bufout;
-  a->buf[a->pos] = inp + bufout * a->feedback;
-  a->pos = (a->pos + 1) % a->size;
-  return out;
+// Block allpass, in place
+static void allpass_process_block(Allpass *a, float *io, int frames) {
+  float scratch[FX_BLOCK], next[FX_BLOCK];
+  for (int start = 0; start < frames;) {
+    int n = frames - start;
+    if (n > a->delay)
+      n = a->delay;
+    const float *past = delay_line_span(&a->line, a->delay, n, scratch);
+    for (int i = 0; i < n; ++i) {
+      float inp = io[start + i];
+      next[i] = inp + past[i] * a->feedback;
+      io[start + i] = -inp + past[i];
+    }
+    delay_line_write_block(&a->line, next, n);
+    start += n;
+  }
 }
 
-typedef struct {
-  Comb combL[REVERB_COMBS], combR[REVERB_COMBS];
-  Allpass allpassL[REVERB_ALLPASS], allpassR[REVERB_ALLPASS];
-  int initialized;
-} ReverbState;
+// Tap offsets and gains only change with BPM or tap parameters, never per sample
+static void fx_update_multitap(FX *fx) {
+  float samples_per_beat = 60.0f / fx->bpm * fx->samplerate;
+  int max_offset = fx->delay_line[0].size - 1;
+  for (int tap = 0; tap < MAX_DELAY_TAPS; ++tap) {
+    int offset = (int)(fx->multitap_taps[tap] * samples_per_beat + 0.5f);
+    fx->multitap_offset[tap] = offset < 1 ? 1 : (offset > max_offset ? max_offset : offset);
 
-static ReverbState reverb_state = {0};
+    // Balance law: centre keeps both sides at unity
+    float pan = fmaxf(-1.0f, fminf(1.0f, fx->multitap_pan[tap]));
+    int active = tap < fx->num_taps && fx->multitap_taps[tap] > 0.0f;
+    float level = active ? fx->multitap_levels[tap] : 0.0f;
+    fx->multitap_gain_l[tap] = level * fminf(1.0f, 1.0f - pan);
+    fx->multitap_gain_r[tap] = level * fminf(1.0f, 1.0f + pan);
+    fx->multitap_fb[tap] = active ? fmaxf(0.0f, fminf(0.95f, fx->multitap_feedback[tap])) : 0.0f;
+  }
+  fx->multitap_dirty = 0;
+}
 
 void fx_init(FX *fx, int samplerate) {
   fx->samplerate = samplerate;
@@ -69,30 +92,48 @@ void fx_init(FX *fx, int samplerate) {
   fx->reverb_size = 0.0f;      // Set to 0.0 (minimal/no reverb)
   fx->reverb_damping = 0.3f;
   fx->reverb_mix = 0.0f;       // Set to 0.0 (100% dry - no reverb in output)
-  fx->delay_bufsize = (int)(samplerate * 2.0f);
-  fx->delay_buffer = calloc(fx->delay_bufsize * 2, sizeof(float));
-  fx->delay_pos = 0;
-  fx->flanger_bufsize = (int)(samplerate * 0.05f);
-  fx->flanger_buffer = calloc(fx->flanger_bufsize * 2, sizeof(float));
-  fx->flanger_pos = 0;
+  fx->reverb_algorithm = REVERB_CLASSIC;
+  fdn_reverb_init(&fx->fdn, (float)samplerate);
+  fdn_reverb_set_params(&fx->fdn, fx->reverb_size, fx->reverb_damping);
+  fx->conv_mix = 0.0f;         // No impulse response until one is loaded
+  fx->conv_ir_path[0] = '\0';
+  convolver_init(&fx->conv, samplerate);
+  fx->flanger_max_delay = samplerate * FLANGER_MAX_SECONDS;
+  fx->flanger_phase = 0.0f;
+  fx->chorus_depth = 0.5f;
+  fx->chorus_rate = 0.8f;
+  fx->chorus_mix = 0.0f;       // Set to 0 (disabled)
+  fx->chorus_phase = 0.0f;
+  for (int ch = 0; ch < 2; ++ch) {
+    delay_line_init(&fx->delay_line[ch], (int)(samplerate * DELAY_MAX_SECONDS));
+    delay_line_init(&fx->flanger_line[ch], (int)(samplerate * FLANGER_MAX_SECONDS) + 2);
+    delay_line_init(&fx->chorus_line[ch],
+                    (int)(samplerate * (CHORUS_BASE_SECONDS + CHORUS_SWING_SECONDS)) + 2);
+    fx->flanger_tap[ch].y1 = 0.0f;
+    for (int v = 0; v < CHORUS_VOICES; ++v)
+      fx->chorus_tap[ch][v].y1 = 0.0f;
+  }
+  delay_glide_init(&fx->delay_glide, fx->delay_time * samplerate, DELAY_GLIDE_MS,
+                   (float)samplerate);
   
   // Initialize multi-tap delay
   fx->bpm = 120.0f;
   fx->multitap_enabled = 0;
   fx->multitap_delay_pos = 0;
   fx->num_taps = 4;
-  // Default tap delays in beats: quarter, dotted eighth, eighth, triplet
-  float tap_beats[] = {1.0f, 0.75f, 0.5f, 0.333f};
-  float tap_levels[] = {0.7f, 0.5f, 0.4f, 0.3f};
+  // Default tap delays in beats: quarter, dotted eighth, eighth, triplet,
+  // then quieter taps that sound once the tap count is raised
+  float tap_beats[MAX_DELAY_TAPS] = {1.0f, 0.75f, 0.5f, 0.333f, 1.5f, 1.25f, 2.0f, 0.25f};
+  float tap_levels[MAX_DELAY_TAPS] = {0.7f, 0.5f, 0.4f, 0.3f, 0.25f, 0.2f, 0.15f, 0.1f};
   for (int i = 0; i < MAX_DELAY_TAPS; i++) {
-    if (i < 4) {
-      fx->multitap_taps[i] = tap_beats[i];
-      fx->multitap_levels[i] = tap_levels[i];
-    } else {
-      fx->multitap_taps[i] = 0.0f;
-      fx->multitap_levels[i] = 0.0f;
-    }
+    fx->multitap_taps[i] = tap_beats[i];
+    fx->multitap_levels[i] = tap_levels[i];
+    fx->multitap_pan[i] = 0.0f;
+    fx->multitap_feedback[i] = 0.0f;
   }
+  fx_update_multitap(fx);
+  for (int i = 0; i < MAX_DELAY_TAPS; i++)
+    fx->multitap_prev_offset[i] = fx->multitap_offset[i];
   
   // Initialize analog filter
   fx->filter_enabled = 0;       // Disabled by default
@@ -103,79 +144,23 @@ void fx_init(FX *fx, int samplerate) {
   fx->filter_oversampling = 2; // 2x oversampling default
   analog_filter_init(&fx->filter, samplerate);
 
-  if (!reverb_state.initialized) {
-    int comb_delays[REVERB_COMBS] = {
-        (int)(0.0297f * samplerate), (int)(0.0371f * samplerate),
-        (int)(0.0411f * samplerate), (int)(0.0437f * samplerate)};
-    int allpass_delays[REVERB_ALLPASS] = {(int)(0.005f * samplerate),
-                                          (int)(0.0017f * samplerate)};
-    float comb_feedback = 0.805f;
-    float allpass_feedback = 0.7f;
-    for (int i = 0; i < REVERB_COMBS; ++i) {
-      comb_init(&reverb_state.combL[i], comb_delays[i], comb_feedback);
-      comb_init(&reverb_state.combR[i], comb_delays[i] + 23, comb_feedback);
-    }
-    for (int i = 0; i < REVERB_ALLPASS; ++i) {
-      allpass_init(&reverb_state.allpassL[i], allpass_delays[i],
-                   allpass_feedback);
-      allpass_init(&reverb_state.allpassR[i], allpass_delays[i] + 13,
-                   allpass_feedback);
-    }
-    reverb_state.initialized = 1;
+  // Classic reverb; each FX instance owns its own lines
+  int comb_delays[REVERB_COMBS] = {
+      (int)(0.0297f * samplerate), (int)(0.0371f * samplerate),
+      (int)(0.0411f * samplerate), (int)(0.0437f * samplerate)};
+  int allpass_delays[REVERB_ALLPASS] = {(int)(0.005f * samplerate),
+                                        (int)(0.0017f * samplerate)};
+  float comb_feedback = 0.805f;
+  float allpass_feedback = 0.7f;
+  for (int i = 0; i < REVERB_COMBS; ++i) {
+    comb_init(&fx->classic.combL[i], comb_delays[i], comb_feedback);
+    comb_init(&fx->classic.combR[i], comb_delays[i] + 23, comb_feedback);
   }
-}
-
-void fx_set_param(FX *fx, const char *param, float value) {
-  if (!strcmp(param, "flanger.depth"))
-    fx->flanger_depth = value;
-  else if (!strcmp(param, "flanger.rate"))
-    fx->flanger_rate = value;
-  else if (!strcmp(param, "flanger.feedback"))
-    fx->flanger_feedback = value;
-  else if (!strcmp(param, "delay.time"))
-    fx->delay_time = value;
-  else if (!strcmp(param, "delay.feedback"))
-    fx->delay_feedback = value;
-  else if (!strcmp(param, "delay.mix"))
-    fx->delay_mix = value;
-  else if (!strcmp(param, "reverb.size"))
-    fx->reverb_size = value;
-  else if (!strcmp(param, "reverb.damping"))
-    fx->reverb_damping = value;
-  else if (!strcmp(param, "reverb.mix"))
-    fx->reverb_mix = value;
-  // Multi-tap delay parameters
-  else if (!strcmp(param, "multitap.enabled"))
-    fx->multitap_enabled = (int)value;
-  else if (!strcmp(param, "multitap.bpm"))
-    fx->bpm = value;
-  else if (!strncmp(param, "multitap.tap", 12)) {
-    // Parse tap index: multitap.tap0, multitap.tap1, etc.
-    int tap_idx = atoi(param + 12);
-    if (tap_idx >= 0 && tap_idx < MAX_DELAY_TAPS) {
-      if (!strncmp(param + 13, "_level", 6)) {
-        fx->multitap_levels[tap_idx] = value;
-      } else {
-        fx->multitap_taps[tap_idx] = value;
-      }
-    }
-  }
-  // Analog filter parameters
-  else if (!strcmp(param, "filter.enabled"))
-    fx->filter_enabled = (int)value;
-  else if (!strcmp(param, "filter.cutoff"))
-    fx->filter_cutoff = value;
-  else if (!strcmp(param, "filter.resonance"))
-    fx->filter_resonance = value;
-  else if (!strcmp(param, "filter.drive"))
-    fx->filter_drive = value;
-  else if (!strcmp(param, "filter.mix"))
-    fx->filter_mix = value;
-  else if (!strcmp(param, "filter.oversampling"))
-    fx->filter_oversampling = (int)value;
-  // Pass through to analog filter
-  else if (!strncmp(param, "filter.", 7)) {
-    analog_filter_set_param(&fx->filter, param + 7, value);
+  for (int i = 0; i < REVERB_ALLPASS; ++i) {
+    allpass_init(&fx->classic.allpassL[i], allpass_delays[i],
+                 allpass_feedback);
+    allpass_init(&fx->classic.allpassR[i], allpass_delays[i] + 13,
+                 allpass_feedback);
   }
 }
 
@@ -211,107 +196,232 @@ void fx_process(FX *fx, float *stereo, int frames) {
     }
   }
   
+  // Flanger (depth 0 keeps the line filled but leaves the signal dry)
+  float flanger_inc = fx->flanger_rate / fx->samplerate;
   for (int n = 0; n < frames; ++n) {
-    float phase =
-        fastsin(2.0f * 3.14159265f * fx->flanger_rate * n / fx->samplerate);
-    int delay_samp = (int)(fx->flanger_depth * (fx->flanger_bufsize - 1) *
-                           (0.5f + 0.5f * phase));
-    int pos = (fx->flanger_pos + fx->flanger_bufsize - delay_samp) %
-              fx->flanger_bufsize;
+    float lfo = fastsin(TWO_PI * fx->flanger_phase);
+    fx->flanger_phase += flanger_inc;
+    if (fx->flanger_phase >= 1.0f)
+      fx->flanger_phase -= 1.0f;
+    float delay = 1.5f + fx->flanger_depth * (fx->flanger_max_delay - 1.5f) *
+                             (0.5f + 0.5f * lfo);
     for (int ch = 0; ch < 2; ++ch) {
       float in = stereo[n * 2 + ch];
-      float fb = fx->flanger_buffer[pos * 2 + ch];
-      stereo[n * 2 + ch] = in + fb * fx->flanger_feedback;
-      fx->flanger_buffer[fx->flanger_pos * 2 + ch] = in;
+      if (fx->flanger_depth > 0.0f) {
+        float fb = delay_line_read_allpass(&fx->flanger_line[ch],
+                                           &fx->flanger_tap[ch], delay);
+        stereo[n * 2 + ch] = in + fb * fx->flanger_feedback;
+      }
+      delay_line_write(&fx->flanger_line[ch], in);
     }
-    fx->flanger_pos = (fx->flanger_pos + 1) % fx->flanger_bufsize;
   }
+
+  // Chorus: voices spread evenly over the LFO cycle, right side offset 90 degrees
+  if (fx->chorus_mix > 0.0f) {
+    float chorus_inc = fx->chorus_rate / fx->samplerate;
+    float base = CHORUS_BASE_SECONDS * fx->samplerate;
+    float swing = fx->chorus_depth * CHORUS_SWING_SECONDS * fx->samplerate * 0.5f;
+    for (int n = 0; n < frames; ++n) {
+      for (int ch = 0; ch < 2; ++ch) {
+        float in = stereo[n * 2 + ch];
+        float wet = 0.0f;
+        for (int v = 0; v < CHORUS_VOICES; ++v) {
+          float phase = fx->chorus_phase + (float)v / CHORUS_VOICES + 0.25f * ch;
+          float delay = base + swing * (1.0f + fastsin(TWO_PI * phase));
+          wet += delay_line_read_allpass(&fx->chorus_line[ch],
+                                         &fx->chorus_tap[ch][v], delay);
+        }
+        wet *= 1.0f / CHORUS_VOICES;
+        delay_line_write(&fx->chorus_line[ch], in);
+        stereo[n * 2 + ch] = in * (1.0f - fx->chorus_mix) + wet * fx->chorus_mix;
+      }
+      fx->chorus_phase += chorus_inc;
+      if (fx->chorus_phase >= 1.0f)
+        fx->chorus_phase -= 1.0f;
+    }
+  }
+
   // Multi-tap delay synced to BPM (replaces standard delay when enabled)
   if (fx->multitap_enabled && fx->delay_mix > 0.0f) {
-    float seconds_per_beat = 60.0f / fx->bpm;
-    
-    for (int n = 0; n < frames; ++n) {
-      float dryL = stereo[n * 2 + 0];
-      float dryR = stereo[n * 2 + 1];
-      float wetL = 0.0f, wetR = 0.0f;
-      
-      // Sum all taps
+    if (fx->multitap_dirty)
+      fx_update_multitap(fx);
+
+    // Spans may not reach samples written in the same span (tap feedback).
+    // Silent taps are skipped below, so they do not shorten the span.
+    int span_max = FX_BLOCK;
+    for (int tap = 0; tap < fx->num_taps; ++tap) {
+      if (fx->multitap_gain_l[tap] == 0.0f && fx->multitap_gain_r[tap] == 0.0f &&
+          fx->multitap_fb[tap] == 0.0f)
+        continue;
+      if (fx->multitap_offset[tap] < span_max)
+        span_max = fx->multitap_offset[tap];
+      if (fx->multitap_prev_offset[tap] < span_max)
+        span_max = fx->multitap_prev_offset[tap];
+    }
+
+    for (int start = 0; start < frames;) {
+      int n = frames - start < span_max ? frames - start : span_max;
+      float *io = stereo + start * 2;
+      float wetL[FX_BLOCK] = {0}, wetR[FX_BLOCK] = {0};
+      float fbL[FX_BLOCK] = {0}, fbR[FX_BLOCK] = {0};
+
       for (int tap = 0; tap < fx->num_taps; ++tap) {
-        if (fx->multitap_levels[tap] > 0.0f && fx->multitap_taps[tap] > 0.0f) {
-          float delay_seconds = fx->multitap_taps[tap] * seconds_per_beat;
-          int delay_samp = (int)(delay_seconds * fx->samplerate);
-          
-          // Ensure delay is within buffer bounds
-          if (delay_samp > 0 && delay_samp < fx->delay_bufsize) {
-            int pos = (fx->delay_pos + fx->delay_bufsize - delay_samp) % fx->delay_bufsize;
-            
-            // Read delayed signal
-            float tapL = fx->delay_buffer[pos * 2 + 0];
-            float tapR = fx->delay_buffer[pos * 2 + 1];
-            
-            // Add to wet mix with tap level
-            wetL += tapL * fx->multitap_levels[tap];
-            wetR += tapR * fx->multitap_levels[tap];
+        float gl = fx->multitap_gain_l[tap], gr = fx->multitap_gain_r[tap];
+        float fb = fx->multitap_fb[tap];
+        if (gl == 0.0f && gr == 0.0f && fb == 0.0f)
+          continue;
+
+        float scratchL[FX_BLOCK], scratchR[FX_BLOCK];
+        const float *tl = delay_line_span(&fx->delay_line[0], fx->multitap_offset[tap], n, scratchL);
+        const float *tr = delay_line_span(&fx->delay_line[1], fx->multitap_offset[tap], n, scratchR);
+
+        // Tap moved: crossfade from the old offset over this span
+        float xfadeL[FX_BLOCK], xfadeR[FX_BLOCK];
+        if (fx->multitap_prev_offset[tap] != fx->multitap_offset[tap]) {
+          float oldL[FX_BLOCK], oldR[FX_BLOCK];
+          const float *pl = delay_line_span(&fx->delay_line[0], fx->multitap_prev_offset[tap], n, oldL);
+          const float *pr = delay_line_span(&fx->delay_line[1], fx->multitap_prev_offset[tap], n, oldR);
+          float step = 1.0f / n;
+          for (int i = 0; i < n; ++i) {
+            float g = (i + 1) * step;
+            xfadeL[i] = pl[i] + (tl[i] - pl[i]) * g;
+            xfadeR[i] = pr[i] + (tr[i] - pr[i]) * g;
           }
+          tl = xfadeL;
+          tr = xfadeR;
+        }
+
+        for (int i = 0; i < n; ++i) {
+          wetL[i] += tl[i] * gl;
+          wetR[i] += tr[i] * gr;
+          fbL[i] += tl[i] * fb;
+          fbR[i] += tr[i] * fb;
         }
       }
-      
-      // Mix wet and dry
-      stereo[n * 2 + 0] = dryL * (1.0f - fx->delay_mix) + wetL * fx->delay_mix;
-      stereo[n * 2 + 1] = dryR * (1.0f - fx->delay_mix) + wetR * fx->delay_mix;
-      
-      // Write input to buffer (ALWAYS write dry signal to keep buffer filled)
-      fx->delay_buffer[fx->delay_pos * 2 + 0] = dryL;
-      fx->delay_buffer[fx->delay_pos * 2 + 1] = dryR;
-      fx->delay_pos = (fx->delay_pos + 1) % fx->delay_bufsize;
+      for (int tap = 0; tap < fx->num_taps; ++tap)
+        fx->multitap_prev_offset[tap] = fx->multitap_offset[tap];
+
+      // Mix wet and dry; the line always gets the dry signal plus tap feedback
+      for (int i = 0; i < n; ++i) {
+        float dryL = io[i * 2 + 0], dryR = io[i * 2 + 1];
+        io[i * 2 + 0] = dryL * (1.0f - fx->delay_mix) + wetL[i] * fx->delay_mix;
+        io[i * 2 + 1] = dryR * (1.0f - fx->delay_mix) + wetR[i] * fx->delay_mix;
+        fbL[i] += dryL;
+        fbR[i] += dryR;
+      }
+      delay_line_write_block(&fx->delay_line[0], fbL, n);
+      delay_line_write_block(&fx->delay_line[1], fbR, n);
+      start += n;
     }
   } else {
-    // Standard delay (original behavior)
-    for (int n = 0; n < frames; ++n) {
-      int delay_samp = (int)(fx->delay_time * fx->samplerate);
-      int pos =
-          (fx->delay_pos + fx->delay_bufsize - delay_samp) % fx->delay_bufsize;
-      for (int ch = 0; ch < 2; ++ch) {
-        float dry = stereo[n * 2 + ch];
-        float wet = fx->delay_buffer[pos * 2 + ch];
-        stereo[n * 2 + ch] = dry * (1.0f - fx->delay_mix) + wet * fx->delay_mix;
-        fx->delay_buffer[fx->delay_pos * 2 + ch] = dry + wet * fx->delay_feedback;
+    // Standard delay; a time of 0 leaves the signal dry
+    fx->delay_glide.target = fx->delay_time * fx->samplerate;
+    for (int start = 0; start < frames; start += FX_BLOCK) {
+      int n = frames - start < FX_BLOCK ? frames - start : FX_BLOCK;
+      float *io = stereo + start * 2;
+      DelayGlide *g = &fx->delay_glide;
+      int settled = fabsf(g->target - g->current) < 1e-3f;
+      int di = (int)g->current;
+
+      if (fx->delay_time > 0.0f && settled && di - 1 >= n &&
+          g->current < (float)(fx->delay_line[0].size - 3)) {
+        // Constant delay: cubic read over a contiguous span, vectorizable
+        g->current = g->target;
+        float t = g->current - (float)di;
+        for (int ch = 0; ch < 2; ++ch) {
+          float scratch[FX_BLOCK + 3], next[FX_BLOCK];
+          // span[j] is the sample di + 2 - j back from the block start
+          const float *span =
+              delay_line_span(&fx->delay_line[ch], di + 2, n + 3, scratch);
+          for (int i = 0; i < n; ++i) {
+            float x2 = span[i], x1 = span[i + 1], x0 = span[i + 2], xm1 = span[i + 3];
+            float c1 = 0.5f * (x1 - xm1);
+            float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+            float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+            float wet = ((c3 * t + c2) * t + c1) * t + x0;
+            float dry = io[i * 2 + ch];
+            io[i * 2 + ch] = dry * (1.0f - fx->delay_mix) + wet * fx->delay_mix;
+            next[i] = dry + wet * fx->delay_feedback;
+          }
+          delay_line_write_block(&fx->delay_line[ch], next, n);
+        }
+        continue;
       }
-      fx->delay_pos = (fx->delay_pos + 1) % fx->delay_bufsize;
-    }
-  }
-  for (int n = 0; n < frames; ++n) {
-    float inL = stereo[n * 2 + 0];
-    float inR = stereo[n * 2 + 1];
-    float reverb_in = (inL + inR) * 0.5f * fx->reverb_size;
 
-    float outL = 0, outR = 0;
-    for (int i = 0; i < REVERB_COMBS; ++i) {
-      outL += comb_process(&reverb_state.combL[i], reverb_in);
-      outR += comb_process(&reverb_state.combR[i], reverb_in);
+      for (int i = 0; i < n; ++i) {
+        float delay = delay_glide_next(g);
+        for (int ch = 0; ch < 2; ++ch) {
+          float dry = io[i * 2 + ch];
+          if (fx->delay_time > 0.0f) {
+            float wet = delay_line_read_cubic(&fx->delay_line[ch], delay);
+            io[i * 2 + ch] = dry * (1.0f - fx->delay_mix) + wet * fx->delay_mix;
+            delay_line_write(&fx->delay_line[ch], dry + wet * fx->delay_feedback);
+          } else {
+            delay_line_write(&fx->delay_line[ch], dry);
+          }
+        }
+      }
     }
-    for (int i = 0; i < REVERB_ALLPASS; ++i) {
-      outL = allpass_process(&reverb_state.allpassL[i], outL);
-      outR = allpass_process(&reverb_state.allpassR[i], outR);
+  }
+  if (fx->reverb_algorithm == REVERB_FDN) {
+    fdn_reverb_process(&fx->fdn, stereo, frames, fx->reverb_mix);
+  } else {
+    for (int start = 0; start < frames; start += FX_BLOCK) {
+      int n = frames - start < FX_BLOCK ? frames - start : FX_BLOCK;
+      float *io = stereo + start * 2;
+      float rin[FX_BLOCK], outL[FX_BLOCK], outR[FX_BLOCK];
+      for (int i = 0; i < n; ++i) {
+        rin[i] = (io[i * 2 + 0] + io[i * 2 + 1]) * 0.5f * fx->reverb_size;
+        outL[i] = 0.0f;
+        outR[i] = 0.0f;
+      }
+      for (int i = 0; i < REVERB_COMBS; ++i) {
+        comb_process_block(&fx->classic.combL[i], rin, outL, n);
+        comb_process_block(&fx->classic.combR[i], rin, outR, n);
+      }
+      for (int i = 0; i < REVERB_ALLPASS; ++i) {
+        allpass_process_block(&fx->classic.allpassL[i], outL, n);
+        allpass_process_block(&fx->classic.allpassR[i], outR, n);
+      }
+      for (int i = 0; i < n; ++i) {
+        io[i * 2 + 0] = io[i * 2 + 0] * (1.0f - fx->reverb_mix) + outL[i] * fx->reverb_mix;
+        io[i * 2 + 1] = io[i * 2 + 1] * (1.0f - fx->reverb_mix) + outR[i] * fx->reverb_mix;
+      }
     }
-    stereo[n * 2 + 0] = inL * (1.0f - fx->reverb_mix) + outL * fx->reverb_mix;
-    stereo[n * 2 + 1] = inR * (1.0f - fx->reverb_mix) + outR * fx->reverb_mix;
   }
+  if (fx->conv_mix > 0.0f)
+    convolver_process(&fx->conv, stereo, frames, fx->conv_mix);
 }
 
 void fx_set_bpm(FX *fx, float bpm) {
+  if (bpm != fx->bpm)
+    fx->multitap_dirty = 1;
   fx->bpm = bpm;
 }
 
+int fx_load_impulse_response(FX *fx, const char *path) {
+  if (!convolver_load_ir(&fx->conv, path))
+    return 0;
+  snprintf(fx->conv_ir_path, sizeof(fx->conv_ir_path), "%s", path);
+  return 1;
+}
+
 void fx_cleanup(FX *fx) {
-  if (fx->delay_buffer) {
-    free(fx->delay_buffer);
-    fx->delay_buffer = NULL;
+  for (int ch = 0; ch < 2; ++ch) {
+    delay_line_cleanup(&fx->delay_line[ch]);
+    delay_line_cleanup(&fx->flanger_line[ch]);
+    delay_line_cleanup(&fx->chorus_line[ch]);
+  }
+  for (int i = 0; i < REVERB_COMBS; ++i) {
+    delay_line_cleanup(&fx->classic.combL[i].line);
+    delay_line_cleanup(&fx->classic.combR[i].line);
   }
-  if (fx->flanger_buffer) {
-    free(fx->flanger_buffer);
-    fx->flanger_buffer = NULL;
+  for (int i = 0; i < REVERB_ALLPASS; ++i) {
+    delay_line_cleanup(&fx->classic.allpassL[i].line);
+    delay_line_cleanup(&fx->classic.allpassR[i].line);
   }
+  fdn_reverb_cleanup(&fx->fdn);
+  convolver_cleanup(&fx->conv);
   // Clean up analog filter
   analog_filter_cleanup(&fx->filter);
 }
\ No newline at end of file
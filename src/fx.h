@@ -1,25 +1,86 @@
 #pragma once
 #include "analog_filter.h"
+#include "fdn_reverb.h"
+#include "convolver.h"
+#include "delay_line.h"
 
 #define MAX_DELAY_TAPS 8
+#define CHORUS_VOICES 2
+
+// Freeverb-style reverb state
+#define REVERB_COMBS 4
+#define REVERB_ALLPASS 2
+
+typedef struct {
+  DelayLine line;
+  int delay;
+  float feedback;
+} Comb;
+
+typedef struct {
+  DelayLine line;
+  int delay;
+  float feedback;
+} Allpass;
+
+typedef struct {
+  Comb combL[REVERB_COMBS], combR[REVERB_COMBS];
+  Allpass allpassL[REVERB_ALLPASS], allpassR[REVERB_ALLPASS];
+} ClassicReverb;
+
+typedef enum {
+  REVERB_CLASSIC = 0, // Freeverb-style combs + allpasses
+  REVERB_FDN = 1,     // 8-line feedback delay network
+} ReverbAlgorithm;
 
 typedef struct {
   float flanger_depth, flanger_rate, flanger_feedback;
   float delay_time, delay_feedback, delay_mix;
   float reverb_size, reverb_damping, reverb_mix;
-  float *delay_buffer;
-  int delay_bufsize, delay_pos;
-  float *flanger_buffer;
-  int flanger_bufsize, flanger_pos;
+  int reverb_algorithm;
+  ClassicReverb classic;
+  FdnReverb fdn;
+
+  // Convolution reverb (impulse response loaded from WAV)
+  float conv_mix;
+  char conv_ir_path[256];
+  Convolver conv;
+
   int samplerate;
+
+  // Standard and multi-tap delay share one line per channel
+  DelayLine delay_line[2];
+  DelayGlide delay_glide;
+
+  // Flanger LFO phase persists across callbacks
+  DelayLine flanger_line[2];
+  DelayTap flanger_tap[2];
+  float flanger_phase;
+  float flanger_max_delay;      // Samples at depth 1.0
+
+  // Chorus: CHORUS_VOICES modulated taps per channel
+  float chorus_depth, chorus_rate, chorus_mix;
+  DelayLine chorus_line[2];
+  DelayTap chorus_tap[2][CHORUS_VOICES];
+  float chorus_phase;
   
   // Multi-tap delay synced to BPM
   float bpm;
   int multitap_enabled;
   float multitap_taps[MAX_DELAY_TAPS];
   float multitap_levels[MAX_DELAY_TAPS];
+  float multitap_pan[MAX_DELAY_TAPS];       // -1 (left) to 1 (right)
+  float multitap_feedback[MAX_DELAY_TAPS];  // Tap output fed back into the line
   int num_taps;
   int multitap_delay_pos;
+
+  // Derived on the audio thread whenever a tap parameter or the BPM changes
+  int multitap_dirty;
+  int multitap_offset[MAX_DELAY_TAPS];      // Samples
+  int multitap_prev_offset[MAX_DELAY_TAPS]; // Crossfaded from after a change
+  float multitap_gain_l[MAX_DELAY_TAPS];
+  float multitap_gain_r[MAX_DELAY_TAPS];
+  float multitap_fb[MAX_DELAY_TAPS];
   
   // Analog filter parameters
   int filter_enabled;
@@ -36,8 +97,9 @@ extern "C" {
 #endif
 
 void fx_init(FX *fx, int samplerate);
-void fx_set_param(FX *fx, const char *param, float value);
 void fx_set_bpm(FX *fx, float bpm);
+// Call from a non-audio thread; the IR is prepared there and swapped in atomically
+int fx_load_impulse_response(FX *fx, const char *path);
 void fx_process(FX *fx, float *stereo, int frames);
 void fx_cleanup(FX *fx);
 
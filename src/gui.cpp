@@ -3,36 +3,70 @@
 #include "backends/imgui_impl_sdl2.h"
 #include "backends/imgui_impl_opengl3.h"
 #include "oscilloscope.h"
-#include "dejavusans_ttf.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <SDL2/SDL.h>
-#include <SDL_ttf.h>
 #include <SDL_opengl.h>
 
 // Global pointers to app state for GUI access
-static int *g_chord_prog_enabled = NULL;
 static float *g_velocity_var = NULL;
 static float *g_timing_var = NULL;
 static float *g_bpm = NULL;
 static Synth *g_synth = NULL;
-static void (*g_toggle_chord_progression)(void) = NULL;
+static int *g_idle_mode = NULL;
+static float *g_scope_fps = NULL;
+static const float *g_ui_cpu = NULL;
+static void (*g_toggle_chord_progression)(Synth *) = NULL;
 
 // Keyboard state
 static int pressed_keys[128] = {0}; // 0: not pressed, 1: pressed
 
 static SDL_Renderer *g_renderer = NULL;
-static TTF_Font *g_font = NULL;
 
-static GLuint g_oscilloscope_gl_texture = 0;
-static SDL_Surface* g_oscilloscope_surface = NULL;
-static SDL_Renderer* g_oscilloscope_renderer = NULL;
-static int osc_width = 500;
-static int osc_height = 300;
+static ScopeTrace g_scope_trace;
+static float g_scope_time_ms = 20.0f; // Visible time span per pane
+static GLuint g_waterfall_texture = 0;
+static int g_waterfall_row = 0; // Texture row holding the newest spectrum
 
-void gui_set_humanize_vars(int *enabled, float *vel_var, float *time_var, float *bpm, void (*toggle_func)(void), Synth *synth) {
-    g_chord_prog_enabled = enabled;
+// One oscilloscope channel: each column contributes its max and min point,
+// so a single polyline shows the plain waveform when a column holds one
+// frame and a filled envelope when it holds many
+static void draw_scope_pane(ImDrawList* draw, ImVec2 pos, float w, float h,
+                            const ScopeTrace* trace, int ch, ImU32 color, const char* label) {
+    ImVec2 end = ImVec2(pos.x + w, pos.y + h);
+    draw->AddRectFilled(pos, end, IM_COL32(20, 25, 35, 255));
+    for (int i = 1; i < 8; i++) {
+        float gx = pos.x + w * i / 8;
+        draw->AddLine(ImVec2(gx, pos.y), ImVec2(gx, end.y), IM_COL32(40, 45, 55, 255));
+    }
+    for (int i = 1; i < 4; i++) {
+        float gy = pos.y + h * i / 4;
+        draw->AddLine(ImVec2(pos.x, gy), ImVec2(end.x, gy), IM_COL32(40, 45, 55, 255));
+    }
+    float center_y = pos.y + h / 2;
+    draw->AddLine(ImVec2(pos.x, center_y), ImVec2(end.x, center_y), IM_COL32(80, 85, 100, 255));
+
+    if (trace->columns > 1) {
+        static ImVec2 points[SCOPE_MAX_COLUMNS * 2];
+        float half = h / 2;
+        for (int c = 0; c < trace->columns; c++) {
+            float x = pos.x + w * c / (trace->columns - 1);
+            float y_hi = center_y - fminf(fmaxf(trace->max[ch][c], -1.0f), 1.0f) * half;
+            float y_lo = center_y - fminf(fmaxf(trace->min[ch][c], -1.0f), 1.0f) * half;
+            points[c * 2 + 0] = ImVec2(x, y_hi);
+            points[c * 2 + 1] = ImVec2(x, y_lo);
+        }
+        draw->PushClipRect(pos, end, true);
+        draw->AddPolyline(points, trace->columns * 2, color, 0, 1.0f);
+        draw->PopClipRect();
+    }
+
+    draw->AddRect(pos, end, IM_COL32(100, 100, 120, 255));
+    draw->AddText(ImVec2(pos.x + 5, pos.y + 5), color, label);
+}
+
+void gui_set_humanize_vars(float *vel_var, float *time_var, float *bpm, void (*toggle_func)(Synth *), Synth *synth) {
     g_velocity_var = vel_var;
     g_timing_var = time_var;
     g_bpm = bpm;
@@ -40,6 +74,12 @@ void gui_set_humanize_vars(int *enabled, float *vel_var, float *time_var, float
     g_synth = synth;
 }
 
+void gui_set_frame_vars(int *idle_mode, float *scope_fps, const float *ui_cpu) {
+    g_idle_mode = idle_mode;
+    g_scope_fps = scope_fps;
+    g_ui_cpu = ui_cpu;
+}
+
 void gui_init(SDL_Window *window, SDL_GLContext gl_context) {
     // Setup Dear ImGui context
     ImGui::CreateContext(NULL);
@@ -58,65 +98,28 @@ void gui_init(SDL_Window *window, SDL_GLContext gl_context) {
         fprintf(stderr, "Failed to create SDL renderer: %s\n", SDL_GetError());
     }
 
-    if (TTF_Init() == -1) {
-        fprintf(stderr, "Failed to initialize SDL_ttf: %s\n", TTF_GetError());
-    }
-
-    // Load font from embedded data
-    SDL_RWops *font_rw = SDL_RWFromConstMem(DejaVuSans_ttf, DejaVuSans_ttf_len);
-    if (!font_rw) {
-        fprintf(stderr, "Failed to create font RWops: %s\n", SDL_GetError());
-    }
-    
-    g_font = TTF_OpenFontRW(font_rw, 1, 12); // 1 = auto-close RWops
-    if (!g_font) {
-        fprintf(stderr, "Failed to load embedded font: %s\n", TTF_GetError());
-    }
-
     oscilloscope_init();
 
-    // Initialize persistent oscilloscope rendering resources
-    g_oscilloscope_surface = SDL_CreateRGBSurfaceWithFormat(0, osc_width, osc_height, 32, SDL_PIXELFORMAT_RGBA32);
-    if (!g_oscilloscope_surface) {
-        fprintf(stderr, "Failed to create g_oscilloscope_surface: %s\n", SDL_GetError());
-    } else {
-        g_oscilloscope_renderer = SDL_CreateSoftwareRenderer(g_oscilloscope_surface);
-        if (!g_oscilloscope_renderer) {
-            fprintf(stderr, "Failed to create g_oscilloscope_renderer: %s\n", SDL_GetError());
-            SDL_FreeSurface(g_oscilloscope_surface);
-            g_oscilloscope_surface = NULL;
-        }
-    }
-
-    glGenTextures(1, &g_oscilloscope_gl_texture);
-    glBindTexture(GL_TEXTURE_2D, g_oscilloscope_gl_texture);
+    // Waterfall: rows are written in a ring and scrolled by wrapping the
+    // vertical texture coordinate, so each frame uploads a single row
+    unsigned char* blank = (unsigned char*)calloc(SPECTRUM_COLUMNS * WATERFALL_HEIGHT, 4);
+    glGenTextures(1, &g_waterfall_texture);
+    glBindTexture(GL_TEXTURE_2D, g_waterfall_texture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, osc_width, osc_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL); // Allocate texture memory
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SPECTRUM_COLUMNS, WATERFALL_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, blank);
+    free(blank);
 }
 
 void gui_shutdown() {
     oscilloscope_shutdown();
-
-    if (g_oscilloscope_gl_texture) {
-        glDeleteTextures(1, &g_oscilloscope_gl_texture);
-        g_oscilloscope_gl_texture = 0;
-    }
-    if (g_oscilloscope_renderer) {
-        SDL_DestroyRenderer(g_oscilloscope_renderer);
-        g_oscilloscope_renderer = NULL;
-    }
-    if (g_oscilloscope_surface) {
-        SDL_FreeSurface(g_oscilloscope_surface);
-        g_oscilloscope_surface = NULL;
+    if (g_waterfall_texture) {
+        glDeleteTextures(1, &g_waterfall_texture);
+        g_waterfall_texture = 0;
     }
 
-    if (g_font) {
-        TTF_CloseFont(g_font);
-        g_font = NULL;
-    }
-    TTF_Quit();
-
     if (g_renderer) {
         SDL_DestroyRenderer(g_renderer);
         g_renderer = NULL;
@@ -137,9 +140,7 @@ void gui_set_key_pressed(int midi_note, int is_pressed) {
     }
 }
 
-void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context, 
-              int chord_prog_enabled, int current_chord_idx, int chord_prog_len,
-              int current_rhythm_step, int rhythm_len) {
+void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context) {
     SDL_GL_MakeCurrent(window, gl_context);
 
     // Start the Dear ImGui frame
@@ -147,6 +148,11 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
     ImGui_ImplSDL2_NewFrame();
     ImGui::NewFrame();
 
+    // Consistent copy of the audio thread's meters for this frame
+    const SynthSnapshot* snap = snapshot_read(&synth->snapshot);
+    // Patch sections edit the selected part
+    Part *part = synth_edit_part(synth);
+
     int window_width, window_height;
     SDL_GetWindowSize(window, &window_width, &window_height);
 
@@ -156,45 +162,130 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
 
     // Oscilloscope
     if (ImGui::CollapsingHeader("Oscilloscope", ImGuiTreeNodeFlags_DefaultOpen)) {
-		// Set fixed height of 200 pixels, use full available width
-		ImGui::PushStyleVar(ImGuiStyleVar_ChildBorderSize, 0.0f);
-		ImGui::BeginChild("OscilloscopeChild", ImVec2(0, 200), false, ImGuiWindowFlags_NoScrollbar);
-		ImVec2 content_size = ImGui::GetContentRegionAvail();
-		if (content_size.x > 0 && content_size.y > 0) {
-			if ((int)content_size.x != osc_width || 200 != osc_height) {
-				// Recreate resources if size has changed
-				if (g_oscilloscope_renderer) SDL_DestroyRenderer(g_oscilloscope_renderer);
-				if (g_oscilloscope_surface) SDL_FreeSurface(g_oscilloscope_surface);
-				if (g_oscilloscope_gl_texture) glDeleteTextures(1, &g_oscilloscope_gl_texture);
-				
-				osc_width = (int)content_size.x;
-				osc_height = 200; // Fixed height of 200 pixels
-				
-				g_oscilloscope_surface = SDL_CreateRGBSurfaceWithFormat(0, osc_width, osc_height, 32, SDL_PIXELFORMAT_RGBA32);
-				g_oscilloscope_renderer = SDL_CreateSoftwareRenderer(g_oscilloscope_surface);
-				
-				glGenTextures(1, &g_oscilloscope_gl_texture);
-				glBindTexture(GL_TEXTURE_2D, g_oscilloscope_gl_texture);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, osc_width, osc_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-			}
-			
-			if (g_oscilloscope_renderer && g_oscilloscope_surface && g_oscilloscope_gl_texture && g_font) {
-				SDL_SetRenderDrawColor(g_oscilloscope_renderer, 0, 0, 0, 0);
-				SDL_RenderClear(g_oscilloscope_renderer);
-				oscilloscope_draw(g_oscilloscope_renderer, synth, 0, 0, osc_width, osc_height, g_font);
-				
-				glBindTexture(GL_TEXTURE_2D, g_oscilloscope_gl_texture);
-				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, osc_width, osc_height, GL_RGBA, GL_UNSIGNED_BYTE, g_oscilloscope_surface->pixels);
-				
-				ImGui::Image((void*)(intptr_t)g_oscilloscope_gl_texture, ImVec2((float)osc_width, (float)osc_height));
-			}
+		// Short spans trigger on the signal, long ones roll
+		float max_time_ms = 1000.0f * oscilloscope_max_span() / synth->sample_rate;
+		ImGui::SliderFloat("Time span", &g_scope_time_ms, 1.0f, fminf(10000.0f, max_time_ms), "%.1f ms",
+		                   ImGuiSliderFlags_Logarithmic);
+
+#ifndef __EMSCRIPTEN__
+		// The browser drives frames itself, so idle redraw is native only
+		if (g_idle_mode && g_scope_fps) {
+			bool idle = *g_idle_mode != 0;
+			if (ImGui::Checkbox("Redraw on demand", &idle))
+				*g_idle_mode = idle ? 1 : 0;
+			ImGui::SameLine();
+			ImGui::SetNextItemWidth(150.0f);
+			ImGui::SliderFloat("Refresh rate", g_scope_fps, SCOPE_MIN_FPS, 60.0f, "%.0f Hz");
+		}
+#endif
+
+		// Two panes of fixed height 200 pixels across the full width, drawn
+		// straight into the window's draw list from per-column min/max pairs
+		float scope_w = ImGui::GetContentRegionAvail().x;
+		float scope_h = 200.0f;
+		float pane_w = floorf((scope_w - 2.0f) / 2.0f);
+		if (pane_w >= 2.0f) {
+			oscilloscope_trace(&g_scope_trace, (int)pane_w, (int)(g_scope_time_ms * 0.001f * synth->sample_rate));
+			ImVec2 scope_pos = ImGui::GetCursorScreenPos();
+			ImDrawList* scope_draw = ImGui::GetWindowDrawList();
+			draw_scope_pane(scope_draw, scope_pos, pane_w, scope_h, &g_scope_trace, 0,
+			                IM_COL32(255, 100, 100, 255), "L");
+			draw_scope_pane(scope_draw, ImVec2(scope_pos.x + pane_w + 2.0f, scope_pos.y), pane_w, scope_h,
+			                &g_scope_trace, 1, IM_COL32(100, 255, 100, 255), "R");
+		}
+		ImGui::Dummy(ImVec2(scope_w, scope_h));
+
+		// Spectrum analyzer: at most one FFT and one waterfall row per frame
+		if (oscilloscope_spectrum_update() && g_waterfall_texture) {
+			unsigned char row[SPECTRUM_COLUMNS * 4];
+			oscilloscope_waterfall_row(row);
+			g_waterfall_row = (g_waterfall_row + WATERFALL_HEIGHT - 1) % WATERFALL_HEIGHT;
+			glBindTexture(GL_TEXTURE_2D, g_waterfall_texture);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, g_waterfall_row, SPECTRUM_COLUMNS, 1, GL_RGBA, GL_UNSIGNED_BYTE, row);
+		}
+
+		const float* spectrum = oscilloscope_spectrum();
+		float spec_w = ImGui::GetContentRegionAvail().x;
+		float spec_h = 120.0f;
+		ImVec2 spec_pos = ImGui::GetCursorScreenPos();
+		ImVec2 spec_end = ImVec2(spec_pos.x + spec_w, spec_pos.y + spec_h);
+		ImDrawList* spec_draw = ImGui::GetWindowDrawList();
+		spec_draw->AddRectFilled(spec_pos, spec_end, IM_COL32(20, 25, 35, 255));
+
+		// Decade lines and 20 dB steps
+		const float decades[] = { 100.0f, 1000.0f, 10000.0f };
+		const char* decade_labels[] = { "100", "1k", "10k" };
+		float log_span = logf(SPECTRUM_MAX_HZ / SPECTRUM_MIN_HZ);
+		for (int i = 0; i < 3; ++i) {
+			float gx = spec_pos.x + spec_w * logf(decades[i] / SPECTRUM_MIN_HZ) / log_span;
+			spec_draw->AddLine(ImVec2(gx, spec_pos.y), ImVec2(gx, spec_end.y), IM_COL32(40, 45, 55, 255));
+			spec_draw->AddText(ImVec2(gx + 2, spec_end.y - 15), IM_COL32(180, 180, 200, 255), decade_labels[i]);
+		}
+		for (float db = -20.0f; db > SPECTRUM_MIN_DB; db -= 20.0f) {
+			float gy = spec_pos.y + spec_h * db / SPECTRUM_MIN_DB;
+			spec_draw->AddLine(ImVec2(spec_pos.x, gy), ImVec2(spec_end.x, gy), IM_COL32(40, 45, 55, 255));
+		}
+
+		ImVec2 spec_points[SPECTRUM_COLUMNS];
+		for (int c = 0; c < SPECTRUM_COLUMNS; ++c) {
+			float t = spectrum[c] / SPECTRUM_MIN_DB; // 0 at 0 dBFS, 1 at the floor
+			spec_points[c] = ImVec2(spec_pos.x + spec_w * c / (SPECTRUM_COLUMNS - 1),
+			                        spec_pos.y + spec_h * fminf(fmaxf(t, 0.0f), 1.0f));
 		}
-		ImGui::EndChild();
-		ImGui::PopStyleVar();
+		spec_draw->AddPolyline(spec_points, SPECTRUM_COLUMNS, IM_COL32(100, 200, 255, 255), 0, 1.5f);
+		spec_draw->AddRect(spec_pos, spec_end, IM_COL32(100, 100, 120, 255));
+		ImGui::Dummy(ImVec2(spec_w, spec_h));
+
+		// Newest row at the top; the texture coordinate wraps around the ring
+		if (g_waterfall_texture) {
+			float v0 = (float)g_waterfall_row / WATERFALL_HEIGHT;
+			ImGui::Image((void*)(intptr_t)g_waterfall_texture, ImVec2(spec_w, (float)WATERFALL_HEIGHT / 2),
+			             ImVec2(0.0f, v0), ImVec2(1.0f, v0 + 1.0f));
+		}
+	} else {
+		oscilloscope_drain();
 	}
 
+    // Parts
+    if (ImGui::CollapsingHeader("Parts", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Text("Edit part");
+        for (int p = 0; p < SYNTH_MAX_PARTS; ++p) {
+            char label[32];
+            snprintf(label, sizeof(label), "%d##part%d", p + 1, p);
+            if (p % 8)
+                ImGui::SameLine();
+            // Parts with sounding voices light up
+            bool sounding = p < SNAPSHOT_MAX_PARTS && snap->part_voices[p] > 0;
+            if (sounding)
+                ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.2f, 0.6f, 0.3f, 1.0f));
+            if (ImGui::RadioButton(label, synth->edit_part == p))
+                synth_set_param(synth, "part.edit", (float)p);
+            if (sounding)
+                ImGui::PopStyleColor();
+        }
+        // Re-read: the buttons above may have switched parts
+        part = synth_edit_part(synth);
+
+        ImGui::SliderInt("MIDI Channel", &part->channel, 0, 16, part->channel ? "%d" : "All");
+        ImGui::SliderFloat("Level##part", &part->level, 0.0f, 2.0f, "%.2f", 0);
+        ImGui::SliderFloat("Pan##part", &part->pan, -1.0f, 1.0f, "%.2f", 0);
+        ImGui::SliderFloat("Reverb Send", &part->reverb_send, 0.0f, 1.0f, "%.2f", 0);
+        ImGui::SliderFloat("Delay Send", &part->delay_send, 0.0f, 1.0f, "%.2f", 0);
+
+        ImGui::Separator();
+        ImGui::Text("Send Bus");
+        float bus_size = synth->bus.reverb_size;
+        float bus_damping = synth->bus.reverb_damping;
+        if (ImGui::SliderFloat("Reverb Size##bus", &bus_size, 0.0f, 1.0f, "%.2f", 0))
+            synth_set_param(synth, "bus.reverb.size", bus_size);
+        if (ImGui::SliderFloat("Reverb Damping##bus", &bus_damping, 0.0f, 1.0f, "%.2f", 0))
+            synth_set_param(synth, "bus.reverb.damping", bus_damping);
+        ImGui::SliderFloat("Reverb Return##bus", &synth->bus.reverb_return, 0.0f, 2.0f, "%.2f", 0);
+        ImGui::SliderFloat("Delay Time##bus", &synth->bus.delay_time, 0.01f, SEND_BUS_DELAY_SECONDS, "%.3f s", 0);
+        ImGui::SliderFloat("Delay Feedback##bus", &synth->bus.delay_feedback, 0.0f, 0.95f, "%.2f", 0);
+        ImGui::SliderFloat("Delay Return##bus", &synth->bus.delay_return, 0.0f, 2.0f, "%.2f", 0);
+    }
+
     // Oscillators
     if (ImGui::CollapsingHeader("Oscillators", ImGuiTreeNodeFlags_DefaultOpen)) {
         ImGui::Columns(2, "osc_columns", true);
@@ -207,21 +298,21 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
             ImGui::Text("%s", title);
 
             const char* items[] = { "SINE", "SAW", "SQUARE", "TRI", "NOISE" };
-            int current_item = (int)synth->osc[i].waveform;
+            int current_item = (int)part->osc[i].waveform;
             if (ImGui::Combo("Waveform", &current_item, "SINE\0SAW\0SQUARE\0TRI\0NOISE\0\0", 5)) {
-                synth->osc[i].waveform = (OscWaveform)current_item;
+                part->osc[i].waveform = (OscWaveform)current_item;
             }
 
-            ImGui::SliderFloat("Pitch", &synth->osc[i].pitch, -24.0f, 24.0f, "%.2f", 0);
-            ImGui::SliderFloat("Detune", &synth->osc[i].detune, -1.0f, 1.0f, "%.2f", 0);
-            ImGui::SliderFloat("Gain", &synth->osc[i].gain, 0.0f, 1.0f, "%.2f", 0);
-            ImGui::SliderFloat("Pan", &synth->osc[i].pan, -1.0f, 1.0f, "%.2f", 0);
-            ImGui::SliderFloat("Pulse Width", &synth->osc[i].pulse_width, 0.0f, 1.0f, "%.2f", 0);
-            int unison_voices = synth->osc[i].unison_voices;
+            ImGui::SliderFloat("Pitch", &part->osc[i].pitch, -24.0f, 24.0f, "%.2f", 0);
+            ImGui::SliderFloat("Detune", &part->osc[i].detune, -1.0f, 1.0f, "%.2f", 0);
+            ImGui::SliderFloat("Gain", &part->osc[i].gain, 0.0f, 1.0f, "%.2f", 0);
+            ImGui::SliderFloat("Pan", &part->osc[i].pan, -1.0f, 1.0f, "%.2f", 0);
+            ImGui::SliderFloat("Pulse Width", &part->osc[i].pulse_width, 0.0f, 1.0f, "%.2f", 0);
+            int unison_voices = part->osc[i].unison_voices;
             if (ImGui::SliderInt("Unison", &unison_voices, 1, 8, "%d", 0)) {
-                synth->osc[i].unison_voices = unison_voices;
+                part->osc[i].unison_voices = unison_voices;
             }
-            ImGui::SliderFloat("Unison Detune", &synth->osc[i].unison_detune, 0.0f, 1.0f, "%.2f", 0);
+            ImGui::SliderFloat("Unison Detune", &part->osc[i].unison_detune, 0.0f, 1.0f, "%.2f", 0);
 
             ImGui::EndChild();
             ImGui::PopID();
@@ -265,29 +356,29 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         
         // Attack column
         ImGui::Text("Attack");
-        if (ImGui::SliderFloat("##adsrattack", &synth->adsr.attack, 0.001f, 5.0f, "%.3f s", 0)) {
-            synth_set_param(synth, "adsr.attack", synth->adsr.attack);
+        if (ImGui::SliderFloat("##adsrattack", &part->adsr.attack, 0.001f, 5.0f, "%.3f s", 0)) {
+            synth_set_param(synth, "adsr.attack", part->adsr.attack);
         }
         ImGui::NextColumn();
         
         // Decay column
         ImGui::Text("Decay");
-        if (ImGui::SliderFloat("##adsrdecay", &synth->adsr.decay, 0.001f, 5.0f, "%.3f s", 0)) {
-            synth_set_param(synth, "adsr.decay", synth->adsr.decay);
+        if (ImGui::SliderFloat("##adsrdecay", &part->adsr.decay, 0.001f, 5.0f, "%.3f s", 0)) {
+            synth_set_param(synth, "adsr.decay", part->adsr.decay);
         }
         ImGui::NextColumn();
         
         // Sustain column
         ImGui::Text("Sustain");
-        if (ImGui::SliderFloat("##adsrsustain", &synth->adsr.sustain, 0.0f, 1.0f, "%.2f", 0)) {
-            synth_set_param(synth, "adsr.sustain", synth->adsr.sustain);
+        if (ImGui::SliderFloat("##adsrsustain", &part->adsr.sustain, 0.0f, 1.0f, "%.2f", 0)) {
+            synth_set_param(synth, "adsr.sustain", part->adsr.sustain);
         }
         ImGui::NextColumn();
         
         // Release column
         ImGui::Text("Release");
-        if (ImGui::SliderFloat("##adsrrelease", &synth->adsr.release, 0.001f, 10.0f, "%.3f s", 0)) {
-            synth_set_param(synth, "adsr.release", synth->adsr.release);
+        if (ImGui::SliderFloat("##adsrrelease", &part->adsr.release, 0.001f, 10.0f, "%.3f s", 0)) {
+            synth_set_param(synth, "adsr.release", part->adsr.release);
         }
         ImGui::NextColumn();
         
@@ -304,7 +395,7 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         
         // Calculate envelope curve points
         const int num_points = 100;
-        float total_time = synth->adsr.attack + synth->adsr.decay + synth->adsr.release + 1.0f; // Add 1 second for sustain phase
+        float total_time = part->adsr.attack + part->adsr.decay + part->adsr.release + 1.0f; // Add 1 second for sustain phase
         float max_time = fmaxf(total_time, 2.0f); // At least 2 seconds for display
         
         // Calculate envelope points and clip to canvas bounds
@@ -315,20 +406,20 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
             float t = (float)i / (float)(num_points - 1) * max_time;
             float amplitude = 0.0f;
             
-            if (t < synth->adsr.attack) {
+            if (t < part->adsr.attack) {
                 // Attack phase: linear ramp from 0 to 1
-                amplitude = t / synth->adsr.attack;
-            } else if (t < synth->adsr.attack + synth->adsr.decay) {
+                amplitude = t / part->adsr.attack;
+            } else if (t < part->adsr.attack + part->adsr.decay) {
                 // Decay phase: exponential decay from 1 to sustain
-                float decay_progress = (t - synth->adsr.attack) / synth->adsr.decay;
-                amplitude = 1.0f - (1.0f - synth->adsr.sustain) * decay_progress;
-            } else if (t < synth->adsr.attack + synth->adsr.decay + 1.0f) {
+                float decay_progress = (t - part->adsr.attack) / part->adsr.decay;
+                amplitude = 1.0f - (1.0f - part->adsr.sustain) * decay_progress;
+            } else if (t < part->adsr.attack + part->adsr.decay + 1.0f) {
                 // Sustain phase: constant
-                amplitude = synth->adsr.sustain;
+                amplitude = part->adsr.sustain;
             } else {
                 // Release phase: exponential decay from sustain to 0
-                float release_progress = (t - synth->adsr.attack - synth->adsr.decay - 1.0f) / synth->adsr.release;
-                amplitude = synth->adsr.sustain * (1.0f - release_progress);
+                float release_progress = (t - part->adsr.attack - part->adsr.decay - 1.0f) / part->adsr.release;
+                amplitude = part->adsr.sustain * (1.0f - release_progress);
             }
             
             // Calculate screen position and clip to canvas bounds
@@ -353,10 +444,18 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         draw_list->AddText(ImVec2(canvas_pos.x + canvas_size.x / 4 + 2, canvas_pos.y + canvas_size.y - 15), IM_COL32(180, 180, 200, 255), "D");
         draw_list->AddText(ImVec2(canvas_pos.x + canvas_size.x / 2 + 2, canvas_pos.y + canvas_size.y - 15), IM_COL32(180, 180, 200, 255), "S");
         draw_list->AddText(ImVec2(canvas_pos.x + 3 * canvas_size.x / 4 + 2, canvas_pos.y + canvas_size.y - 15), IM_COL32(180, 180, 200, 255), "R");
+
+        // Live envelope level of each sounding voice along the right edge
+        for (int v = 0; v < snap->active_voices; ++v) {
+            float y = bg_end.y - fminf(snap->voices[v].level, 1.0f) * canvas_size.y;
+            draw_list->AddLine(ImVec2(bg_end.x - 10, y), ImVec2(bg_end.x, y), IM_COL32(255, 200, 80, 255), 2.0f);
+        }
         
         ImGui::Dummy(canvas_size); // Reserve space for the drawing
         
         ImGui::Columns(1, "", false);
+        ImGui::Text("Voices: %d | DSP load: %.1f%% | UI thread: %.1f%%", snap->active_voices, snap->dsp_load,
+                    g_ui_cpu ? *g_ui_cpu : 0.0f);
         
         // Preset buttons
         ImGui::Separator();
@@ -491,22 +590,22 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
             ImGui::Text("%s", lfo_names[i]);
             
             // Enable/Disable toggle button
-            if (synth->lfos[i].enabled) {
+            if (part->lfos[i].enabled) {
                 ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.0f, 0.8f, 0.0f, 1.0f));
                 if (ImGui::Button("ON")) {
-                    synth->lfos[i].enabled = 0;
+                    part->lfos[i].enabled = 0;
                 }
                 ImGui::PopStyleColor();
             } else {
                 ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
                 if (ImGui::Button("OFF")) {
-                    synth->lfos[i].enabled = 1;
+                    part->lfos[i].enabled = 1;
                 }
                 ImGui::PopStyleColor();
             }
             
             // Waveform selection
-            int current_waveform = (int)synth->lfos[i].waveform;
+            int current_waveform = (int)part->lfos[i].waveform;
             if (ImGui::Combo("Waveform", &current_waveform, waveforms, IM_ARRAYSIZE(waveforms))) {
                 char param_name[32];
                 snprintf(param_name, sizeof(param_name), "lfo%d.waveform", i + 1);
@@ -514,28 +613,28 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
             }
             
             // Frequency slider
-            if (ImGui::SliderFloat("Frequency (Hz)", &synth->lfos[i].frequency, 0.1f, 20.0f, "%.2f", 0)) {
+            if (ImGui::SliderFloat("Frequency (Hz)", &part->lfos[i].frequency, 0.1f, 20.0f, "%.2f", 0)) {
                 char param_name[32];
                 snprintf(param_name, sizeof(param_name), "lfo%d.frequency", i + 1);
-                synth_set_param(synth, param_name, synth->lfos[i].frequency);
+                synth_set_param(synth, param_name, part->lfos[i].frequency);
             }
             
             // Depth slider
-            if (ImGui::SliderFloat("Depth", &synth->lfos[i].depth, 0.0f, 1.0f, "%.2f", 0)) {
+            if (ImGui::SliderFloat("Depth", &part->lfos[i].depth, 0.0f, 1.0f, "%.2f", 0)) {
                 char param_name[32];
                 snprintf(param_name, sizeof(param_name), "lfo%d.depth", i + 1);
-                synth_set_param(synth, param_name, synth->lfos[i].depth);
+                synth_set_param(synth, param_name, part->lfos[i].depth);
             }
             
             // Phase slider
-            if (ImGui::SliderFloat("Phase", &synth->lfos[i].phase, 0.0f, 1.0f, "%.2f", 0)) {
+            if (ImGui::SliderFloat("Phase", &part->lfos[i].phase, 0.0f, 1.0f, "%.2f", 0)) {
                 char param_name[32];
                 snprintf(param_name, sizeof(param_name), "lfo%d.phase", i + 1);
-                synth_set_param(synth, param_name, synth->lfos[i].phase);
+                synth_set_param(synth, param_name, part->lfos[i].phase);
             }
             
             // Sync mode selection
-            int current_sync = (int)synth->lfos[i].sync;
+            int current_sync = (int)part->lfos[i].sync;
             if (ImGui::Combo("Sync", &current_sync, sync_modes, IM_ARRAYSIZE(sync_modes))) {
                 char param_name[32];
                 snprintf(param_name, sizeof(param_name), "lfo%d.sync", i + 1);
@@ -596,6 +695,19 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         ImGui::SliderFloat("Rate##flanger", &synth->fx.flanger_rate, 0.0f, 5.0f, "%.2f", 0);
         ImGui::SliderFloat("Feedback##flanger", &synth->fx.flanger_feedback, 0.0f, 1.0f, "%.2f", 0);
 
+        ImGui::Separator();
+
+        ImGui::Text("Chorus");
+        if (ImGui::SliderFloat("Depth##chorus", &synth->fx.chorus_depth, 0.0f, 1.0f, "%.2f", 0)) {
+            synth_set_param(synth, "fx.chorus.depth", synth->fx.chorus_depth);
+        }
+        if (ImGui::SliderFloat("Rate##chorus", &synth->fx.chorus_rate, 0.05f, 5.0f, "%.2f", 0)) {
+            synth_set_param(synth, "fx.chorus.rate", synth->fx.chorus_rate);
+        }
+        if (ImGui::SliderFloat("Mix##chorus", &synth->fx.chorus_mix, 0.0f, 1.0f, "%.2f", 0)) {
+            synth_set_param(synth, "fx.chorus.mix", synth->fx.chorus_mix);
+        }
+
         ImGui::Separator();
         ImGui::Text("Delay");
         static bool delay_enabled = false;
@@ -624,9 +736,38 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         
         ImGui::Columns(1, "reverb_column", true);
         ImGui::Text("Reverb");
-        ImGui::SliderFloat("Size##reverb", &synth->fx.reverb_size, 0.0f, 1.0f, "%.2f", 0);
+        const char* reverb_algorithms[] = { "Classic", "FDN" };
+        if (ImGui::Combo("Algorithm##reverb", &synth->fx.reverb_algorithm, reverb_algorithms, IM_ARRAYSIZE(reverb_algorithms))) {
+            synth_set_param(synth, "fx.reverb.algorithm", (float)synth->fx.reverb_algorithm);
+        }
+        if (ImGui::SliderFloat("Size##reverb", &synth->fx.reverb_size, 0.0f, 1.0f, "%.2f", 0)) {
+            synth_set_param(synth, "fx.reverb.size", synth->fx.reverb_size);
+        }
         ImGui::SliderFloat("Mix##reverb", &synth->fx.reverb_mix, 0.0f, 1.0f, "%.2f", 0);
-        ImGui::SliderFloat("Damping##reverb", &synth->fx.reverb_damping, 0.0f, 1.0f, "%.2f", 0);
+        if (ImGui::SliderFloat("Damping##reverb", &synth->fx.reverb_damping, 0.0f, 1.0f, "%.2f", 0)) {
+            synth_set_param(synth, "fx.reverb.damping", synth->fx.reverb_damping);
+        }
+
+        ImGui::Separator();
+
+        ImGui::Text("Convolution");
+        static char ir_path[256] = "";
+        ImGui::InputText("IR file##conv", ir_path, sizeof(ir_path));
+        ImGui::SameLine();
+        if (ImGui::Button("Load##conv") && ir_path[0]) {
+            // Loads and transforms the IR here; the audio thread only swaps a pointer
+            fx_load_impulse_response(&synth->fx, ir_path);
+        }
+        if (synth->fx.conv_ir_path[0]) {
+            ImGui::Text("Loaded: %s", synth->fx.conv_ir_path);
+        }
+        if (ImGui::SliderFloat("Mix##conv", &synth->fx.conv_mix, 0.0f, 1.0f, "%.2f", 0)) {
+            synth_set_param(synth, "fx.convolution.mix", synth->fx.conv_mix);
+        }
+        int late = snap->conv_late_blocks;
+        if (late > 0) {
+            ImGui::Text("Late tail blocks: %d", late);
+        }
 
         ImGui::Columns(1, "", false);
     }
@@ -670,6 +811,10 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         
         ImGui::Text("Makeup Gain");
         ImGui::SliderFloat("##makeup", &synth->mixer.comp_makeup_gain, 0.0f, 12.0f, "%.1f dB", 0);
+
+        const char* detectors[] = { "Peak", "RMS" };
+        ImGui::Combo("Detector##comp", &synth->mixer.comp_detector, detectors, IM_ARRAYSIZE(detectors));
+        ImGui::Text("Gain reduction: %.1f dB", snap->comp_gain_reduction);
 	}
 
     // Mastering
@@ -685,11 +830,20 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         ImGui::SliderFloat("Threshold (dB)##soft_clip", &synth->mixer.soft_clip_threshold, -20.0f, 0.0f, "%.1f dB", 0);
         ImGui::SliderFloat("Knee Ratio##soft_clip", &synth->mixer.soft_clip_ratio, 1.0f, 10.0f, "%.1f", 0);
         
+        ImGui::Separator();
+
+        ImGui::Text("True-Peak Limiter");
+        ImGui::Checkbox("Enabled##limiter", (bool*)&synth->mixer.limiter_enabled);
+        ImGui::SliderFloat("Ceiling (dBTP)##limiter", &synth->mixer.limiter_ceiling, -12.0f, 0.0f, "%.1f dB", 0);
+        ImGui::SliderFloat("Release##limiter", &synth->mixer.limiter_release, 5.0f, 500.0f, "%.0f ms", 0);
+        ImGui::Text("Gain reduction: %.1f dB", snap->limiter_gain_reduction);
+
         ImGui::Separator();
         
         ImGui::Text("Auto Gain");
         ImGui::Checkbox("Enabled##auto_gain", (bool*)&synth->mixer.auto_gain_enabled);
-        ImGui::SliderFloat("Target (dB)##auto_gain", &synth->mixer.auto_gain_target, -20.0f, 0.0f, "%.1f dB", 0);
+        ImGui::SliderFloat("Target (LUFS)##auto_gain", &synth->mixer.auto_gain_target, -36.0f, -6.0f, "%.1f LUFS", 0);
+        ImGui::SliderFloat("Response##auto_gain", &synth->mixer.auto_gain_seconds, 0.1f, 10.0f, "%.1f s", 0);
         
         ImGui::Separator();
         
@@ -703,7 +857,7 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         
         // Peak meter
         ImVec2 peak_bar_pos = ImGui::GetCursorScreenPos();
-        float normalized_peak = fmaxf(0.0f, fminf(1.0f, (synth->mixer.peak_level + 60.0f) / 60.0f)); // Normalize -60 to 0 dB
+        float normalized_peak = fmaxf(0.0f, fminf(1.0f, (snap->peak_level + 60.0f) / 60.0f)); // Normalize -60 to 0 dB
         ImDrawList* draw_list = ImGui::GetWindowDrawList();
         draw_list->AddRectFilled(peak_bar_pos, 
                               ImVec2(peak_bar_pos.x + bar_width * normalized_peak, peak_bar_pos.y + bar_height),
@@ -712,63 +866,75 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
                           ImVec2(peak_bar_pos.x + bar_width, peak_bar_pos.y + bar_height),
                           ImColor(1.0f, 1.0f, 1.0f, 1.0f)); // White border
         // ImGui::Dummy(ImVec2(bar_width + bar_spacing, bar_height));
-        ImGui::Text("Peak: %.1f dB", synth->mixer.peak_level);
+        ImGui::Text("Peak: %.1f dB", snap->peak_level);
         
         // RMS meter
         ImVec2 rms_bar_pos = ImGui::GetCursorScreenPos();
-        float normalized_rms = fmaxf(0.0f, fminf(1.0f, (synth->mixer.rms_level + 60.0f) / 60.0f)); // Normalize -60 to 0 dB
+        float normalized_rms = fmaxf(0.0f, fminf(1.0f, (snap->rms_level + 60.0f) / 60.0f)); // Normalize -60 to 0 dB
         draw_list->AddRectFilled(rms_bar_pos, 
                               ImVec2(rms_bar_pos.x + bar_width * normalized_rms, rms_bar_pos.y + bar_height),
                               ImColor(0.8f, 0.2f, 0.2f, 1.0f)); // Orange bar
         draw_list->AddRect(rms_bar_pos, 
                           ImVec2(rms_bar_pos.x + bar_width, rms_bar_pos.y + bar_height),
                           ImColor(1.0f, 1.0f, 1.0f, 1.0f)); // White border
-        ImGui::Text("RMS: %.1f dB", synth->mixer.rms_level);
+        ImGui::Text("RMS: %.1f dB", snap->rms_level);
+
+        ImGui::Separator();
+
+        // EBU R128 loudness of the bus output
+        ImGui::Text("Loudness");
+        ImGui::Text("Momentary: %.1f LUFS", snap->lufs_momentary);
+        ImGui::Text("Short-term: %.1f LUFS", snap->lufs_short_term);
+        ImGui::Text("Integrated: %.1f LUFS", snap->lufs_integrated);
+        ImGui::Text("True peak: %.1f dBTP", snap->true_peak);
+        if (ImGui::Button("Reset##loudness")) {
+            synth->mixer.loudness_reset_request = 1;
+        }
 
 		ImGui::Separator();
 	}
         
     // Arpeggiator
     if (ImGui::CollapsingHeader("Arpeggiator", ImGuiTreeNodeFlags_DefaultOpen)) {
-        ImGui::Checkbox("Enabled##arp", (bool*)&synth->arp.enabled);
+        ImGui::Checkbox("Enabled##arp", (bool*)&part->arp.enabled);
         const char* arp_modes[] = { 
             "OFF", "CHORD", "UP", "DOWN", "UP/DOWN", "PENDULUM", 
             "CONVERGE", "DIVERGE", "LEAPFROG", "THUMB-UP", "THUMB-DOWN", 
             "PINKY-UP", "PINKY-DOWN", "REPEAT", "RANDOM", "RANDOM WALK", "SHUFFLE", "ORDER" 
         };
-        int current_arp_mode = (int)synth->arp.mode;
+        int current_arp_mode = (int)part->arp.mode;
         if (ImGui::Combo("Mode", &current_arp_mode, arp_modes, 18)) {
-            synth->arp.mode = (ArpMode)current_arp_mode;
+            part->arp.mode = (ArpMode)current_arp_mode;
         }
-        ImGui::SliderFloat("Tempo", &synth->arp.tempo, 30.0f, 240.0f, "%.2f", 0);
-        const char* arp_rates[] = { "1/4", "1/8", "1/16", "1/32" };
-        int current_arp_rate = (int)synth->arp.rate;
-        if (ImGui::Combo("Rate", &current_arp_rate, arp_rates, 4)) {
-            synth->arp.rate = (ArpRate)current_arp_rate;
+        ImGui::SliderFloat("Tempo", &synth->transport.bpm, 30.0f, 240.0f, "%.2f", 0);
+        const char* arp_rates[] = { "1/4", "1/8", "1/16", "1/32", "1/64" };
+        int current_arp_rate = (int)part->arp.rate;
+        if (ImGui::Combo("Rate", &current_arp_rate, arp_rates, 5)) {
+            part->arp.rate = (ArpRate)current_arp_rate;
         }
-        ImGui::SliderInt("Octave", &synth->arp.octave, 0, 4, "%d");
-        ImGui::SliderInt("Octaves", &synth->arp.octaves, 1, 6, "%d");
-        ImGui::Checkbox("Polyphonic", (bool*)&synth->arp.polyphonic);
-        ImGui::Checkbox("Hold", (bool*)&synth->arp.hold);
+        ImGui::SliderInt("Octave", &part->arp.octave, 0, 4, "%d");
+        ImGui::SliderInt("Octaves", &part->arp.octaves, 1, 6, "%d");
+        ImGui::Checkbox("Polyphonic", (bool*)&part->arp.polyphonic);
+        ImGui::Checkbox("Hold", (bool*)&part->arp.hold);
         
         ImGui::Separator();
         ImGui::Text("Chord Generation:");
         
         // Chord Type
         const char* chord_types[] = {"MAJOR", "MINOR", "SUS", "DIM"};
-        int current_chord_type = (int)synth->arp.chord_type;
+        int current_chord_type = (int)part->arp.chord_type;
         if (ImGui::Combo("Chord Type", &current_chord_type, chord_types, 4)) {
-            synth->arp.chord_type = (ChordType)current_chord_type;
+            part->arp.chord_type = (ChordType)current_chord_type;
         }
         
         // Chord Extensions
-        ImGui::Checkbox("Add 6th", (bool*)&synth->arp.add_6);
-        ImGui::Checkbox("Add m7", (bool*)&synth->arp.add_m7);
-        ImGui::Checkbox("Add Maj7", (bool*)&synth->arp.add_M7);
-        ImGui::Checkbox("Add 9th", (bool*)&synth->arp.add_9);
+        ImGui::Checkbox("Add 6th", (bool*)&part->arp.add_6);
+        ImGui::Checkbox("Add m7", (bool*)&part->arp.add_m7);
+        ImGui::Checkbox("Add Maj7", (bool*)&part->arp.add_M7);
+        ImGui::Checkbox("Add 9th", (bool*)&part->arp.add_9);
         
         // Voicing
-        ImGui::SliderInt("Voicing", &synth->arp.voicing, 0, 16, "%d");
+        ImGui::SliderInt("Voicing", &part->arp.voicing, 0, 16, "%d");
         if (ImGui::IsItemHovered()) {
             const char* voicing_descriptions[] = {
                 "Root Position",
@@ -777,171 +943,203 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
                 "Drop 2", "Drop 3", "Drop 2&4", "Drop 2&3",
                 "Open Harmony", "Wide Spread", "Clustered", "Alternating Octaves"
             };
-            if (synth->arp.voicing >= 0 && synth->arp.voicing <= 16) {
-                ImGui::SetTooltip("%s", voicing_descriptions[synth->arp.voicing]);
+            if (part->arp.voicing >= 0 && part->arp.voicing <= 16) {
+                ImGui::SetTooltip("%s", voicing_descriptions[part->arp.voicing]);
             }
         }
         
         ImGui::Separator();
         ImGui::Text("Gate & Timing:");
-        ImGui::SliderFloat("Gate Length", &synth->arp.gate_length, 0.1f, 1.0f, "%.2f");
+        ImGui::SliderFloat("Gate Length", &part->arp.gate_length, 0.1f, 1.0f, "%.2f");
         if (ImGui::IsItemHovered()) {
             ImGui::SetTooltip("Controls note duration (0.1=10%%, 0.5=50%%, 1.0=100%% of step time)");
         }
+        ImGui::SliderFloat("Swing", &part->arp.swing, 0.5f, 0.75f, "%.2f");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Position of every second step (0.50=straight, 0.67=triplet feel)");
+        }
+        ImGui::SliderInt("Steps", &part->arp.pattern_length, 1, ARP_PATTERN_LEN, "%d");
+
+        // Step lanes: one column per step, dimmed past the pattern length
+        const ImVec2 lane_size(18.0f, 48.0f);
+        const char* lane_names[] = { "Vel", "Gate", "Prob", "Ratch", "Tie" };
+        for (int lane = 0; lane < 5; lane++) {
+            ImGui::Text("%-5s", lane_names[lane]);
+            for (int i = 0; i < ARP_PATTERN_LEN; i++) {
+                ArpStep* step = &part->arp.lanes[i];
+                ImGui::SameLine();
+                ImGui::PushID(lane * ARP_PATTERN_LEN + i);
+                ImGui::BeginDisabled(i >= part->arp.pattern_length);
+                switch (lane) {
+                case 0: ImGui::VSliderFloat("##vel", lane_size, &step->velocity, 0.0f, 1.0f, ""); break;
+                case 1: ImGui::VSliderFloat("##gate", lane_size, &step->gate, 0.05f, 1.0f, ""); break;
+                case 2: ImGui::VSliderFloat("##prob", lane_size, &step->probability, 0.0f, 1.0f, ""); break;
+                case 3: ImGui::VSliderInt("##ratchet", lane_size, &step->ratchet, 1, ARP_MAX_RATCHET, "%d"); break;
+                case 4: {
+                    bool tie = step->tie != 0;
+                    if (ImGui::Checkbox("##tie", &tie))
+                        step->tie = tie ? 1 : 0;
+                    break;
+                }
+                }
+                ImGui::EndDisabled();
+                ImGui::PopID();
+            }
+        }
         
         ImGui::Separator();
         ImGui::Text("Presets:");
         ImGui::Columns(4, "arp_presets", true);
         
         if (ImGui::Button("Classic Up")) {
-            synth->arp.mode = ARP_UP;
-            synth->arp.tempo = 120.0f;
-            synth->arp.octaves = 2;
-            synth->arp.polyphonic = 0;
-            synth->arp.gate_length = 0.8f;
+            part->arp.mode = ARP_UP;
+            synth->transport.bpm = 120.0f;
+            part->arp.octaves = 2;
+            part->arp.polyphonic = 0;
+            part->arp.gate_length = 0.8f;
         }
         ImGui::SameLine(); ImGui::Text("8th notes");
         
         if (ImGui::Button("Classic Down")) {
-            synth->arp.mode = ARP_DOWN;
-            synth->arp.tempo = 120.0f;
-            synth->arp.octaves = 2;
-            synth->arp.polyphonic = 0;
-            synth->arp.gate_length = 0.8f;
+            part->arp.mode = ARP_DOWN;
+            synth->transport.bpm = 120.0f;
+            part->arp.octaves = 2;
+            part->arp.polyphonic = 0;
+            part->arp.gate_length = 0.8f;
         }
         ImGui::SameLine(); ImGui::Text("Descending");
         
         if (ImGui::Button("Synth Pop")) {
-            synth->arp.mode = ARP_UP;
-            synth->arp.tempo = 130.0f;
-            synth->arp.octaves = 3;
-            synth->arp.polyphonic = 1;
-            synth->arp.gate_length = 0.7f;
+            part->arp.mode = ARP_UP;
+            synth->transport.bpm = 130.0f;
+            part->arp.octaves = 3;
+            part->arp.polyphonic = 1;
+            part->arp.gate_length = 0.7f;
         }
         ImGui::SameLine(); ImGui::Text("Pop style");
         
         if (ImGui::Button("Bass Line")) {
-            synth->arp.mode = ARP_ORDER;
-            synth->arp.tempo = 128.0f;
-            synth->arp.octaves = 1;
-            synth->arp.polyphonic = 0;
-            synth->arp.gate_length = 0.9f;
+            part->arp.mode = ARP_ORDER;
+            synth->transport.bpm = 128.0f;
+            part->arp.octaves = 1;
+            part->arp.polyphonic = 0;
+            part->arp.gate_length = 0.9f;
         }
         ImGui::SameLine(); ImGui::Text("Sequential");
         
         ImGui::NextColumn();
         
         if (ImGui::Button("Trance Gate")) {
-            synth->arp.mode = ARP_UP;
-            synth->arp.tempo = 140.0f;
-            synth->arp.rate = RATE_SIXTEENTH;
-            synth->arp.octaves = 4;
-            synth->arp.polyphonic = 1;
-            synth->arp.gate_length = 0.4f;
+            part->arp.mode = ARP_UP;
+            synth->transport.bpm = 140.0f;
+            part->arp.rate = RATE_SIXTEENTH;
+            part->arp.octaves = 4;
+            part->arp.polyphonic = 1;
+            part->arp.gate_length = 0.4f;
         }
         ImGui::SameLine(); ImGui::Text("16th notes");
         
         if (ImGui::Button("Random Chaos")) {
-            synth->arp.mode = ARP_RANDOM;
-            synth->arp.tempo = 100.0f;
-            synth->arp.octaves = 3;
-            synth->arp.polyphonic = 0;
-            synth->arp.gate_length = 0.6f;
+            part->arp.mode = ARP_RANDOM;
+            synth->transport.bpm = 100.0f;
+            part->arp.octaves = 3;
+            part->arp.polyphonic = 0;
+            part->arp.gate_length = 0.6f;
         }
         ImGui::SameLine(); ImGui::Text("Unpredictable");
         
         if (ImGui::Button("House Chord")) {
-            synth->arp.mode = ARP_ORDER;
-            synth->arp.tempo = 124.0f;
-            synth->arp.octaves = 2;
-            synth->arp.polyphonic = 1;
-            synth->arp.gate_length = 0.8f;
+            part->arp.mode = ARP_ORDER;
+            synth->transport.bpm = 124.0f;
+            part->arp.octaves = 2;
+            part->arp.polyphonic = 1;
+            part->arp.gate_length = 0.8f;
         }
         ImGui::SameLine(); ImGui::Text("Progressive");
         
         if (ImGui::Button("Sustained Chord")) {
-            synth->arp.mode = ARP_CHORD;
-            synth->arp.tempo = 60.0f;
-            synth->arp.octaves = 1;
-            synth->arp.polyphonic = 1;
-            synth->arp.gate_length = 1.0f;
+            part->arp.mode = ARP_CHORD;
+            synth->transport.bpm = 60.0f;
+            part->arp.octaves = 1;
+            part->arp.polyphonic = 1;
+            part->arp.gate_length = 1.0f;
         }
         ImGui::SameLine(); ImGui::Text("Chordal");
         
         ImGui::NextColumn();
         
         if (ImGui::Button("Techno Pulse")) {
-            synth->arp.mode = ARP_DOWN;
-            synth->arp.tempo = 135.0f;
-            synth->arp.octaves = 2;
-            synth->arp.polyphonic = 0;
-            synth->arp.gate_length = 0.3f;
+            part->arp.mode = ARP_DOWN;
+            synth->transport.bpm = 135.0f;
+            part->arp.octaves = 2;
+            part->arp.polyphonic = 0;
+            part->arp.gate_length = 0.3f;
         }
         ImGui::SameLine(); ImGui::Text("Driving");
         
         if (ImGui::Button("Dub Sequence")) {
-            synth->arp.mode = ARP_UP;
-            synth->arp.tempo = 70.0f;
-            synth->arp.octaves = 1;
-            synth->arp.polyphonic = 0;
-            synth->arp.gate_length = 0.7f;
+            part->arp.mode = ARP_UP;
+            synth->transport.bpm = 70.0f;
+            part->arp.octaves = 1;
+            part->arp.polyphonic = 0;
+            part->arp.gate_length = 0.7f;
         }
         ImGui::SameLine(); ImGui::Text("Reggae");
         
         if (ImGui::Button("DnB Roll")) {
-            synth->arp.mode = ARP_RANDOM;
-            synth->arp.tempo = 174.0f;
-            synth->arp.rate = RATE_THIRTYSECOND;
-            synth->arp.octaves = 2;
-            synth->arp.polyphonic = 1;
-            synth->arp.gate_length = 0.2f;
+            part->arp.mode = ARP_RANDOM;
+            synth->transport.bpm = 174.0f;
+            part->arp.rate = RATE_THIRTYSECOND;
+            part->arp.octaves = 2;
+            part->arp.polyphonic = 1;
+            part->arp.gate_length = 0.2f;
         }
         ImGui::SameLine(); ImGui::Text("Fast");
         
         if (ImGui::Button("Video Game")) {
-            synth->arp.mode = ARP_UP;
-            synth->arp.tempo = 110.0f;
-            synth->arp.octaves = 2;
-            synth->arp.polyphonic = 0;
-            synth->arp.gate_length = 0.5f;
+            part->arp.mode = ARP_UP;
+            synth->transport.bpm = 110.0f;
+            part->arp.octaves = 2;
+            part->arp.polyphonic = 0;
+            part->arp.gate_length = 0.5f;
         }
         ImGui::SameLine(); ImGui::Text("8-bit");
         
         ImGui::NextColumn();
         
         if (ImGui::Button("Classic Arp")) {
-            synth->arp.mode = ARP_UP;
-            synth->arp.tempo = 92.0f;
-            synth->arp.octaves = 4;
-            synth->arp.polyphonic = 0;
-            synth->arp.gate_length = 0.8f;
+            part->arp.mode = ARP_UP;
+            synth->transport.bpm = 92.0f;
+            part->arp.octaves = 4;
+            part->arp.polyphonic = 0;
+            part->arp.gate_length = 0.8f;
         }
         ImGui::SameLine(); ImGui::Text("Classic");
         
         if (ImGui::Button("Dream Pop")) {
-            synth->arp.mode = ARP_ORDER;
-            synth->arp.tempo = 80.0f;
-            synth->arp.octaves = 3;
-            synth->arp.polyphonic = 1;
-            synth->arp.gate_length = 0.9f;
+            part->arp.mode = ARP_ORDER;
+            synth->transport.bpm = 80.0f;
+            part->arp.octaves = 3;
+            part->arp.polyphonic = 1;
+            part->arp.gate_length = 0.9f;
         }
         ImGui::SameLine(); ImGui::Text("Ethereal");
         
         if (ImGui::Button("Industrial")) {
-            synth->arp.mode = ARP_RANDOM;
-            synth->arp.tempo = 160.0f;
-            synth->arp.gate_length = 0.2f; // Staccato industrial feel
-            synth->arp.octaves = 2;
-            synth->arp.polyphonic = 0;
+            part->arp.mode = ARP_RANDOM;
+            synth->transport.bpm = 160.0f;
+            part->arp.gate_length = 0.2f; // Staccato industrial feel
+            part->arp.octaves = 2;
+            part->arp.polyphonic = 0;
         }
         ImGui::SameLine(); ImGui::Text("Harsh");
         
         if (ImGui::Button("Pendulum")) {
-            synth->arp.mode = ARP_PENDULUM;
-            synth->arp.tempo = 120.0f;
-            synth->arp.octaves = 2;
-            synth->arp.polyphonic = 0;
-            synth->arp.gate_length = 0.6f; // Medium gate for swing feel
+            part->arp.mode = ARP_PENDULUM;
+            synth->transport.bpm = 120.0f;
+            part->arp.octaves = 2;
+            part->arp.polyphonic = 0;
+            part->arp.gate_length = 0.6f; // Medium gate for swing feel
         }
         ImGui::SameLine(); ImGui::Text("Bouncing");
         
@@ -953,10 +1151,10 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         ImGui::Columns(2, "pattern_columns", true);
         
         ImGui::Text("Chord Progression");
-        if (g_toggle_chord_progression && g_chord_prog_enabled) {
-            const char* label = *g_chord_prog_enabled ? "Stop Progression" : "Start Progression";
+        if (g_toggle_chord_progression) {
+            const char* label = snap->seq_running ? "Stop Progression" : "Start Progression";
             if (ImGui::Button(label, ImVec2(160, 0))) {
-                g_toggle_chord_progression();
+                g_toggle_chord_progression(g_synth);
             }
         }
         
@@ -964,63 +1162,72 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         if (g_bpm) {
             ImGui::SliderFloat("BPM", g_bpm, 60.0f, 200.0f, "%.1f");
         }
+        int transport_beats = (int)snap->transport_beat;
+        ImGui::Text("Bar %d  Beat %d", transport_beats / TRANSPORT_BEATS_PER_BAR + 1,
+                    transport_beats % TRANSPORT_BEATS_PER_BAR + 1);
+        if (snap->clock_following) {
+            ImGui::SameLine();
+            ImGui::TextDisabled(snap->transport_running ? "(MIDI clock)" : "(MIDI clock, stopped)");
+        }
+        if (g_synth) {
+            ImGui::Checkbox("Sync to MIDI clock", (bool*)&g_synth->midi_clock.follow);
+            ImGui::Checkbox("Send MIDI clock", (bool*)&g_synth->midi_clock.send);
+        }
         
         ImGui::Text("Multi-Tap Delay");
         if (g_synth) {
             // Sync checkbox with actual state
             bool multitap_enabled = g_synth->fx.multitap_enabled;
             if (ImGui::Checkbox("Enable", &multitap_enabled)) {
-                fx_set_param(&g_synth->fx, "multitap.enabled", multitap_enabled ? 1.0f : 0.0f);
+                synth_set_param(g_synth, "fx.multitap.enabled", multitap_enabled ? 1.0f : 0.0f);
                 // When enabling multi-tap, also ensure delay mix is set
                 if (multitap_enabled && g_synth->fx.delay_mix <= 0.0f) {
-                    fx_set_param(&g_synth->fx, "delay.mix", 0.5f);
+                    synth_set_param(g_synth, "fx.delay.mix", 0.5f);
                 }
             }
             
-            // Use actual values from FX struct, not static variables
-            float tap0_beat = g_synth->fx.multitap_taps[0];
-            float tap0_level = g_synth->fx.multitap_levels[0];
-            float tap1_beat = g_synth->fx.multitap_taps[1];
-            float tap1_level = g_synth->fx.multitap_levels[1];
-            float tap2_beat = g_synth->fx.multitap_taps[2];
-            float tap2_level = g_synth->fx.multitap_levels[2];
-            float tap3_beat = g_synth->fx.multitap_taps[3];
-            float tap3_level = g_synth->fx.multitap_levels[3];
-            
-            ImGui::Text("Tap 1 (Quarter):");
-            if (ImGui::SliderFloat("##tap0_beat", &tap0_beat, 0.125f, 2.0f, "%.3f beats")) {
-                fx_set_param(&g_synth->fx, "multitap.tap0", tap0_beat);
+            int num_taps = g_synth->fx.num_taps;
+            if (ImGui::SliderInt("Taps", &num_taps, 1, MAX_DELAY_TAPS)) {
+                synth_set_param(g_synth, "fx.multitap.taps", (float)num_taps);
             }
-            ImGui::SameLine();
-            if (ImGui::SliderFloat("##tap0_level", &tap0_level, 0.0f, 1.0f, "%.2f")) {
-                fx_set_param(&g_synth->fx, "multitap.tap0_level", tap0_level);
-            }
-            
-            ImGui::Text("Tap 2 (Dotted 8th):");
-            if (ImGui::SliderFloat("##tap1_beat", &tap1_beat, 0.125f, 2.0f, "%.3f beats")) {
-                fx_set_param(&g_synth->fx, "multitap.tap1", tap1_beat);
-            }
-            ImGui::SameLine();
-            if (ImGui::SliderFloat("##tap1_level", &tap1_level, 0.0f, 1.0f, "%.2f")) {
-                fx_set_param(&g_synth->fx, "multitap.tap1_level", tap1_level);
-            }
-            
-            ImGui::Text("Tap 3 (Eighth):");
-            if (ImGui::SliderFloat("##tap2_beat", &tap2_beat, 0.125f, 2.0f, "%.3f beats")) {
-                fx_set_param(&g_synth->fx, "multitap.tap2", tap2_beat);
-            }
-            ImGui::SameLine();
-            if (ImGui::SliderFloat("##tap2_level", &tap2_level, 0.0f, 1.0f, "%.2f")) {
-                fx_set_param(&g_synth->fx, "multitap.tap2_level", tap2_level);
-            }
-            
-            ImGui::Text("Tap 4 (Triplet):");
-            if (ImGui::SliderFloat("##tap3_beat", &tap3_beat, 0.125f, 2.0f, "%.3f beats")) {
-                fx_set_param(&g_synth->fx, "multitap.tap3", tap3_beat);
-            }
-            ImGui::SameLine();
-            if (ImGui::SliderFloat("##tap3_level", &tap3_level, 0.0f, 1.0f, "%.2f")) {
-                fx_set_param(&g_synth->fx, "multitap.tap3_level", tap3_level);
+
+            // Use actual values from FX struct, not static variables
+            static const char *tap_names[4] = {"Quarter", "Dotted 8th", "Eighth", "Triplet"};
+            for (int tap = 0; tap < g_synth->fx.num_taps; ++tap) {
+                char label[32], param[32];
+                float beat = g_synth->fx.multitap_taps[tap];
+                float level = g_synth->fx.multitap_levels[tap];
+                float pan = g_synth->fx.multitap_pan[tap];
+                float feedback = g_synth->fx.multitap_feedback[tap];
+                if (tap < 4)
+                    ImGui::Text("Tap %d (%s):", tap + 1, tap_names[tap]);
+                else
+                    ImGui::Text("Tap %d:", tap + 1);
+
+                snprintf(label, sizeof(label), "##tap%d_beat", tap);
+                if (ImGui::SliderFloat(label, &beat, 0.125f, 2.0f, "%.3f beats")) {
+                    snprintf(param, sizeof(param), "fx.multitap.tap%d", tap);
+                    synth_set_param(g_synth, param, beat);
+                }
+                ImGui::SameLine();
+                snprintf(label, sizeof(label), "##tap%d_level", tap);
+                if (ImGui::SliderFloat(label, &level, 0.0f, 1.0f, "%.2f")) {
+                    snprintf(param, sizeof(param), "fx.multitap.tap%d_level", tap);
+                    synth_set_param(g_synth, param, level);
+                }
+
+                // Per-tap pan and feedback
+                snprintf(label, sizeof(label), "Pan %d##tap%d_pan", tap + 1, tap);
+                if (ImGui::SliderFloat(label, &pan, -1.0f, 1.0f, "%.2f")) {
+                    snprintf(param, sizeof(param), "fx.multitap.tap%d_pan", tap);
+                    synth_set_param(g_synth, param, pan);
+                }
+                ImGui::SameLine();
+                snprintf(label, sizeof(label), "Fb %d##tap%d_fb", tap + 1, tap);
+                if (ImGui::SliderFloat(label, &feedback, 0.0f, 0.95f, "%.2f")) {
+                    snprintf(param, sizeof(param), "fx.multitap.tap%d_feedback", tap);
+                    synth_set_param(g_synth, param, feedback);
+                }
             }
         }
         
@@ -1033,10 +1240,10 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         ImGui::NextColumn();
         
         ImGui::Text("Status");
-        if (chord_prog_enabled) {
+        if (snap->seq_running) {
             ImGui::Text("Playing: Yes");
-            ImGui::Text("Chord: %d/%d", current_chord_idx + 1, chord_prog_len);
-            ImGui::Text("Step: %d/%d", current_rhythm_step + 1, rhythm_len);
+            ImGui::Text("Chord: %d/%d", snap->seq_chord_index + 1, snap->seq_chord_count);
+            ImGui::Text("Step: %d/%d", snap->seq_rhythm_step + 1, snap->seq_step_count);
         } else {
             ImGui::Text("Playing: No");
             ImGui::Text("Press F1 to start");
@@ -1045,6 +1252,35 @@ void gui_draw(Synth *synth, SDL_Window *window, SDL_GLContext gl_context,
         ImGui::Columns(1, "", false);
     }
 
+    // MIDI file player
+    if (ImGui::CollapsingHeader("MIDI File", ImGuiTreeNodeFlags_DefaultOpen)) {
+        static char song_path[SMF_PATH_SIZE] = "";
+        ImGui::InputText("File##song", song_path, sizeof(song_path));
+        ImGui::SameLine();
+        if (ImGui::Button("Load##song") && song_path[0]) {
+            // Parses here; the audio thread only swaps a pointer
+            smf_player_load(&synth->song, song_path, synth->sample_rate);
+        }
+        if (snap->song_beats > 0.0) {
+            ImGui::Text("Loaded: %s", synth->song.path);
+            if (ImGui::Button(snap->song_playing ? "Stop##song" : "Play##song", ImVec2(80, 0))) {
+                smf_player_play(&synth->song, !snap->song_playing);
+            }
+            ImGui::SameLine();
+            // Bars count from 1, as in the transport display
+            float bars = (float)(snap->song_beats / TRANSPORT_BEATS_PER_BAR);
+            float bar = (float)(snap->song_beat / TRANSPORT_BEATS_PER_BAR) + 1.0f;
+            if (ImGui::SliderFloat("Position##song", &bar, 1.0f, bars + 1.0f, "Bar %.1f")) {
+                smf_player_seek(&synth->song, (bar - 1.0f) * TRANSPORT_BEATS_PER_BAR);
+            }
+            ImGui::Checkbox("Loop##song", (bool*)&synth->song.loop);
+            int last_bar = (int)ceilf(bars);
+            ImGui::SliderInt("Loop start##song", &synth->song.loop_start, 1, last_bar, "Bar %d");
+            ImGui::SliderInt("Loop end##song", &synth->song.loop_end, 0, last_bar,
+                             synth->song.loop_end > 0 ? "Bar %d" : "Song end");
+        }
+    }
+
     ImGui::End();
 
     // Rendering
@@ -16,25 +16,7 @@ void lfo_init(LFO *lfo, float samplerate) {
   lfo->sync = LFO_SYNC_FREE;
   lfo->enabled = 0;
   lfo->notes_pressed = 0;
-}
-
-void lfo_set_param(LFO *lfo, const char *param, float value) {
-  if (strcmp(param, "waveform") == 0)
-    lfo->waveform = (LfoWaveform)((int)value);
-  else if (strcmp(param, "frequency") == 0)
-    lfo->frequency = value;
-  else if (strcmp(param, "depth") == 0)
-    lfo->depth = value;
-  else if (strcmp(param, "phase") == 0)
-    lfo->phase = value;
-  else if (strcmp(param, "gain") == 0)
-    lfo->gain = value;
-  else if (strcmp(param, "target") == 0)
-    lfo->target = (LfoTarget)((int)value);
-  else if (strcmp(param, "sync") == 0)
-    lfo->sync = (LfoSyncMode)((int)value);
-  else if (strcmp(param, "enabled") == 0)
-    lfo->enabled = (int)(value + 0.5f);
+  lfo->rng = rng_seed(0);
 }
 
 float lfo_process(LFO *lfo) {
@@ -66,7 +48,7 @@ float lfo_process(LFO *lfo) {
     output = 2.0f * p - 1.0f;
     break;
   case LFO_RANDOM:
-    output = (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+    output = rng_float(&lfo->rng) * 2.0f - 1.0f;
     break;
   default:
     output = 0.0f;
@@ -20,10 +20,10 @@ typedef struct LFO {
   LfoSyncMode sync;   // Sync mode (free, retrigger, keyfollow)
   int enabled;        // LFO on/off
   int notes_pressed;  // For keyfollow sync - number of notes currently pressed
+  unsigned int rng;   // Random waveform state
 } LFO;
 
 void lfo_init(LFO *lfo, float samplerate);
-void lfo_set_param(LFO *lfo, const char *param, float value);
 float lfo_process(LFO *lfo);
 float lfo_get_modulation_value(LFO *lfo);
 void lfo_note_on(LFO *lfo);
@@ -0,0 +1,86 @@
+#include "limiter.h"
+#include <math.h>
+#include <string.h>
+
+void limiter_init(Limiter *l, int sample_rate) {
+  memset(l, 0, sizeof(*l));
+  l->sample_rate = sample_rate;
+  l->lookahead = (int)(LIMITER_LOOKAHEAD_MS * 0.001f * sample_rate);
+  if (l->lookahead < 1)
+    l->lookahead = 1;
+  if (l->lookahead > LIMITER_MAX_LOOKAHEAD)
+    l->lookahead = LIMITER_MAX_LOOKAHEAD;
+  l->latency = TRUE_PEAK_DELAY + l->lookahead - 1;
+
+  true_peak_init(&l->detector);
+  for (int i = 0; i < l->lookahead; ++i)
+    l->box[i] = 1.0f;
+  l->box_sum = l->lookahead;
+  l->release_gain = 1.0f;
+  limiter_set_params(l, -1.0f, 50.0f);
+}
+
+void limiter_set_params(Limiter *l, float ceiling_db, float release_ms) {
+  l->ceiling = powf(10.0f, ceiling_db / 20.0f);
+  if (release_ms < 1.0f)
+    release_ms = 1.0f;
+  l->release_coeff = expf(-1.0f / (release_ms * 0.001f * l->sample_rate));
+}
+
+void limiter_process(Limiter *l, float *stereo, int frames) {
+  const int window = l->lookahead;
+  const unsigned int dq_mask = LIMITER_MAX_LOOKAHEAD - 1;
+  float min_gain = 1.0f;
+
+  for (int n = 0; n < frames; ++n) {
+    float in_l = stereo[n * 2 + 0];
+    float in_r = stereo[n * 2 + 1];
+
+    // Linked detection: one peak for both channels, covering both intervals
+    // next to sample n - TRUE_PEAK_DELAY
+    float cur = true_peak_push(&l->detector, in_l, in_r, l->ceiling);
+    float peak = fmaxf(cur, l->prev_interval_peak);
+    l->prev_interval_peak = cur;
+    float required = peak > l->ceiling ? l->ceiling / peak : 1.0f;
+
+    // Sliding minimum over the look-ahead window
+    while (l->deque_count > 0 &&
+           l->deque_gain[(l->deque_head + l->deque_count - 1) & dq_mask] >= required)
+      l->deque_count--;
+    int back = (l->deque_head + l->deque_count) & dq_mask;
+    l->deque_gain[back] = required;
+    l->deque_time[back] = l->time;
+    l->deque_count++;
+    if (l->time - l->deque_time[l->deque_head] >= (unsigned int)window) {
+      l->deque_head = (l->deque_head + 1) & dq_mask;
+      l->deque_count--;
+    }
+    l->time++;
+    float held = l->deque_gain[l->deque_head];
+
+    // Instant attack into the hold, smooth recovery after it
+    if (held < l->release_gain)
+      l->release_gain = held;
+    else
+      l->release_gain = held + (l->release_gain - held) * l->release_coeff;
+
+    // Moving average over the same window ramps down before the peak arrives
+    l->box_sum += l->release_gain - l->box[l->box_pos];
+    l->box[l->box_pos] = l->release_gain;
+    if (++l->box_pos >= window)
+      l->box_pos = 0;
+    float gain = (float)(l->box_sum / window);
+    if (gain < min_gain)
+      min_gain = gain;
+
+    int d = l->delay_pos;
+    int r = (d - l->latency) & (LIMITER_DELAY_SIZE - 1);
+    l->delay[0][d] = in_l;
+    l->delay[1][d] = in_r;
+    l->delay_pos = (d + 1) & (LIMITER_DELAY_SIZE - 1);
+    stereo[n * 2 + 0] = l->delay[0][r] * gain;
+    stereo[n * 2 + 1] = l->delay[1][r] * gain;
+  }
+
+  l->gain_reduction = 20.0f * log10f(min_gain);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "true_peak.h"
+
+// Stereo-linked look-ahead brickwall limiter with true-peak detection.
+// Peaks are measured on 4x oversampled data, the required gain is held over
+// the look-ahead window with a monotonic deque (O(1) per sample) and then
+// smoothed by a moving average of the same length, so the gain is already
+// down when the delayed peak reaches the output.
+#define LIMITER_MAX_LOOKAHEAD 1024    // Frames; covers 5 ms at 192 kHz
+#define LIMITER_DELAY_SIZE 2048       // Signal delay (power of two)
+#define LIMITER_LOOKAHEAD_MS 1.5f
+
+typedef struct {
+  int sample_rate;
+  int lookahead;                // Window length in samples
+  float ceiling;                // Linear true-peak ceiling
+  float release_coeff;          // One-pole recovery per sample
+
+  TruePeak detector;
+  float prev_interval_peak;
+
+  // Sliding minimum of the required gain (monotonic deque)
+  float deque_gain[LIMITER_MAX_LOOKAHEAD];
+  unsigned int deque_time[LIMITER_MAX_LOOKAHEAD];
+  int deque_head, deque_count;
+  unsigned int time;
+
+  // Release smoothing and moving average
+  float release_gain;
+  float box[LIMITER_MAX_LOOKAHEAD];
+  int box_pos;
+  double box_sum;
+
+  float delay[2][LIMITER_DELAY_SIZE];
+  int delay_pos;
+  int latency;                  // Total delay in samples
+
+  float gain_reduction;         // Deepest reduction in the last block (dB)
+} Limiter;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void limiter_init(Limiter *l, int sample_rate);
+void limiter_set_params(Limiter *l, float ceiling_db, float release_ms);
+void limiter_process(Limiter *l, float *stereo, int frames);
+
+#ifdef __cplusplus
+}
+#endif
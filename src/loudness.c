@@ -0,0 +1,168 @@
+#include "loudness.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Mean square (sum over channels) to LUFS
+static float energy_to_lufs(double energy) {
+  if (energy <= 0.0)
+    return LOUDNESS_SILENCE;
+  return (float)(-0.691 + 10.0 * log10(energy));
+}
+
+// BS.1770 K-weighting, designed for any sample rate from the analog
+// prototypes (matches the published 48 kHz coefficients)
+static void design_k_weighting(LoudnessMeter *m) {
+  double fs = (double)m->sample_rate;
+
+  double f0 = 1681.974450955533;
+  double gain_db = 3.999843853973347;
+  double q = 0.7071752369554196;
+  double k = tan(M_PI * f0 / fs);
+  double vh = pow(10.0, gain_db / 20.0);
+  double vb = pow(vh, 0.4996667741545416);
+  double a0 = 1.0 + k / q + k * k;
+  m->shelf.b0 = (vh + vb * k / q + k * k) / a0;
+  m->shelf.b1 = 2.0 * (k * k - vh) / a0;
+  m->shelf.b2 = (vh - vb * k / q + k * k) / a0;
+  m->shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+  m->shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+  f0 = 38.13547087602444;
+  q = 0.5003270373238773;
+  k = tan(M_PI * f0 / fs);
+  a0 = 1.0 + k / q + k * k;
+  m->highpass.b0 = 1.0;
+  m->highpass.b1 = -2.0;
+  m->highpass.b2 = 1.0;
+  m->highpass.a1 = 2.0 * (k * k - 1.0) / a0;
+  m->highpass.a2 = (1.0 - k / q + k * k) / a0;
+}
+
+static inline double biquad_tick(LoudnessBiquad *f, int ch, double x) {
+  double y = f->b0 * x + f->z1[ch];
+  f->z1[ch] = f->b1 * x - f->a1 * y + f->z2[ch];
+  f->z2[ch] = f->b2 * x - f->a2 * y;
+  return y;
+}
+
+void loudness_init(LoudnessMeter *m, int sample_rate) {
+  memset(m, 0, sizeof(*m));
+  m->sample_rate = sample_rate;
+  m->sub_length = sample_rate * LOUDNESS_SUBBLOCK_MS / 1000;
+  design_k_weighting(m);
+  true_peak_init(&m->detector);
+  loudness_reset(m);
+}
+
+void loudness_reset(LoudnessMeter *m) {
+  memset(m->shelf.z1, 0, sizeof(m->shelf.z1));
+  memset(m->shelf.z2, 0, sizeof(m->shelf.z2));
+  memset(m->highpass.z1, 0, sizeof(m->highpass.z1));
+  memset(m->highpass.z2, 0, sizeof(m->highpass.z2));
+  m->sub_sum = 0.0;
+  m->sub_count = 0;
+  memset(m->blocks, 0, sizeof(m->blocks));
+  m->block_pos = 0;
+  m->blocks_filled = 0;
+  memset(m->hist_count, 0, sizeof(m->hist_count));
+  memset(m->hist_energy, 0, sizeof(m->hist_energy));
+  m->true_peak_linear = 0.0f;
+  m->momentary = LOUDNESS_SILENCE;
+  m->short_term = LOUDNESS_SILENCE;
+  m->integrated = LOUDNESS_SILENCE;
+  m->true_peak = LOUDNESS_SILENCE;
+}
+
+// Mean energy of the newest 'count' sub-blocks
+static double recent_energy(const LoudnessMeter *m, int count) {
+  double sum = 0.0;
+  for (int i = 1; i <= count; ++i)
+    sum += m->blocks[(m->block_pos - i + LOUDNESS_SHORT_TERM_BLOCKS) % LOUDNESS_SHORT_TERM_BLOCKS];
+  return sum / count;
+}
+
+// Two-stage gating over the histogram: absolute gate at -70 LUFS (blocks
+// below it never enter), then a relative gate 10 LU under the mean
+static void update_integrated(LoudnessMeter *m) {
+  double energy = 0.0;
+  unsigned int count = 0;
+  for (int i = 0; i < LOUDNESS_HIST_BINS; ++i) {
+    energy += m->hist_energy[i];
+    count += m->hist_count[i];
+  }
+  if (count == 0)
+    return;
+
+  float relative_gate = energy_to_lufs(energy / count) - 10.0f;
+  int first = (int)ceilf((relative_gate - LOUDNESS_HIST_MIN) / LOUDNESS_HIST_STEP);
+  if (first < 0)
+    first = 0;
+
+  energy = 0.0;
+  count = 0;
+  for (int i = first; i < LOUDNESS_HIST_BINS; ++i) {
+    energy += m->hist_energy[i];
+    count += m->hist_count[i];
+  }
+  if (count > 0)
+    m->integrated = energy_to_lufs(energy / count);
+}
+
+static void finish_sub_block(LoudnessMeter *m) {
+  m->blocks[m->block_pos] = m->sub_sum / m->sub_length;
+  m->block_pos = (m->block_pos + 1) % LOUDNESS_SHORT_TERM_BLOCKS;
+  if (m->blocks_filled < LOUDNESS_SHORT_TERM_BLOCKS)
+    m->blocks_filled++;
+  m->sub_sum = 0.0;
+  m->sub_count = 0;
+
+  if (m->blocks_filled >= LOUDNESS_MOMENTARY_BLOCKS) {
+    // Gating blocks are 400 ms with 75% overlap, so one per sub-block
+    double energy = recent_energy(m, LOUDNESS_MOMENTARY_BLOCKS);
+    m->momentary = energy_to_lufs(energy);
+    if (m->momentary >= LOUDNESS_HIST_MIN) {
+      int bin = (int)((m->momentary - LOUDNESS_HIST_MIN) / LOUDNESS_HIST_STEP);
+      if (bin >= LOUDNESS_HIST_BINS)
+        bin = LOUDNESS_HIST_BINS - 1;
+      m->hist_count[bin]++;
+      m->hist_energy[bin] += energy;
+      update_integrated(m);
+    }
+  }
+  if (m->blocks_filled >= LOUDNESS_SHORT_TERM_BLOCKS)
+    m->short_term = energy_to_lufs(recent_energy(m, LOUDNESS_SHORT_TERM_BLOCKS));
+}
+
+void loudness_process(LoudnessMeter *m, const float *stereo, int frames) {
+  int n = 0;
+  while (n < frames) {
+    int chunk = m->sub_length - m->sub_count;
+    if (chunk > frames - n)
+      chunk = frames - n;
+
+    double sum = 0.0;
+    float peak = m->true_peak_linear;
+    for (int i = n; i < n + chunk; ++i) {
+      float l = stereo[i * 2 + 0], r = stereo[i * 2 + 1];
+      double wl = biquad_tick(&m->highpass, 0, biquad_tick(&m->shelf, 0, l));
+      double wr = biquad_tick(&m->highpass, 1, biquad_tick(&m->shelf, 1, r));
+      sum += wl * wl + wr * wr;
+      // Only a new maximum matters, so quiet history skips the filters
+      peak = fmaxf(peak, true_peak_push(&m->detector, l, r, peak));
+    }
+    m->sub_sum += sum;
+    m->sub_count += chunk;
+    n += chunk;
+
+    if (peak > m->true_peak_linear) {
+      m->true_peak_linear = peak;
+      m->true_peak = 20.0f * log10f(peak);
+    }
+    if (m->sub_count >= m->sub_length)
+      finish_sub_block(m);
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "true_peak.h"
+
+// EBU R128 / ITU-R BS.1770 loudness meter for a stereo stream. Audio is
+// K-weighted and summed into 100 ms sub-blocks; momentary (400 ms) and
+// short-term (3 s) loudness are sliding sums over a ring of sub-blocks.
+// Every 100 ms the newest 400 ms gating block goes into a histogram, so the
+// gated integrated loudness is updated without keeping the whole history.
+#define LOUDNESS_SUBBLOCK_MS 100
+#define LOUDNESS_MOMENTARY_BLOCKS 4
+#define LOUDNESS_SHORT_TERM_BLOCKS 30
+#define LOUDNESS_HIST_MIN -70.0f      // Absolute gate (LUFS)
+#define LOUDNESS_HIST_MAX 10.0f
+#define LOUDNESS_HIST_STEP 0.1f       // Histogram resolution (LU)
+#define LOUDNESS_HIST_BINS 800
+#define LOUDNESS_SILENCE -144.0f      // Reported when nothing was measured yet
+
+typedef struct {
+  double b0, b1, b2, a1, a2;
+  double z1[2], z2[2];          // Transposed direct form II state per channel
+} LoudnessBiquad;
+
+typedef struct {
+  int sample_rate;
+  LoudnessBiquad shelf;         // Stage 1: head-related high shelf
+  LoudnessBiquad highpass;      // Stage 2: RLB high-pass
+
+  // Sub-block accumulation
+  double sub_sum;
+  int sub_count;
+  int sub_length;               // Samples per sub-block
+
+  double blocks[LOUDNESS_SHORT_TERM_BLOCKS]; // Energy per finished sub-block
+  int block_pos;
+  int blocks_filled;
+
+  // Gating histogram of 400 ms blocks above the absolute gate
+  unsigned int hist_count[LOUDNESS_HIST_BINS];
+  double hist_energy[LOUDNESS_HIST_BINS];
+
+  TruePeak detector;
+  float true_peak_linear;
+
+  // Readouts, updated every sub-block
+  float momentary;              // LUFS
+  float short_term;             // LUFS
+  float integrated;             // LUFS
+  float true_peak;              // dBTP, maximum since reset
+} LoudnessMeter;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void loudness_init(LoudnessMeter *m, int sample_rate);
+void loudness_reset(LoudnessMeter *m);
+void loudness_process(LoudnessMeter *m, const float *stereo, int frames);
+
+#ifdef __cplusplus
+}
+#endif
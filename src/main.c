@@ -1,14 +1,19 @@
 #include "app.h"
+#include "wav.h"
 #include <SDL2/SDL.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #if __EMSCRIPTEN__
 	#include <emscripten.h>
 #endif
 
-App app;
-
-void main_loop() {
+// The App is too big for the stack; main() allocates it and hands it to
+// the loop
+static void main_loop(void *arg) {
+    App *app = (App *)arg;
 #ifdef __EMSCRIPTEN__
     // Set timing on first iteration to avoid warnings
     static bool timing_set = false;
@@ -17,42 +22,203 @@ void main_loop() {
         timing_set = true;
     }
     
-    app_poll_events(&app);
-    app_update(&app);
-    app_render(&app);
+    app_poll_events(app);
+    app_update(app);
+    app_render(app);
 #else
-    // For native builds, use manual frame rate limiting
+    if (app->idle_mode) {
+      // Sleep until input, moving audio or the refresh timer asks for a frame
+      app_wait_events(app);
+      app_poll_events(app);
+      app_update(app);
+      app_render(app);
+      app->last_frame_time = SDL_GetTicks();
+      return;
+    }
+
+    // Fixed-rate mode, use manual frame rate limiting
     Uint32 frame_start = SDL_GetTicks();
     
-    app_poll_events(&app);
-    app_update(&app);
-    app_render(&app);
+    app_poll_events(app);
+    app_update(app);
+    app_render(app);
     
     // Frame rate limiting for 60 FPS
     Uint32 frame_time = SDL_GetTicks() - frame_start;
-    if (frame_time < app.target_frame_time) {
-      SDL_Delay(app.target_frame_time - frame_time);
+    if (frame_time < app->target_frame_time) {
+      SDL_Delay(app->target_frame_time - frame_time);
     }
     
-    app.last_frame_time = SDL_GetTicks();
+    app->last_frame_time = SDL_GetTicks();
 #endif
 }
 
+#ifndef __EMSCRIPTEN__
+#define RENDER_BLOCK 1024
+
+static void render_usage(void) {
+  fprintf(stderr,
+          "usage: synth --render song.mid out.wav [--preset file.json] [--rate hz]\n"
+          "             [--bits 16|24|32] [--seconds max] [--tail seconds] [--seed n] [--arp]\n");
+}
+
+static char *read_text_file(const char *path) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp)
+    return NULL;
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  char *text = size >= 0 ? (char *)malloc((size_t)size + 1) : NULL;
+  if (text && fread(text, 1, (size_t)size, fp) != (size_t)size) {
+    free(text);
+    text = NULL;
+  }
+  fclose(fp);
+  if (text)
+    text[size] = '\0';
+  return text;
+}
+
+// Offline render of a MIDI file to WAV, with no window or audio device and
+// as fast as the engine runs. Patches come from the same files the app
+// loads, or a preset given on the command line.
+static int render_song(int argc, char *argv[]) {
+  if (argc < 4) {
+    render_usage();
+    return 1;
+  }
+  const char *song_path = argv[2];
+  const char *wav_path = argv[3];
+  const char *preset = NULL;
+  int rate = 48000, bits = 24, arp = 0;
+  double max_seconds = 0.0, tail = 2.0;
+  unsigned int seed = 1;
+  for (int i = 4; i < argc; ++i) {
+    if (!strcmp(argv[i], "--arp"))
+      arp = 1;
+    else if (i + 1 < argc && !strcmp(argv[i], "--preset"))
+      preset = argv[++i];
+    else if (i + 1 < argc && !strcmp(argv[i], "--rate"))
+      rate = atoi(argv[++i]);
+    else if (i + 1 < argc && !strcmp(argv[i], "--bits"))
+      bits = atoi(argv[++i]);
+    else if (i + 1 < argc && !strcmp(argv[i], "--seconds"))
+      max_seconds = atof(argv[++i]);
+    else if (i + 1 < argc && !strcmp(argv[i], "--tail"))
+      tail = atof(argv[++i]);
+    else if (i + 1 < argc && !strcmp(argv[i], "--seed"))
+      seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+    else {
+      render_usage();
+      return 1;
+    }
+  }
+  if (rate < 8000 || rate > 192000 || (bits != 16 && bits != 24 && bits != 32)) {
+    render_usage();
+    return 1;
+  }
+
+  Synth *synth = (Synth *)calloc(1, sizeof(Synth));
+  if (!synth || !synth_init(synth, rate, RENDER_BLOCK, 16)) {
+    free(synth);
+    return 1;
+  }
+  // With a preset, the same seed renders the same file every time; the
+  // default patch is detuned at random on every start, as in the app
+  synth_seed(synth, seed);
+  if (preset) {
+    char *json = read_text_file(preset);
+    if (!json) {
+      fprintf(stderr, "Failed to read preset '%s'.\n", preset);
+      synth_shutdown(synth);
+      free(synth);
+      return 1;
+    }
+    synth_load_preset_json(synth, json);
+    free(json);
+  } else {
+    synth_load_default_config(synth);
+  }
+  synth_load_programs(synth, SYNTH_PROGRAMS_FILE);
+  // A song brings its own notes, so the arpeggiators stay off unless asked for
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+    synth_set_part_param(synth, p, "arp.enabled", arp ? 1.0f : 0.0f);
+  // A looping song never ends; only a length limit can stop it
+  if (max_seconds <= 0.0)
+    synth_set_param(synth, "song.loop", 0.0f);
+
+  WavWriter wav;
+  int ok = smf_player_load(&synth->song, song_path, (float)rate);
+  if (ok && !wav_write_open(&wav, wav_path, 2, rate, bits)) {
+    fprintf(stderr, "Failed to create '%s'.\n", wav_path);
+    ok = 0;
+  }
+  if (ok) {
+    // The first block takes the song and starts it; after its end the
+    // tail lets releases, reverb and delays ring out
+    smf_player_play(&synth->song, 1);
+    float buf[RENDER_BLOCK * 2];
+    long long limit = max_seconds > 0.0 ? (long long)(max_seconds * rate) : -1;
+    long long frames = 0, tail_left = (long long)(tail * rate);
+    while (limit < 0 || frames < limit) {
+      int n = RENDER_BLOCK;
+      if (limit >= 0 && limit - frames < n)
+        n = (int)(limit - frames);
+      synth_render(synth, buf, n);
+      if (!wav_write(&wav, buf, n)) {
+        ok = 0;
+        break;
+      }
+      frames += n;
+      if (!synth->song.playing && (tail_left -= n) <= 0)
+        break;
+    }
+    if (!wav_write_close(&wav))
+      ok = 0;
+    if (ok)
+      printf("Rendered %.1f s of '%s' to '%s'.\n", frames / (double)rate, song_path, wav_path);
+    else
+      fprintf(stderr, "Failed to write '%s'.\n", wav_path);
+  }
+
+  synth_shutdown(synth);
+  free(synth);
+  return ok ? 0 : 1;
+}
+#endif
+
 int main(int argc, char *argv[]) {
-  if (!app_init(&app)) {
+#ifndef __EMSCRIPTEN__
+  if (argc > 1 && !strcmp(argv[1], "--render"))
+    return render_song(argc, argv);
+#endif
+
+  App *app = (App *)calloc(1, sizeof(App));
+  if (!app || !app_init(app)) {
     return 1;
   }
 
+#ifndef __EMSCRIPTEN__
+  // A MIDI file named on the command line starts playing right away
+  if (argc > 1 && smf_player_load(&app->synth.song, argv[1], app->synth.sample_rate))
+    smf_player_play(&app->synth.song, 1);
+#else
+  (void)argc;
+  (void)argv;
+#endif
+
 #if __EMSCRIPTEN__
   // Set up main loop after all initialization is complete  
-  emscripten_set_main_loop(main_loop, 0, 1);
+  emscripten_set_main_loop_arg(main_loop, app, 0, 1);
   // Note: emscripten_set_main_loop_timing called from main_loop to avoid timing warnings
 #else
-  while (!app.quit) {
-	  main_loop();
+  while (!app->quit) {
+	  main_loop(app);
   }
 #endif
 
-  app_shutdown(&app);
+  app_shutdown(app);
+  free(app);
   return 0;
 }
@@ -11,159 +11,20 @@
 #include <emscripten.h>
 #endif
 
+#include <SDL2/SDL.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Standard MIDI CC mapping following MIDI specification
-// Uses commonly assigned CC numbers for universal compatibility
-const CCMapping cc_map[] = {
-    // BANK SELECT & MODULATION (CC 0-31)
-    {1, "osc1.pitch", -24.0f, 24.0f},        // CC 1: Modulation Wheel → OSC 1 Pitch Bend
-    {2, "osc1.detune", -1.0f, 1.0f},        // CC 2: Breath Controller → OSC 1 Detune
-    {7, "osc1.gain", 0.0f, 1.0f},           // CC 7: Volume (Channel Volume) → OSC 1 Gain
-    {10, "osc1.waveform", 0.0f, 4.0f},      // CC 10: Pan → OSC 1 Waveform Select
-    {11, "osc1.pulse_width", 0.0f, 1.0f},    // CC 11: Expression → OSC 1 Pulse Width
-    {12, "osc2.pitch", -24.0f, 24.0f},       // CC 12: Effect Control 1 → OSC 2 Pitch Bend
-    {13, "osc2.detune", -1.0f, 1.0f},        // CC 13: Effect Control 2 → OSC 2 Detune
-    {14, "osc2.gain", 0.0f, 1.0f},           // CC 14: (Undefined/Unused) → OSC 2 Gain
-    {15, "osc3.gain", 0.0f, 1.0f},           // CC 15: (Undefined/Unused) → OSC 3 Gain
-    {15, "osc3.waveform", 0.0f, 4.0f},      // CC 15: (Undefined/Unused) → OSC 3 Waveform Select
-    {16, "osc4.pitch", -24.0f, 24.0f},       // CC 16: General Purpose Controller 1 → OSC 4 Pitch Bend
-    {17, "osc4.detune", -1.0f, 1.0f},        // CC 17: General Purpose Controller 2 → OSC 4 Detune
-    
-    
-    // OSCILLATOR PARAMETER BLOCK (CC 20-31)
-    {20, "mixer.master", 0.0f, 2.0f},           // CC 20: (Undefined) → Master Volume
-    {21, "fx.filter_cutoff", 20.0f, 20000.0f},   // CC 21: (Undefined) → Filter Cutoff
-    {22, "fx.filter_resonance", 0.1f, 10.0f},    // CC 22: (Undefined) → Filter Resonance
-    {23, "fx.flanger.rate", 0.1f, 20.0f},       // CC 23: (Undefined) → Flanger Rate
-    {24, "fx.delay.time", 0.0f, 1.0f},          // CC 24: (Undefined) → Delay Time
-    {25, "fx.reverb.size", 0.0f, 1.0f},          // CC 25: (Undefined) → Reverb Size
-    {26, "fx.reverb.mix", 0.0f, 1.0f},            // CC 26: (Undefined) → Reverb Mix
-    {27, "fx.flanger.depth", 0.0f, 1.0f},         // CC 27: (Undefined) → Flanger Depth
-    {28, "fx.delay.feedback", 0.0f, 1.0f},        // CC 28: (Undefined) → Delay Feedback
-    {29, "fx.flanger.feedback", 0.0f, 1.0f},       // CC 29: (Undefined) → Flanger Feedback
-    {30, "fx.delay.mix", 0.0f, 1.0f},            // CC 30: (Undefined) → Delay Mix
-    
-    // STANDARD MIDI CONTROLLERS (CC 32-63)
-    {33, "osc4.gain", 0.0f, 1.0f},            // CC 33: (Undefined) → OSC 4 Gain
-    {34, "osc4.waveform", 0.0f, 4.0f},        // CC 34: LSB of Bank Select → OSC 4 Waveform
-    {35, "osc3.waveform", 0.0f, 4.0f},        // CC 35: LSB of Bank Select → OSC 3 Waveform
-    {36, "osc2.waveform", 0.0f, 4.0f},        // CC 36: LSB of Bank Select → OSC 2 Waveform
-    {37, "osc2.waveform", 0.0f, 4.0f},        // CC 37: LSB of Bank Select → OSC 2 Waveform
-    {38, "osc1.waveform", 0.0f, 4.0f},        // CC 38: LSB of Bank Select → OSC 1 Waveform
-    {39, "mixer.comp.threshold", -24.0f, 0.0f},    // CC 39: LSB of Bank Select → Compressor Threshold
-    {40, "mixer.comp.ratio", 1.0f, 10.0f},        // CC 40: LSB of Bank Select → Compressor Ratio
-    {41, "mixer.comp.attack", 1.0f, 100.0f},        // CC 41: LSB of Bank Select → Compressor Attack
-    {42, "mixer.comp.release", 10.0f, 1000.0f},     // CC 42: LSB of Bank Select → Compressor Release
-    {43, "mixer.comp.makeup", 0.0f, 12.0f},         // CC 43: LSB of Bank Select → Compressor Makeup
-    {44, "fx.filter_drive", 1.0f, 10.0f},          // CC 44: LSB of Bank Select → Filter Drive
-    {45, "fx.filter_resonance", 0.1f, 10.0f},        // CC 45: LSB of Bank Select → Filter Resonance
-    {46, "fx.filter_mix", 0.0f, 1.0f},             // CC 46: LSB of Bank Select → Filter Mix
-    {48, "osc4.unison_voices", 1.0f, 8.0f},        // CC 48: LSB of Bank Select → OSC 4 Unison Voices
-    {49, "osc4.unison_voices", 1.0f, 8.0f},        // CC 49: LSB of Bank Select → OSC 4 Unison Voices
-    {50, "osc3.unison_voices", 1.0f, 8.0f},        // CC 50: LSB of Bank Select → OSC 3 Unison Voices
-    {51, "osc2.unison_voices", 1.0f, 8.0f},        // CC 51: LSB of Bank Select → OSC 2 Unison Voices
-    {52, "osc1.unison_voices", 1.0f, 8.0f},        // CC 52: LSB of Bank Select → OSC 1 Unison Voices
-    
-    // FOOTSWITCH & PEDALS (CC 64-95)
-    {64, "sustain_pedal", 0.0f, 1.0f},         // CC 64: Damper Pedal (Sustain) → Sustain On/Off
-    {65, "portamento", 0.0f, 1.0f},              // CC 65: Portamento → Portamento On/Off
-    {66, "sostenuto", 0.0f, 1.0f},               // CC 66: Sostenuto → Sostenuto On/Off
-    {67, "soft_pedal", 0.0f, 1.0f},               // CC 67: Soft Pedal → Soft Pedal On/Off
-    {68, "legato_pedal", 0.0f, 1.0f},             // CC 68: Legato Pedal → Legato On/Off
-    {69, "hold_pedal", 0.0f, 1.0f},               // CC 69: Hold Pedal → Hold On/Off
-    
-    // ADDITIONAL EFFECTS & PERFORMANCE CONTROLS (CC 70-95)
-    {70, "arp.tempo", 60.0f, 240.0f},             // CC 70: Sound Controller 1 → Arpeggiator Tempo
-    {71, "arp.enabled", 0.0f, 1.0f},               // CC 71: Sound Controller 2 → Arpeggiator Enable
-    {72, "arp.mode", 0.0f, 17.0f},                 // CC 72: Sound Controller 3 → Arpeggiator Mode (0-17)
-    {73, "arp.hold", 0.0f, 1.0f},                  // CC 73: Sound Controller 4 → Arpeggiator Hold
-    {74, "arp.octave", 0.0f, 4.0f},                // CC 74: Sound Controller 5 → Arpeggiator Base Octave
-    {75, "arp.octaves", 1.0f, 6.0f},                // CC 75: Sound Controller 6 → Arpeggiator Octave Spread
-    {76, "fx.delay_feedback", 0.0f, 1.0f},           // CC 76: Sound Controller 7 → Delay Feedback
-    {77, "fx.delay.time", 0.0f, 1.0f},              // CC 77: Sound Controller 8 → Delay Time
-    {78, "fx.delay.mix", 0.0f, 1.0f},               // CC 78: Sound Controller 9 → Delay Mix
-    {79, "fx.flanger.rate", 0.1f, 20.0f},           // CC 79: Sound Controller 10 → Flanger Rate
-    {80, "fx.flanger.depth", 0.0f, 1.0f},          // CC 80: Sound Controller 11 → Flanger Depth
-    {81, "fx.flanger.feedback", 0.0f, 1.0f},        // CC 81: Sound Controller 12 → Flanger Feedback
-    {82, "fx.reverb.size", 0.0f, 1.0f},             // CC 82: Sound Controller 13 → Reverb Size
-    {83, "fx.reverb.mix", 0.0f, 1.0f},               // CC 83: Sound Controller 14 → Reverb Mix
-    {84, "all_notes_off", 0.0f, 1.0f},              // CC 84: Sound Controller 15 → All Notes Off
-    {85, "reset_controllers", 0.0f, 1.0f},           // CC 85: Sound Controller 16 → Reset All Controllers
-    
-    // CHANNEL MODE & PARAMETER CONTROLS (CC 102-119)
-    {102, "arp.polyphonic", 0.0f, 1.0f},           // CC 102: (Undefined) → Arpeggiator Polyphonic Mode
-    {103, "arp.tempo", 60.0f, 240.0f},             // CC 103: (Undefined) → Arpeggiator Tempo (Secondary)
-    {104, "fx.filter_cutoff", 20.0f, 20000.0f},       // CC 104: (Undefined) → Filter Cutoff (Secondary)
-    {105, "fx.filter_resonance", 0.1f, 10.0f},        // CC 105: (Undefined) → Filter Resonance (Secondary)
-    {106, "fx.filter_drive", 1.0f, 10.0f},          // CC 106: (Undefined) → Filter Drive (Secondary)
-    {107, "fx.filter_mix", 0.0f, 1.0f},               // CC 107: (Undefined) → Filter Mix (Secondary)
-    {108, "fx.reverb.size", 0.0f, 1.0f},             // CC 108: (Undefined) → Reverb Size (Secondary)
-    {109, "fx.reverb.mix", 0.0f, 1.0f},               // CC 109: (Undefined) → Reverb Mix (Secondary)
-    {110, "arp.octave", 0.0f, 4.0f},                // CC 110: (Undefined) → Arpeggiator Base Octave (Secondary)
-    {111, "arp.octaves", 1.0f, 6.0f},                // CC 111: (Undefined) → Arpeggiator Octave Spread (Secondary)
-    {112, "arp.hold", 0.0f, 1.0f},                  // CC 112: (Undefined) → Arpeggiator Hold (Secondary)
-    {113, "arp.enabled", 0.0f, 1.0f},               // CC 113: (Undefined) → Arpeggiator Enable (Secondary)
-    {114, "arp.mode", 0.0f, 17.0f},                 // CC 114: (Undefined) → Arpeggiator Mode (Secondary)
-    {115, "arp.polyphonic", 0.0f, 1.0f},           // CC 115: (Undefined) → Arpeggiator Polyphonic Mode (Secondary)
-    {116, "arp.tempo", 60.0f, 240.0f},             // CC 116: (Undefined) → Arpeggiator Tempo (Secondary)
-};
-size_t CC_MAP_SIZE = sizeof(cc_map) / sizeof(cc_map[0]);
-
-// Enhanced MIDI callback with comprehensive logging
+// Runs on the MIDI input thread: the message is only parsed and queued,
+// the synth applies it at the start of its next block. Nothing here logs;
+// the queue counts what it skips and the app reports that periodically.
 void on_midi1_message(void* ctx, libremidi_timestamp ts, const libremidi_midi1_symbol* msg, size_t len) {
+  (void)ts;
   struct Synth *synth = (struct Synth *)ctx;
-  
-   // Defensive check to prevent processing invalid messages
-  if (!msg || !synth || len < 3) {
-    SDL_Log("ERROR: Invalid MIDI message: msg=%p, len=%zu, synth=%p\n", (void*)msg, (size_t)len, (void*)synth);
-    return;
-  }
-   
-  // Additional safety check: verify message pointer validity before accessing
-  if (len < 3 || len > 256) {
-    SDL_Log("WARNING: Invalid MIDI message - len=%zu, msg=%p\n", (size_t)len, (void*)msg);
+  if (!synth)
     return;
-  }
-  
-  if (len >= 3) {
-    unsigned char status = msg[0] & 0xF0;
-    unsigned char note = msg[1];
-    unsigned char vel = msg[2];
-    
-    switch (status) {
-      case 0x80: // Note Off
-        if (synth->arp.enabled) {
-          arpeggiator_note_off(&synth->arp, note);
-        } else {
-          synth_note_off(synth, note);
-        }
-        break;
-        
-      case 0x90: // Note On (with velocity)
-        if (synth->arp.enabled) {
-          arpeggiator_note_on(&synth->arp, note);
-        } else {
-          synth_note_on(synth, note, vel / 127.0f);
-        }
-        break;
-        
-      case 0xB0: // Control Change
-        // Store last CC info for GUI display
-        synth->midi.last_cc = note;
-        synth->midi.last_cc_value = vel;
-        
-        // Map CC to synth parameters
-        midi_map_cc_to_param(synth, note, vel);
-        break;
-        
-      default:
-        SDL_Log("Unknown Status: 0x%02X\n", status);
-        break;
-    }
-  }
+  synth_midi_message(synth, msg, len > 3 ? 3 : (int)len);
 }
 
 // Structure to store enumerated ports
@@ -194,18 +55,13 @@ void webmidi_input_added(void* ctx, const libremidi_midi_in_port* port) {
     return;
   }
   
-  struct Synth *synth = (struct Synth *)ctx;
+  Midi *midi = (Midi *)ctx;
+  struct Synth *synth = midi->synth;
   if (!synth) {
     SDL_Log("ERROR: webmidi_input_added called with null synth\n");
     return;
   }
   
-  Midi *midi = &synth->midi;
-  if (!midi) {
-    SDL_Log("ERROR: webmidi_input_added called with null midi\n");
-    return;
-  }
-  
   if (midi->device_count >= MAX_MIDI_PORTS) {
     SDL_Log("WARNING: Maximum MIDI devices reached, ignoring new device\n");
     return;
@@ -248,6 +104,7 @@ void webmidi_input_added(void* ctx, const libremidi_midi_in_port* port) {
   }
   
   midi_conf.version = MIDI1;
+  midi_conf.ignore_timing = false; // MIDI clock, see midi_clock.h
   midi_conf.in_port = port_clone;
   midi_conf.on_midi1_message.callback = on_midi1_message;
   midi_conf.on_midi1_message.context = synth;
@@ -299,8 +156,8 @@ void webmidi_input_removed(void* ctx, const libremidi_midi_in_port* port) {
     return;
   }
   
-  struct Synth *synth = (struct Synth *)ctx;
-  if (!synth) {
+  Midi *midi = (Midi *)ctx;
+  if (!midi->synth) {
     SDL_Log("ERROR: webmidi_input_removed called with null synth\n");
     return;
   }
@@ -323,9 +180,75 @@ void webmidi_output_removed(void* ctx, const libremidi_midi_out_port* port) {
   (void)port;
 }
 
+#ifndef __EMSCRIPTEN__
+// Sends the clock messages the audio thread queued once they are due. A
+// millisecond of polling is a fraction of a clock at any tempo.
+static int midi_clock_thread(void *data) {
+  Midi *midi = (Midi *)data;
+  while (platform_atomic_get(&midi->clock_running)) {
+    unsigned char msg[3];
+    int len;
+    while ((len = midi_clock_pop_out(&midi->synth->midi_clock, platform_ticks(), msg)) > 0)
+      libremidi_midi_out_send_message(midi->clock_out, msg, (size_t)len);
+    platform_sleep_ms(1);
+  }
+  return 0;
+}
+
+#if defined(_WIN32)
+static void on_output_port_found(void* ctx, const libremidi_midi_out_port* port) {
+  libremidi_midi_out_port** first = (libremidi_midi_out_port**)ctx;
+  if (!*first)
+    libremidi_midi_out_port_clone(port, first);
+}
+#endif
+
+// Clock out goes to a virtual port other apps can connect to; Windows MM
+// has none, so there it goes to the first output
+static void midi_open_clock_out(Midi *midi, libremidi_midi_observer_handle* observer,
+                                libremidi_api_configuration api_conf) {
+  libremidi_midi_configuration midi_conf;
+  if (libremidi_midi_configuration_init(&midi_conf) != 0)
+    return;
+  midi_conf.version = MIDI1;
+  midi_conf.on_error.callback = NULL;
+  midi_conf.on_error.context = NULL;
+  midi_conf.on_warning.callback = NULL;
+  midi_conf.on_warning.context = NULL;
+  api_conf.configuration_type = Output;
+
+  libremidi_midi_out_port* port = NULL;
+#if defined(_WIN32)
+  libremidi_midi_observer_enumerate_output_ports(observer, &port, on_output_port_found);
+  if (!port) {
+    SDL_Log("No MIDI output for clock out\n");
+    return;
+  }
+  midi_conf.out_port = port;
+#else
+  (void)observer;
+  midi_conf.virtual_port = true;
+  midi_conf.port_name = "sdl2-synth";
+#endif
+
+  if (libremidi_midi_out_new(&midi_conf, &api_conf, &midi->clock_out) == 0) {
+    platform_atomic_set(&midi->clock_running, 1);
+    midi->clock_thread = platform_thread_create(midi_clock_thread, "midi_clock", midi);
+    SDL_Log("MIDI clock out ready\n");
+  } else {
+    midi->clock_out = NULL;
+    SDL_Log("Failed to open MIDI clock out\n");
+  }
+  if (port)
+    libremidi_midi_out_port_free(port);
+}
+#endif
+
 void midi_init(Midi *midi, struct Synth *synth) {
   // Initialize MIDI structure
   memset(midi, 0, sizeof(Midi));
+  midi->synth = synth;
+  midi_map_load_file(&synth->midi_map, MIDI_MAP_FILE);
   
   SDL_Log("=== Initializing MIDI System ===\n");
 
@@ -367,13 +290,13 @@ void midi_init(Midi *midi, struct Synth *synth) {
   SDL_Log("Using WebMIDI API for Emscripten\n");
   
   // Set up WebMIDI-specific callbacks
-  observer_conf.input_added.context = synth;
+  observer_conf.input_added.context = midi;
   observer_conf.input_added.callback = webmidi_input_added;
-  observer_conf.input_removed.context = synth;
+  observer_conf.input_removed.context = midi;
   observer_conf.input_removed.callback = webmidi_input_removed;
-  observer_conf.output_added.context = synth;
+  observer_conf.output_added.context = midi;
   observer_conf.output_added.callback = webmidi_output_added;
-  observer_conf.output_removed.context = synth;
+  observer_conf.output_removed.context = midi;
   observer_conf.output_removed.callback = webmidi_output_removed;
   
   observer_api_conf.api = WEBMIDI;
@@ -454,6 +377,7 @@ void midi_init(Midi *midi, struct Synth *synth) {
     }
     
     midi_conf.version = MIDI1;
+    midi_conf.ignore_timing = false; // MIDI clock, see midi_clock.h
     midi_conf.in_port = enumerated.ports[i];
     midi_conf.on_midi1_message.callback = on_midi1_message;
     midi_conf.on_midi1_message.context = synth;
@@ -506,6 +430,7 @@ void midi_init(Midi *midi, struct Synth *synth) {
       libremidi_midi_in_port_free(enumerated.ports[i]);
     }
   }
+  midi_open_clock_out(midi, observer, observer_api_conf);
   libremidi_midi_observer_free(observer);
   
   midi->device_count = successfully_opened;
@@ -521,14 +446,21 @@ void midi_init(Midi *midi, struct Synth *synth) {
     SDL_Log("  - No MIDI devices available\n");
   }
 #endif
-
-  midi->last_cc = -1;
-  midi->last_cc_value = 0;
 }
 
 void midi_shutdown(Midi *midi) {
   // First, set a flag to prevent any new MIDI processing
   midi->enabled = 0;
+
+  if (midi->clock_thread) {
+    platform_atomic_set(&midi->clock_running, 0);
+    platform_thread_join(midi->clock_thread);
+    midi->clock_thread = NULL;
+  }
+  if (midi->clock_out) {
+    libremidi_midi_out_free(midi->clock_out);
+    midi->clock_out = NULL;
+  }
   
   // Add a longer delay to allow any in-progress callbacks to complete
   SDL_Delay(100);
@@ -553,14 +485,3 @@ void midi_shutdown(Midi *midi) {
   
   midi->device_count = 0;
 }
-
-void midi_map_cc_to_param(struct Synth *synth, int cc, int value) {
-  for (size_t i = 0; i < CC_MAP_SIZE; ++i) {
-    if (cc_map[i].cc == cc) {
-      float norm = value / 127.0f;
-      float mapped = cc_map[i].min + (cc_map[i].max - cc_map[i].min) * norm;
-      synth_set_param(synth, cc_map[i].param, mapped);
-      return;
-    }
-  }
-}
@@ -0,0 +1,276 @@
+#include "midi_clock.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MIDI_CLOCK_FRESH 4            // Flag on the middle index: not read yet
+#define MIDI_CLOCK_LOCK_BANDWIDTH 4.0 // DLL bandwidth while locking (Hz)
+#define MIDI_CLOCK_MIN_PERIOD (60.0 / (400.0 * MIDI_CLOCK_PPQN))
+#define MIDI_CLOCK_MAX_PERIOD (60.0 / (10.0 * MIDI_CLOCK_PPQN))
+#define MIDI_CLOCK_NUDGE 0.25         // Tempo correction per beat of position error
+#define MIDI_CLOCK_MAX_NUDGE 0.05     // At most 5% off the clock's tempo
+#define MIDI_CLOCK_MAX_SONG_POSITION 0x3FFF // Sixteenths a song position can reach
+
+void midi_clock_init(MidiClock *clock) {
+  memset(clock, 0, sizeof(MidiClock));
+  clock->follow = 1;
+  clock->in.period = 60.0 / (120.0 * MIDI_CLOCK_PPQN);
+  for (int i = 0; i < 3; ++i)
+    clock->slots[i] = clock->in;
+  clock->back = 0;
+  platform_atomic_set(&clock->middle, 1);
+  clock->front = 2;
+}
+
+static double seconds(uint64_t ticks) {
+  return (double)ticks / (double)platform_ticks_per_second();
+}
+
+static double midi_clock_timeout(const MidiClockState *s) {
+  return fmax(MIDI_CLOCK_TIMEOUT, 3.0 * s->period);
+}
+
+static void midi_clock_publish(MidiClock *clock) {
+  clock->slots[clock->back] = clock->in;
+  platform_barrier_release();
+  int old = platform_atomic_set(&clock->middle, clock->back | MIDI_CLOCK_FRESH);
+  clock->back = old & (MIDI_CLOCK_FRESH - 1);
+}
+
+static const MidiClockState *midi_clock_read(MidiClock *clock) {
+  if (platform_atomic_get(&clock->middle) & MIDI_CLOCK_FRESH) {
+    int old = platform_atomic_set(&clock->middle, clock->front);
+    clock->front = old & (MIDI_CLOCK_FRESH - 1);
+    platform_barrier_acquire();
+  }
+  return &clock->slots[clock->front];
+}
+
+// Delay-locked loop after Fons Adriaensen, "Using a DLL to filter time":
+// 'next' predicts the next clock, the prediction error corrects both the
+// phase and the period. Wider while locking so the tempo settles within a
+// beat, then narrow to reject jitter.
+static void midi_clock_tick(MidiClock *clock, double now) {
+  MidiClockState *in = &clock->in;
+  if (clock->count > 0 && now - in->time > midi_clock_timeout(in))
+    clock->count = 0; // Clock was gone; start over from the last tempo
+
+  if (clock->count < 2) {
+    // The first interval is taken as it is
+    if (clock->count == 1)
+      in->period = fmin(fmax(now - in->time, MIDI_CLOCK_MIN_PERIOD), MIDI_CLOCK_MAX_PERIOD);
+    in->time = now;
+    clock->next = now + in->period;
+  } else {
+    double bandwidth = clock->count < MIDI_CLOCK_PPQN ? MIDI_CLOCK_LOCK_BANDWIDTH
+                                                      : MIDI_CLOCK_BANDWIDTH;
+    double w = 2.0 * M_PI * bandwidth * in->period;
+    double error = now - clock->next;
+    in->time = clock->next;
+    clock->next = in->time + sqrt(2.0) * w * error + in->period;
+    in->period = fmin(fmax(in->period + w * w * error, MIDI_CLOCK_MIN_PERIOD), MIDI_CLOCK_MAX_PERIOD);
+  }
+  clock->count++;
+  in->locked = clock->count >= MIDI_CLOCK_LOCK_CLOCKS;
+
+  if (clock->pending) {
+    clock->pending = 0;
+    in->running = 1; // This clock is the position start or continue set
+  } else if (in->running) {
+    in->position++;
+  }
+}
+
+int midi_clock_receive(MidiClock *clock, const unsigned char *msg, int len, uint64_t now) {
+  if (len < 1)
+    return 0;
+  unsigned char status = msg[0];
+  if (status != 0xF8 && status != 0xFA && status != 0xFB && status != 0xFC && status != 0xF2)
+    return 0;
+  if (status == 0xF2 && len < 3)
+    return 1; // Truncated song position
+
+  // Several MIDI inputs may deliver at once; the section is short
+  while (!platform_atomic_cas(&clock->busy, 0, 1))
+    ;
+
+  MidiClockState *in = &clock->in;
+  switch (status) {
+  case 0xF8: // Clock
+    midi_clock_tick(clock, seconds(now));
+    break;
+  case 0xFA: // Start: from the top on the next clock
+    in->position = 0;
+    in->running = 0;
+    in->positioned = 1;
+    in->locates++;
+    clock->pending = 1;
+    break;
+  case 0xFB: // Continue: from the current position on the next clock
+    in->running = 0;
+    in->positioned = 1;
+    in->locates++;
+    clock->pending = 1;
+    break;
+  case 0xFC: // Stop: resume after the last clock played
+    if (in->running)
+      in->position++;
+    in->running = 0;
+    clock->pending = 0;
+    break;
+  case 0xF2: // Song position, in sixteenth notes
+    in->position = (long long)(msg[1] | (msg[2] << 7)) * (MIDI_CLOCK_PPQN / 4);
+    in->positioned = 1;
+    in->locates++;
+    break;
+  }
+  midi_clock_publish(clock);
+
+  platform_atomic_set(&clock->busy, 0);
+  return 1;
+}
+
+int midi_clock_follow(MidiClock *clock, Transport *t, uint64_t now_ticks) {
+  const MidiClockState *s = midi_clock_read(clock);
+  double now = seconds(now_ticks);
+  if (!clock->follow || !s->locked || now - s->time > midi_clock_timeout(s)) {
+    // No clock to follow: free-run at its last tempo, without the nudge,
+    // unless the sender had stopped
+    if (clock->following) {
+      clock->following = 0;
+      t->running = !s->positioned || s->running;
+      transport_set_bpm(t, (float)(60.0 / (s->period * MIDI_CLOCK_PPQN)));
+    }
+    return 0;
+  }
+  clock->following = 1;
+
+  float bpm = (float)(60.0 / (s->period * MIDI_CLOCK_PPQN));
+  if (!s->positioned) {
+    // Clock without start or song position: tempo only
+    t->running = 1;
+    transport_set_bpm(t, bpm);
+    return 0;
+  }
+
+  // Song position now, between the last clock and the next
+  double beat = (double)s->position;
+  if (s->running)
+    beat += fmin((now - s->time) / s->period, 1.0);
+  beat /= MIDI_CLOCK_PPQN;
+
+  int result = 0;
+  if (s->locates != clock->locates_seen) {
+    clock->locates_seen = s->locates;
+    transport_locate(t, beat);
+    clock->error = 0.0;
+    result = MIDI_CLOCK_MOVED;
+  }
+  if (t->running && !s->running)
+    result = MIDI_CLOCK_MOVED;
+  t->running = s->running;
+
+  if (s->running) {
+    // Close the remaining gap by bending the tempo slightly, so the
+    // transport never jumps while playing
+    double error = beat - t->beat;
+    if (fabs(error) > 1.0) {
+      transport_locate(t, beat);
+      error = 0.0;
+      clock->error = 0.0;
+      result = MIDI_CLOCK_MOVED;
+    }
+    // A late clock stalls 'beat'; hold the correction until it arrives
+    if (now - s->time < 2.0 * s->period)
+      clock->error += 0.05 * (error - clock->error);
+    double nudge = fmin(fmax(clock->error * MIDI_CLOCK_NUDGE, -MIDI_CLOCK_MAX_NUDGE), MIDI_CLOCK_MAX_NUDGE);
+    bpm *= (float)(1.0 + nudge);
+  }
+  transport_set_bpm(t, bpm);
+  return result;
+}
+
+static void midi_clock_push_message(MidiClock *clock, uint64_t time, const unsigned char *msg,
+                                    int len) {
+  unsigned int w = (unsigned int)platform_atomic_get(&clock->out_write);
+  unsigned int r = (unsigned int)platform_atomic_get(&clock->out_read);
+  if (w - r >= MIDI_CLOCK_OUT_SIZE)
+    return; // Nobody is sending; drop
+  MidiClockMessage *m = &clock->out[w & (MIDI_CLOCK_OUT_SIZE - 1)];
+  m->time = time;
+  memcpy(m->msg, msg, (size_t)len);
+  m->len = len;
+  platform_atomic_set(&clock->out_write, (int)(w + 1));
+}
+
+static void midi_clock_push_out(MidiClock *clock, uint64_t time, unsigned char status) {
+  midi_clock_push_message(clock, time, &status, 1);
+}
+
+// Start plays from the top; anywhere else the receiver is first told the
+// song position, in sixteenths, then continues from there
+static void midi_clock_start_out(MidiClock *clock, uint64_t time, long long position) {
+  if (position == 0) {
+    midi_clock_push_out(clock, time, 0xFA);
+    return;
+  }
+  int sixteenths = (int)(position / (MIDI_CLOCK_PPQN / 4));
+  unsigned char spp[3] = {0xF2, (unsigned char)(sixteenths & 0x7F),
+                          (unsigned char)(sixteenths >> 7)};
+  midi_clock_push_message(clock, time, spp, 3);
+  midi_clock_push_out(clock, time, 0xFB);
+}
+
+void midi_clock_emit(MidiClock *clock, const Transport *t, int frames, uint64_t now) {
+  if (!clock->send || !t->running) {
+    if (clock->sending) {
+      midi_clock_push_out(clock, now, 0xFC); // Stop
+      clock->sending = 0;
+    }
+    return;
+  }
+
+  double frames_per_beat = transport_frames_per_beat(t);
+  double ticks_per_frame = (double)platform_ticks_per_second() / t->sample_rate;
+  double end = (t->beat + frames / frames_per_beat) * MIDI_CLOCK_PPQN;
+  long long n = (long long)ceil(t->beat * MIDI_CLOCK_PPQN - 1e-6);
+  if (clock->sending) {
+    if (n == clock->out_next - 1) {
+      n = clock->out_next; // Sent at the end of the last block
+    } else if (n != clock->out_next) {
+      // The transport jumped; the receiver restarts with us at the next bar
+      midi_clock_push_out(clock, now, 0xFC);
+      clock->sending = 0;
+    }
+  }
+
+  for (; n < end; ++n) {
+    double offset = (n / (double)MIDI_CLOCK_PPQN - t->beat) * frames_per_beat;
+    uint64_t due = now + (uint64_t)((frames + offset) * ticks_per_frame);
+    if (!clock->sending) {
+      if (n % (MIDI_CLOCK_PPQN * TRANSPORT_BEATS_PER_BAR) != 0 ||
+          n / (MIDI_CLOCK_PPQN / 4) > MIDI_CLOCK_MAX_SONG_POSITION)
+        continue; // Start on a bar line a song position can name
+      midi_clock_start_out(clock, due, n);
+      clock->sending = 1;
+    }
+    midi_clock_push_out(clock, due, 0xF8);
+    clock->out_next = n + 1;
+  }
+}
+
+int midi_clock_pop_out(MidiClock *clock, uint64_t now, unsigned char *msg) {
+  unsigned int r = (unsigned int)platform_atomic_get(&clock->out_read);
+  if (r == (unsigned int)platform_atomic_get(&clock->out_write))
+    return 0;
+  const MidiClockMessage *m = &clock->out[r & (MIDI_CLOCK_OUT_SIZE - 1)];
+  if (m->time > now)
+    return 0;
+  int len = m->len;
+  memcpy(msg, m->msg, (size_t)len);
+  platform_atomic_set(&clock->out_read, (int)(r + 1));
+  return len;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "platform.h"
+#include "transport.h"
+#include <stdint.h>
+
+// MIDI clock in and out. Incoming clocks (24 per quarter note) are
+// timestamped on the MIDI thread and smoothed by a delay-locked loop, a
+// second-order PLL on the clock period, so USB and driver jitter does not
+// reach the tempo. Start, continue, stop and song position set where the
+// clock is in the song. The audio thread then steers the transport
+// towards that position and tempo once per block. Outgoing clocks are
+// derived from the transport on the audio thread, stamped with the time
+// they are due, and sent by the host from its own thread.
+#define MIDI_CLOCK_PPQN 24
+#define MIDI_CLOCK_BANDWIDTH 0.5      // DLL bandwidth once locked (Hz)
+#define MIDI_CLOCK_LOCK_CLOCKS 4      // Clocks before the tempo is trusted
+#define MIDI_CLOCK_TIMEOUT 0.3        // Seconds without a clock before it counts as gone
+#define MIDI_CLOCK_OUT_SIZE 256       // Power of two
+
+// Where the incoming clock is, as published by the MIDI thread
+typedef struct {
+  int locked;                   // Enough clocks for a tempo
+  int positioned;               // Start, continue or song position seen
+  int running;                  // Between start/continue and stop
+  long long position;           // Clocks: index of the last clock while running,
+                                // where playback resumes while stopped
+  double time;                  // Filtered time of the last clock (seconds)
+  double period;                // Filtered clock period (seconds)
+  unsigned int locates;         // Bumped by start, continue and song position
+} MidiClockState;
+
+typedef struct {
+  uint64_t time;                // platform_ticks() when due
+  unsigned char msg[3];
+  int len;
+} MidiClockMessage;
+
+typedef struct {
+  int follow;                   // Transport follows incoming clock (GUI, params)
+  int send;                     // Send clock out (GUI, params)
+
+  // MIDI input threads, one at a time
+  PlatformAtomic busy;
+  MidiClockState in;
+  double next;                  // Predicted time of the next clock
+  int count;                    // Clocks since the loop was reset
+  int pending;                  // Start/continue waits for its first clock
+
+  // Input state for the audio thread, through a triple buffer as in
+  // snapshot.h
+  MidiClockState slots[3];
+  PlatformAtomic middle;
+  int back, front;
+
+  // Audio thread
+  int following;                // Transport currently slaved
+  unsigned int locates_seen;
+  double error;                 // Smoothed position error (beats)
+  int sending;                  // Start or continue sent, clocks going out
+  long long out_next;           // Next clock to send, counted in song clocks
+
+  // Clock out, audio thread to host thread
+  MidiClockMessage out[MIDI_CLOCK_OUT_SIZE];
+  PlatformAtomic out_write, out_read;
+} MidiClock;
+
+// midi_clock_follow() result
+#define MIDI_CLOCK_MOVED 1            // Transport jumped or stopped
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void midi_clock_init(MidiClock *clock);
+// MIDI thread: a system real-time or song position message, received at
+// 'now' (platform_ticks). Returns 0 for messages that are not clock related.
+int midi_clock_receive(MidiClock *clock, const unsigned char *msg, int len, uint64_t now);
+// Audio thread, block start: steer the transport's tempo and position
+// towards the incoming clock while following is on and a clock arrives.
+// Returns MIDI_CLOCK_MOVED when the caller has to reschedule.
+int midi_clock_follow(MidiClock *clock, Transport *t, uint64_t now);
+// Audio thread, block start: queue the clocks that fall in the next
+// 'frames', due one block after 'now' when the block is heard. Sending
+// starts on a bar line: with start at the top of the song, elsewhere with
+// song position and continue so the receiver joins at the same place.
+void midi_clock_emit(MidiClock *clock, const Transport *t, int frames, uint64_t now);
+// Host thread: next outgoing message due by 'now', copied to 'msg' (3
+// bytes). Returns its length, 0 when none is due.
+int midi_clock_pop_out(MidiClock *clock, uint64_t now, unsigned char *msg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,228 @@
+#include "midi_map.h"
+#include "params.h"
+#include "synth.h"
+#include "cJSON.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Standard MIDI CC mapping following MIDI specification
+// Uses commonly assigned CC numbers for universal compatibility
+const CCMapping cc_map[] = {
+    // BANK SELECT & MODULATION (CC 0-31)
+    {1, "osc1.pitch", -24.0f, 24.0f},        // CC 1: Modulation Wheel → OSC 1 Pitch Bend
+    {2, "osc1.detune", -1.0f, 1.0f},        // CC 2: Breath Controller → OSC 1 Detune
+    {7, "osc1.gain", 0.0f, 1.0f},           // CC 7: Volume (Channel Volume) → OSC 1 Gain
+    {10, "osc1.waveform", 0.0f, 4.0f},      // CC 10: Pan → OSC 1 Waveform Select
+    {11, "osc1.pulse_width", 0.0f, 1.0f},    // CC 11: Expression → OSC 1 Pulse Width
+    {12, "osc2.pitch", -24.0f, 24.0f},       // CC 12: Effect Control 1 → OSC 2 Pitch Bend
+    {13, "osc2.detune", -1.0f, 1.0f},        // CC 13: Effect Control 2 → OSC 2 Detune
+    {14, "osc2.gain", 0.0f, 1.0f},           // CC 14: (Undefined/Unused) → OSC 2 Gain
+    {15, "osc3.gain", 0.0f, 1.0f},           // CC 15: (Undefined/Unused) → OSC 3 Gain
+    {15, "osc3.waveform", 0.0f, 4.0f},      // CC 15: (Undefined/Unused) → OSC 3 Waveform Select
+    {16, "osc4.pitch", -24.0f, 24.0f},       // CC 16: General Purpose Controller 1 → OSC 4 Pitch Bend
+    {17, "osc4.detune", -1.0f, 1.0f},        // CC 17: General Purpose Controller 2 → OSC 4 Detune
+    
+    
+    // OSCILLATOR PARAMETER BLOCK (CC 20-31)
+    {20, "mixer.master", 0.0f, 2.0f},           // CC 20: (Undefined) → Master Volume
+    {21, "fx.filter.cutoff", 20.0f, 20000.0f},   // CC 21: (Undefined) → Filter Cutoff
+    {22, "fx.filter.resonance", 0.1f, 10.0f},    // CC 22: (Undefined) → Filter Resonance
+    {23, "fx.flanger.rate", 0.1f, 20.0f},       // CC 23: (Undefined) → Flanger Rate
+    {24, "fx.delay.time", 0.0f, 1.0f},          // CC 24: (Undefined) → Delay Time
+    {25, "fx.reverb.size", 0.0f, 1.0f},          // CC 25: (Undefined) → Reverb Size
+    {26, "fx.reverb.mix", 0.0f, 1.0f},            // CC 26: (Undefined) → Reverb Mix
+    {27, "fx.flanger.depth", 0.0f, 1.0f},         // CC 27: (Undefined) → Flanger Depth
+    {28, "fx.delay.feedback", 0.0f, 1.0f},        // CC 28: (Undefined) → Delay Feedback
+    {29, "fx.flanger.feedback", 0.0f, 1.0f},       // CC 29: (Undefined) → Flanger Feedback
+    {30, "fx.delay.mix", 0.0f, 1.0f},            // CC 30: (Undefined) → Delay Mix
+    
+    // STANDARD MIDI CONTROLLERS (CC 32-63)
+    {33, "osc4.gain", 0.0f, 1.0f},            // CC 33: (Undefined) → OSC 4 Gain
+    {34, "osc4.waveform", 0.0f, 4.0f},        // CC 34: LSB of Bank Select → OSC 4 Waveform
+    {35, "osc3.waveform", 0.0f, 4.0f},        // CC 35: LSB of Bank Select → OSC 3 Waveform
+    {36, "osc2.waveform", 0.0f, 4.0f},        // CC 36: LSB of Bank Select → OSC 2 Waveform
+    {37, "osc2.waveform", 0.0f, 4.0f},        // CC 37: LSB of Bank Select → OSC 2 Waveform
+    {38, "osc1.waveform", 0.0f, 4.0f},        // CC 38: LSB of Bank Select → OSC 1 Waveform
+    {39, "mixer.comp.threshold", -24.0f, 0.0f},    // CC 39: LSB of Bank Select → Compressor Threshold
+    {40, "mixer.comp.ratio", 1.0f, 10.0f},        // CC 40: LSB of Bank Select → Compressor Ratio
+    {41, "mixer.comp.attack", 1.0f, 100.0f},        // CC 41: LSB of Bank Select → Compressor Attack
+    {42, "mixer.comp.release", 10.0f, 1000.0f},     // CC 42: LSB of Bank Select → Compressor Release
+    {43, "mixer.comp.makeup", 0.0f, 12.0f},         // CC 43: LSB of Bank Select → Compressor Makeup
+    {44, "fx.filter.drive", 1.0f, 10.0f},          // CC 44: LSB of Bank Select → Filter Drive
+    {45, "fx.filter.resonance", 0.1f, 10.0f},        // CC 45: LSB of Bank Select → Filter Resonance
+    {46, "fx.filter.mix", 0.0f, 1.0f},             // CC 46: LSB of Bank Select → Filter Mix
+    {48, "osc4.unison_voices", 1.0f, 8.0f},        // CC 48: LSB of Bank Select → OSC 4 Unison Voices
+    {49, "osc4.unison_voices", 1.0f, 8.0f},        // CC 49: LSB of Bank Select → OSC 4 Unison Voices
+    {50, "osc3.unison_voices", 1.0f, 8.0f},        // CC 50: LSB of Bank Select → OSC 3 Unison Voices
+    {51, "osc2.unison_voices", 1.0f, 8.0f},        // CC 51: LSB of Bank Select → OSC 2 Unison Voices
+    {52, "osc1.unison_voices", 1.0f, 8.0f},        // CC 52: LSB of Bank Select → OSC 1 Unison Voices
+    
+    
+    // ADDITIONAL EFFECTS & PERFORMANCE CONTROLS (CC 70-95)
+    {70, "arp.tempo", 60.0f, 240.0f},             // CC 70: Sound Controller 1 → Arpeggiator Tempo
+    {71, "arp.enabled", 0.0f, 1.0f},               // CC 71: Sound Controller 2 → Arpeggiator Enable
+    {72, "arp.mode", 0.0f, 17.0f},                 // CC 72: Sound Controller 3 → Arpeggiator Mode (0-17)
+    {73, "arp.hold", 0.0f, 1.0f},                  // CC 73: Sound Controller 4 → Arpeggiator Hold
+    {74, "arp.octave", 0.0f, 4.0f},                // CC 74: Sound Controller 5 → Arpeggiator Base Octave
+    {75, "arp.octaves", 1.0f, 6.0f},                // CC 75: Sound Controller 6 → Arpeggiator Octave Spread
+    {76, "fx.delay.feedback", 0.0f, 1.0f},           // CC 76: Sound Controller 7 → Delay Feedback
+    {77, "fx.delay.time", 0.0f, 1.0f},              // CC 77: Sound Controller 8 → Delay Time
+    {78, "fx.delay.mix", 0.0f, 1.0f},               // CC 78: Sound Controller 9 → Delay Mix
+    {79, "fx.flanger.rate", 0.1f, 20.0f},           // CC 79: Sound Controller 10 → Flanger Rate
+    {80, "fx.flanger.depth", 0.0f, 1.0f},          // CC 80: Sound Controller 11 → Flanger Depth
+    {81, "fx.flanger.feedback", 0.0f, 1.0f},        // CC 81: Sound Controller 12 → Flanger Feedback
+    {82, "fx.reverb.size", 0.0f, 1.0f},             // CC 82: Sound Controller 13 → Reverb Size
+    {83, "fx.reverb.mix", 0.0f, 1.0f},               // CC 83: Sound Controller 14 → Reverb Mix
+    
+    // CHANNEL MODE & PARAMETER CONTROLS (CC 102-119)
+    {102, "arp.polyphonic", 0.0f, 1.0f},           // CC 102: (Undefined) → Arpeggiator Polyphonic Mode
+    {103, "arp.tempo", 60.0f, 240.0f},             // CC 103: (Undefined) → Arpeggiator Tempo (Secondary)
+    {104, "fx.filter.cutoff", 20.0f, 20000.0f},       // CC 104: (Undefined) → Filter Cutoff (Secondary)
+    {105, "fx.filter.resonance", 0.1f, 10.0f},        // CC 105: (Undefined) → Filter Resonance (Secondary)
+    {106, "fx.filter.drive", 1.0f, 10.0f},          // CC 106: (Undefined) → Filter Drive (Secondary)
+    {107, "fx.filter.mix", 0.0f, 1.0f},               // CC 107: (Undefined) → Filter Mix (Secondary)
+    {108, "fx.reverb.size", 0.0f, 1.0f},             // CC 108: (Undefined) → Reverb Size (Secondary)
+    {109, "fx.reverb.mix", 0.0f, 1.0f},               // CC 109: (Undefined) → Reverb Mix (Secondary)
+    {110, "arp.octave", 0.0f, 4.0f},                // CC 110: (Undefined) → Arpeggiator Base Octave (Secondary)
+    {111, "arp.octaves", 1.0f, 6.0f},                // CC 111: (Undefined) → Arpeggiator Octave Spread (Secondary)
+    {112, "arp.hold", 0.0f, 1.0f},                  // CC 112: (Undefined) → Arpeggiator Hold (Secondary)
+    {113, "arp.enabled", 0.0f, 1.0f},               // CC 113: (Undefined) → Arpeggiator Enable (Secondary)
+    {114, "arp.mode", 0.0f, 17.0f},                 // CC 114: (Undefined) → Arpeggiator Mode (Secondary)
+    {115, "arp.polyphonic", 0.0f, 1.0f},           // CC 115: (Undefined) → Arpeggiator Polyphonic Mode (Secondary)
+    {116, "arp.tempo", 60.0f, 240.0f},             // CC 116: (Undefined) → Arpeggiator Tempo (Secondary)
+};
+const int CC_MAP_SIZE = (int)(sizeof(cc_map) / sizeof(cc_map[0]));
+
+void midi_map_clear(MidiMap *map) {
+  memset(map, 0, sizeof(*map));
+}
+
+void midi_map_load_defaults(MidiMap *map) {
+  for (int i = 0; i < CC_MAP_SIZE; ++i)
+    midi_map_add(map, 0, cc_map[i].cc, cc_map[i].param, cc_map[i].min, cc_map[i].max, 0);
+}
+
+int midi_map_add(MidiMap *map, int channel, int cc, const char *param,
+                 float min, float max, int high_resolution) {
+  if (channel < 0 || channel > MIDI_CHANNELS || cc < 0 || cc > 127) {
+    platform_log("MIDI map: channel %d / CC %d out of range", channel, cc);
+    return 0;
+  }
+  int id = param_lookup(param);
+  if (id == PARAM_NONE) {
+    platform_log("MIDI map: unknown parameter '%s' for CC %d", param, cc);
+    return 0;
+  }
+  if (high_resolution && cc >= 32) {
+    platform_log("MIDI map: CC %d cannot be a 14-bit MSB, using 7 bits", cc);
+    high_resolution = 0;
+  }
+
+  int first = channel ? channel - 1 : 0;
+  int last = channel ? channel - 1 : MIDI_CHANNELS - 1;
+  for (int ch = first; ch <= last; ++ch) {
+    MidiMapSlot *slot = &map->cc[ch][cc];
+    if (slot->mode == MIDI_CC_14BIT_LSB) {
+      platform_log("MIDI map: CC %d is the LSB of a 14-bit pair, '%s' ignored", cc, param);
+      return 0;
+    }
+    if (slot->count >= MIDI_MAP_MAX_TARGETS) {
+      platform_log("MIDI map: CC %d already has %d targets, '%s' ignored", cc, MIDI_MAP_MAX_TARGETS, param);
+      return 0;
+    }
+    if (high_resolution) {
+      MidiMapSlot *lsb = &map->cc[ch][cc + 32];
+      if (lsb->count > 0 && ch == first)
+        platform_log("MIDI map: CC %d now carries the LSB of CC %d, its own targets are dropped", cc + 32, cc);
+      lsb->mode = MIDI_CC_14BIT_LSB;
+      lsb->count = 0;
+      slot->mode = MIDI_CC_14BIT_MSB;
+    }
+    MidiMapTarget *t = &slot->targets[slot->count++];
+    t->param = id;
+    t->min = min;
+    t->range = max - min;
+  }
+  return 1;
+}
+
+// {"replace": false, "mappings": [{"cc": 1, "channel": 0, "param":
+// "fx.filter.cutoff", "min": 20, "max": 20000, "14bit": true}, ...]}
+int midi_map_load_file(MidiMap *map, const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return 0;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *text = malloc((size_t)size + 1);
+  if (!text || fread(text, 1, (size_t)size, f) != (size_t)size) {
+    free(text);
+    fclose(f);
+    return 0;
+  }
+  fclose(f);
+  text[size] = '\0';
+
+  cJSON *root = cJSON_Parse(text);
+  free(text);
+  cJSON *mappings = cJSON_GetObjectItemCaseSensitive(root, "mappings");
+  if (!cJSON_IsArray(mappings)) {
+    platform_log("MIDI map: '%s' has no \"mappings\" array", path);
+    cJSON_Delete(root);
+    return 0;
+  }
+
+  if (cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(root, "replace")))
+    midi_map_clear(map);
+
+  int added = 0;
+  const cJSON *m;
+  cJSON_ArrayForEach(m, mappings) {
+    const cJSON *cc = cJSON_GetObjectItemCaseSensitive(m, "cc");
+    const cJSON *param = cJSON_GetObjectItemCaseSensitive(m, "param");
+    if (!cJSON_IsNumber(cc) || !cJSON_IsString(param)) {
+      platform_log("MIDI map: entry without \"cc\" or \"param\" skipped");
+      continue;
+    }
+    const cJSON *channel = cJSON_GetObjectItemCaseSensitive(m, "channel");
+    const cJSON *min = cJSON_GetObjectItemCaseSensitive(m, "min");
+    const cJSON *max = cJSON_GetObjectItemCaseSensitive(m, "max");
+    added += midi_map_add(map, cJSON_IsNumber(channel) ? channel->valueint : 0, cc->valueint,
+                          param->valuestring,
+                          cJSON_IsNumber(min) ? (float)min->valuedouble : 0.0f,
+                          cJSON_IsNumber(max) ? (float)max->valuedouble : 1.0f,
+                          cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(m, "14bit")));
+  }
+  cJSON_Delete(root);
+  platform_log("MIDI map: %d mappings loaded from '%s'", added, path);
+  return 1;
+}
+
+void midi_map_dispatch(MidiMap *map, struct Synth *synth, int channel, int cc, int value) {
+  channel &= MIDI_CHANNELS - 1;
+  cc &= 127;
+  const MidiMapSlot *slot = &map->cc[channel][cc];
+  float norm;
+  switch (slot->mode) {
+  case MIDI_CC_14BIT_MSB:
+    // Usable on its own, scaled as the pair with LSB 0 so a following LSB
+    // only refines it
+    map->msb[channel][cc] = (unsigned char)value;
+    norm = value * 128 / 16383.0f;
+    break;
+  case MIDI_CC_14BIT_LSB:
+    slot = &map->cc[channel][cc - 32];
+    norm = (map->msb[channel][cc - 32] * 128 + value) / 16383.0f;
+    break;
+  default:
+    norm = value / 127.0f;
+    break;
+  }
+  for (int i = 0; i < slot->count; ++i) {
+    const MidiMapTarget *t = &slot->targets[i];
+    synth_channel_param(synth, channel, t->param, t->min + t->range * norm);
+  }
+}
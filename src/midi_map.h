@@ -0,0 +1,62 @@
+#pragma once
+
+struct Synth;
+
+// Control change routing, resolved once into a table indexed by channel
+// and controller number. Every slot holds up to MIDI_MAP_MAX_TARGETS
+// parameter IDs with their ranges, so a CC costs one lookup and a few
+// direct setter calls. CCs 0-31 can pair with CC n+32 as a 14-bit value.
+#define MIDI_CHANNELS 16
+#define MIDI_MAP_MAX_TARGETS 4
+#define MIDI_MAP_FILE "midi_map.json"   // Loaded at startup when present
+
+typedef enum {
+  MIDI_CC_7BIT,
+  MIDI_CC_14BIT_MSB,            // CC 0-31 of a 14-bit pair
+  MIDI_CC_14BIT_LSB             // CC 32-63; uses the MSB slot's targets
+} MidiCCMode;
+
+typedef struct {
+  int cc;
+  const char *param;
+  float min, max;
+} CCMapping;
+
+typedef struct {
+  int param;                    // ID from params.h
+  float min, range;             // value = min + range * normalized
+} MidiMapTarget;
+
+typedef struct {
+  MidiCCMode mode;
+  int count;
+  MidiMapTarget targets[MIDI_MAP_MAX_TARGETS];
+} MidiMapSlot;
+
+typedef struct {
+  MidiMapSlot cc[MIDI_CHANNELS][128];
+  unsigned char msb[MIDI_CHANNELS][32]; // Last MSB of each 14-bit pair
+} MidiMap;
+
+extern const CCMapping cc_map[];
+extern const int CC_MAP_SIZE;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void midi_map_clear(MidiMap *map);
+// Built-in mapping (cc_map) on all channels
+void midi_map_load_defaults(MidiMap *map);
+// channel is 1-16, or 0 for all channels. Returns 1 on success.
+int midi_map_add(MidiMap *map, int channel, int cc, const char *param,
+                 float min, float max, int high_resolution);
+// JSON mapping file, see README. Returns 1 on success.
+int midi_map_load_file(MidiMap *map, const char *path);
+// Audio thread, as synth_render() applies the queued MIDI messages:
+// channel 0-15
+void midi_map_dispatch(MidiMap *map, struct Synth *synth, int channel, int cc, int value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,105 @@
+#include "midi_queue.h"
+#include <string.h>
+
+// Bounded multi-producer queue after Dmitry Vyukov. A slot's seq equals
+// its position while free, position + 1 once written, and position +
+// MIDI_QUEUE_SIZE after the audio thread has read it. Producers claim a
+// position with a compare-and-swap on head, so they never wait on a lock.
+// Positions wrap as unsigned ints; differences are taken as signed.
+
+// Data bytes for each channel message type, indexed by status >> 4
+static const int message_length[16] = {
+  0, 0, 0, 0, 0, 0, 0, 0,
+  2, // 0x80 note off
+  2, // 0x90 note on
+  2, // 0xA0 poly aftertouch
+  2, // 0xB0 control change
+  1, // 0xC0 program change
+  1, // 0xD0 channel aftertouch
+  2, // 0xE0 pitch bend
+  0, // 0xF0 system, not queued
+};
+
+void midi_queue_init(MidiQueue *q) {
+  memset(q, 0, sizeof(MidiQueue));
+  for (int i = 0; i < MIDI_QUEUE_SIZE; ++i)
+    platform_atomic_set(&q->slots[i].seq, i);
+}
+
+static int midi_queue_push(MidiQueue *q, const MidiEvent *event) {
+  unsigned int pos = (unsigned int)platform_atomic_get(&q->head);
+  for (;;) {
+    MidiQueueSlot *slot = &q->slots[pos & (MIDI_QUEUE_SIZE - 1)];
+    int diff = (int)((unsigned int)platform_atomic_get(&slot->seq) - pos);
+    if (diff == 0) {
+      if (platform_atomic_cas(&q->head, (int)pos, (int)(pos + 1))) {
+        slot->event = *event;
+        platform_atomic_set(&slot->seq, (int)(pos + 1));
+        return 1;
+      }
+      pos = (unsigned int)platform_atomic_get(&q->head);
+    } else if (diff < 0) {
+      return 0; // Full: the audio thread has not read this slot yet
+    } else {
+      pos = (unsigned int)platform_atomic_get(&q->head);
+    }
+  }
+}
+
+int midi_queue_push_message(MidiQueue *q, const unsigned char *msg, int len) {
+  if (!msg || len < 1 || !(msg[0] & 0x80)) {
+    platform_atomic_add(&q->malformed, 1);
+    return 0;
+  }
+  int type = msg[0] >> 4;
+  if (type == 0xF) {
+    // Real-time bytes (clock, active sensing) arrive constantly and are
+    // not worth a report
+    if (msg[0] < 0xF8)
+      platform_atomic_add(&q->ignored, 1);
+    return 0;
+  }
+  int data = message_length[type];
+  if (len < 1 + data || (msg[1] & 0x80) || (data == 2 && (msg[2] & 0x80))) {
+    platform_atomic_add(&q->malformed, 1);
+    return 0;
+  }
+
+  MidiEvent event;
+  event.status = msg[0];
+  event.data1 = msg[1];
+  event.data2 = data == 2 ? msg[2] : 0;
+  if (!midi_queue_push(q, &event)) {
+    platform_atomic_add(&q->dropped, 1);
+    return 0;
+  }
+  platform_atomic_add(&q->received, 1);
+  return 1;
+}
+
+int midi_queue_pop(MidiQueue *q, MidiEvent *event) {
+  MidiQueueSlot *slot = &q->slots[q->tail & (MIDI_QUEUE_SIZE - 1)];
+  int diff = (int)((unsigned int)platform_atomic_get(&slot->seq) - (q->tail + 1));
+  if (diff < 0)
+    return 0;
+  *event = slot->event;
+  platform_atomic_set(&slot->seq, (int)(q->tail + MIDI_QUEUE_SIZE));
+  q->tail++;
+  return 1;
+}
+
+void midi_queue_report(MidiQueue *q) {
+  uint64_t now = platform_ticks();
+  uint64_t interval = platform_ticks_per_second() * MIDI_REPORT_INTERVAL_MS / 1000;
+  if (q->last_report && now - q->last_report < interval)
+    return;
+
+  int ignored = platform_atomic_set(&q->ignored, 0);
+  int malformed = platform_atomic_set(&q->malformed, 0);
+  int dropped = platform_atomic_set(&q->dropped, 0);
+  if (ignored + malformed + dropped == 0)
+    return;
+  q->last_report = now;
+  platform_log("MIDI: %d system messages ignored, %d malformed, %d dropped (queue full)",
+               ignored, malformed, dropped);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "platform.h"
+#include <stdint.h>
+
+// Lock-free hand-off of MIDI channel messages to the audio thread. Any
+// number of input threads push; the audio thread drains the queue at the
+// start of every block. Nothing here logs or blocks: malformed, system
+// and overflowing messages only bump counters, which the host reports
+// from its own thread with midi_queue_report().
+#define MIDI_QUEUE_SIZE 1024          // Power of two
+#define MIDI_REPORT_INTERVAL_MS 2000  // Least time between two reports
+
+typedef struct {
+  unsigned char status;         // Channel message type | channel
+  unsigned char data1;
+  unsigned char data2;
+} MidiEvent;
+
+typedef struct {
+  PlatformAtomic seq;           // Turn of this slot, see midi_queue.c
+  MidiEvent event;
+} MidiQueueSlot;
+
+typedef struct {
+  MidiQueueSlot slots[MIDI_QUEUE_SIZE];
+  PlatformAtomic head;          // Next position a producer claims
+  unsigned int tail;            // Next position the audio thread reads
+
+  PlatformAtomic received;      // Channel messages queued
+  PlatformAtomic ignored;       // SysEx and system common messages
+  PlatformAtomic malformed;     // Truncated or stray data bytes
+  PlatformAtomic dropped;       // Lost because the queue was full
+  uint64_t last_report;         // Host thread only
+} MidiQueue;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void midi_queue_init(MidiQueue *q);
+// Any thread. Parses one complete MIDI 1.0 message; returns 1 when a
+// channel message was queued.
+int midi_queue_push_message(MidiQueue *q, const unsigned char *msg, int len);
+// Audio thread. Returns 0 once the queue is empty.
+int midi_queue_pop(MidiQueue *q, MidiEvent *event);
+// Host thread. Logs what was ignored or lost since the last report, at
+// most once per MIDI_REPORT_INTERVAL_MS.
+void midi_queue_report(MidiQueue *q);
+
+#ifdef __cplusplus
+}
+#endif
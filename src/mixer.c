@@ -17,34 +17,6 @@ float linear_to_db(float linear) {
   return 20.0f * log10f(linear);
 }
 
-// DC offset filter to remove DC component
-float dc_filter_process(float input, float *state, float cutoff_freq, float sample_rate) {
-  // Simple 1-pole high-pass filter for DC removal
-  float rc = 1.0f / (2.0f * 3.14159265f * cutoff_freq);
-  float alpha = rc / (rc + 1.0f / sample_rate);
-  *state += (input - *state) * alpha;
-  return *state;
-}
-
-// Soft clipping with adjustable knee
-float soft_clip_process(float input, float threshold_db, float ratio) {
-  float threshold_linear = db_to_linear(threshold_db);
-  
-  if (fabsf(input) <= threshold_linear) {
-    return input; // Below threshold
-  }
-  
-  // Soft knee using power function
-  float over_amount = fabsf(input) - threshold_linear;
-  float clipped_amount = powf(over_amount / threshold_linear, 1.0f / ratio);
-  
-  if (input > 0) {
-    return threshold_linear + clipped_amount * threshold_linear;
-  } else {
-    return -(threshold_linear + clipped_amount * threshold_linear);
-  }
-}
-
 // Update peak and RMS level meters
 void update_level_meters(float *stereo, int frames, float *peak_level, float *rms_level) {
   float peak_L = 0.0f, peak_R = 0.0f;
@@ -77,19 +49,12 @@ static void calculate_coefficients(BusCompressor *comp, float attack_ms, float r
 }
 
 void mixer_init(Mixer *mixer) {
-  // Set oscillator gains
-  mixer->osc_gain[0] = 1.0f;  // OSC 1 - full volume
-  mixer->osc_gain[1] = 1.0f;  // OSC 2 - full volume
-  mixer->osc_gain[2] = 1.0f;  // OSC 3 - full volume
-  mixer->osc_gain[3] = 1.0f;  // OSC 4 - full volume
-  
   mixer->master = 0.25f;  // Reduced from 1.0f to 0.25f
   mixer->master_pan = 0.0f; // Center pan by default
   mixer->master_width = 1.0f; // Full stereo width by default
   
   // Initialize bus compressor
-  mixer->compressor.envelope_L = 0.0f;
-  mixer->compressor.envelope_R = 0.0f;
+  mixer->compressor.envelope = 0.0f;
   mixer->compressor.gain_reduction = 0.0f;
   mixer->compressor.sample_rate = 48000;
   
@@ -99,6 +64,7 @@ void mixer_init(Mixer *mixer) {
   mixer->comp_attack = 10.0f;        // 10ms attack
   mixer->comp_release = 100.0f;      // 100ms release
   mixer->comp_makeup_gain = 6.0f;    // Increased from 3.0dB to 6.0dB makeup gain
+  mixer->comp_detector = COMP_DETECT_PEAK;
   mixer->comp_enabled = 0;           // Disabled by default (changed from 1 to 0)
   
   // Initialize mastering parameters
@@ -108,203 +74,294 @@ void mixer_init(Mixer *mixer) {
   mixer->soft_clip_threshold = -3.0f;   // -3dB soft clipping threshold
   mixer->soft_clip_ratio = 2.0f;          // Soft clipping ratio
   mixer->auto_gain_enabled = 0;         // Auto gain disabled by default
-  mixer->auto_gain_target = -6.0f;         // -6dB target level
+  mixer->auto_gain_target = -14.0f;        // -14 LUFS target loudness
+  mixer->limiter_enabled = 1;
+  mixer->limiter_ceiling = -1.0f;           // -1 dBTP
+  mixer->limiter_release = 50.0f;
   mixer->peak_level = 0.0f;
   mixer->rms_level = 0.0f;
   
   // Initialize auto gain state
   mixer->auto_gain_gain = 1.0f;
-  mixer->gain_smoothing_coeff = 0.9995f; // More gentle smoothing
+  mixer->auto_gain_seconds = 1.0f;
+  mixer->auto_gain_active = 0;
+  mixer->loudness_reset_request = 0;
   mixer->dc_filter_state_L = 0.0f;
   mixer->dc_filter_state_R = 0.0f;
+  mixer->dc_filter_prev_L = 0.0f;
+  mixer->dc_filter_prev_R = 0.0f;
+  limiter_init(&mixer->limiter, mixer->compressor.sample_rate);
+  loudness_init(&mixer->loudness, mixer->compressor.sample_rate);
+  loudness_init(&mixer->input_loudness, mixer->compressor.sample_rate);
+  mixer->num_stages = 0;
+  mixer->limiter_running = 0;
+  mixer->dirty = 1;
 }
 
 void mixer_set_sample_rate(Mixer *mixer, int sample_rate) {
   mixer->compressor.sample_rate = sample_rate;
-  calculate_coefficients(&mixer->compressor, mixer->comp_attack, mixer->comp_release, sample_rate);
+  limiter_init(&mixer->limiter, sample_rate);
+  loudness_init(&mixer->loudness, sample_rate);
+  loudness_init(&mixer->input_loudness, sample_rate);
+  mixer->dirty = 1;
   
   // Reset auto gain state when sample rate changes
   mixer->auto_gain_gain = 1.0f;
   mixer->dc_filter_state_L = 0.0f;
   mixer->dc_filter_state_R = 0.0f;
+  mixer->dc_filter_prev_L = 0.0f;
+  mixer->dc_filter_prev_R = 0.0f;
 }
 
-static float process_compressor_channel(BusCompressor *comp, float input, float *envelope, 
-                                      float threshold_linear, float ratio, float makeup_linear) {
-  // Envelope detection (peak detector with attack/release)
-  float input_level = fabsf(input);
-  
-  if (input_level > *envelope) {
-    // Attack: faster response to peaks
-    *envelope = input_level + ((*envelope - input_level) * comp->attack_coeff);
-  } else {
-    // Release: slower response to level drops
-    *envelope = input_level + ((*envelope - input_level) * comp->release_coeff);
-  }
-  
-  // Compute gain reduction
-  float gain_reduction = 1.0f;
-  if (*envelope > threshold_linear) {
-    // Calculate compression
-    float over_threshold = *envelope / threshold_linear;
-    float compressed_level = powf(over_threshold, 1.0f / ratio);
-    gain_reduction = compressed_level / over_threshold;
+// Stages run over the whole block in order; each is a tight loop with no
+// parameter conversions inside
+
+static void stage_gain(Mixer *mixer, float *stereo, int frames) {
+  const float g = mixer->block_gain;
+  for (int n = 0; n < frames * 2; ++n)
+    stereo[n] *= g;
+}
+
+static void stage_pan(Mixer *mixer, float *stereo, int frames) {
+  const float gl = mixer->pan_gain_L, gr = mixer->pan_gain_R;
+  for (int n = 0; n < frames; ++n) {
+    stereo[n * 2 + 0] *= gl;
+    stereo[n * 2 + 1] *= gr;
   }
-  
-  // Apply compression and makeup gain
-  return input * gain_reduction * makeup_linear;
 }
 
-void mixer_apply(Mixer *mixer, float *stereo, int frames) {
-  // Calculate levels BEFORE any processing for accurate auto gain measurement
-  if (mixer->auto_gain_enabled) {
-    update_level_meters(stereo, frames, &mixer->peak_level, &mixer->rms_level);
-    
-    // Calculate required gain to reach target with safe limits
-    float current_level_db = mixer->rms_level;
-    float target_level_db = mixer->auto_gain_target;
-    float level_diff_db = target_level_db - current_level_db;
-    
-    // Limit maximum gain change per buffer to prevent clipping
-    const float MAX_GAIN_PER_UPDATE = 1.1f; // Maximum +0.83dB per update
-    const float MAX_AUTO_GAIN = 4.0f;       // Maximum 12dB total gain
-    
-    // Calculate safe gain ratio (relative, not absolute)
-    float level_ratio = powf(10.0f, level_diff_db / 40.0f); // Half the dB range for safety
-    level_ratio = fminf(level_ratio, MAX_GAIN_PER_UPDATE);
-    level_ratio = fmaxf(level_ratio, 1.0f / MAX_GAIN_PER_UPDATE); // Also limit reduction
-    
-    // Smooth gain changes to avoid artifacts
-    float smoothing_factor = 1.0f - mixer->gain_smoothing_coeff;
-    mixer->auto_gain_gain += (level_ratio - mixer->auto_gain_gain) * smoothing_factor;
-    
-    // Clamp total gain to prevent clipping
-    mixer->auto_gain_gain = fminf(mixer->auto_gain_gain, MAX_AUTO_GAIN);
-    mixer->auto_gain_gain = fmaxf(mixer->auto_gain_gain, 0.1f); // Minimum gain
+// Mid/side width: 0 = mono, 1 = unchanged, 2 = wide
+static void stage_width(Mixer *mixer, float *stereo, int frames) {
+  const float w = mixer->master_width;
+  for (int n = 0; n < frames; ++n) {
+    float mid = (stereo[n * 2 + 0] + stereo[n * 2 + 1]) * 0.5f;
+    float side = (stereo[n * 2 + 0] - stereo[n * 2 + 1]) * 0.5f * w;
+    stereo[n * 2 + 0] = mid + side;
+    stereo[n * 2 + 1] = mid - side;
   }
-  
-  // Apply all processing in single pass for each sample
-  for (int n = 0; n < frames * 2; n += 2) { // Process stereo pairs
-    // Get current samples
-    float left = stereo[n];
-    float right = stereo[n + 1];
-    
-    // Apply master gain first
-    left *= mixer->master;
-    right *= mixer->master;
-    
-    // Apply auto gain control (calculated before loop)
-    if (mixer->auto_gain_enabled) {
-      left *= mixer->auto_gain_gain;
-      right *= mixer->auto_gain_gain;
-    }
-    
-    // Apply master panning using constant-power pan law (FIXED: no extra gain)
-    float pan = mixer->master_pan;
-    float pan_norm = fabsf(pan);
-    
-    if (pan_norm > 0.0001f) { // Only apply panning if not centered
-      // Calculate pan gains using equal-power pan law
-      float pan_angle = (pan + 1.0f) * M_PI * 0.25f; // Map -1..1 to 0..PI/2
-      float left_gain = fastcos(pan_angle);
-      float right_gain = fastsin(pan_angle);
-      
-      // Apply panning to stereo channels (FIXED: removed sqrtf(2.0f) amplification)
-      left *= left_gain;
-      right *= right_gain;
-    }
-    
-    // Apply stereo width (mid-side processing) with NO amplification
-    float width = mixer->master_width;
-    if (width > 0.0001f) { // Only apply width if not mono
-      // Calculate mid/side from left/right
-      float mid = (left + right) * 0.5f;
-      float side = (left - right) * 0.5f;
-      
-      // Apply width factor (0.0 = mono, 1.0 = normal stereo, 2.0 = wide stereo)
-      float width_factor = 1.0f + (width - 1.0f);
-      
-      // Reconstruct from mid/side (FIXED: removed * 2.0f amplification)
-      left = mid - side * width_factor;
-      right = mid + side * width_factor;
-    }
-    
-    // Apply bus compressor if enabled
-    if (mixer->comp_enabled) {
-      float threshold_linear = db_to_linear(mixer->comp_threshold);
-      float makeup_linear = db_to_linear(mixer->comp_makeup_gain);
-      
-      // Process each channel through compressor
-      left = process_compressor_channel(&mixer->compressor, left, 
-                                                      &mixer->compressor.envelope_L, 
-                                                      threshold_linear, mixer->comp_ratio, makeup_linear);
-      right = process_compressor_channel(&mixer->compressor, right, 
-                                                       &mixer->compressor.envelope_R, 
-                                                       threshold_linear, mixer->comp_ratio, makeup_linear);
-    }
-    
-    // Apply DC offset filter
-    if (mixer->dc_filter_enabled) {
-      left = dc_filter_process(left, &mixer->dc_filter_state_L, mixer->dc_filter_freq, (float)mixer->compressor.sample_rate);
-      right = dc_filter_process(right, &mixer->dc_filter_state_R, mixer->dc_filter_freq, (float)mixer->compressor.sample_rate);
+}
+
+// Stereo-linked: one detector over both channels drives a common gain so the
+// image doesn't shift. Peak mode follows max(|L|, |R|), RMS mode the mean
+// power. The gain is computed in the log2 domain and skipped entirely while
+// the envelope is under the threshold.
+static void stage_compressor(Mixer *mixer, float *stereo, int frames) {
+  BusCompressor *comp = &mixer->compressor;
+  const float att = comp->attack_coeff, rel = comp->release_coeff;
+  const float thr = mixer->comp_threshold_detect;
+  const float thr_log2 = mixer->comp_threshold_log2;
+  const float slope = mixer->comp_slope * mixer->comp_detect_scale;
+  const float makeup = mixer->comp_makeup_linear;
+  const int rms = mixer->comp_detector == COMP_DETECT_RMS;
+  float env = comp->envelope;
+  float min_gain_log2 = 0.0f;
+
+  for (int n = 0; n < frames; ++n) {
+    float l = stereo[n * 2 + 0], r = stereo[n * 2 + 1];
+    float level = rms ? 0.5f * (l * l + r * r) : fmaxf(fabsf(l), fabsf(r));
+    float coeff = level > env ? att : rel;
+    env = level + (env - level) * coeff;
+
+    float gain = makeup;
+    if (env > thr) {
+      float gain_log2 = (fast_log2f(env) - thr_log2) * slope;
+      if (gain_log2 < min_gain_log2)
+        min_gain_log2 = gain_log2;
+      gain *= fast_exp2f(gain_log2);
     }
-    
-    // Apply soft clipping
-    if (mixer->soft_clip_enabled) {
-      left = soft_clip_process(left, mixer->soft_clip_threshold, mixer->soft_clip_ratio);
-      right = soft_clip_process(right, mixer->soft_clip_threshold, mixer->soft_clip_ratio);
+    stereo[n * 2 + 0] = l * gain;
+    stereo[n * 2 + 1] = r * gain;
+  }
+
+  comp->envelope = env;
+  comp->gain_reduction = min_gain_log2 * 6.0206f; // dB, for display
+}
+
+// One-pole RC high-pass: y = a * (y1 + x - x1)
+static void stage_dc_filter(Mixer *mixer, float *stereo, int frames) {
+  const float a = mixer->dc_coeff;
+  float yl = mixer->dc_filter_state_L, yr = mixer->dc_filter_state_R;
+  float xl1 = mixer->dc_filter_prev_L, xr1 = mixer->dc_filter_prev_R;
+  for (int n = 0; n < frames; ++n) {
+    float xl = stereo[n * 2 + 0], xr = stereo[n * 2 + 1];
+    yl = a * (yl + xl - xl1);
+    yr = a * (yr + xr - xr1);
+    xl1 = xl;
+    xr1 = xr;
+    stereo[n * 2 + 0] = yl;
+    stereo[n * 2 + 1] = yr;
+  }
+  mixer->dc_filter_state_L = yl;
+  mixer->dc_filter_state_R = yr;
+  mixer->dc_filter_prev_L = xl1;
+  mixer->dc_filter_prev_R = xr1;
+}
+
+// Soft knee above the threshold: T * (1 + ((|x| - T) / T)^(1/ratio))
+static void stage_soft_clip(Mixer *mixer, float *stereo, int frames) {
+  const float t = mixer->soft_clip_linear;
+  const float inv_t = mixer->soft_clip_inv_linear;
+  const float inv_ratio = mixer->soft_clip_inv_ratio;
+  for (int n = 0; n < frames * 2; ++n) {
+    float x = stereo[n];
+    float a = fabsf(x);
+    if (a <= t)
+      continue;
+    float over = (a - t) * inv_t;
+    float y = t * (1.0f + fast_exp2f(inv_ratio * fast_log2f(over)));
+    stereo[n] = x > 0.0f ? y : -y;
+  }
+}
+
+static void mixer_take_snapshot(const Mixer *mixer, MixerParamSnapshot *snap) {
+  memset(snap, 0, sizeof(*snap));
+  snap->master_pan = mixer->master_pan;
+  snap->master_width = mixer->master_width;
+  snap->comp_threshold = mixer->comp_threshold;
+  snap->comp_ratio = mixer->comp_ratio;
+  snap->comp_attack = mixer->comp_attack;
+  snap->comp_release = mixer->comp_release;
+  snap->comp_makeup_gain = mixer->comp_makeup_gain;
+  snap->dc_filter_freq = mixer->dc_filter_freq;
+  snap->soft_clip_threshold = mixer->soft_clip_threshold;
+  snap->soft_clip_ratio = mixer->soft_clip_ratio;
+  snap->limiter_ceiling = mixer->limiter_ceiling;
+  snap->limiter_release = mixer->limiter_release;
+  snap->comp_enabled = mixer->comp_enabled;
+  snap->comp_detector = mixer->comp_detector;
+  snap->dc_filter_enabled = mixer->dc_filter_enabled;
+  snap->soft_clip_enabled = mixer->soft_clip_enabled;
+  snap->limiter_enabled = mixer->limiter_enabled;
+  snap->sample_rate = mixer->compressor.sample_rate;
+}
+
+// Recompute every coefficient and the list of active stages
+static void mixer_rebuild(Mixer *mixer) {
+  float sr = (float)mixer->compressor.sample_rate;
+  int count = 0;
+
+  mixer->stages[count++] = stage_gain;
+
+  // Constant-power pan law
+  if (fabsf(mixer->master_pan) > 0.0001f) {
+    float pan_angle = (mixer->master_pan + 1.0f) * (float)M_PI * 0.25f;
+    mixer->pan_gain_L = cosf(pan_angle);
+    mixer->pan_gain_R = sinf(pan_angle);
+    mixer->stages[count++] = stage_pan;
+  }
+
+  if (fabsf(mixer->master_width - 1.0f) > 0.0001f)
+    mixer->stages[count++] = stage_width;
+
+  if (mixer->comp_enabled) {
+    BusCompressor *comp = &mixer->compressor;
+    calculate_coefficients(comp, fmaxf(mixer->comp_attack, 0.01f),
+                           fmaxf(mixer->comp_release, 0.01f), comp->sample_rate);
+    float threshold = db_to_linear(mixer->comp_threshold);
+    if (mixer->comp_detector == COMP_DETECT_RMS) {
+      mixer->comp_threshold_detect = threshold * threshold;
+      mixer->comp_detect_scale = 0.5f;
+    } else {
+      mixer->comp_threshold_detect = threshold;
+      mixer->comp_detect_scale = 1.0f;
     }
-    
-    // FINAL HARD CLIP PROTECTION - prevent exceeding 0dBFS
-    left = fmaxf(-1.0f, fminf(1.0f, left));
-    right = fmaxf(-1.0f, fminf(1.0f, right));
-    
-    // Write back to buffer
-    stereo[n] = left;
-    stereo[n + 1] = right;
+    mixer->comp_threshold_log2 = log2f(mixer->comp_threshold_detect);
+    mixer->comp_slope = 1.0f / fmaxf(mixer->comp_ratio, 1.0f) - 1.0f;
+    mixer->comp_makeup_linear = db_to_linear(mixer->comp_makeup_gain);
+    mixer->stages[count++] = stage_compressor;
+  } else {
+    mixer->compressor.gain_reduction = 0.0f;
+  }
+
+  if (mixer->dc_filter_enabled) {
+    float rc = 1.0f / (2.0f * (float)M_PI * fmaxf(mixer->dc_filter_freq, 0.1f));
+    mixer->dc_coeff = rc / (rc + 1.0f / sr);
+    mixer->stages[count++] = stage_dc_filter;
   }
+
+  if (mixer->soft_clip_enabled) {
+    mixer->soft_clip_linear = db_to_linear(mixer->soft_clip_threshold);
+    mixer->soft_clip_inv_linear = 1.0f / mixer->soft_clip_linear;
+    mixer->soft_clip_inv_ratio = 1.0f / fmaxf(mixer->soft_clip_ratio, 0.01f);
+    mixer->stages[count++] = stage_soft_clip;
+  }
+
+  // The limiter itself runs in mixer_master(), after the effects
+  if (mixer->limiter_enabled) {
+    // Coming back from bypass: drop whatever was left in the look-ahead
+    if (!mixer->limiter_running)
+      limiter_init(&mixer->limiter, mixer->compressor.sample_rate);
+    limiter_set_params(&mixer->limiter, mixer->limiter_ceiling, mixer->limiter_release);
+  } else {
+    mixer->limiter.gain_reduction = 0.0f;
+  }
+  mixer->limiter_running = mixer->limiter_enabled;
+
+  mixer->num_stages = count;
+  mixer->dirty = 0;
 }
 
-void mixer_set_param(Mixer *mixer, const char *param, float value) {
-  if (strncmp(param, "osc", 3) == 0) {
-    int i = param[3] - '1';
-    if (i >= 0 && i < 4)
-      mixer->osc_gain[i] = value;
-  } else if (!strcmp(param, "master")) {
-    mixer->master = value;
-  } else if (!strcmp(param, "master.pan")) {
-    mixer->master_pan = value;
-  } else if (!strcmp(param, "master.width")) {
-    mixer->master_width = value;
-  } else if (!strcmp(param, "comp.threshold")) {
-    mixer->comp_threshold = value;
-  } else if (!strcmp(param, "comp.ratio")) {
-    mixer->comp_ratio = value;
-  } else if (!strcmp(param, "comp.attack")) {
-    mixer->comp_attack = value;
-    calculate_coefficients(&mixer->compressor, mixer->comp_attack, mixer->comp_release, 
-                          mixer->compressor.sample_rate);
-  } else if (!strcmp(param, "comp.release")) {
-    mixer->comp_release = value;
-    calculate_coefficients(&mixer->compressor, mixer->comp_attack, mixer->comp_release, 
-                          mixer->compressor.sample_rate);
-  } else if (!strcmp(param, "comp.makeup")) {
-    mixer->comp_makeup_gain = value;
-  } else if (!strcmp(param, "comp.enabled")) {
-    mixer->comp_enabled = (int)value;
-  } else if (!strcmp(param, "dc.filter.enabled")) {
-    mixer->dc_filter_enabled = (int)value;
-  } else if (!strcmp(param, "dc.filter.freq")) {
-    mixer->dc_filter_freq = value;
-  } else if (!strcmp(param, "soft.clip.enabled")) {
-    mixer->soft_clip_enabled = (int)value;
-  } else if (!strcmp(param, "soft.clip.threshold")) {
-    mixer->soft_clip_threshold = value;
-  } else if (!strcmp(param, "soft.clip.ratio")) {
-    mixer->soft_clip_ratio = value;
-  } else if (!strcmp(param, "auto.gain.enabled")) {
-    mixer->auto_gain_enabled = (int)value;
-  } else if (!strcmp(param, "auto.gain.target")) {
-    mixer->auto_gain_target = value;
+// Auto gain follows the K-weighted loudness of the bus input (short-term once
+// 3 s are measured, momentary before that) and sets the gain that brings the
+// output, including the master volume, to the LUFS target
+static void update_auto_gain(Mixer *mixer, const float *stereo, int frames) {
+  const float MAX_AUTO_GAIN = 4.0f;       // Maximum 12dB total gain
+  const float MIN_AUTO_GAIN = 0.1f;
+
+  if (!mixer->auto_gain_active) {
+    loudness_reset(&mixer->input_loudness);
+    mixer->auto_gain_active = 1;
+  }
+  loudness_process(&mixer->input_loudness, stereo, frames);
+
+  const LoudnessMeter *in = &mixer->input_loudness;
+  float level = in->short_term > LOUDNESS_SILENCE ? in->short_term : in->momentary;
+  if (level < LOUDNESS_HIST_MIN)
+    return; // Hold the gain through silence instead of raising the noise floor
+
+  float master_db = linear_to_db(fmaxf(mixer->master, 0.000001f));
+  float wanted = db_to_linear(mixer->auto_gain_target - level - master_db);
+  wanted = fmaxf(MIN_AUTO_GAIN, fminf(MAX_AUTO_GAIN, wanted));
+
+  float seconds = fmaxf(mixer->auto_gain_seconds, 0.01f);
+  float coeff = expf(-(float)frames / (seconds * (float)mixer->compressor.sample_rate));
+  mixer->auto_gain_gain = wanted + (mixer->auto_gain_gain - wanted) * coeff;
+}
+
+void mixer_apply(Mixer *mixer, float *stereo, int frames) {
+  if (mixer->auto_gain_enabled)
+    update_auto_gain(mixer, stereo, frames);
+  else
+    mixer->auto_gain_active = 0;
+
+  MixerParamSnapshot snap;
+  mixer_take_snapshot(mixer, &snap);
+  if (mixer->dirty || memcmp(&snap, &mixer->snapshot, sizeof(snap)) != 0) {
+    mixer->snapshot = snap;
+    mixer_rebuild(mixer);
+  }
+
+  mixer->block_gain = mixer->master * (mixer->auto_gain_enabled ? mixer->auto_gain_gain : 1.0f);
+  for (int i = 0; i < mixer->num_stages; ++i)
+    mixer->stages[i](mixer, stereo, frames);
+}
+
+// Last writer of the output buffer, after ring mod and the effects, so
+// nothing they add can pass the ceiling or 0 dBFS, and the meters read
+// exactly what goes out
+void mixer_master(Mixer *mixer, float *stereo, int frames) {
+  if (mixer->limiter_running)
+    limiter_process(&mixer->limiter, stereo, frames);
+
+  // Final protection against exceeding 0 dBFS
+  for (int n = 0; n < frames * 2; ++n)
+    stereo[n] = fmaxf(-1.0f, fminf(1.0f, stereo[n]));
+
+  // Output metering
+  if (mixer->loudness_reset_request) {
+    mixer->loudness_reset_request = 0;
+    loudness_reset(&mixer->loudness);
   }
+  loudness_process(&mixer->loudness, stereo, frames);
+  update_level_meters(stereo, frames, &mixer->peak_level, &mixer->rms_level);
 }
@@ -1,18 +1,40 @@
 #pragma once
 #include <math.h>
+#include "limiter.h"
+#include "loudness.h"
+
+#define MIXER_MAX_STAGES 8
+
+typedef struct Mixer Mixer;
+typedef void (*MixerStageFn)(Mixer *mixer, float *stereo, int frames);
+
+// Parameters that derived coefficients depend on. Compared once per block so
+// direct writes (e.g. from the GUI) trigger a rebuild just like the param registry.
+typedef struct {
+  float master_pan, master_width;
+  float comp_threshold, comp_ratio, comp_attack, comp_release, comp_makeup_gain;
+  float dc_filter_freq, soft_clip_threshold, soft_clip_ratio;
+  float limiter_ceiling, limiter_release;
+  int comp_enabled, comp_detector, dc_filter_enabled, soft_clip_enabled, limiter_enabled;
+  int sample_rate;
+} MixerParamSnapshot;
+
+// Compressor level detectors
+enum {
+  COMP_DETECT_PEAK = 0,
+  COMP_DETECT_RMS = 1
+};
 
 typedef struct {
-  // Bus compressor state
-  float envelope_L;
-  float envelope_R;
+  // Bus compressor state (stereo-linked: one envelope drives both channels)
+  float envelope;
   float gain_reduction;
   float attack_coeff;
   float release_coeff;
   int sample_rate;
 } BusCompressor;
 
-typedef struct {
-  float osc_gain[4];
+struct Mixer {
   float master;
   float master_pan;     // Stereo panning for master (-1.0 left to +1.0 right, 0.0 center)
   float master_width;    // Stereo width for master (0.0 mono to 2.0 max)
@@ -26,6 +48,7 @@ typedef struct {
   float comp_attack;       // seconds
   float comp_release;      // seconds
   float comp_makeup_gain;  // dB
+  int comp_detector;       // COMP_DETECT_PEAK or COMP_DETECT_RMS
   int comp_enabled;
   
   // Mastering parameters
@@ -34,26 +57,58 @@ typedef struct {
   int soft_clip_enabled;       // Soft clipping enabled
   float soft_clip_threshold;   // Soft clipping threshold (dB)
   float soft_clip_ratio;        // Soft clipping ratio (knee softness)
-  int auto_gain_enabled;        // Auto gain control enabled
-  float auto_gain_target;       // Target level for auto gain (dB)
+  int auto_gain_enabled;        // Loudness-based auto gain enabled
+  float auto_gain_target;       // Target loudness for auto gain (LUFS)
+  int limiter_enabled;          // True-peak limiter before the final clip
+  float limiter_ceiling;        // True-peak ceiling (dBTP)
+  float limiter_release;        // Limiter recovery time (ms)
   float peak_level;             // Current peak level (for display)
   float rms_level;              // Current RMS level (for display)
   
   // Auto gain mastering state
   float auto_gain_gain;
-  float gain_smoothing_coeff;
+  float auto_gain_seconds;      // Time constant of gain changes
+  int auto_gain_active;         // Previous block had auto gain on
+  LoudnessMeter input_loudness; // Pre-gain loudness that auto gain follows
+
+  // Output loudness (EBU R128), always running
+  LoudnessMeter loudness;
+  int loudness_reset_request;   // Set by the GUI, cleared on the audio thread
   float dc_filter_state_L;
   float dc_filter_state_R;
-} Mixer;
+  float dc_filter_prev_L;
+  float dc_filter_prev_R;
+  Limiter limiter;
+  int limiter_running;          // Limiter set up for mixer_master()
+
+  // Stage graph: only enabled stages, rebuilt when a parameter changes
+  MixerStageFn stages[MIXER_MAX_STAGES];
+  int num_stages;
+  MixerParamSnapshot snapshot;
+  int dirty;
+
+  // Coefficients derived in the rebuild, never in the per-sample loop
+  float block_gain;             // master * auto gain, per block
+  float pan_gain_L, pan_gain_R;
+  float comp_threshold_detect;  // Threshold in the detector's domain (level or power)
+  float comp_threshold_log2;
+  float comp_detect_scale;      // 1 for peak, 0.5 to turn log2 power into log2 level
+  float comp_slope;             // 1/ratio - 1, gain change per log2 unit over threshold
+  float comp_makeup_linear;
+  float dc_coeff;
+  float soft_clip_linear;
+  float soft_clip_inv_linear;
+  float soft_clip_inv_ratio;
+};
 
 void mixer_init(Mixer *mixer);
+// Bus stages up to the soft clip, before ring mod and the effects
 void mixer_apply(Mixer *mixer, float *stereo, int frames);
-void mixer_set_param(Mixer *mixer, const char *param, float value);
+// Limiter, hard clip and output meters; the last stage of the output
+void mixer_master(Mixer *mixer, float *stereo, int frames);
 void mixer_set_sample_rate(Mixer *mixer, int sample_rate);
 
 // Mastering functions
-float dc_filter_process(float input, float *state, float cutoff_freq, float sample_rate);
-float soft_clip_process(float input, float threshold_db, float ratio);
 void update_level_meters(float *stereo, int frames, float *peak_level, float *rms_level);
 
 // Utility functions
@@ -0,0 +1,65 @@
+#include "mpe.h"
+
+static void mpe_reset_channel(MpeChannel *c) {
+  c->bend = 0.0f;
+  c->pressure = 0.0f;
+  c->timbre = 1.0f;
+}
+
+void mpe_init(Mpe *mpe) {
+  for (int z = 0; z < 2; ++z) {
+    mpe->members[z] = 0;
+    mpe->bend_range[z] = MPE_MEMBER_BEND_RANGE;
+  }
+  for (int c = 0; c < MIDI_CHANNELS; ++c) {
+    mpe_reset_channel(&mpe->channels[c]);
+    mpe->rpn[c] = MPE_RPN_NONE;
+  }
+}
+
+int mpe_zone(int manager) { return manager == MPE_UPPER_MANAGER ? 1 : 0; }
+
+void mpe_set_zone(Mpe *mpe, int manager, int members) {
+  int zone = mpe_zone(manager);
+  members = members < 0 ? 0 : (members > 15 ? 15 : members);
+  mpe->members[zone] = members;
+  mpe->bend_range[zone] = MPE_MEMBER_BEND_RANGE;
+
+  // The two zones share channels 2-15; a full zone also takes the other
+  // manager channel, which disables that zone
+  int other = 1 - zone;
+  if (members == 15)
+    mpe->members[other] = 0;
+  else if (mpe->members[other] > 14 - members)
+    mpe->members[other] = 14 - members;
+
+  for (int c = 0; c < MIDI_CHANNELS; ++c)
+    mpe_reset_channel(&mpe->channels[c]);
+}
+
+int mpe_manager(const Mpe *mpe, int channel) {
+  if (channel > MPE_LOWER_MANAGER && channel <= mpe->members[0])
+    return MPE_LOWER_MANAGER;
+  if (channel < MPE_UPPER_MANAGER && channel >= MPE_UPPER_MANAGER - mpe->members[1])
+    return MPE_UPPER_MANAGER;
+  return -1;
+}
+
+int mpe_rpn_control(Mpe *mpe, int channel, int cc, int value) {
+  int *rpn = &mpe->rpn[channel];
+  switch (cc) {
+  case 101: // RPN MSB
+    *rpn = (value << 7) | (*rpn & 0x7F);
+    return -1;
+  case 100: // RPN LSB
+    *rpn = (*rpn & ~0x7F) | value;
+    return -1;
+  case 98: // An NRPN deselects the RPN
+  case 99:
+    *rpn = MPE_RPN_NONE;
+    return -1;
+  case 6: // Data entry MSB
+    return *rpn == MPE_RPN_NONE ? -1 : *rpn;
+  }
+  return -1;
+}
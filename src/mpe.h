@@ -0,0 +1,51 @@
+#pragma once
+#include "midi_map.h"
+
+// MIDI Polyphonic Expression zones. The lower zone is managed from
+// channel 1 and plays notes on channels 2 and up, the upper zone from
+// channel 16 with its member channels counting down. A controller gives
+// every note a member channel of its own, so pitch bend, pressure and
+// CC 74 (timbre) on that channel shape just that note, while messages on
+// the manager channel reach the whole zone. Zones are set by the MPE
+// Configuration Message (RPN 6 on a manager channel) or the mpe.lower and
+// mpe.upper params.
+#define MPE_LOWER_MANAGER 0
+#define MPE_UPPER_MANAGER 15
+#define MPE_MEMBER_BEND_RANGE 48.0f   // Default member pitch bend, semitones
+#define MPE_TIMBRE_CC 74
+#define MPE_RPN_NONE 0x3FFF           // RPN 127/127 deselects
+
+// Expression last sent on a member channel. A note starts from it, so a
+// controller may send its initial timbre or bend just before the note on.
+typedef struct {
+  float bend;                   // -1 to 1 of the zone's member bend range
+  float pressure;               // 0-1
+  float timbre;                 // 0-1, 1 leaves the tone open
+} MpeChannel;
+
+typedef struct {
+  int members[2];               // Member channels of the lower and upper zone, 0 = off
+  float bend_range[2];          // Member pitch bend in semitones, per zone
+  MpeChannel channels[MIDI_CHANNELS];
+  int rpn[MIDI_CHANNELS];       // Selected registered parameter (MSB << 7 | LSB)
+} Mpe;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mpe_init(Mpe *mpe);
+// manager is MPE_LOWER_MANAGER or MPE_UPPER_MANAGER; members 0-15. An
+// overlapping other zone shrinks to fit, as the MPE spec asks.
+void mpe_set_zone(Mpe *mpe, int manager, int members);
+// Manager channel of the zone a channel (0-15) is a member of, or -1
+int mpe_manager(const Mpe *mpe, int channel);
+// Zone index (0 lower, 1 upper) of a manager channel
+int mpe_zone(int manager);
+// Tracks RPN selection from CC 101/100. Returns the selected RPN when cc
+// is data entry (CC 6), or -1 when the CC is not part of an RPN.
+int mpe_rpn_control(Mpe *mpe, int channel, int cc, int value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,27 +15,7 @@ void osc_init(Oscillator *osc, float samplerate) {
   osc->pulse_width = 0.5f;
   osc->unison_detune = 0.1f;
   osc->unison_voices = 1;
-}
-
-void osc_set_param(Oscillator *osc, const char *param, float value) {
-  if (strcmp(param, "waveform") == 0)
-    osc->waveform = (OscWaveform)((int)value);
-  else if (strcmp(param, "pitch") == 0)
-    osc->pitch = value;
-  else if (strcmp(param, "phase") == 0)
-    osc->phase = value;
-  else if (strcmp(param, "detune") == 0)
-    osc->detune = value;
-  else if (strcmp(param, "gain") == 0)
-    osc->gain = value;
-  else if (strcmp(param, "pulse_width") == 0)
-    osc->pulse_width = value;
-  else if (strcmp(param, "unison_detune") == 0)
-    osc->unison_detune = value;
-  else if (strcmp(param, "unison_voices") == 0)
-    osc->unison_voices = (int)(value + 0.5f); // Round to nearest int
-  else if (strcmp(param, "pan") == 0)
-    osc->pan = value;
+  osc->rng = rng_seed(0);
 }
 
 float osc_process(Oscillator *osc, float note, float *phase_acc) {
@@ -86,7 +66,7 @@ float osc_process(Oscillator *osc, float note, float *phase_acc) {
       voice_output = 4.0f * fabsf(p - 0.5f) - 1.0f;
       break;
     case OSC_NOISE:
-      voice_output = (float)rand() / (float)RAND_MAX * 2.0f - 1.0f; // White noise
+      voice_output = rng_float(&osc->rng) * 2.0f - 1.0f; // White noise
       break;
     default:
       voice_output = 0.0f;
@@ -17,8 +17,8 @@ typedef struct Oscillator {
   float pulse_width; // For square wave pulse width modulation (0.1 to 0.9)
   float unison_detune; // Unison spread amount (0 to 1)
   int unison_voices;   // Number of unison voices (1 to 8)
+  unsigned int rng;    // Noise state
 } Oscillator;
 
 void osc_init(Oscillator *osc, float samplerate);
-void osc_set_param(Oscillator *osc, const char *param, float value);
 float osc_process(Oscillator *osc, float note, float *phase_acc);
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "oscilloscope.h"
+#include "fft.h"
 #include "synth.h"
 #include <math.h>
 #include <stdlib.h>
@@ -9,142 +10,350 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-#define WAVEFORM_BUFFER_SIZE 2048
+// Audio to GUI handoff: single-producer, single-consumer ring of stereo
+// frames. The audio thread copies whole blocks in and publishes one index;
+// everything else happens on the GUI thread.
+static float scope_ring[SCOPE_RING_FRAMES * 2];
+static SDL_atomic_t scope_write_pos;     // Frames written (audio thread)
+static SDL_atomic_t scope_read_pos;      // Frames consumed (GUI thread)
 
-// for waveform
-static float waveform_buffer[WAVEFORM_BUFFER_SIZE];
+// GUI-side stereo history shared by the scope and the spectrum
+#define WAVEFORM_BUFFER_SIZE SCOPE_HISTORY_FRAMES
+static float waveform_buffer[WAVEFORM_BUFFER_SIZE * 2];
 static int waveform_write_pos = 0;
 static int buffer_ready = 0;
+static int spectrum_pending = 0;         // Frames not yet analyzed
+
+// Min/max decimation pyramid over the history, updated as frames arrive.
+// Each bucket is {min L, max L, min R, max R}; level k (from 1) summarizes
+// SCOPE_DECIMATION^k frames. Levels count buckets from the same start, so
+// the newest bucket of every level ends on a frame boundary of level 0.
+typedef struct {
+  float bucket[4];
+  int count;                             // Children merged so far
+} ScopeAccumulator;
+static float scope_pyramid[SCOPE_LEVELS - 1][SCOPE_HISTORY_FRAMES][4];
+static ScopeAccumulator scope_accumulator[SCOPE_LEVELS];
+static unsigned int scope_level_count[SCOPE_LEVELS]; // Buckets completed per level
+
+static Fft spectrum_fft;
+static int spectrum_ready = 0;
+static float spectrum_sample_rate = 48000.0f;
+static float spectrum_history[FFT_SIZE]; // Newest FFT_SIZE mono samples, oldest first
+static float spectrum_window[FFT_SIZE];
+static float spectrum_windowed[FFT_SIZE];
+static float spectrum_re[FFT_SIZE / 2 + 1];
+static float spectrum_im[FFT_SIZE / 2 + 1];
+static float spectrum_db[SPECTRUM_COLUMNS];
+// Bin range [col_lo, col_hi) per display column, with an interpolation
+// position for columns narrower than one bin
+static int spectrum_col_lo[SPECTRUM_COLUMNS];
+static int spectrum_col_hi[SPECTRUM_COLUMNS];
+static float spectrum_col_pos[SPECTRUM_COLUMNS];
+static unsigned char spectrum_palette[256][3];
+
+static void spectrum_build_columns(void) {
+  float bin_hz = spectrum_sample_rate / FFT_SIZE;
+  float max_hz = fminf(SPECTRUM_MAX_HZ, spectrum_sample_rate * 0.5f);
+  float ratio = max_hz / SPECTRUM_MIN_HZ;
+  for (int c = 0; c < SPECTRUM_COLUMNS; ++c) {
+    float f0 = SPECTRUM_MIN_HZ * powf(ratio, (float)c / SPECTRUM_COLUMNS);
+    float f1 = SPECTRUM_MIN_HZ * powf(ratio, (float)(c + 1) / SPECTRUM_COLUMNS);
+    int lo = (int)ceilf(f0 / bin_hz);
+    int hi = (int)ceilf(f1 / bin_hz);
+    if (hi > FFT_SIZE / 2 + 1)
+      hi = FFT_SIZE / 2 + 1;
+    spectrum_col_lo[c] = lo;
+    spectrum_col_hi[c] = hi;
+    spectrum_col_pos[c] = 0.5f * (f0 + f1) / bin_hz;
+  }
+}
+
+// Black -> blue -> magenta -> orange -> white
+static void spectrum_build_palette(void) {
+  static const float stops[5][3] = {
+    {0, 0, 0}, {20, 30, 140}, {170, 40, 150}, {250, 160, 40}, {255, 255, 230}};
+  for (int i = 0; i < 256; ++i) {
+    float t = i / 255.0f * 4.0f;
+    int k = t >= 4.0f ? 3 : (int)t;
+    float f = t - k;
+    for (int ch = 0; ch < 3; ++ch)
+      spectrum_palette[i][ch] = (unsigned char)(stops[k][ch] + (stops[k + 1][ch] - stops[k][ch]) * f);
+  }
+}
 
 void oscilloscope_init() {
-    // Initialize waveform buffer to 0
-    memset(waveform_buffer, 0, sizeof(waveform_buffer));
+  // Initialize waveform buffer to 0
+  memset(waveform_buffer, 0, sizeof(waveform_buffer));
+  waveform_write_pos = 0;
+  buffer_ready = 0;
+  memset(scope_pyramid, 0, sizeof(scope_pyramid));
+  memset(scope_accumulator, 0, sizeof(scope_accumulator));
+  memset(scope_level_count, 0, sizeof(scope_level_count));
+
+  if (spectrum_ready)
+    return;
+  if (!fft_init(&spectrum_fft, FFT_SIZE)) {
+    SDL_Log("Spectrum analyzer: failed to allocate FFT");
+    return;
+  }
+  for (int i = 0; i < FFT_SIZE; ++i)
+    spectrum_window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / FFT_SIZE);
+  for (int c = 0; c < SPECTRUM_COLUMNS; ++c)
+    spectrum_db[c] = SPECTRUM_MIN_DB;
+  spectrum_build_columns();
+  spectrum_build_palette();
+  spectrum_ready = 1;
 }
 
 void oscilloscope_shutdown() {
+  if (spectrum_ready) {
+    fft_cleanup(&spectrum_fft);
+    spectrum_ready = 0;
+  }
 }
 
-void oscilloscope_update_fft(float sample) {
-    (void)sample;
+void oscilloscope_set_sample_rate(float sample_rate) {
+  spectrum_sample_rate = sample_rate;
+  spectrum_build_columns();
 }
 
-void oscilloscope_feed(float sample) {
-  // Clamp sample to reasonable range
-  if (sample > 1.0f) sample = 1.0f;
-  if (sample < -1.0f) sample = -1.0f;
-  
-  waveform_buffer[waveform_write_pos] = sample;
-  waveform_write_pos = (waveform_write_pos + 1) % WAVEFORM_BUFFER_SIZE;
-  buffer_ready = 1;
+void oscilloscope_feed_block(const float *stereo, int frames) {
+  // Positions only ever grow; unsigned differences survive the wrap
+  unsigned int w = (unsigned int)SDL_AtomicGet(&scope_write_pos);
+  unsigned int r = (unsigned int)SDL_AtomicGet(&scope_read_pos);
+  unsigned int space = SCOPE_RING_FRAMES - (w - r);
+  // Drop frames rather than wait when the GUI falls behind
+  if ((unsigned int)frames > space)
+    frames = (int)space;
+  if (frames <= 0)
+    return;
+
+  int start = (int)(w & (SCOPE_RING_FRAMES - 1));
+  int first = SCOPE_RING_FRAMES - start;
+  if (first > frames)
+    first = frames;
+  memcpy(scope_ring + start * 2, stereo, sizeof(float) * 2 * first);
+  memcpy(scope_ring, stereo + first * 2, sizeof(float) * 2 * (frames - first));
+  SDL_MemoryBarrierRelease();
+  SDL_AtomicSet(&scope_write_pos, (int)(w + frames));
+}
 
+// Merge one bucket into 'level' and carry completed buckets upwards
+static void scope_pyramid_push(int level, const float *bucket) {
+  for (; level < SCOPE_LEVELS; ++level) {
+    ScopeAccumulator *acc = &scope_accumulator[level];
+    if (acc->count == 0) {
+      memcpy(acc->bucket, bucket, sizeof(acc->bucket));
+    } else {
+      acc->bucket[0] = fminf(acc->bucket[0], bucket[0]);
+      acc->bucket[1] = fmaxf(acc->bucket[1], bucket[1]);
+      acc->bucket[2] = fminf(acc->bucket[2], bucket[2]);
+      acc->bucket[3] = fmaxf(acc->bucket[3], bucket[3]);
+    }
+    if (++acc->count < SCOPE_DECIMATION)
+      return;
+    acc->count = 0;
+    float *dst = scope_pyramid[level - 1][scope_level_count[level] & (SCOPE_HISTORY_FRAMES - 1)];
+    memcpy(dst, acc->bucket, sizeof(acc->bucket));
+    scope_level_count[level]++;
+    bucket = dst;
+  }
 }
 
-// Simple draw_text helper
-static void draw_text(SDL_Renderer *renderer, const char *text, int x, int y,
-                      SDL_Color color, TTF_Font *font) {
-  if (!font)
+// GUI thread: move everything published so far into the stereo history
+static void scope_drain(void) {
+  unsigned int r = (unsigned int)SDL_AtomicGet(&scope_read_pos);
+  int available = (int)((unsigned int)SDL_AtomicGet(&scope_write_pos) - r);
+  if (available <= 0)
     return;
-  SDL_Surface *surf = TTF_RenderText_Blended(font, text, color);
-  if (surf) {
-    SDL_Texture *tex = SDL_CreateTextureFromSurface(renderer, surf);
-    if (tex) {
-      SDL_Rect dst = {x, y, surf->w, surf->h};
-      SDL_RenderCopy(renderer, tex, NULL, &dst);
-      SDL_DestroyTexture(tex);
+  SDL_MemoryBarrierAcquire();
+
+  // Only the newest history's worth matters
+  int n = available > WAVEFORM_BUFFER_SIZE ? WAVEFORM_BUFFER_SIZE : available;
+  r += available - n;
+  while (n > 0) {
+    int src = (int)(r & (SCOPE_RING_FRAMES - 1));
+    int chunk = n;
+    if (chunk > SCOPE_RING_FRAMES - src)
+      chunk = SCOPE_RING_FRAMES - src;
+    if (chunk > WAVEFORM_BUFFER_SIZE - waveform_write_pos)
+      chunk = WAVEFORM_BUFFER_SIZE - waveform_write_pos;
+    float *dst = waveform_buffer + waveform_write_pos * 2;
+    memcpy(dst, scope_ring + src * 2, sizeof(float) * 2 * chunk);
+    for (int i = 0; i < chunk; ++i) {
+      float frame[4] = {dst[i * 2], dst[i * 2], dst[i * 2 + 1], dst[i * 2 + 1]};
+      scope_pyramid_push(1, frame);
     }
-    SDL_FreeSurface(surf);
+    scope_level_count[0] += chunk;
+    waveform_write_pos = (waveform_write_pos + chunk) & (WAVEFORM_BUFFER_SIZE - 1);
+    spectrum_pending += chunk;
+    r += chunk;
+    n -= chunk;
   }
+  SDL_MemoryBarrierRelease();
+  SDL_AtomicSet(&scope_read_pos, (int)r);
+  buffer_ready = 1;
 }
 
-void oscilloscope_draw(SDL_Renderer *renderer, const struct Synth *synth,
-                        int x, int y, int w, int h, TTF_Font *font) {
-  (void)synth; // Not used in this implementation
+void oscilloscope_drain(void) {
+  scope_drain();
+}
+
+static inline float scope_mid(int idx) {
+  return 0.5f * (waveform_buffer[idx * 2 + 0] + waveform_buffer[idx * 2 + 1]);
+}
+
+int oscilloscope_spectrum_update(void) {
+  if (!spectrum_ready)
+    return 0;
+  scope_drain();
+  if (spectrum_pending == 0)
+    return 0;
+  spectrum_pending = 0;
+
+  // Mono mix of the newest FFT_SIZE frames
+  for (int i = 0; i < FFT_SIZE; ++i) {
+    int idx = (waveform_write_pos - FFT_SIZE + i) & (WAVEFORM_BUFFER_SIZE - 1);
+    spectrum_history[i] = scope_mid(idx);
+  }
+
+  for (int i = 0; i < FFT_SIZE; ++i)
+    spectrum_windowed[i] = spectrum_history[i] * spectrum_window[i];
+  fft_real_forward(&spectrum_fft, spectrum_windowed, spectrum_re, spectrum_im);
 
-  int waveform_h = h; // Use the full height for waveform
+  // Power per bin, scaled so a full-scale sine reads 0 dBFS (Hann gain 0.5)
+  const float scale = 16.0f / ((float)FFT_SIZE * (float)FFT_SIZE);
+  for (int i = 0; i <= FFT_SIZE / 2; ++i)
+    spectrum_re[i] = (spectrum_re[i] * spectrum_re[i] + spectrum_im[i] * spectrum_im[i]) * scale;
 
-  // Split width for two channels
-  int channel_width = w / 2;
-  int left_x = x;
-  int right_x = x + channel_width + 2; // Add small gap between channels
+  for (int c = 0; c < SPECTRUM_COLUMNS; ++c) {
+    float power;
+    if (spectrum_col_hi[c] > spectrum_col_lo[c]) {
+      // Several bins: keep the strongest so narrow peaks stay visible
+      power = 0.0f;
+      for (int b = spectrum_col_lo[c]; b < spectrum_col_hi[c]; ++b)
+        power = fmaxf(power, spectrum_re[b]);
+    } else {
+      // Narrower than a bin at the low end: interpolate
+      float pos = spectrum_col_pos[c];
+      int b = (int)pos;
+      if (b >= FFT_SIZE / 2)
+        b = FFT_SIZE / 2 - 1;
+      float f = pos - b;
+      power = spectrum_re[b] + (spectrum_re[b + 1] - spectrum_re[b]) * f;
+    }
+    float db = power > 1e-12f ? 10.0f * log10f(power) : SPECTRUM_MIN_DB;
+    spectrum_db[c] = fmaxf(db, SPECTRUM_MIN_DB);
+  }
+  return 1;
+}
 
-  // Draw left channel background
-  SDL_Rect left_area = {left_x, y, channel_width, waveform_h};
-  SDL_SetRenderDrawColor(renderer, 20, 25, 35, 255);
-  SDL_RenderFillRect(renderer, &left_area);
+const float *oscilloscope_spectrum(void) {
+  return spectrum_db;
+}
 
-  // Draw right channel background
-  SDL_Rect right_area = {right_x, y, channel_width, waveform_h};
-  SDL_RenderFillRect(renderer, &right_area);
+void oscilloscope_waterfall_row(unsigned char *rgba) {
+  for (int c = 0; c < SPECTRUM_COLUMNS; ++c) {
+    float t = 1.0f - spectrum_db[c] / SPECTRUM_MIN_DB;
+    int idx = (int)(fmaxf(0.0f, fminf(1.0f, t)) * 255.0f);
+    rgba[c * 4 + 0] = spectrum_palette[idx][0];
+    rgba[c * 4 + 1] = spectrum_palette[idx][1];
+    rgba[c * 4 + 2] = spectrum_palette[idx][2];
+    rgba[c * 4 + 3] = 255;
+  }
+}
 
-  // Draw grid lines for both channels
-  SDL_SetRenderDrawColor(renderer, 40, 45, 55, 255);
-  for (int i = 1; i < 8; i++) {
-    int grid_x1 = left_x + (channel_width * i) / 8;
-    int grid_x2 = right_x + (channel_width * i) / 8;
-    SDL_RenderDrawLine(renderer, grid_x1, y, grid_x1, y + waveform_h);
-    SDL_RenderDrawLine(renderer, grid_x2, y, grid_x2, y + waveform_h);
+// One bucket of 'level' as {min L, max L, min R, max R}
+static inline void scope_bucket(int level, unsigned int index, float *out) {
+  index &= SCOPE_HISTORY_FRAMES - 1;
+  if (level == 0) {
+    out[0] = out[1] = waveform_buffer[index * 2 + 0];
+    out[2] = out[3] = waveform_buffer[index * 2 + 1];
+  } else {
+    memcpy(out, scope_pyramid[level - 1][index], sizeof(float) * 4);
   }
-  for (int i = 1; i < 4; i++) {
-    int grid_y = y + (waveform_h * i) / 4;
-    SDL_RenderDrawLine(renderer, left_x, grid_y, left_x + channel_width, grid_y);
-    SDL_RenderDrawLine(renderer, right_x, grid_y, right_x + channel_width, grid_y);
+}
+
+int oscilloscope_max_span(void) {
+  int span = SCOPE_HISTORY_FRAMES;
+  for (int level = 1; level < SCOPE_LEVELS; ++level)
+    span *= SCOPE_DECIMATION;
+  return span;
+}
+
+void oscilloscope_trace(ScopeTrace *trace, int columns, int span) {
+  if (columns > SCOPE_MAX_COLUMNS)
+    columns = SCOPE_MAX_COLUMNS;
+  if (span > oscilloscope_max_span())
+    span = oscilloscope_max_span();
+  trace->columns = 0;
+
+  scope_drain();
+  if (!buffer_ready || columns < 2 || span < 2)
+    return;
+
+  // Coarsest level that still gives every column at least one bucket
+  int level = 0;
+  int bucket_frames = 1;
+  while (level + 1 < SCOPE_LEVELS && bucket_frames * SCOPE_DECIMATION * columns <= span) {
+    bucket_frames *= SCOPE_DECIMATION;
+    level++;
   }
+  int buckets = span / bucket_frames;
+  unsigned int start = scope_level_count[level] - (unsigned int)buckets;
 
-  // Draw center lines (0V reference)
-  SDL_SetRenderDrawColor(renderer, 80, 85, 100, 255);
-  SDL_RenderDrawLine(renderer, left_x, y + waveform_h/2, left_x + channel_width, y + waveform_h/2);
-  SDL_RenderDrawLine(renderer, right_x, y + waveform_h/2, right_x + channel_width, y + waveform_h/2);
+  if (span <= WAVEFORM_BUFFER_SIZE / 2) {
+    // Find a stable trigger point on rising edge zero crossing of the mid
+    // signal, early enough that the whole window is already in the history
+    int samples_to_display = span;
+    int trigger_pos = (waveform_write_pos - samples_to_display) & (WAVEFORM_BUFFER_SIZE - 1);
 
-  if (buffer_ready) {
-    // Find a stable trigger point on rising edge zero crossing
-    int trigger_pos = waveform_write_pos;
-    int samples_to_display = channel_width > WAVEFORM_BUFFER_SIZE ? WAVEFORM_BUFFER_SIZE : channel_width;
-    
     // Search backwards from write position for stable trigger
     // We'll look for a zero crossing where signal goes from negative to positive
     int search_range = WAVEFORM_BUFFER_SIZE / 4; // Search through 1/4 of buffer
     int stable_trigger = -1;
     int best_trigger = trigger_pos;
     float min_crossing_diff = 1.0f; // Track smallest crossing amplitude difference
-    
+  
     for (int offset = 0; offset < search_range; offset++) {
         int idx1 = (trigger_pos - offset - 1 + WAVEFORM_BUFFER_SIZE) % WAVEFORM_BUFFER_SIZE;
         int idx2 = (trigger_pos - offset + WAVEFORM_BUFFER_SIZE) % WAVEFORM_BUFFER_SIZE;
-        
-        float sample1 = waveform_buffer[idx1];
-        float sample2 = waveform_buffer[idx2];
-        
+      
+        float sample1 = scope_mid(idx1);
+        float sample2 = scope_mid(idx2);
+      
         // Check for rising edge zero crossing (negative to positive)
         if (sample1 < 0.0f && sample2 >= 0.0f) {
             // Calculate how close to zero this crossing is
             float crossing_diff = fabsf(sample1) + fabsf(sample2);
-            
+          
             // Prefer crossings with smaller amplitude difference (closer to true zero crossing)
             if (crossing_diff < min_crossing_diff) {
                 min_crossing_diff = crossing_diff;
                 best_trigger = idx2;
-                
+              
                 // Additional stability check: ensure signal has some amplitude after crossing
                 // Check a few samples ahead to make sure this isn't noise
                 int stable_count = 0;
                 float amplitude_sum = 0.0f;
                 for (int check = 0; check < 8 && check < samples_to_display; check++) {
                     int check_idx = (idx2 + check) % WAVEFORM_BUFFER_SIZE;
-                    float check_sample = waveform_buffer[check_idx];
+                    float check_sample = scope_mid(check_idx);
                     amplitude_sum += fabsf(check_sample);
-                    if (fabsf(check_sample) > 0.01f) { // Small threshold to avoid noise
+                    if (fabsf(check_sample) > 0.0025f) { // Small threshold to avoid noise
                         stable_count++;
                     }
                 }
-                
+              
                 // Consider it stable if at least half the samples have measurable amplitude
-                if (stable_count >= 4 && amplitude_sum / 8.0f > 0.02f) {
+                if (stable_count >= 4 && amplitude_sum / 8.0f > 0.005f) {
                     stable_trigger = idx2;
                 }
             }
         }
     }
-    
+  
     // Use stable trigger if found, otherwise use best zero crossing
     if (stable_trigger >= 0) {
         trigger_pos = stable_trigger;
@@ -152,99 +361,55 @@ void oscilloscope_draw(SDL_Renderer *renderer, const struct Synth *synth,
         trigger_pos = best_trigger;
     }
 
-    // Find the actual signal range for auto-scaling
-    float min_sample = 0.0f, max_sample = 0.0f;
-    int first_sample = 1;
-    
-    for (int i = 0; i < samples_to_display; i++) {
-      int sample_idx = (trigger_pos + i) % WAVEFORM_BUFFER_SIZE;
-      float sample = waveform_buffer[sample_idx];
-      
-      if (first_sample) {
-        min_sample = max_sample = sample;
-        first_sample = 0;
-      } else {
-        if (sample < min_sample) min_sample = sample;
-        if (sample > max_sample) max_sample = sample;
-      }
+    // Same start on the chosen level: count back from its newest bucket,
+    // which ends 'partial' frames before the newest frame
+    int back = (waveform_write_pos - trigger_pos) & (WAVEFORM_BUFFER_SIZE - 1);
+    int partial = (int)(scope_level_count[0] & (unsigned int)(bucket_frames - 1));
+    int back_buckets = (back - partial) / bucket_frames;
+    if (back_buckets > buckets)
+      start = scope_level_count[level] - (unsigned int)back_buckets;
+  }
+
+  // Reduce each column's buckets to a min/max pair, so the trace keeps its
+  // peaks however many frames fall into one column
+  float min_sample = 0.0f, max_sample = 0.0f;
+  for (int c = 0; c < columns; c++) {
+    int begin = (int)(((long long)c * buckets) / columns);
+    int end = (int)(((long long)(c + 1) * buckets) / columns);
+    if (end <= begin)
+      end = begin + 1;
+    float acc[4], b[4];
+    scope_bucket(level, start + begin, acc);
+    for (int i = begin + 1; i < end; i++) {
+      scope_bucket(level, start + i, b);
+      acc[0] = fminf(acc[0], b[0]);
+      acc[1] = fmaxf(acc[1], b[1]);
+      acc[2] = fminf(acc[2], b[2]);
+      acc[3] = fmaxf(acc[3], b[3]);
     }
-    
-    // Calculate scaling factor to fit the waveform in the available height
-    float signal_range = max_sample - min_sample;
-    float scale_factor;
-    
-    if (signal_range < 0.001f) {
-      // Signal is essentially flat, use default scaling
-      scale_factor = (waveform_h / 2.0f) * 0.8f; // Use 80% of available range
+    trace->min[0][c] = acc[0];
+    trace->max[0][c] = acc[1];
+    trace->min[1][c] = acc[2];
+    trace->max[1][c] = acc[3];
+    if (c == 0) {
+      min_sample = fminf(acc[0], acc[2]);
+      max_sample = fmaxf(acc[1], acc[3]);
     } else {
-      // Scale to fit 90% of available height
-      scale_factor = (waveform_h / 2.0f) * 0.9f / (signal_range / 2.0f);
-    }
-    
-    // Calculate center offset
-    float signal_center = (max_sample + min_sample) / 2.0f;
-    int center_y = y + waveform_h / 2;
-
-    // Draw left channel waveform (red)
-    SDL_SetRenderDrawColor(renderer, 255, 100, 100, 255); // Red color
-    for (int px = 0; px < channel_width - 1; px++) {
-      int sample_idx1 = (trigger_pos + (px * samples_to_display) / channel_width) % WAVEFORM_BUFFER_SIZE;
-      int sample_idx2 = (trigger_pos + ((px + 1) * samples_to_display) / channel_width) % WAVEFORM_BUFFER_SIZE;
-
-      float sample1 = waveform_buffer[sample_idx1];
-      float sample2 = waveform_buffer[sample_idx2];
-
-      // Apply auto-scaling: center the signal and scale it to fit
-      int y1 = center_y - (int)((sample1 - signal_center) * scale_factor);
-      int y2 = center_y - (int)((sample2 - signal_center) * scale_factor);
-
-      // Clamp to drawing area
-      if (y1 < y) y1 = y;
-      if (y1 >= y + waveform_h) y1 = y + waveform_h - 1;
-      if (y2 < y) y2 = y;
-      if (y2 >= y + waveform_h) y2 = y + waveform_h - 1;
-
-      SDL_RenderDrawLine(renderer, left_x + px, y1, left_x + px + 1, y2);
-    }
-
-    // Draw right channel waveform (green)
-    SDL_SetRenderDrawColor(renderer, 100, 255, 100, 255); // Green color
-    for (int px = 0; px < channel_width - 1; px++) {
-      int sample_idx1 = (trigger_pos + (px * samples_to_display) / channel_width) % WAVEFORM_BUFFER_SIZE;
-      int sample_idx2 = (trigger_pos + ((px + 1) * samples_to_display) / channel_width) % WAVEFORM_BUFFER_SIZE;
-
-      float sample1 = waveform_buffer[sample_idx1];
-      float sample2 = waveform_buffer[sample_idx2];
-
-      // Apply auto-scaling: center the signal and scale it to fit
-      int y1 = center_y - (int)((sample1 - signal_center) * scale_factor);
-      int y2 = center_y - (int)((sample2 - signal_center) * scale_factor);
-
-      // Clamp to drawing area
-      if (y1 < y) y1 = y;
-      if (y1 >= y + waveform_h) y1 = y + waveform_h - 1;
-      if (y2 < y) y2 = y;
-      if (y2 >= y + waveform_h) y2 = y + waveform_h - 1;
-
-      SDL_RenderDrawLine(renderer, right_x + px, y1, right_x + px + 1, y2);
+      min_sample = fminf(min_sample, fminf(acc[0], acc[2]));
+      max_sample = fmaxf(max_sample, fmaxf(acc[1], acc[3]));
     }
   }
 
-  // Draw borders for both waveforms
-  SDL_SetRenderDrawColor(renderer, 100, 100, 120, 255);
-  SDL_RenderDrawRect(renderer, &left_area);
-  SDL_RenderDrawRect(renderer, &right_area);
-
-  // Draw labels for stereo channels
-  if (font) {
-    SDL_Color text_color = {180, 180, 200, 255};
-    
-    // Left channel label
-    SDL_SetRenderDrawColor(renderer, 255, 100, 100, 255); // Red text
-    draw_text(renderer, "L", left_x + 5, y + 5, text_color, font);
-    
-    // Right channel label
-    SDL_SetRenderDrawColor(renderer, 100, 255, 100, 255); // Green text
-    draw_text(renderer, "R", right_x + 5, y + 5, text_color, font);
+  // Scale to fit 90% of the pane, or 80% of full scale for a flat signal,
+  // shared by both channels
+  float signal_range = max_sample - min_sample;
+  float scale_factor = signal_range < 0.00025f ? 0.8f : 0.9f / (signal_range / 2.0f);
+  float signal_center = (max_sample + min_sample) / 2.0f;
+  for (int ch = 0; ch < 2; ch++) {
+    for (int c = 0; c < columns; c++) {
+      trace->min[ch][c] = (trace->min[ch][c] - signal_center) * scale_factor;
+      trace->max[ch][c] = (trace->max[ch][c] - signal_center) * scale_factor;
+    }
   }
-}
\ No newline at end of file
+  trace->columns = columns;
+}
@@ -1,10 +1,27 @@
 #pragma once
 
-#include <SDL_ttf.h>
 #include "synth.h"
 #include <SDL2/SDL.h>
 #define FFT_SIZE 2048
 #define WATERFALL_HEIGHT 256
+#define SCOPE_RING_FRAMES 16384       // Audio to GUI stereo ring (power of two), > 1/SCOPE_MIN_FPS s at 48 kHz
+#define SCOPE_MIN_FPS 5.0f            // Slowest scope refresh rate
+#define SCOPE_HISTORY_FRAMES 8192     // Buckets per pyramid level, >= FFT_SIZE (power of two)
+#define SCOPE_LEVELS 5                // Level 0 is raw; level k holds min/max of 4^k frames
+#define SCOPE_DECIMATION 4
+#define SPECTRUM_COLUMNS 512          // Log-frequency display columns
+#define SPECTRUM_MIN_HZ 20.0f
+#define SPECTRUM_MAX_HZ 20000.0f
+#define SPECTRUM_MIN_DB -100.0f
+#define SCOPE_MAX_COLUMNS 2048
+
+// Scope display data: per column and channel the lowest and highest frame,
+// scaled so the visible signal spans about [-0.9, 0.9]
+typedef struct {
+  int columns;                  // 0 until audio has arrived
+  float min[2][SCOPE_MAX_COLUMNS];
+  float max[2][SCOPE_MAX_COLUMNS];
+} ScopeTrace;
 
 #ifdef __cplusplus
 extern "C" {
@@ -12,10 +29,26 @@ extern "C" {
 
 void oscilloscope_init();
 void oscilloscope_shutdown();
-void oscilloscope_feed(float sample);
-void oscilloscope_update_fft(float sample);
-void oscilloscope_draw(SDL_Renderer *renderer, const struct Synth *synth, int x, int y,
-                       int w, int h, TTF_Font *font);
+void oscilloscope_set_sample_rate(float sample_rate);
+// Audio thread: copy a block of interleaved stereo frames into the ring
+void oscilloscope_feed_block(const float *stereo, int frames);
+// GUI thread: move published frames into the history without drawing, so
+// the ring keeps up while the scope is hidden or redraws are slow
+void oscilloscope_drain(void);
+// GUI thread: drain the ring and analyze the newest FFT_SIZE frames.
+// Returns 1 when a new spectrum (and waterfall row) is available.
+int oscilloscope_spectrum_update(void);
+// SPECTRUM_COLUMNS magnitudes in dBFS, log-spaced from SPECTRUM_MIN_HZ
+const float *oscilloscope_spectrum(void);
+// Latest spectrum as one RGBA row of SPECTRUM_COLUMNS pixels
+void oscilloscope_waterfall_row(unsigned char *rgba);
+// GUI thread: drain the ring and reduce the newest 'span' frames to
+// 'columns' min/max pairs per channel. Short spans trigger on the mid
+// signal; longer ones roll and read the coarsest pyramid level that still
+// has a bucket per column, so the cost does not grow with the span.
+void oscilloscope_trace(ScopeTrace *trace, int columns, int span);
+// Longest span the pyramid can show
+int oscilloscope_max_span(void);
 
 #ifdef __cplusplus
 }
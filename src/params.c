@@ -0,0 +1,344 @@
+#include "params.h"
+#include "synth.h"
+#include <string.h>
+
+// Setters for plain fields; 'p' is the part being edited and 'i' selects
+// the oscillator or LFO
+#define FIELD_SETTER(fn, stmt)                                   \
+  static void fn(Synth *s, Part *p, int i, float v) {            \
+    (void)s;                                                     \
+    (void)p;                                                     \
+    (void)i;                                                     \
+    (void)v;                                                     \
+    stmt;                                                        \
+  }
+
+FIELD_SETTER(set_osc_waveform, p->osc[i].waveform = (OscWaveform)((int)v))
+FIELD_SETTER(set_osc_pitch, p->osc[i].pitch = v)
+FIELD_SETTER(set_osc_phase, p->osc[i].phase = v)
+FIELD_SETTER(set_osc_detune, p->osc[i].detune = v)
+FIELD_SETTER(set_osc_pulse_width, p->osc[i].pulse_width = v)
+FIELD_SETTER(set_osc_unison_detune, p->osc[i].unison_detune = v)
+FIELD_SETTER(set_osc_unison_voices, p->osc[i].unison_voices = (int)(v + 0.5f))
+FIELD_SETTER(set_osc_pan, p->osc[i].pan = v)
+FIELD_SETTER(set_osc_gain, p->osc_gain[i] = v)
+
+FIELD_SETTER(set_lfo_waveform, p->lfos[i].waveform = (LfoWaveform)((int)v))
+FIELD_SETTER(set_lfo_frequency, p->lfos[i].frequency = v)
+FIELD_SETTER(set_lfo_depth, p->lfos[i].depth = v)
+FIELD_SETTER(set_lfo_phase, p->lfos[i].phase = v)
+FIELD_SETTER(set_lfo_gain, p->lfos[i].gain = v)
+FIELD_SETTER(set_lfo_target, p->lfos[i].target = (LfoTarget)((int)v))
+FIELD_SETTER(set_lfo_sync, p->lfos[i].sync = (LfoSyncMode)((int)v))
+FIELD_SETTER(set_lfo_enabled, p->lfos[i].enabled = (int)(v + 0.5f))
+
+FIELD_SETTER(set_mixer_master, s->mixer.master = v)
+FIELD_SETTER(set_mixer_master_pan, s->mixer.master_pan = v)
+FIELD_SETTER(set_mixer_master_width, s->mixer.master_width = v)
+FIELD_SETTER(set_comp_threshold, s->mixer.comp_threshold = v)
+FIELD_SETTER(set_comp_ratio, s->mixer.comp_ratio = v)
+FIELD_SETTER(set_comp_attack, s->mixer.comp_attack = v)
+FIELD_SETTER(set_comp_release, s->mixer.comp_release = v)
+FIELD_SETTER(set_comp_makeup, s->mixer.comp_makeup_gain = v)
+FIELD_SETTER(set_comp_detector, s->mixer.comp_detector = v >= 0.5f ? COMP_DETECT_RMS : COMP_DETECT_PEAK)
+FIELD_SETTER(set_comp_enabled, s->mixer.comp_enabled = (int)v)
+FIELD_SETTER(set_dc_filter_enabled, s->mixer.dc_filter_enabled = (int)v)
+FIELD_SETTER(set_dc_filter_freq, s->mixer.dc_filter_freq = v)
+FIELD_SETTER(set_soft_clip_enabled, s->mixer.soft_clip_enabled = (int)v)
+FIELD_SETTER(set_soft_clip_threshold, s->mixer.soft_clip_threshold = v)
+FIELD_SETTER(set_soft_clip_ratio, s->mixer.soft_clip_ratio = v)
+FIELD_SETTER(set_limiter_enabled, s->mixer.limiter_enabled = (int)v)
+FIELD_SETTER(set_limiter_ceiling, s->mixer.limiter_ceiling = v)
+FIELD_SETTER(set_limiter_release, s->mixer.limiter_release = v)
+FIELD_SETTER(set_auto_gain_enabled, s->mixer.auto_gain_enabled = (int)v)
+FIELD_SETTER(set_auto_gain_target, s->mixer.auto_gain_target = v)
+FIELD_SETTER(set_auto_gain_time, s->mixer.auto_gain_seconds = v)
+// A trigger: values under 0.5, as from presets or a released button, do nothing
+FIELD_SETTER(set_loudness_reset, if (v >= 0.5f) s->mixer.loudness_reset_request = 1)
+
+FIELD_SETTER(set_flanger_depth, s->fx.flanger_depth = v)
+FIELD_SETTER(set_flanger_rate, s->fx.flanger_rate = v)
+FIELD_SETTER(set_flanger_feedback, s->fx.flanger_feedback = v)
+FIELD_SETTER(set_chorus_depth, s->fx.chorus_depth = v)
+FIELD_SETTER(set_chorus_rate, s->fx.chorus_rate = v)
+FIELD_SETTER(set_chorus_mix, s->fx.chorus_mix = v)
+FIELD_SETTER(set_delay_time, s->fx.delay_time = v)
+FIELD_SETTER(set_delay_feedback, s->fx.delay_feedback = v)
+FIELD_SETTER(set_delay_mix, s->fx.delay_mix = v)
+FIELD_SETTER(set_reverb_mix, s->fx.reverb_mix = v)
+FIELD_SETTER(set_reverb_algorithm, s->fx.reverb_algorithm = (int)v)
+FIELD_SETTER(set_conv_mix, s->fx.conv_mix = v)
+FIELD_SETTER(set_multitap_enabled, s->fx.multitap_enabled = (int)v)
+FIELD_SETTER(set_multitap_taps, s->fx.num_taps = (int)v < 1 ? 1 :
+             ((int)v > MAX_DELAY_TAPS ? MAX_DELAY_TAPS : (int)v); s->fx.multitap_dirty = 1)
+FIELD_SETTER(set_multitap_tap, s->fx.multitap_taps[i] = v; s->fx.multitap_dirty = 1)
+FIELD_SETTER(set_multitap_tap_level, s->fx.multitap_levels[i] = v; s->fx.multitap_dirty = 1)
+FIELD_SETTER(set_multitap_tap_pan, s->fx.multitap_pan[i] = v; s->fx.multitap_dirty = 1)
+FIELD_SETTER(set_multitap_tap_feedback, s->fx.multitap_feedback[i] = v; s->fx.multitap_dirty = 1)
+FIELD_SETTER(set_filter_enabled, s->fx.filter_enabled = (int)v)
+FIELD_SETTER(set_filter_cutoff, s->fx.filter_cutoff = v)
+FIELD_SETTER(set_filter_resonance, s->fx.filter_resonance = v)
+FIELD_SETTER(set_filter_drive, s->fx.filter_drive = v)
+FIELD_SETTER(set_filter_mix, s->fx.filter_mix = v)
+FIELD_SETTER(set_filter_oversampling, s->fx.filter_oversampling = (int)v)
+FIELD_SETTER(set_filter_type, analog_filter_set_param(&s->fx.filter, "type", v))
+
+FIELD_SETTER(set_arp_mode, p->arp.mode = (ArpMode)((int)v))
+FIELD_SETTER(set_tempo, transport_set_bpm(&s->transport, v))
+FIELD_SETTER(set_arp_rate, p->arp.rate = (ArpRate)((int)v))
+FIELD_SETTER(set_arp_polyphonic, p->arp.polyphonic = (int)v)
+FIELD_SETTER(set_arp_octave, p->arp.octave = (int)v)
+FIELD_SETTER(set_arp_octaves, p->arp.octaves = (int)v)
+FIELD_SETTER(set_arp_chord_type, p->arp.chord_type = (ChordType)((int)v))
+FIELD_SETTER(set_arp_add_6, p->arp.add_6 = (int)v)
+FIELD_SETTER(set_arp_add_m7, p->arp.add_m7 = (int)v)
+FIELD_SETTER(set_arp_add_M7, p->arp.add_M7 = (int)v)
+FIELD_SETTER(set_arp_add_9, p->arp.add_9 = (int)v)
+FIELD_SETTER(set_arp_voicing, p->arp.voicing = (int)v)
+FIELD_SETTER(set_arp_gate_length, p->arp.gate_length = v)
+FIELD_SETTER(set_arp_swing, p->arp.swing = v)
+FIELD_SETTER(set_arp_pattern_length, p->arp.pattern_length = (int)v)
+
+FIELD_SETTER(set_part_channel, p->channel = (int)v < 0 ? 0 : ((int)v > 16 ? 16 : (int)v))
+FIELD_SETTER(set_part_level, p->level = v)
+FIELD_SETTER(set_part_pan, p->pan = v)
+FIELD_SETTER(set_part_reverb_send, p->reverb_send = v)
+FIELD_SETTER(set_part_delay_send, p->delay_send = v)
+FIELD_SETTER(set_part_bend_range, p->bend_range = v < 0.0f ? 0.0f : (v > 24.0f ? 24.0f : v))
+FIELD_SETTER(set_part_aftertouch, p->aftertouch = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v))
+FIELD_SETTER(set_edit_part, s->edit_part = (int)v < 0 ? 0 :
+             ((int)v >= SYNTH_MAX_PARTS ? SYNTH_MAX_PARTS - 1 : (int)v))
+
+FIELD_SETTER(set_clock_sync, s->midi_clock.follow = v >= 0.5f)
+FIELD_SETTER(set_clock_out, s->midi_clock.send = v >= 0.5f)
+
+FIELD_SETTER(set_song_play, smf_player_play(&s->song, v >= 0.5f))
+FIELD_SETTER(set_song_loop, s->song.loop = v >= 0.5f)
+FIELD_SETTER(set_song_loop_start, s->song.loop_start = v < 0.0f ? 0 : (int)v)
+FIELD_SETTER(set_song_loop_end, s->song.loop_end = v < 0.0f ? 0 : (int)v)
+
+FIELD_SETTER(set_mpe_lower, mpe_set_zone(&s->mpe, MPE_LOWER_MANAGER, (int)v))
+FIELD_SETTER(set_mpe_upper, mpe_set_zone(&s->mpe, MPE_UPPER_MANAGER, (int)v))
+FIELD_SETTER(set_mpe_bend_range, s->mpe.bend_range[0] = s->mpe.bend_range[1] =
+             v < 0.0f ? 0.0f : (v > 96.0f ? 96.0f : v))
+
+FIELD_SETTER(set_bus_reverb_size, send_bus_set_reverb(&s->bus, v, s->bus.reverb_damping))
+FIELD_SETTER(set_bus_reverb_damping, send_bus_set_reverb(&s->bus, s->bus.reverb_size, v))
+FIELD_SETTER(set_bus_reverb_return, s->bus.reverb_return = v)
+FIELD_SETTER(set_bus_delay_time, s->bus.delay_time = v)
+FIELD_SETTER(set_bus_delay_feedback, s->bus.delay_feedback = v)
+FIELD_SETTER(set_bus_delay_return, s->bus.delay_return = v)
+
+FIELD_SETTER(set_ring_mod_frequency, ring_mod_set_frequency(&s->ring_mod, v))
+FIELD_SETTER(set_ring_mod_mix, ring_mod_set_mix(&s->ring_mod, v))
+FIELD_SETTER(set_ring_mod_enabled, ring_mod_set_enabled(&s->ring_mod, (int)v))
+
+// Setters with side effects
+static void set_reverb_size(Synth *s, Part *p, int i, float v) {
+  (void)p;
+  (void)i;
+  s->fx.reverb_size = v;
+  fdn_reverb_set_params(&s->fx.fdn, s->fx.reverb_size, s->fx.reverb_damping);
+}
+
+static void set_reverb_damping(Synth *s, Part *p, int i, float v) {
+  (void)p;
+  (void)i;
+  s->fx.reverb_damping = v;
+  fdn_reverb_set_params(&s->fx.fdn, s->fx.reverb_size, s->fx.reverb_damping);
+}
+
+
+// Turning these off releases notes, which the arpeggiator handles itself
+static void set_arp_enabled(Synth *s, Part *p, int i, float v) {
+  (void)s;
+  (void)i;
+  arpeggiator_set_param(&p->arp, "enabled", v, p);
+}
+
+static void set_arp_hold(Synth *s, Part *p, int i, float v) {
+  (void)s;
+  (void)i;
+  arpeggiator_set_param(&p->arp, "hold", v, p);
+}
+
+// Part envelope, copied into every voice of the part
+#define ADSR_SETTER(fn, field)                                   \
+  static void fn(Synth *s, Part *p, int i, float v) {            \
+    (void)s;                                                     \
+    (void)i;                                                     \
+    p->adsr.field = v;                                           \
+    for (int n = 0; n < p->max_voices; ++n)                      \
+      p->voices[n].adsr.field = v;                               \
+  }
+
+ADSR_SETTER(set_adsr_attack, attack)
+ADSR_SETTER(set_adsr_decay, decay)
+ADSR_SETTER(set_adsr_sustain, sustain)
+ADSR_SETTER(set_adsr_release, release)
+
+#define OSC_PARAMS(n)                                            \
+  {"osc" #n ".waveform", set_osc_waveform, n - 1},               \
+  {"osc" #n ".pitch", set_osc_pitch, n - 1},                     \
+  {"osc" #n ".phase", set_osc_phase, n - 1},                     \
+  {"osc" #n ".detune", set_osc_detune, n - 1},                   \
+  {"osc" #n ".gain", set_osc_gain, n - 1},                       \
+  {"osc" #n ".pulse_width", set_osc_pulse_width, n - 1},         \
+  {"osc" #n ".unison_detune", set_osc_unison_detune, n - 1},     \
+  {"osc" #n ".unison_voices", set_osc_unison_voices, n - 1},     \
+  {"osc" #n ".pan", set_osc_pan, n - 1},                         \
+  {"mixer.osc" #n, set_osc_gain, n - 1}
+
+#define LFO_PARAMS(n)                                            \
+  {"lfo" #n ".waveform", set_lfo_waveform, n - 1},               \
+  {"lfo" #n ".frequency", set_lfo_frequency, n - 1},             \
+  {"lfo" #n ".depth", set_lfo_depth, n - 1},                     \
+  {"lfo" #n ".phase", set_lfo_phase, n - 1},                     \
+  {"lfo" #n ".gain", set_lfo_gain, n - 1},                       \
+  {"lfo" #n ".target", set_lfo_target, n - 1},                   \
+  {"lfo" #n ".sync", set_lfo_sync, n - 1},                       \
+  {"lfo" #n ".enabled", set_lfo_enabled, n - 1}
+
+// Multi-tap taps count from 0, as in presets
+#define MULTITAP_TAP_PARAMS(n)                                   \
+  {"fx.multitap.tap" #n, set_multitap_tap, n},                   \
+  {"fx.multitap.tap" #n "_level", set_multitap_tap_level, n},    \
+  {"fx.multitap.tap" #n "_pan", set_multitap_tap_pan, n},        \
+  {"fx.multitap.tap" #n "_feedback", set_multitap_tap_feedback, n}
+
+static const ParamInfo params[] = {
+  OSC_PARAMS(1), OSC_PARAMS(2), OSC_PARAMS(3), OSC_PARAMS(4),
+  LFO_PARAMS(1), LFO_PARAMS(2), LFO_PARAMS(3),
+
+  {"mixer.master", set_mixer_master, 0},
+  {"mixer.master.pan", set_mixer_master_pan, 0},
+  {"mixer.master.width", set_mixer_master_width, 0},
+  {"mixer.comp.threshold", set_comp_threshold, 0},
+  {"mixer.comp.ratio", set_comp_ratio, 0},
+  {"mixer.comp.attack", set_comp_attack, 0},
+  {"mixer.comp.release", set_comp_release, 0},
+  {"mixer.comp.makeup", set_comp_makeup, 0},
+  {"mixer.comp.detector", set_comp_detector, 0},
+  {"mixer.comp.enabled", set_comp_enabled, 0},
+  {"mixer.dc.filter.enabled", set_dc_filter_enabled, 0},
+  {"mixer.dc.filter.freq", set_dc_filter_freq, 0},
+  {"mixer.soft.clip.enabled", set_soft_clip_enabled, 0},
+  {"mixer.soft.clip.threshold", set_soft_clip_threshold, 0},
+  {"mixer.soft.clip.ratio", set_soft_clip_ratio, 0},
+  {"mixer.limiter.enabled", set_limiter_enabled, 0},
+  {"mixer.limiter.ceiling", set_limiter_ceiling, 0},
+  {"mixer.limiter.release", set_limiter_release, 0},
+  {"mixer.auto.gain.enabled", set_auto_gain_enabled, 0},
+  {"mixer.auto.gain.target", set_auto_gain_target, 0},
+  {"mixer.auto.gain.time", set_auto_gain_time, 0},
+  {"mixer.loudness.reset", set_loudness_reset, 0},
+
+  {"fx.flanger.depth", set_flanger_depth, 0},
+  {"fx.flanger.rate", set_flanger_rate, 0},
+  {"fx.flanger.feedback", set_flanger_feedback, 0},
+  {"fx.chorus.depth", set_chorus_depth, 0},
+  {"fx.chorus.rate", set_chorus_rate, 0},
+  {"fx.chorus.mix", set_chorus_mix, 0},
+  {"fx.delay.time", set_delay_time, 0},
+  {"fx.delay.feedback", set_delay_feedback, 0},
+  {"fx.delay.mix", set_delay_mix, 0},
+  {"fx.reverb.size", set_reverb_size, 0},
+  {"fx.reverb.damping", set_reverb_damping, 0},
+  {"fx.reverb.mix", set_reverb_mix, 0},
+  {"fx.reverb.algorithm", set_reverb_algorithm, 0},
+  {"fx.convolution.mix", set_conv_mix, 0},
+  {"fx.multitap.enabled", set_multitap_enabled, 0},
+  {"fx.multitap.taps", set_multitap_taps, 0},   // 1 to MAX_DELAY_TAPS
+  {"fx.multitap.bpm", set_tempo, 0},   // Taps follow the transport
+  MULTITAP_TAP_PARAMS(0), MULTITAP_TAP_PARAMS(1), MULTITAP_TAP_PARAMS(2), MULTITAP_TAP_PARAMS(3),
+  MULTITAP_TAP_PARAMS(4), MULTITAP_TAP_PARAMS(5), MULTITAP_TAP_PARAMS(6), MULTITAP_TAP_PARAMS(7),
+  {"fx.filter.enabled", set_filter_enabled, 0},
+  {"fx.filter.cutoff", set_filter_cutoff, 0},
+  {"fx.filter.resonance", set_filter_resonance, 0},
+  {"fx.filter.drive", set_filter_drive, 0},
+  {"fx.filter.mix", set_filter_mix, 0},
+  {"fx.filter.oversampling", set_filter_oversampling, 0},
+  {"fx.filter.type", set_filter_type, 0},
+
+  {"arp.enabled", set_arp_enabled, 0},
+  {"arp.mode", set_arp_mode, 0},
+  {"arp.tempo", set_tempo, 0},            // Same transport tempo
+  {"arp.rate", set_arp_rate, 0},
+  {"arp.polyphonic", set_arp_polyphonic, 0},
+  {"arp.hold", set_arp_hold, 0},
+  {"arp.octave", set_arp_octave, 0},
+  {"arp.octaves", set_arp_octaves, 0},
+  {"arp.chord_type", set_arp_chord_type, 0},
+  {"arp.add_6", set_arp_add_6, 0},
+  {"arp.add_m7", set_arp_add_m7, 0},
+  {"arp.add_M7", set_arp_add_M7, 0},
+  {"arp.add_9", set_arp_add_9, 0},
+  {"arp.voicing", set_arp_voicing, 0},
+  {"arp.gate_length", set_arp_gate_length, 0},
+  {"arp.swing", set_arp_swing, 0},
+  {"arp.pattern_length", set_arp_pattern_length, 0},
+
+  {"adsr.attack", set_adsr_attack, 0},
+  {"adsr.decay", set_adsr_decay, 0},
+  {"adsr.sustain", set_adsr_sustain, 0},
+  {"adsr.release", set_adsr_release, 0},
+
+  {"ring_mod.frequency", set_ring_mod_frequency, 0},
+  {"ring_mod.mix", set_ring_mod_mix, 0},
+  {"ring_mod.enabled", set_ring_mod_enabled, 0},
+
+  {"transport.bpm", set_tempo, 0},
+  {"transport.sync", set_clock_sync, 0},  // Follow incoming MIDI clock
+  {"transport.clock_out", set_clock_out, 0},
+
+  {"song.play", set_song_play, 0},        // MIDI file loaded with smf_player_load
+  {"song.loop", set_song_loop, 0},
+  {"song.loop_start", set_song_loop_start, 0}, // First bar, from 1
+  {"song.loop_end", set_song_loop_end, 0},     // Last bar, 0 for the song end
+
+  {"part.channel", set_part_channel, 0},
+  {"part.level", set_part_level, 0},
+  {"part.pan", set_part_pan, 0},
+  {"part.reverb_send", set_part_reverb_send, 0},
+  {"part.delay_send", set_part_delay_send, 0},
+  {"part.bend_range", set_part_bend_range, 0},
+  {"part.aftertouch", set_part_aftertouch, 0},
+  {"part.edit", set_edit_part, 0},
+
+  {"mpe.lower", set_mpe_lower, 0},       // Member channels of each zone, 0-15
+  {"mpe.upper", set_mpe_upper, 0},
+  {"mpe.bend_range", set_mpe_bend_range, 0},
+
+  {"bus.reverb.size", set_bus_reverb_size, 0},
+  {"bus.reverb.damping", set_bus_reverb_damping, 0},
+  {"bus.reverb.return", set_bus_reverb_return, 0},
+  {"bus.delay.time", set_bus_delay_time, 0},
+  {"bus.delay.feedback", set_bus_delay_feedback, 0},
+  {"bus.delay.return", set_bus_delay_return, 0},
+};
+
+#define PARAM_COUNT ((int)(sizeof(params) / sizeof(params[0])))
+
+int param_lookup(const char *name) {
+  for (int id = 0; id < PARAM_COUNT; ++id)
+    if (strcmp(params[id].name, name) == 0)
+      return id;
+  return PARAM_NONE;
+}
+
+const char *param_name(int id) {
+  return id >= 0 && id < PARAM_COUNT ? params[id].name : NULL;
+}
+
+int param_count(void) {
+  return PARAM_COUNT;
+}
+
+void param_set(Synth *synth, int id, float value) {
+  param_set_part(synth, synth_edit_part(synth), id, value);
+}
+
+void param_set_part(Synth *synth, Part *part, int id, float value) {
+  if (id >= 0 && id < PARAM_COUNT)
+    params[id].set(synth, part, params[id].index, value);
+}
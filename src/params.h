@@ -0,0 +1,35 @@
+#pragma once
+
+struct Synth;
+struct Part;
+
+// Parameter registry: every named synth parameter gets a small integer ID
+// and a direct setter. Names are resolved once (presets, MIDI mappings);
+// hot paths such as CC dispatch then set values by ID without any string
+// work. Patch parameters (oscillators, LFOs, envelope, arpeggiator, part
+// mix) act on one part; the rest are shared by the whole synth.
+#define PARAM_NONE -1
+
+typedef void (*ParamSetter)(struct Synth *synth, struct Part *part, int index, float value);
+
+typedef struct {
+  const char *name;
+  ParamSetter set;
+  int index;                    // Oscillator or LFO number for per-unit params
+} ParamInfo;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ID for a name such as "osc1.pitch" or "fx.reverb.mix", or PARAM_NONE
+int param_lookup(const char *name);
+const char *param_name(int id);
+int param_count(void);
+// Patch parameters go to the edit part
+void param_set(struct Synth *synth, int id, float value);
+void param_set_part(struct Synth *synth, struct Part *part, int id, float value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,288 @@
+#include "part.h"
+#include "utils.h"
+#include <string.h>
+
+void part_init(Part *part, int samplerate, int voices, int channel) {
+  memset(part, 0, sizeof(Part));
+  part->max_voices = voices < PART_MAX_VOICES ? voices : PART_MAX_VOICES;
+  part->channel = channel;
+  part->level = 1.0f;
+  part->bend_range = 2.0f;
+  part->aftertouch = 0.5f;
+  part->program = -1;
+  memset(part->note_voice, -1, sizeof(part->note_voice));
+
+  for (int i = 0; i < 4; ++i) {
+    osc_init(&part->osc[i], samplerate);
+    part->osc_gain[i] = 1.0f;
+  }
+  for (int i = 0; i < 3; ++i)
+    lfo_init(&part->lfos[i], samplerate);
+  part->lfos[0].target = LFO_TARGET_FREQUENCY;
+  part->lfos[1].target = LFO_TARGET_AMPLITUDE;
+  part->lfos[2].target = LFO_TARGET_FILTER;
+
+  adsr_init(&part->adsr, samplerate);
+  for (int v = 0; v < part->max_voices; ++v)
+    voice_init(&part->voices[v], samplerate);
+
+  arpeggiator_init(&part->arp);
+}
+
+void part_seed(Part *part, unsigned int seed) {
+  unsigned int rng = rng_seed(seed);
+  for (int i = 0; i < 4; ++i)
+    part->osc[i].rng = rng_seed(rng_next(&rng));
+  for (int i = 0; i < 3; ++i)
+    part->lfos[i].rng = rng_seed(rng_next(&rng));
+  part->arp.rng = rng_seed(rng_next(&rng));
+}
+
+static signed char *part_note_slot(Part *part, int channel, int note) {
+  if (note < 0 || note > 127 || channel < -1 || channel > 15)
+    return NULL;
+  return &part->note_voice[channel + 1][note];
+}
+
+// Drop a voice from the note index when it stops or moves to a new note
+static void part_forget_voice(Part *part, int v) {
+  Voice *voice = &part->voices[v];
+  signed char *slot = part_note_slot(part, voice->channel, (int)voice->note);
+  if (slot && *slot == v)
+    *slot = -1;
+}
+
+Voice *part_channel_note_on(Part *part, int channel, int note, float velocity) {
+  signed char *slot = part_note_slot(part, channel, note);
+  if (!slot)
+    return NULL;
+
+  part->timestamp_counter++; // Increment timestamp for new note
+
+  // Trigger LFO sync on note on
+  for (int l = 0; l < 3; ++l) {
+    lfo_note_on(&part->lfos[l]);
+  }
+
+  // 1. If note already playing, retrigger that voice
+  int voice_idx = *slot;
+
+  // 2. Otherwise, find a free voice and use it
+  for (int v = 0; voice_idx < 0 && v < part->max_voices; ++v) {
+    if (!part->voices[v].active)
+      voice_idx = v;
+  }
+
+  // 3. If none free, steal the oldest note
+  if (voice_idx < 0) {
+    unsigned long long min_timestamp = -1; // Max value for unsigned long long
+    for (int v = 0; v < part->max_voices; ++v) {
+      if (part->voices[v].active && part->voices[v].timestamp < min_timestamp) {
+        min_timestamp = part->voices[v].timestamp;
+        voice_idx = v;
+      }
+    }
+  }
+
+  // Only fails when the part has no voices
+  if (voice_idx < 0)
+    return NULL;
+
+  Voice *voice = &part->voices[voice_idx];
+  part_forget_voice(part, voice_idx);
+  voice->channel = channel;
+  *slot = (signed char)voice_idx;
+  voice_on(voice, note, velocity, part->timestamp_counter);
+  return voice;
+}
+
+void part_channel_note_off(Part *part, int channel, int note) {
+  Voice *voice = part_find_voice(part, channel, note);
+  if (!voice)
+    return;
+  voice_off(voice);
+
+  // Trigger LFO sync on note off
+  for (int l = 0; l < 3; ++l) {
+    lfo_note_off(&part->lfos[l]);
+  }
+}
+
+void part_note_on(Part *part, int note, float velocity) {
+  part_channel_note_on(part, -1, note, velocity);
+}
+
+void part_note_off(Part *part, int note) {
+  part_channel_note_off(part, -1, note);
+}
+
+Voice *part_find_voice(Part *part, int channel, int note) {
+  signed char *slot = part_note_slot(part, channel, note);
+  if (!slot || *slot < 0)
+    return NULL;
+  return &part->voices[(int)*slot];
+}
+
+void part_channel_expression(Part *part, int channel, float bend, float pressure, float timbre) {
+  // A member channel normally carries one note, but may carry more once
+  // the controller runs out of channels
+  for (int v = 0; v < part->max_voices; ++v) {
+    Voice *voice = &part->voices[v];
+    if (voice->active && voice->channel == channel) {
+      voice->bend = bend;
+      voice->pressure = pressure;
+      voice->timbre = timbre;
+    }
+  }
+}
+
+int part_active_voices(const Part *part) {
+  int n = 0;
+  for (int i = 0; i < part->max_voices; ++i)
+    if (part->voices[i].active)
+      ++n;
+  return n;
+}
+
+int part_listens(const Part *part, int channel) {
+  return part->channel == 0 || part->channel == channel + 1;
+}
+
+int part_is_idle(const Part *part) {
+  if (part->arp.enabled && part->arp.held_count > 0)
+    return 0;
+  for (int i = 0; i < 16; ++i)
+    if (part->arp.active_arpeggiated_notes[i].active)
+      return 0;
+  return part_active_voices(part) == 0;
+}
+
+void part_fire_events(Part *part, const Transport *t) {
+  Arpeggiator *arp = &part->arp;
+
+  for (int i = 0; i < 16; ++i) {
+    if (arp->active_arpeggiated_notes[i].active &&
+        transport_frames_until_beat(t, arp->active_arpeggiated_notes[i].off_beat) <= 0) {
+      part_note_off(part, arp->active_arpeggiated_notes[i].note);
+      arp->active_arpeggiated_notes[i].active = 0;
+    }
+  }
+
+  if (!arp->enabled || arp->held_count == 0 || !t->running) {
+    arp->next_step_beat = -1.0;
+    arp->ratchets_left = 0;
+    return;
+  }
+
+  // The first step plays on the sample the first key arrives
+  if (arp->next_step_beat < 0.0)
+    arp->next_step_beat = t->beat;
+
+  if (arp->ratchets_left > 0 && transport_frames_until_beat(t, arp->ratchet_beat) <= 0)
+    arpeggiator_ratchet(arp, part);
+
+  // Steps stay on the grid; swing only moves when they sound
+  if (transport_frames_until_beat(t, arp->next_step_beat + arpeggiator_swing_offset(arp)) <= 0) {
+    double beat = arp->next_step_beat;
+    arp->next_step_beat += arpeggiator_step_beats(arp);
+    // The arpeggiator_step function handles note_on/off and the step count
+    arpeggiator_step(arp, beat, part);
+  }
+}
+
+int part_next_event(const Part *part, const Transport *t, int limit) {
+  const Arpeggiator *arp = &part->arp;
+  for (int i = 0; i < 16; ++i) {
+    if (arp->active_arpeggiated_notes[i].active) {
+      int n = transport_frames_until_beat(t, arp->active_arpeggiated_notes[i].off_beat);
+      if (n < limit)
+        limit = n;
+    }
+  }
+  if (arp->enabled && arp->held_count > 0 && arp->next_step_beat >= 0.0) {
+    int n = transport_frames_until_beat(t, arp->next_step_beat + arpeggiator_swing_offset(arp));
+    if (n < limit)
+      limit = n;
+    if (arp->ratchets_left > 0) {
+      n = transport_frames_until_beat(t, arp->ratchet_beat);
+      if (n < limit)
+        limit = n;
+    }
+  }
+  return limit;
+}
+
+void part_render_voices(Part *part, float *out, int frames) {
+  for (int v = 0; v < part->max_voices; ++v) {
+    if (!part->voices[v].active)
+      continue;
+    Voice *voice = &part->voices[v];
+    float pressure = voice->pressure > part->pressure ? voice->pressure : part->pressure;
+    memset(part->vbuf, 0, sizeof(float) * frames * 2);
+    voice_render(voice, part->osc, part->lfos, part->osc_gain, part->bend,
+                 1.0f + part->aftertouch * pressure, part->vbuf, frames);
+    if (!voice->active)
+      part_forget_voice(part, v);
+    for (int i = 0; i < frames * 2; ++i)
+      out[i] += part->vbuf[i];
+  }
+}
+
+void part_note_pressure(Part *part, int channel, int note, float pressure) {
+  Voice *voice = part_find_voice(part, channel, note);
+  if (voice)
+    voice->pressure = pressure;
+}
+
+void part_store_program(const Part *part, PartProgram *program) {
+  memcpy(program->osc, part->osc, sizeof(program->osc));
+  memcpy(program->lfos, part->lfos, sizeof(program->lfos));
+  memcpy(program->osc_gain, part->osc_gain, sizeof(program->osc_gain));
+  program->adsr = part->adsr;
+  program->arp = part->arp;
+}
+
+void part_apply_program(Part *part, const PartProgram *program) {
+  for (int i = 0; i < 4; ++i) {
+    Oscillator osc = program->osc[i];
+    osc.phase_acc = part->osc[i].phase_acc;
+    osc.rng = part->osc[i].rng;
+    part->osc[i] = osc;
+  }
+  for (int i = 0; i < 3; ++i) {
+    LFO lfo = program->lfos[i];
+    lfo.phase_acc = part->lfos[i].phase_acc;
+    lfo.notes_pressed = part->lfos[i].notes_pressed;
+    lfo.rng = part->lfos[i].rng;
+    part->lfos[i] = lfo;
+  }
+  memcpy(part->osc_gain, program->osc_gain, sizeof(part->osc_gain));
+  const AdsrEnvelope *env = &program->adsr;
+  adsr_set_params(&part->adsr, env->attack, env->decay, env->sustain, env->release);
+  for (int v = 0; v < part->max_voices; ++v)
+    adsr_set_params(&part->voices[v].adsr, env->attack, env->decay, env->sustain, env->release);
+
+  // Arpeggiator settings only; held notes, position and sounding notes
+  // carry on
+  Arpeggiator *arp = &part->arp;
+  const Arpeggiator *src = &program->arp;
+  if (!src->enabled && arp->enabled)
+    arpeggiator_clear_notes_with_part(arp, part);
+  arp->enabled = src->enabled;
+  arp->mode = src->mode;
+  memcpy(arp->lanes, src->lanes, sizeof(arp->lanes));
+  arp->pattern_length = src->pattern_length;
+  arp->swing = src->swing;
+  arp->rate = src->rate;
+  arp->polyphonic = src->polyphonic;
+  arp->hold = src->hold;
+  arp->octave = src->octave;
+  arp->octaves = src->octaves;
+  arp->chord_type = src->chord_type;
+  arp->add_6 = src->add_6;
+  arp->add_m7 = src->add_m7;
+  arp->add_M7 = src->add_M7;
+  arp->add_9 = src->add_9;
+  arp->voicing = src->voicing;
+  arp->gate_length = src->gate_length;
+}
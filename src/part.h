@@ -0,0 +1,99 @@
+#pragma once
+#include "adsr.h"
+#include "arpeggiator.h"
+#include "lfo.h"
+#include "osc.h"
+#include "transport.h"
+#include "voice.h"
+
+// One patch of the multitimbral engine: oscillators, LFOs, envelope,
+// voices and arpeggiator, listening on one MIDI channel. A part renders
+// into its own buffer without touching any other part, so parts can run
+// on separate threads; the synth then mixes them and feeds their sends
+// to the shared bus.
+#define PART_MAX_VOICES 64
+#define PART_BLOCK 1024               // Frames a part renders per pass
+#define PART_NOTE_ROWS 17             // Part-wide notes, then 16 MPE member channels
+
+typedef struct Part {
+  Oscillator osc[4];
+  LFO lfos[3];                  // lfos[0] for pitch, lfos[1] for volume, lfos[2] for filter
+  float osc_gain[4];
+  AdsrEnvelope adsr;            // Copied into every voice
+  Voice voices[PART_MAX_VOICES];
+  int max_voices;
+  // Voice playing each note, -1 for none: row 0 holds part-wide notes,
+  // row c + 1 the notes of MPE member channel c. Kept in step with the
+  // voices, so note off and poly pressure never search.
+  signed char note_voice[PART_NOTE_ROWS][128];
+  unsigned long long timestamp_counter;
+  Arpeggiator arp;
+
+  int channel;                  // MIDI channel 1-16, 0 = all channels
+  float level;
+  float pan;                    // -1 (left) to 1 (right)
+  float reverb_send;            // Post-fader sends to the shared bus
+  float delay_send;
+
+  // Channel performance state, set from MIDI at block start
+  float bend_range;             // Semitones at full pitch bend
+  float bend;                   // Current bend in semitones
+  float aftertouch;             // Level boost at full pressure (0-1)
+  float pressure;               // Channel aftertouch, 0-1
+  int program;                  // Last program change, -1 for none
+
+  // Audio thread: output of the current pass
+  float out[PART_BLOCK * 2];
+  float vbuf[PART_BLOCK * 2];
+} Part;
+
+// The sound of a part, as selected by program change: everything a patch
+// sets, none of the playing state
+typedef struct {
+  Oscillator osc[4];
+  LFO lfos[3];
+  float osc_gain[4];
+  AdsrEnvelope adsr;
+  Arpeggiator arp;
+} PartProgram;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void part_init(Part *part, int samplerate, int voices, int channel);
+// Noise, random LFOs and arpeggiator chance all draw from seed
+void part_seed(Part *part, unsigned int seed);
+void part_note_on(Part *part, int note, float velocity);
+void part_note_off(Part *part, int note);
+// channel is an MPE member channel 0-15, or -1 for a part-wide note.
+// Returns the voice now playing the note, NULL for notes outside 0-127.
+Voice *part_channel_note_on(Part *part, int channel, int note, float velocity);
+void part_channel_note_off(Part *part, int channel, int note);
+// The voice sounding a note, or NULL
+Voice *part_find_voice(Part *part, int channel, int note);
+// Per-note expression for every note on an MPE member channel: bend in
+// semitones, pressure and timbre 0-1
+void part_channel_expression(Part *part, int channel, float bend, float pressure, float timbre);
+int part_active_voices(const Part *part);
+// channel is 0-15
+int part_listens(const Part *part, int channel);
+// Nothing sounding and nothing scheduled, so a pass can skip the part
+int part_is_idle(const Part *part);
+
+// Audio thread: arpeggiator note offs, ratchets and steps due at t
+void part_fire_events(Part *part, const Transport *t);
+// Frames until the next arpeggiator event, at most 'limit'
+int part_next_event(const Part *part, const Transport *t, int limit);
+// Add 'frames' of every active voice to out
+void part_render_voices(Part *part, float *out, int frames);
+
+void part_store_program(const Part *part, PartProgram *program);
+// Audio thread: switch to a program; sounding notes keep playing with it
+void part_apply_program(Part *part, const PartProgram *program);
+// Poly aftertouch for a sounding note, 0-1; channel as for note on
+void part_note_pressure(Part *part, int channel, int note, float pressure);
+
+#ifdef __cplusplus
+}
+#endif
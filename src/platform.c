@@ -0,0 +1,262 @@
+#include "platform.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define PLATFORM_NO_THREADS 1
+#endif
+
+static PlatformLogFn log_fn = NULL;
+static void *log_userdata = NULL;
+
+void platform_barrier_release(void) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  MemoryBarrier();
+#else
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+}
+
+void platform_barrier_acquire(void) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  MemoryBarrier();
+#else
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+#endif
+}
+
+#if defined(_WIN32)
+
+struct PlatformThread {
+  HANDLE handle;
+  PlatformThreadFn fn;
+  void *data;
+};
+
+struct PlatformSem {
+  HANDLE handle;
+};
+
+static DWORD WINAPI thread_entry(LPVOID arg) {
+  PlatformThread *t = (PlatformThread *)arg;
+  return (DWORD)t->fn(t->data);
+}
+
+PlatformThread *platform_thread_create(PlatformThreadFn fn, const char *name, void *data) {
+  (void)name;
+  PlatformThread *t = (PlatformThread *)calloc(1, sizeof(PlatformThread));
+  if (!t)
+    return NULL;
+  t->fn = fn;
+  t->data = data;
+  t->handle = CreateThread(NULL, 0, thread_entry, t, 0, NULL);
+  if (!t->handle) {
+    free(t);
+    return NULL;
+  }
+  return t;
+}
+
+void platform_thread_join(PlatformThread *thread) {
+  if (!thread)
+    return;
+  WaitForSingleObject(thread->handle, INFINITE);
+  CloseHandle(thread->handle);
+  free(thread);
+}
+
+void platform_thread_set_realtime(void) {
+  SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+}
+
+int platform_cpu_count(void) {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (int)info.dwNumberOfProcessors;
+}
+
+PlatformSem *platform_sem_create(int initial) {
+  PlatformSem *sem = (PlatformSem *)calloc(1, sizeof(PlatformSem));
+  if (!sem)
+    return NULL;
+  sem->handle = CreateSemaphore(NULL, initial, 0x7fffffff, NULL);
+  if (!sem->handle) {
+    free(sem);
+    return NULL;
+  }
+  return sem;
+}
+
+void platform_sem_wait(PlatformSem *sem) { WaitForSingleObject(sem->handle, INFINITE); }
+void platform_sem_post(PlatformSem *sem) { ReleaseSemaphore(sem->handle, 1, NULL); }
+
+void platform_sem_destroy(PlatformSem *sem) {
+  if (!sem)
+    return;
+  CloseHandle(sem->handle);
+  free(sem);
+}
+
+uint64_t platform_ticks(void) {
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  return (uint64_t)now.QuadPart;
+}
+
+uint64_t platform_ticks_per_second(void) {
+  LARGE_INTEGER freq;
+  QueryPerformanceFrequency(&freq);
+  return (uint64_t)freq.QuadPart;
+}
+
+void platform_sleep_ms(int ms) { Sleep((DWORD)ms); }
+
+#else
+
+struct PlatformThread {
+  pthread_t handle;
+  PlatformThreadFn fn;
+  void *data;
+};
+
+// Mutex and condition rather than sem_t, which macOS does not implement
+struct PlatformSem {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int count;
+};
+
+static void *thread_entry(void *arg) {
+  PlatformThread *t = (PlatformThread *)arg;
+  t->fn(t->data);
+  return NULL;
+}
+
+PlatformThread *platform_thread_create(PlatformThreadFn fn, const char *name, void *data) {
+  (void)name;
+#ifdef PLATFORM_NO_THREADS
+  (void)fn;
+  (void)data;
+  return NULL;
+#else
+  PlatformThread *t = (PlatformThread *)calloc(1, sizeof(PlatformThread));
+  if (!t)
+    return NULL;
+  t->fn = fn;
+  t->data = data;
+  if (pthread_create(&t->handle, NULL, thread_entry, t) != 0) {
+    free(t);
+    return NULL;
+  }
+  return t;
+#endif
+}
+
+void platform_thread_join(PlatformThread *thread) {
+  if (!thread)
+    return;
+  pthread_join(thread->handle, NULL);
+  free(thread);
+}
+
+void platform_thread_set_realtime(void) {
+#ifndef PLATFORM_NO_THREADS
+  // Needs privileges on most systems; without them the thread keeps its
+  // normal priority
+  struct sched_param param;
+  param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+  pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+}
+
+int platform_cpu_count(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+#else
+  return 1;
+#endif
+}
+
+PlatformSem *platform_sem_create(int initial) {
+  PlatformSem *sem = (PlatformSem *)calloc(1, sizeof(PlatformSem));
+  if (!sem)
+    return NULL;
+  if (pthread_mutex_init(&sem->lock, NULL) != 0) {
+    free(sem);
+    return NULL;
+  }
+  if (pthread_cond_init(&sem->cond, NULL) != 0) {
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+    return NULL;
+  }
+  sem->count = initial;
+  return sem;
+}
+
+void platform_sem_wait(PlatformSem *sem) {
+  pthread_mutex_lock(&sem->lock);
+  while (sem->count == 0)
+    pthread_cond_wait(&sem->cond, &sem->lock);
+  sem->count--;
+  pthread_mutex_unlock(&sem->lock);
+}
+
+void platform_sem_post(PlatformSem *sem) {
+  pthread_mutex_lock(&sem->lock);
+  sem->count++;
+  pthread_cond_signal(&sem->cond);
+  pthread_mutex_unlock(&sem->lock);
+}
+
+void platform_sem_destroy(PlatformSem *sem) {
+  if (!sem)
+    return;
+  pthread_cond_destroy(&sem->cond);
+  pthread_mutex_destroy(&sem->lock);
+  free(sem);
+}
+
+uint64_t platform_ticks(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t platform_ticks_per_second(void) { return 1000000000u; }
+
+void platform_sleep_ms(int ms) {
+  struct timespec ts;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+  nanosleep(&ts, NULL);
+}
+
+#endif
+
+void platform_set_log(PlatformLogFn fn, void *userdata) {
+  log_fn = fn;
+  log_userdata = userdata;
+}
+
+void platform_log(const char *fmt, ...) {
+  char message[1024];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(message, sizeof(message), fmt, args);
+  va_end(args);
+  if (log_fn)
+    log_fn(log_userdata, message);
+  else
+    fprintf(stderr, "%s\n", message);
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <stdint.h>
+
+// Threads, atomics, timing and logging for the engine. The synth core
+// uses these instead of SDL, so it links into hosts that have no SDL and
+// several instances can share one process. Win32 and pthreads backends;
+// browser builds without pthreads get no threads.
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+typedef struct {
+  volatile long value;
+} PlatformAtomic;
+
+typedef struct {
+  void *volatile value;
+} PlatformAtomicPtr;
+
+typedef struct PlatformThread PlatformThread;
+typedef struct PlatformSem PlatformSem;
+typedef int (*PlatformThreadFn)(void *data);
+typedef void (*PlatformLogFn)(void *userdata, const char *message);
+
+// Set, add and set_ptr return the previous value, like SDL's atomics;
+// cas returns 1 when it swapped
+#if defined(_MSC_VER) && !defined(__clang__)
+static inline int platform_atomic_get(PlatformAtomic *a) { return (int)_InterlockedOr(&a->value, 0); }
+static inline int platform_atomic_set(PlatformAtomic *a, int v) { return (int)_InterlockedExchange(&a->value, v); }
+static inline int platform_atomic_add(PlatformAtomic *a, int v) { return (int)_InterlockedExchangeAdd(&a->value, v); }
+static inline int platform_atomic_cas(PlatformAtomic *a, int expected, int v) {
+  return _InterlockedCompareExchange(&a->value, v, expected) == expected;
+}
+static inline void *platform_atomic_get_ptr(PlatformAtomicPtr *a) {
+  return _InterlockedCompareExchangePointer((void *volatile *)&a->value, NULL, NULL);
+}
+static inline void *platform_atomic_set_ptr(PlatformAtomicPtr *a, void *v) {
+  return _InterlockedExchangePointer((void *volatile *)&a->value, v);
+}
+#else
+static inline int platform_atomic_get(PlatformAtomic *a) { return (int)__atomic_load_n(&a->value, __ATOMIC_SEQ_CST); }
+static inline int platform_atomic_set(PlatformAtomic *a, int v) { return (int)__atomic_exchange_n(&a->value, v, __ATOMIC_SEQ_CST); }
+static inline int platform_atomic_add(PlatformAtomic *a, int v) { return (int)__atomic_fetch_add(&a->value, v, __ATOMIC_SEQ_CST); }
+static inline int platform_atomic_cas(PlatformAtomic *a, int expected, int v) {
+  long e = expected;
+  return __atomic_compare_exchange_n(&a->value, &e, (long)v, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+static inline void *platform_atomic_get_ptr(PlatformAtomicPtr *a) { return __atomic_load_n(&a->value, __ATOMIC_SEQ_CST); }
+static inline void *platform_atomic_set_ptr(PlatformAtomicPtr *a, void *v) {
+  return __atomic_exchange_n(&a->value, v, __ATOMIC_SEQ_CST);
+}
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void platform_barrier_release(void);
+void platform_barrier_acquire(void);
+
+// NULL when threads are unavailable; callers fall back to running inline
+PlatformThread *platform_thread_create(PlatformThreadFn fn, const char *name, void *data);
+void platform_thread_join(PlatformThread *thread);
+// Best effort: raise the calling thread to audio priority
+void platform_thread_set_realtime(void);
+int platform_cpu_count(void);
+
+PlatformSem *platform_sem_create(int initial);
+void platform_sem_wait(PlatformSem *sem);
+void platform_sem_post(PlatformSem *sem);
+void platform_sem_destroy(PlatformSem *sem);
+
+uint64_t platform_ticks(void);
+uint64_t platform_ticks_per_second(void);
+void platform_sleep_ms(int ms);
+
+// Messages go to stderr unless the host installs its own sink. The sink is
+// process-wide; set it once before creating any synth.
+void platform_set_log(PlatformLogFn fn, void *userdata);
+void platform_log(const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+#include "send_bus.h"
+#include <math.h>
+#include <string.h>
+
+#define SEND_BUS_GLIDE_MS 80.0f
+
+void send_bus_init(SendBus *bus, float sample_rate) {
+  memset(bus, 0, sizeof(SendBus));
+  bus->sample_rate = sample_rate;
+
+  fdn_reverb_init(&bus->reverb, sample_rate);
+  send_bus_set_reverb(bus, 0.6f, 0.4f);
+  bus->reverb_return = 1.0f;
+
+  for (int ch = 0; ch < 2; ++ch)
+    delay_line_init(&bus->delay_line[ch], (int)(SEND_BUS_DELAY_SECONDS * sample_rate));
+  bus->delay_time = 0.375f;
+  bus->delay_feedback = 0.35f;
+  bus->delay_return = 1.0f;
+  delay_glide_init(&bus->delay_glide, bus->delay_time * sample_rate, SEND_BUS_GLIDE_MS,
+                   sample_rate);
+}
+
+void send_bus_set_reverb(SendBus *bus, float size, float damping) {
+  bus->reverb_size = size;
+  bus->reverb_damping = damping;
+  fdn_reverb_set_params(&bus->reverb, size, damping);
+}
+
+void send_bus_process(SendBus *bus, float *out, int frames) {
+  // Nothing to do once the sends are silent and the tails have decayed
+  if (bus->fed)
+    bus->tail = (long)(SEND_BUS_TAIL_SECONDS * bus->sample_rate);
+  else if (bus->tail <= 0)
+    return;
+  bus->tail -= frames;
+  bus->fed = 0;
+
+  // Fully wet reverb, in place on its send input
+  fdn_reverb_process(&bus->reverb, bus->reverb_in, frames, 1.0f);
+
+  float max_delay = (float)(bus->delay_line[0].size - 4);
+  float target = fmaxf(2.0f, fminf(max_delay, bus->delay_time * bus->sample_rate));
+  float feedback = fmaxf(0.0f, fminf(0.95f, bus->delay_feedback));
+  bus->delay_glide.target = target;
+
+  for (int i = 0; i < frames; ++i) {
+    float delay = delay_glide_next(&bus->delay_glide);
+    for (int ch = 0; ch < 2; ++ch) {
+      float wet = delay_line_read_cubic(&bus->delay_line[ch], delay);
+      delay_line_write(&bus->delay_line[ch], bus->delay_in[i * 2 + ch] + wet * feedback);
+      out[i * 2 + ch] += wet * bus->delay_return + bus->reverb_in[i * 2 + ch] * bus->reverb_return;
+    }
+  }
+
+  memset(bus->reverb_in, 0, sizeof(float) * frames * 2);
+  memset(bus->delay_in, 0, sizeof(float) * frames * 2);
+}
+
+void send_bus_cleanup(SendBus *bus) {
+  fdn_reverb_cleanup(&bus->reverb);
+  for (int ch = 0; ch < 2; ++ch)
+    delay_line_cleanup(&bus->delay_line[ch]);
+}
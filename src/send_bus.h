@@ -0,0 +1,45 @@
+#pragma once
+#include "delay_line.h"
+#include "fdn_reverb.h"
+#include "part.h"
+
+// Shared effects fed by every part's reverb and delay sends. The returns
+// are added to the part mix ahead of the master chain, so sixteen parts
+// share one reverb and one delay instead of running their own.
+#define SEND_BUS_DELAY_SECONDS 2.0f
+#define SEND_BUS_TAIL_SECONDS 10.0f  // Longest reverb or delay tail
+
+typedef struct {
+  FdnReverb reverb;
+  float reverb_size, reverb_damping;
+  float reverb_return;
+
+  DelayLine delay_line[2];
+  DelayGlide delay_glide;
+  float delay_time;             // Seconds
+  float delay_feedback;
+  float delay_return;
+
+  float sample_rate;
+
+  // Audio thread: send inputs of the current pass, summed over the parts
+  float reverb_in[PART_BLOCK * 2];
+  float delay_in[PART_BLOCK * 2];
+  int fed;                      // Something was sent this pass
+  long tail;                    // Frames until the returns have died out
+} SendBus;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void send_bus_init(SendBus *bus, float sample_rate);
+// Reverb size and damping take effect here, not in the audio loop
+void send_bus_set_reverb(SendBus *bus, float size, float damping);
+// Add the returns of this pass to out and clear the send inputs
+void send_bus_process(SendBus *bus, float *out, int frames);
+void send_bus_cleanup(SendBus *bus);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+#include "sequencer.h"
+#include "part.h"
+#include "utils.h"
+#include <math.h>
+#include <string.h>
+
+// Uniform in [0, 1)
+static float seq_random(Sequencer *seq) {
+  return rng_float(&seq->rng);
+}
+
+// Uniform in [-1, 1)
+static float seq_random_bipolar(Sequencer *seq) {
+  return seq_random(seq) * 2.0f - 1.0f;
+}
+
+void sequencer_init(Sequencer *seq, unsigned int seed) {
+  memset(seq, 0, sizeof(*seq));
+  platform_atomic_set(&seq->run_request, 0);
+  seq->humanize_velocity = 0.15f;
+  seq->humanize_timing = 0.03f;
+  seq->rng = rng_seed(seed);
+}
+
+void sequencer_toggle(Sequencer *seq) {
+  platform_atomic_set(&seq->run_request, !platform_atomic_get(&seq->run_request));
+}
+
+static void sequencer_generate(Sequencer *seq) {
+  static const int scale[] = {0, 2, 4, 5, 7, 9, 11};
+  static const int progression_patterns[][SEQ_MAX_CHORDS] = {
+    {0, 5, 3, 4, 2, 6, 1, 0},
+    {0, 3, 5, 4, 2, 1, 6, 5},
+    {0, 4, 5, 3, 1, 6, 2, 0},
+    {0, 5, 3, 4, 0, 5, 3, 6},
+    {0, 3, 4, 5, 1, 2, 6, 0},
+    {0, 4, 3, 5, 6, 1, 2, 4},
+    {0, 6, 3, 5, 4, 1, 2, 0},
+    {0, 2, 5, 3, 6, 4, 1, 0},
+  };
+  // 16-step rhythms, repeated to fill the bar
+  static const float base_patterns[][16] = {
+    {1.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.0f, 0.5f, 0.0f, 1.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.0f, 0.5f, 0.0f},
+    {1.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.5f, 0.0f, 1.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.5f, 0.0f, 0.0f},
+    {1.0f, 0.5f, 0.5f, 0.0f, 0.75f, 0.0f, 0.5f, 0.5f, 1.0f, 0.0f, 0.5f, 0.5f, 0.75f, 0.0f, 0.5f, 0.0f},
+    {1.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.75f, 0.0f, 1.0f, 0.0f, 0.5f, 0.0f, 0.5f, 0.75f, 0.0f, 0.0f},
+    {1.0f, 0.5f, 0.0f, 0.5f, 0.75f, 0.5f, 0.0f, 0.5f, 1.0f, 0.5f, 0.0f, 0.5f, 0.75f, 0.5f, 0.0f, 0.5f},
+  };
+
+  int pattern_idx = (int)(seq_random(seq) * 8);
+  int root = 48 + (int)(seq_random(seq) * 12);
+  seq->chord_count = SEQ_MAX_CHORDS;
+  for (int i = 0; i < SEQ_MAX_CHORDS; i++)
+    seq->chords[i] = root + scale[progression_patterns[pattern_idx][i]];
+
+  int rhythm_idx = (int)(seq_random(seq) * 5);
+  seq->step_count = SEQ_MAX_STEPS;
+  for (int i = 0; i < SEQ_MAX_STEPS; i++)
+    seq->rhythm[i] = base_patterns[rhythm_idx][i % 16];
+}
+
+static float humanize_velocity(Sequencer *seq, float velocity) {
+  velocity += seq_random_bipolar(seq) * seq->humanize_velocity;
+  if (velocity < 0.1f) velocity = 0.1f;
+  if (velocity > 1.0f) velocity = 1.0f;
+  return velocity;
+}
+
+static void stop_active_notes(Sequencer *seq, struct Part *part) {
+  for (int i = 0; i < seq->active_count; i++)
+    part_note_off(part, seq->active_notes[i]);
+  seq->active_count = 0;
+}
+
+static void play_chord(Sequencer *seq, struct Part *part, int root_note, float velocity) {
+  static const int intervals[SEQ_CHORD_NOTES] = {0, 3, 4, 7, 10, 12, 15, 16};
+  if (velocity <= 0.0f)
+    return;
+
+  velocity = humanize_velocity(seq, velocity);
+  for (int i = 0; i < SEQ_CHORD_NOTES; i++) {
+    int note = root_note + intervals[i];
+    part_note_on(part, note, humanize_velocity(seq, velocity));
+    seq->active_notes[seq->active_count++] = note;
+  }
+}
+
+static double sequencer_step_beats(const Sequencer *seq) {
+  return (double)TRANSPORT_BEATS_PER_BAR / seq->step_count;
+}
+
+void sequencer_fire(Sequencer *seq, const Transport *t, struct Part *part) {
+  int want = platform_atomic_get(&seq->run_request);
+
+  if (want && !seq->running) {
+    // A fresh progression; its first step plays on this sample
+    sequencer_generate(seq);
+    seq->running = 1;
+    seq->step = 0;
+    seq->next_step_beat = t->beat;
+    seq->jitter = 0.0;
+  } else if (!want && seq->running) {
+    stop_active_notes(seq, part);
+    seq->running = 0;
+    return;
+  }
+  if (!seq->running || !t->running ||
+      transport_frames_until_beat(t, seq->next_step_beat + seq->jitter) > 0)
+    return;
+
+  stop_active_notes(seq, part);
+
+  seq->rhythm_step = (int)(seq->step % seq->step_count);
+  seq->chord_index = (int)((seq->step / seq->step_count) % seq->chord_count);
+  play_chord(seq, part, seq->chords[seq->chord_index], seq->rhythm[seq->rhythm_step]);
+
+  // Humanize the next step by up to +/- humanize_timing seconds, but keep
+  // it inside its own half step so steps never swap order
+  double step_beats = sequencer_step_beats(seq);
+  double jitter = seq_random_bipolar(seq) * seq->humanize_timing * t->bpm / 60.0;
+  if (jitter > step_beats * 0.5) jitter = step_beats * 0.5;
+  if (jitter < -step_beats * 0.5) jitter = -step_beats * 0.5;
+  seq->step++;
+  seq->next_step_beat += step_beats;
+  seq->jitter = jitter;
+}
+
+void sequencer_locate(Sequencer *seq, const Transport *t, struct Part *part) {
+  stop_active_notes(seq, part);
+  if (!seq->running)
+    return;
+  // First step on or after the new position
+  double step_beats = sequencer_step_beats(seq);
+  seq->step = (long long)ceil(t->beat / step_beats - 1e-9);
+  seq->next_step_beat = seq->step * step_beats;
+  seq->jitter = 0.0;
+}
+
+int sequencer_next_event(const Sequencer *seq, const Transport *t, int limit) {
+  // A pending start or stop is handled at the top of the next sub-block
+  if (!seq->running)
+    return limit;
+  int n = transport_frames_until_beat(t, seq->next_step_beat + seq->jitter);
+  return n < limit ? n : limit;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "transport.h"
+#include "platform.h"
+
+struct Part; // Forward declaration
+
+// Chord progression player. It runs on the audio thread and schedules its
+// steps against the transport, so the groove keeps going while the window
+// is minimized or a frame stalls. The GUI only requests start/stop and
+// reads the position back through the synth snapshot. It plays the first
+// part.
+#define SEQ_MAX_CHORDS 8
+#define SEQ_MAX_STEPS 128             // Rhythm steps per bar
+#define SEQ_CHORD_NOTES 8
+
+typedef struct {
+  PlatformAtomic run_request;   // Desired state, written by the GUI thread
+  float humanize_velocity;      // Random velocity spread (GUI edits directly)
+  float humanize_timing;        // Random timing spread in seconds
+
+  // Audio thread only
+  int running;
+  int chords[SEQ_MAX_CHORDS];   // Root note per chord
+  int chord_count;
+  float rhythm[SEQ_MAX_STEPS];  // Velocity per step, 0 = rest
+  int step_count;
+  int chord_index, rhythm_step; // Position of the last step played
+  long long step;               // Steps played since start
+  double next_step_beat;        // Grid position of the next step
+  double jitter;                // Humanized offset of the next step (beats)
+  int active_notes[SEQ_CHORD_NOTES];
+  int active_count;
+  unsigned int rng;             // rand() is not safe off the main thread
+} Sequencer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void sequencer_init(Sequencer *seq, unsigned int seed);
+// GUI thread: takes effect at the next audio block
+void sequencer_toggle(Sequencer *seq);
+// Audio thread: play whatever is due at t on the given part
+void sequencer_fire(Sequencer *seq, const Transport *t, struct Part *part);
+// Audio thread: the transport jumped or stopped. Ends the sounding chord
+// and puts the progression at the step that belongs to the new position.
+void sequencer_locate(Sequencer *seq, const Transport *t, struct Part *part);
+// Frames until the next step, at most 'limit'
+int sequencer_next_event(const Sequencer *seq, const Transport *t, int limit);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,606 @@
+#include "smf.h"
+#include "transport.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A message as read from a track, before the tempo map is applied
+typedef struct {
+  uint64_t tick;
+  unsigned int order;           // Position in the file, keeps the sort stable
+  unsigned int tempo;           // SMF_TEMPO: microseconds per quarter note
+  unsigned char status, data1, data2;
+} SmfRaw;
+
+typedef struct {
+  SmfRaw *items;
+  int count, capacity;
+} SmfRawList;
+
+static uint32_t read_be32(const unsigned char *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) |
+         (uint32_t)p[3];
+}
+
+static uint16_t read_be16(const unsigned char *p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Variable-length quantity of at most four bytes; 0 when it runs past end
+static int read_vlq(const unsigned char **p, const unsigned char *end, uint32_t *value) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i) {
+    if (*p >= end)
+      return 0;
+    unsigned char b = *(*p)++;
+    v = (v << 7) | (b & 0x7F);
+    if (!(b & 0x80)) {
+      *value = v;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int raw_push(SmfRawList *list, SmfRaw raw) {
+  if (list->count == list->capacity) {
+    int capacity = list->capacity ? list->capacity * 2 : 1024;
+    SmfRaw *items = realloc(list->items, sizeof(SmfRaw) * (size_t)capacity);
+    if (!items)
+      return 0;
+    list->items = items;
+    list->capacity = capacity;
+  }
+  raw.order = (unsigned int)list->count;
+  list->items[list->count++] = raw;
+  return 1;
+}
+
+// One MTrk chunk. A damaged track keeps the events read before the damage,
+// as most players do. Returns 0 only when memory runs out.
+static int parse_track(const unsigned char *p, const unsigned char *end, SmfRawList *list,
+                       uint64_t *end_tick) {
+  uint64_t tick = 0;
+  unsigned char running = 0;
+  while (p < end) {
+    uint32_t delta, len;
+    if (!read_vlq(&p, end, &delta) || p >= end)
+      break;
+    tick += delta;
+
+    unsigned char status = *p;
+    if (status & 0x80)
+      p++;
+    else if (running)
+      status = running; // Running status: the data bytes follow directly
+    else
+      break;
+
+    if (status == 0xFF) { // Meta event
+      running = 0;
+      if (p >= end)
+        break;
+      unsigned char type = *p++;
+      if (!read_vlq(&p, end, &len) || len > (uint32_t)(end - p))
+        break;
+      if (type == 0x2F) // End of track
+        break;
+      if (type == 0x51 && len == 3) {
+        SmfRaw raw = {0};
+        raw.tick = tick;
+        raw.status = SMF_TEMPO;
+        raw.tempo = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+        if (raw.tempo > 0 && !raw_push(list, raw))
+          return 0;
+      }
+      p += len;
+    } else if (status == 0xF0 || status == 0xF7) { // SysEx, skipped
+      running = 0;
+      if (!read_vlq(&p, end, &len) || len > (uint32_t)(end - p))
+        break;
+      p += len;
+    } else if (status > 0xF0) {
+      break; // System messages have no place in a file
+    } else {
+      running = status;
+      int kind = status & 0xF0;
+      int size = kind == 0xC0 || kind == 0xD0 ? 1 : 2;
+      if (end - p < size)
+        break;
+      SmfRaw raw = {0};
+      raw.tick = tick;
+      raw.status = status;
+      raw.data1 = p[0] & 0x7F;
+      raw.data2 = size == 2 ? p[1] & 0x7F : 0;
+      p += size;
+      if (!raw_push(list, raw))
+        return 0;
+    }
+  }
+  if (tick > *end_tick)
+    *end_tick = tick;
+  return 1;
+}
+
+// At the same tick: tempo first, then note offs, so a note that ends where
+// another track restarts it is not cut off
+static int raw_rank(const SmfRaw *r) {
+  int kind = r->status & 0xF0;
+  if (r->status == SMF_TEMPO)
+    return 0;
+  if (kind == 0x80 || (kind == 0x90 && r->data2 == 0))
+    return 1;
+  return 2;
+}
+
+static int raw_compare(const void *a, const void *b) {
+  const SmfRaw *x = (const SmfRaw *)a, *y = (const SmfRaw *)b;
+  if (x->tick != y->tick)
+    return x->tick < y->tick ? -1 : 1;
+  int rx = raw_rank(x), ry = raw_rank(y);
+  if (rx != ry)
+    return rx - ry;
+  return x->order < y->order ? -1 : (x->order > y->order);
+}
+
+// Data entry, (N)RPN selection and channel mode messages only make sense
+// in their original order, so a seek does not repeat them
+static int smf_chased_cc(int cc) {
+  return cc != 6 && cc != 38 && (cc < 96 || cc > 101) && cc < 120;
+}
+
+static void smf_chase_reset(SmfChase *chase) {
+  chase->next = 0;
+  for (int c = 0; c < 16; ++c)
+    chase->program[c] = chase->pressure[c] = chase->bend[c] = -1;
+  memset(chase->cc, -1, sizeof(chase->cc));
+}
+
+// Take in the event at chase->next
+static void smf_chase_step(SmfChase *chase, const SmfEvent *events) {
+  const SmfEvent *e = &events[chase->next++];
+  int c = e->status & 0x0F;
+  if (e->status == SMF_TEMPO)
+    return;
+  switch (e->status & 0xF0) {
+  case 0xB0:
+    if (smf_chased_cc(e->data1))
+      chase->cc[c][e->data1] = (signed char)e->data2;
+    break;
+  case 0xC0:
+    chase->program[c] = e->data1;
+    break;
+  case 0xD0:
+    chase->pressure[c] = e->data1;
+    break;
+  case 0xE0:
+    chase->bend[c] = (short)(e->data2 << 7 | e->data1);
+    break;
+  }
+}
+
+int smf_parse(const unsigned char *data, size_t size, float sample_rate, Smf *smf) {
+  memset(smf, 0, sizeof(Smf));
+  if (size < 14 || memcmp(data, "MThd", 4))
+    return 0;
+  uint32_t header = read_be32(data + 4);
+  if (header < 6 || header > size - 8)
+    return 0;
+  int format = read_be16(data + 8);
+  int tracks = read_be16(data + 10);
+  int division = read_be16(data + 12);
+  if (format > 1 || division == 0)
+    return 0;
+
+  // Quarter notes per tick. SMPTE files count real time and ignore tempo
+  // changes; they play as if at 120 BPM.
+  int smpte = division & 0x8000;
+  double beats_per_tick;
+  if (smpte) {
+    int fps = -(signed char)(division >> 8);
+    int per_frame = division & 0xFF;
+    if (fps <= 0 || per_frame == 0)
+      return 0;
+    beats_per_tick = 2.0 / ((fps == 29 ? 29.97 : fps) * per_frame);
+  } else {
+    beats_per_tick = 1.0 / division;
+  }
+
+  SmfRawList list = {0};
+  uint64_t end_tick = 0;
+  int found = 0;
+  size_t off = 8 + header;
+  while (off + 8 <= size && found < tracks) {
+    size_t body = off + 8;
+    uint32_t len = read_be32(data + off + 4);
+    if (len > size - body)
+      len = (uint32_t)(size - body);
+    if (!memcmp(data + off, "MTrk", 4)) {
+      if (!parse_track(data + body, data + body + len, &list, &end_tick)) {
+        free(list.items);
+        return 0;
+      }
+      found++;
+    }
+    off = body + len;
+  }
+  if (found == 0) {
+    free(list.items);
+    return 0;
+  }
+  qsort(list.items, (size_t)list.count, sizeof(SmfRaw), raw_compare);
+
+  int tempo_changes = 0;
+  for (int i = 0; i < list.count; ++i)
+    tempo_changes += list.items[i].status == SMF_TEMPO;
+  smf->tempos = malloc(sizeof(SmfTempo) * (size_t)(tempo_changes + 1));
+  smf->events = malloc(sizeof(SmfEvent) * (size_t)(list.count + 1));
+  if (!smf->tempos || !smf->events) {
+    free(list.items);
+    smf_free(smf);
+    return 0;
+  }
+  smf->tempos[0].beat = 0.0;
+  smf->tempos[0].frame = 0.0;
+  smf->tempos[0].frames_per_beat = smpte ? sample_rate / 2.0 : SMF_DEFAULT_TEMPO * 1e-6 * sample_rate;
+  smf->tempo_count = 1;
+
+  // Walk the merged tracks once, extending the tempo map as it changes
+  for (int i = 0; i < list.count; ++i) {
+    const SmfRaw *raw = &list.items[i];
+    double beat = raw->tick * beats_per_tick;
+    if (raw->status == SMF_TEMPO) {
+      if (smpte)
+        continue;
+      SmfTempo *last = &smf->tempos[smf->tempo_count - 1];
+      double frame = last->frame + (beat - last->beat) * last->frames_per_beat;
+      if (beat > last->beat)
+        last = &smf->tempos[smf->tempo_count++];
+      last->beat = beat;
+      last->frame = frame;
+      last->frames_per_beat = raw->tempo * 1e-6 * sample_rate;
+    }
+    SmfEvent *e = &smf->events[smf->count++];
+    e->frame = (uint64_t)(smf_frame_at_beat(smf, beat) + 0.5);
+    e->bpm = raw->status == SMF_TEMPO ? (float)(60e6 / raw->tempo) : 0.0f;
+    e->status = raw->status;
+    e->data1 = raw->data1;
+    e->data2 = raw->data2;
+  }
+  free(list.items);
+
+  smf->beats = end_tick * beats_per_tick;
+  smf->length = (uint64_t)(smf_frame_at_beat(smf, smf->beats) + 0.5);
+  if (smf->count > 0 && smf->events[smf->count - 1].frame > smf->length)
+    smf->length = smf->events[smf->count - 1].frame;
+
+  // Chase state at every bar line, so a jump only has to catch up on the
+  // rest of one bar and a loop wrap on nothing
+  smf->bar_count = (int)(smf_beat_at_frame(smf, (double)smf->length) / TRANSPORT_BEATS_PER_BAR) + 1;
+  smf->bars = malloc(sizeof(SmfChase) * (size_t)smf->bar_count);
+  if (!smf->bars) {
+    smf_free(smf);
+    return 0;
+  }
+  SmfChase chase;
+  smf_chase_reset(&chase);
+  for (int b = 0; b < smf->bar_count; ++b) {
+    uint64_t frame = (uint64_t)(smf_frame_at_beat(smf, (double)b * TRANSPORT_BEATS_PER_BAR) + 0.5);
+    while (chase.next < smf->count && smf->events[chase.next].frame < frame)
+      smf_chase_step(&chase, smf->events);
+    smf->bars[b] = chase;
+  }
+  smf->sample_rate = sample_rate;
+  smf->format = format;
+  smf->tracks = found;
+  return 1;
+}
+
+int smf_load(const char *path, float sample_rate, Smf *smf) {
+  memset(smf, 0, sizeof(Smf));
+
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return 0;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  if (size < 14) {
+    fclose(f);
+    return 0;
+  }
+  unsigned char *data = malloc((size_t)size);
+  if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+    free(data);
+    fclose(f);
+    return 0;
+  }
+  fclose(f);
+
+  int ok = smf_parse(data, (size_t)size, sample_rate, smf);
+  free(data);
+  return ok;
+}
+
+void smf_free(Smf *smf) {
+  free(smf->events);
+  free(smf->tempos);
+  free(smf->bars);
+  memset(smf, 0, sizeof(Smf));
+}
+
+double smf_frame_at_beat(const Smf *smf, double beat) {
+  int lo = 0, hi = smf->tempo_count - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (smf->tempos[mid].beat <= beat)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  const SmfTempo *t = &smf->tempos[lo];
+  return t->frame + (beat - t->beat) * t->frames_per_beat;
+}
+
+static const SmfTempo *smf_tempo_at_frame(const Smf *smf, double frame) {
+  int lo = 0, hi = smf->tempo_count - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (smf->tempos[mid].frame <= frame)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return &smf->tempos[lo];
+}
+
+double smf_beat_at_frame(const Smf *smf, double frame) {
+  const SmfTempo *t = smf_tempo_at_frame(smf, frame);
+  return t->beat + (frame - t->frame) / t->frames_per_beat;
+}
+
+int smf_find(const Smf *smf, uint64_t frame) {
+  int lo = 0, hi = smf->count;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (smf->events[mid].frame < frame)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static void smf_destroy(Smf *smf) {
+  if (smf) {
+    smf_free(smf);
+    free(smf);
+  }
+}
+
+void smf_player_init(SmfPlayer *player) {
+  memset(player, 0, sizeof(SmfPlayer));
+  player->loop_start = 1;
+}
+
+void smf_player_cleanup(SmfPlayer *player) {
+  smf_destroy(player->song);
+  smf_destroy((Smf *)platform_atomic_set_ptr(&player->pending, NULL));
+  smf_destroy((Smf *)platform_atomic_set_ptr(&player->retired, NULL));
+  player->song = NULL;
+  player->playing = 0;
+}
+
+int smf_player_load(SmfPlayer *player, const char *path, float sample_rate) {
+  Smf *smf = (Smf *)malloc(sizeof(Smf));
+  if (!smf || !smf_load(path, sample_rate, smf)) {
+    free(smf);
+    platform_log("Failed to load MIDI file: %s", path);
+    return 0;
+  }
+
+  // A new song starts stopped. The audio thread only takes a pending song
+  // once the retired slot is empty, and never touches a retired one again.
+  platform_atomic_set(&player->run_request, 0);
+  platform_atomic_set(&player->seek_request, 0);
+  smf_destroy((Smf *)platform_atomic_set_ptr(&player->retired, NULL));
+  smf_destroy((Smf *)platform_atomic_set_ptr(&player->pending, smf));
+  snprintf(player->path, sizeof(player->path), "%s", path);
+  platform_log("Loaded MIDI file %s (type %d, %d tracks, %d events, %.1f bars)", path,
+               smf->format, smf->tracks, smf->count, smf->beats / TRANSPORT_BEATS_PER_BAR);
+  return 1;
+}
+
+void smf_player_play(SmfPlayer *player, int play) {
+  platform_atomic_set(&player->run_request, play != 0);
+}
+
+void smf_player_seek(SmfPlayer *player, double beat) {
+  platform_atomic_set(&player->seek_request, (int)(beat > 0.0 ? beat * 4.0 + 0.5 : 0.0) + 1);
+}
+
+static void smf_player_send(SmfPlayer *player, const SmfEvent *e, SmfSendFn send, void *ctx) {
+  int kind = e->status & 0xF0;
+  unsigned short *held = &player->held[e->status & 0x0F][e->data1 >> 4];
+  unsigned short bit = (unsigned short)(1u << (e->data1 & 15));
+  if (kind == 0x90 && e->data2 > 0)
+    *held |= bit;
+  else if (kind == 0x80 || kind == 0x90)
+    *held &= (unsigned short)~bit;
+  send(ctx, e);
+}
+
+// Note off for every note the song left sounding
+static void smf_player_release(SmfPlayer *player, SmfSendFn send, void *ctx) {
+  for (int c = 0; c < 16; ++c) {
+    for (int w = 0; w < 8; ++w) {
+      for (int b = 0; player->held[c][w]; ++b) {
+        if (!(player->held[c][w] & (1u << b)))
+          continue;
+        SmfEvent off = {0};
+        off.status = (unsigned char)(0x80 | c);
+        off.data1 = (unsigned char)(w * 16 + b);
+        smf_player_send(player, &off, send, ctx);
+      }
+    }
+  }
+}
+
+// Resend what the skipped part of the song left each channel at: tempo,
+// program, controllers, pressure and pitch bend
+static void smf_player_chase(SmfPlayer *player, SmfSendFn send, void *ctx) {
+  const Smf *s = player->song;
+  // Start from the last bar line before the position; a loop start is one
+  int bar = (int)(smf_beat_at_frame(s, (double)player->position) / TRANSPORT_BEATS_PER_BAR);
+  if (bar >= s->bar_count)
+    bar = s->bar_count - 1;
+  while (bar > 0 && s->bars[bar].next > player->next)
+    bar--;
+  SmfChase *chase = &player->chase;
+  *chase = s->bars[bar];
+  while (chase->next < player->next)
+    smf_chase_step(chase, s->events);
+
+  // The tempo map knows the tempo even where the file never set one
+  SmfEvent tempo = {0};
+  tempo.status = SMF_TEMPO;
+  tempo.bpm = (float)(60.0 * s->sample_rate /
+                      smf_tempo_at_frame(s, (double)player->position)->frames_per_beat);
+  send(ctx, &tempo);
+  for (int c = 0; c < 16; ++c) {
+    SmfEvent e = {0};
+    if (chase->program[c] >= 0) {
+      e.status = (unsigned char)(0xC0 | c);
+      e.data1 = (unsigned char)chase->program[c];
+      send(ctx, &e);
+    }
+    for (int n = 0; n < 128; ++n) {
+      if (chase->cc[c][n] < 0)
+        continue;
+      e.status = (unsigned char)(0xB0 | c);
+      e.data1 = (unsigned char)n;
+      e.data2 = (unsigned char)chase->cc[c][n];
+      send(ctx, &e);
+    }
+    if (chase->pressure[c] >= 0) {
+      e.status = (unsigned char)(0xD0 | c);
+      e.data1 = (unsigned char)chase->pressure[c];
+      e.data2 = 0;
+      send(ctx, &e);
+    }
+    if (chase->bend[c] >= 0) {
+      e.status = (unsigned char)(0xE0 | c);
+      e.data1 = (unsigned char)(chase->bend[c] & 0x7F);
+      e.data2 = (unsigned char)(chase->bend[c] >> 7);
+      send(ctx, &e);
+    }
+  }
+}
+
+static void smf_player_locate(SmfPlayer *player, uint64_t frame, SmfSendFn send, void *ctx) {
+  smf_player_release(player, send, ctx);
+  player->position = frame;
+  player->next = smf_find(player->song, frame);
+  smf_player_chase(player, send, ctx);
+}
+
+// Loop region in frames; 0 while looping is off or the region is empty
+static int smf_player_loop(const SmfPlayer *player, uint64_t *start, uint64_t *end) {
+  const Smf *s = player->song;
+  if (!player->loop)
+    return 0;
+  int first = player->loop_start > 1 ? player->loop_start - 1 : 0;
+  *start = (uint64_t)(smf_frame_at_beat(s, (double)first * TRANSPORT_BEATS_PER_BAR) + 0.5);
+  *end = player->loop_end > 0
+             ? (uint64_t)(smf_frame_at_beat(s, (double)player->loop_end * TRANSPORT_BEATS_PER_BAR) + 0.5)
+             : s->length;
+  return *end > *start;
+}
+
+int smf_player_update(SmfPlayer *player, SmfSendFn send, void *ctx) {
+  // Swap in a freshly loaded song; the old one is freed off this thread
+  if (!platform_atomic_get_ptr(&player->retired)) {
+    Smf *next = (Smf *)platform_atomic_set_ptr(&player->pending, NULL);
+    if (next) {
+      smf_player_release(player, send, ctx);
+      platform_atomic_set_ptr(&player->retired, player->song);
+      player->song = next;
+      player->playing = 0;
+      player->position = 0;
+      player->next = 0;
+    }
+  }
+  const Smf *s = player->song;
+  if (!s)
+    return 0;
+
+  int moved = 0;
+  int seek = platform_atomic_set(&player->seek_request, 0);
+  if (seek > 0) {
+    double frame = smf_frame_at_beat(s, (seek - 1) / 4.0);
+    smf_player_locate(player, frame < (double)s->length ? (uint64_t)(frame + 0.5) : s->length,
+                      send, ctx);
+    moved = SMF_PLAYER_MOVED;
+  }
+
+  int run = platform_atomic_get(&player->run_request);
+  if (run && !player->playing) {
+    // Resume where the song stopped, or play again from the top
+    smf_player_locate(player, player->position < s->length ? player->position : 0, send, ctx);
+    player->playing = 1;
+    moved = SMF_PLAYER_MOVED;
+  } else if (!run && player->playing) {
+    smf_player_release(player, send, ctx);
+    player->playing = 0;
+  }
+  // While stopped the transport is not the song's to move
+  return player->playing ? moved : 0;
+}
+
+int smf_player_fire(SmfPlayer *player, SmfSendFn send, void *ctx) {
+  const Smf *s = player->song;
+  if (!player->playing || !s)
+    return 0;
+
+  int moved = 0;
+  uint64_t start, end;
+  int looping = smf_player_loop(player, &start, &end);
+  if (looping && player->position >= end) {
+    smf_player_locate(player, start, send, ctx);
+    moved = SMF_PLAYER_MOVED;
+  }
+
+  while (player->next < s->count && s->events[player->next].frame <= player->position)
+    smf_player_send(player, &s->events[player->next++], send, ctx);
+
+  if (!looping && player->position >= s->length) {
+    smf_player_release(player, send, ctx);
+    player->playing = 0;
+    platform_atomic_cas(&player->run_request, 1, 0);
+  }
+  return moved;
+}
+
+int smf_player_next_event(const SmfPlayer *player, int limit) {
+  const Smf *s = player->song;
+  if (!player->playing || !s)
+    return limit;
+
+  uint64_t start, until;
+  if (!smf_player_loop(player, &start, &until))
+    until = s->length;
+  if (player->next < s->count && s->events[player->next].frame < until)
+    until = s->events[player->next].frame;
+  if (until <= player->position)
+    return 0;
+  return until - player->position < (uint64_t)limit ? (int)(until - player->position) : limit;
+}
+
+void smf_player_advance(SmfPlayer *player, int frames) {
+  if (player->playing)
+    player->position += (uint64_t)frames;
+}
+
+double smf_player_beat(const SmfPlayer *player) {
+  return player->song ? smf_beat_at_frame(player->song, (double)player->position) : 0.0;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "platform.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Standard MIDI File playback. A type 0 or 1 file is compiled once, off
+// the audio thread, into a single array of channel messages sorted by the
+// sample frame they fall on, with the file's tempo map already applied.
+// The player then walks that array with an index: the synth cuts its
+// render passes at event frames, so every message lands on its exact
+// sample and nothing converts ticks while audio runs.
+#define SMF_TEMPO 0xFF                // Event status of a tempo change
+#define SMF_DEFAULT_TEMPO 500000      // Microseconds per quarter note until set
+#define SMF_PATH_SIZE 256
+
+typedef struct {
+  uint64_t frame;               // Sample offset from the start of the song
+  float bpm;                    // SMF_TEMPO only
+  unsigned char status, data1, data2;
+} SmfEvent;
+
+// A stretch of constant tempo, from 'beat' on
+typedef struct {
+  double beat;                  // Quarter notes from the start
+  double frame;
+  double frames_per_beat;
+} SmfTempo;
+
+// What the song has left each channel at up to an event, for resending
+// after a jump; -1 where the song has not set it yet
+typedef struct {
+  int next;                     // Covers the events before this one
+  short program[16], pressure[16], bend[16];
+  signed char cc[16][128];
+} SmfChase;
+
+typedef struct {
+  SmfEvent *events;             // Channel messages and tempo changes, by frame
+  int count;
+  SmfTempo *tempos;             // Tempo map, by beat; at least one entry
+  int tempo_count;
+  SmfChase *bars;               // Chase state at every bar line
+  int bar_count;
+  uint64_t length;              // Frames to the end of the longest track
+  double beats;                 // The same in quarter notes
+  float sample_rate;            // Frames are counted at this rate
+  int format, tracks;
+} Smf;
+
+// What the player sends to the synth
+typedef void (*SmfSendFn)(void *ctx, const SmfEvent *event);
+
+// smf_player_update() and smf_player_fire() result
+#define SMF_PLAYER_MOVED 1            // The song jumped; relocate the transport
+
+typedef struct {
+  // Any thread
+  PlatformAtomicPtr pending;    // Song published by the loader
+  PlatformAtomicPtr retired;    // Replaced song, freed by the next load
+  PlatformAtomic run_request;   // 1 plays, 0 stops
+  PlatformAtomic seek_request;  // Sixteenth note + 1 to seek to, 0 for none
+  int loop;                     // Loop the bars below (GUI, params)
+  int loop_start, loop_end;     // First and last bar, from 1; loop_end 0 is the song end
+  char path[SMF_PATH_SIZE];     // Last file loaded, for display
+
+  // Audio thread
+  Smf *song;
+  int playing;
+  int next;                     // Next event to send
+  uint64_t position;            // Song frame at the start of the next pass
+  unsigned short held[16][8];   // Sounding notes per channel, one bit each
+  SmfChase chase;               // Rebuilt from the nearest bar line after a jump
+} SmfPlayer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns 1 on success, 0 for data that is not a type 0 or 1 file (smf is
+// left zeroed). Times are compiled for 'sample_rate'.
+int smf_parse(const unsigned char *data, size_t size, float sample_rate, Smf *smf);
+int smf_load(const char *path, float sample_rate, Smf *smf);
+void smf_free(Smf *smf);
+double smf_frame_at_beat(const Smf *smf, double beat);
+double smf_beat_at_frame(const Smf *smf, double frame);
+// Index of the first event at or after 'frame'
+int smf_find(const Smf *smf, uint64_t frame);
+
+void smf_player_init(SmfPlayer *player);
+void smf_player_cleanup(SmfPlayer *player);
+// Loader thread: parse a file and hand it to the audio thread, stopped
+// at the start. Returns 0 when the file cannot be read.
+int smf_player_load(SmfPlayer *player, const char *path, float sample_rate);
+// Any thread
+void smf_player_play(SmfPlayer *player, int play);
+void smf_player_seek(SmfPlayer *player, double beat);
+
+// Audio thread, block start: take a new song, then play, stop and seek
+// requests. Notes cut short are sent their note off; after a seek, and
+// when playback starts, the tempo and the last program, controllers and
+// pitch bend of every channel are sent again.
+int smf_player_update(SmfPlayer *player, SmfSendFn send, void *ctx);
+// Audio thread, pass start: send the events due now, wrapping at the loop
+// end and stopping at the song end
+int smf_player_fire(SmfPlayer *player, SmfSendFn send, void *ctx);
+// Frames until the next event, loop end or song end, at most 'limit'
+int smf_player_next_event(const SmfPlayer *player, int limit);
+void smf_player_advance(SmfPlayer *player, int frames);
+// Song position in quarter notes
+double smf_player_beat(const SmfPlayer *player);
+
+#ifdef __cplusplus
+}
+#endif
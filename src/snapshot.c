@@ -0,0 +1,29 @@
+#include "snapshot.h"
+#include <string.h>
+
+void snapshot_channel_init(SnapshotChannel *ch) {
+  memset(ch->slots, 0, sizeof(ch->slots));
+  ch->back = 0;
+  platform_atomic_set(&ch->middle, 1);
+  ch->front = 2;
+}
+
+SynthSnapshot *snapshot_write_begin(SnapshotChannel *ch) {
+  return &ch->slots[ch->back];
+}
+
+void snapshot_publish(SnapshotChannel *ch) {
+  // Slot contents must be visible before the index that hands it over
+  platform_barrier_release();
+  int old = platform_atomic_set(&ch->middle, ch->back | SNAPSHOT_FRESH);
+  ch->back = old & (SNAPSHOT_FRESH - 1);
+}
+
+const SynthSnapshot *snapshot_read(SnapshotChannel *ch) {
+  if (platform_atomic_get(&ch->middle) & SNAPSHOT_FRESH) {
+    int old = platform_atomic_set(&ch->middle, ch->front);
+    ch->front = old & (SNAPSHOT_FRESH - 1);
+    platform_barrier_acquire();
+  }
+  return &ch->slots[ch->front];
+}
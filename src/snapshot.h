@@ -0,0 +1,65 @@
+#pragma once
+#include "platform.h"
+
+// Meter and voice state published by the audio thread once per block and
+// read by the GUI. A triple buffer swaps slots through one atomic index, so
+// the writer never waits for the reader and the reader always sees a
+// complete block's worth of values.
+#define SNAPSHOT_MAX_VOICES 64
+#define SNAPSHOT_MAX_PARTS 16
+#define SNAPSHOT_FRESH 4              // Flag on the middle index: not read yet
+
+typedef struct {
+  float note;
+  float level;                  // Envelope output (0 to 1)
+  int phase;                    // AdsrPhase
+} VoiceSnapshot;
+
+typedef struct {
+  float cpu_usage;              // Process CPU time per buffer (%)
+  float dsp_load;               // Audio callback time per buffer (%)
+  int active_voices;            // Entries used in voices[] (edit part)
+  VoiceSnapshot voices[SNAPSHOT_MAX_VOICES];
+  int part_voices[SNAPSHOT_MAX_PARTS]; // Sounding voices per part
+
+  float peak_level, rms_level;  // dBFS
+  float comp_gain_reduction;    // dB
+  float limiter_gain_reduction; // dB
+  float lufs_momentary, lufs_short_term, lufs_integrated;
+  float true_peak;              // dBTP
+  int conv_late_blocks;
+
+  int midi_last_cc, midi_last_cc_value;
+
+  double transport_beat;        // Song position at the end of the block
+  float transport_bpm;
+  int transport_running;
+  int clock_following;          // Tempo comes from MIDI clock
+  int song_playing;             // MIDI file position and length, in beats
+  double song_beat, song_beats;
+  int seq_running;              // Chord progression position
+  int seq_chord_index, seq_chord_count;
+  int seq_rhythm_step, seq_step_count;
+} SynthSnapshot;
+
+typedef struct {
+  SynthSnapshot slots[3];
+  PlatformAtomic middle;        // Last published slot | SNAPSHOT_FRESH
+  int back;                     // Slot the writer fills (audio thread only)
+  int front;                    // Slot the reader holds (GUI thread only)
+} SnapshotChannel;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void snapshot_channel_init(SnapshotChannel *ch);
+// Writer side: fill the returned slot, then publish it
+SynthSnapshot *snapshot_write_begin(SnapshotChannel *ch);
+void snapshot_publish(SnapshotChannel *ch);
+// Reader side: newest published snapshot, valid until the next call
+const SynthSnapshot *snapshot_read(SnapshotChannel *ch);
+
+#ifdef __cplusplus
+}
+#endif
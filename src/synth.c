@@ -1,6 +1,6 @@
 #include "synth.h"
-#include "midi.h"
-#include "oscilloscope.h"
+#include "params.h"
+#include "utils.h"
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -11,8 +11,6 @@ static int order_compare(const void *a, const void *b) {
   return (*(int *)a) - (*(int *)b);
 }
 
-static int arp_last_played_note = -1;
-
 // Define a simple startup chord progression
 static MelodyNote startup_melody[] = {
     // C Major Chord
@@ -37,454 +35,700 @@ static MelodyNote startup_melody[] = {
 
     {-1, 0.0f, 0.0f}  // End marker
 };
-static int current_melody_note_idx = 0;
-static float melody_time_elapsed = 0.0f;
-static int melody_playing = 0;
-
-typedef struct {
-    int note;
-    float remaining_duration;
-    int active;
-} ActiveMelodyNote;
-#define MAX_MELODY_POLYPHONY 8 
-static ActiveMelodyNote active_melody_notes[MAX_MELODY_POLYPHONY];
-
-void synth_update_arpeggiator(Synth *synth, int frames) {
-    Arpeggiator *arp = &synth->arp;
-    if (!arp->enabled || arp->held_count == 0) {
-        if (arp_last_played_note != -1) {
-            synth_note_off(synth, arp_last_played_note);
-            arp_last_played_note = -1;
-        }
-        return;
-    }
-
-    float dt = (float)frames / synth->sample_rate;
-    float step_time = 60.0f / arp->tempo / 4.0f; // 16th notes
-
-    arp->step_phase += dt;
-
-    // Update active arpeggiated notes duration every frame
-    for (int i = 0; i < 16; ++i) {
-        if (arp->active_arpeggiated_notes[i].active) {
-            arp->active_arpeggiated_notes[i].remaining_duration -= dt;
-            if (arp->active_arpeggiated_notes[i].remaining_duration <= 0) {
-                synth_note_off(synth, arp->active_arpeggiated_notes[i].note);
-                arp->active_arpeggiated_notes[i].active = 0;
-            }
-        }
-    }
-
-    if (arp->step_phase >= step_time) {
-        arp->step_phase -= step_time;
 
-        // The arpeggiator_step function now handles note_on/off directly
-        arpeggiator_step(arp, synth->sample_rate, synth);
-        
-        arp->step++;
-    }
+static unsigned long long melody_frames(const Synth *synth, float seconds) {
+    return (unsigned long long)(seconds * synth->sample_rate + 0.5f);
 }
 
 void synth_play_startup_melody(Synth *synth) {
-    current_melody_note_idx = 0;
-    melody_time_elapsed = 0.0f;
-    melody_playing = 1;
+    MelodyPlayer *mp = &synth->melody;
+    mp->index = 0;
+    mp->next_frame = synth->transport.frame + melody_frames(synth, startup_melody[0].duration);
+    mp->playing = 1;
 }
 
-void synth_update_startup_melody(Synth *synth, int frames) {
-    if (!melody_playing) return;
-
-    float dt = (float)frames / synth->sample_rate;
+static void synth_fire_startup_melody(Synth *synth, const Transport *t, Part *part) {
+    MelodyPlayer *mp = &synth->melody;
 
-    // Update active notes and turn off expired ones
+    // Turn off expired notes, including the tail after the melody ends
     for (int i = 0; i < MAX_MELODY_POLYPHONY; ++i) {
-        if (active_melody_notes[i].active) {
-            active_melody_notes[i].remaining_duration -= dt;
-            if (active_melody_notes[i].remaining_duration <= 0) {
-                synth_note_off(synth, active_melody_notes[i].note);
-                active_melody_notes[i].active = 0;
-            }
+        if (mp->active[i].active &&
+            transport_frames_until_frame(t, mp->active[i].off_frame) <= 0) {
+            part_note_off(part, mp->active[i].note);
+            mp->active[i].active = 0;
         }
     }
 
-    melody_time_elapsed += dt;
+    if (!mp->playing || transport_frames_until_frame(t, mp->next_frame) > 0)
+        return;
 
-    if (startup_melody[current_melody_note_idx].note == -1) { // End of melody
-        melody_playing = 0;
-        // Turn off any remaining active notes
-        for (int i = 0; i < MAX_MELODY_POLYPHONY; ++i) {
-            if (active_melody_notes[i].active) {
-                synth_note_off(synth, active_melody_notes[i].note);
-                active_melody_notes[i].active = 0;
-            }
-        }
+    const MelodyNote *m = &startup_melody[mp->index];
+    if (m->note == -1) { // End of melody
+        mp->playing = 0;
         return;
     }
 
-    if (melody_time_elapsed >= startup_melody[current_melody_note_idx].duration) {
-        // Find a free slot for the new note
-        int free_slot = -1;
-        for (int i = 0; i < MAX_MELODY_POLYPHONY; ++i) {
-            if (!active_melody_notes[i].active) {
-                free_slot = i;
-                break;
-            }
+    // Find a free slot for the new note
+    int free_slot = -1;
+    for (int i = 0; i < MAX_MELODY_POLYPHONY; ++i) {
+        if (!mp->active[i].active) {
+            free_slot = i;
+            break;
         }
+    }
 
-        if (free_slot != -1) {
-            active_melody_notes[free_slot].note = startup_melody[current_melody_note_idx].note;
-            active_melody_notes[free_slot].remaining_duration = startup_melody[current_melody_note_idx].duration;
-            active_melody_notes[free_slot].active = 1;
-            synth_note_on(synth, startup_melody[current_melody_note_idx].note, startup_melody[current_melody_note_idx].velocity);
-        } else {
-            // No free slot, voice stealing will handle it if synth has enough voices
-            synth_note_on(synth, startup_melody[current_melody_note_idx].note, startup_melody[current_melody_note_idx].velocity);
+    if (free_slot != -1) {
+        mp->active[free_slot].note = m->note;
+        mp->active[free_slot].off_frame = t->frame + melody_frames(synth, m->duration);
+        mp->active[free_slot].active = 1;
+    }
+    // Without a free slot, voice stealing will handle it if the part has enough voices
+    part_note_on(part, m->note, m->velocity);
+
+    mp->index++;
+    mp->next_frame = t->frame + melody_frames(synth, startup_melody[mp->index].duration);
+}
+
+static int synth_melody_next_event(const Synth *synth, const Transport *t, int limit) {
+    const MelodyPlayer *mp = &synth->melody;
+    for (int i = 0; i < MAX_MELODY_POLYPHONY; ++i) {
+        if (mp->active[i].active) {
+            int n = transport_frames_until_frame(t, mp->active[i].off_frame);
+            if (n < limit)
+                limit = n;
         }
-        
-        melody_time_elapsed = 0.0f;
-        current_melody_note_idx++;
     }
+    if (mp->playing) {
+        int n = transport_frames_until_frame(t, mp->next_frame);
+        if (n < limit)
+            limit = n;
+    }
+    return limit;
 }
 
 int synth_init(Synth *synth, int samplerate, int buffer_size, int voices) {
   memset(synth, 0, sizeof(Synth));
-  synth->max_voices = voices;
   synth->sample_rate = samplerate;
   
-  srand(time(NULL)); // Seed random number generator
+  synth->rng = rng_seed((unsigned int)time(NULL));
+  synth->last_cc = -1;
 
+  snapshot_channel_init(&synth->snapshot);
   mixer_init(&synth->mixer);
   mixer_set_sample_rate(&synth->mixer, samplerate);
   synth_set_param(synth, "mixer.master", 1.0f);
   fx_init(&synth->fx, samplerate);
   synth_set_param(synth, "fx.delay.mix", 0.0f); // Set delay mix to 0.0
   synth_set_param(synth, "fx.reverb.mix", 0.05f); // Enable reverb with a mix of 0.05
+  send_bus_init(&synth->bus, samplerate);
   ring_mod_init(&synth->ring_mod, samplerate);
   // Set default ring modulator settings like Roland System 100
   synth_set_param(synth, "ring_mod.frequency", 20.0f);  // Low frequency for metallic character
   synth_set_param(synth, "ring_mod.mix", 0.0f);         // Disabled by default
   synth_set_param(synth, "ring_mod.enabled", 0);        // Disabled by default
-  arpeggiator_init(&synth->arp);
-  
 
-  synth->arp.enabled = 1; // Will be enabled when progression starts
-  synth->arp.tempo = 120.0f;
-  synth->arp.mode = ARP_UP;
-  
-  midi_init(&synth->midi, synth);
-  
-  // Initialize LFOs
-  for (int i = 0; i < 3; ++i) {
-    lfo_init(&synth->lfos[i], samplerate);
-  }
-  // Set default LFO targets
-  synth->lfos[0].target = LFO_TARGET_FREQUENCY;
-  synth->lfos[1].target = LFO_TARGET_AMPLITUDE;
-  synth->lfos[2].target = LFO_TARGET_FILTER;
-  // Set default LFO parameters
-  synth_set_param(synth, "lfo1.frequency", 2.0f);
-  synth_set_param(synth, "lfo1.depth", 0.1f);
-  synth_set_param(synth, "lfo1.waveform", LFO_SINE);
-  synth_set_param(synth, "lfo1.sync", 1.0f); // LFO_SYNC_RETRIGGER
-  synth_set_param(synth, "lfo2.sync", 1.0f); // LFO_SYNC_RETRIGGER
-  synth_set_param(synth, "lfo3.sync", 1.0f); // LFO_SYNC_RETRIGGER
-  
-  // synth_play_startup_melody(synth); // Start the melody at startup
-  
-  char param_name[16];
-  for (int i = 0; i < 4; ++i) { // Loop for all 4 oscillators
-    osc_init(&synth->osc[i], samplerate);
-
-    // Default parameters for main oscillators (0-3)
-    if (i < 4) {
+  transport_init(&synth->transport, samplerate);
+  sequencer_init(&synth->seq, rng_next(&synth->rng));
+  midi_map_load_defaults(&synth->midi_map);
+  midi_queue_init(&synth->midi_in);
+  mpe_init(&synth->mpe);
+  midi_clock_init(&synth->midi_clock);
+  smf_player_init(&synth->song);
+
+  // Every part starts from the same default patch on its own channel
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p) {
+    Part *part = &synth->parts[p];
+    part_init(part, samplerate, voices, p + 1);
+    part_seed(part, rng_next(&synth->rng));
+    part->arp.enabled = 1; // Will be enabled when progression starts
+    part->arp.mode = ARP_UP;
+
+    // Set default LFO parameters
+    synth_set_part_param(synth, p, "lfo1.frequency", 2.0f);
+    synth_set_part_param(synth, p, "lfo1.depth", 0.1f);
+    synth_set_part_param(synth, p, "lfo1.waveform", LFO_SINE);
+    synth_set_part_param(synth, p, "lfo1.sync", 1.0f); // LFO_SYNC_RETRIGGER
+    synth_set_part_param(synth, p, "lfo2.sync", 1.0f); // LFO_SYNC_RETRIGGER
+    synth_set_part_param(synth, p, "lfo3.sync", 1.0f); // LFO_SYNC_RETRIGGER
+
+    char param_name[16];
+    for (int i = 0; i < 4; ++i) { // Loop for all 4 oscillators
       // Randomize pitch (-0.5 to 0.5 semitones)
-      float random_pitch = -0.5f + ((float)rand() / (float)RAND_MAX) * (1.0f);
+      float random_pitch = -0.5f + rng_float(&synth->rng) * (1.0f);
       snprintf(param_name, sizeof(param_name), "osc%d.pitch", i + 1);
-      synth_set_param(synth, param_name, random_pitch);
+      synth_set_part_param(synth, p, param_name, random_pitch);
 
       // Randomize detune (-0.05 to 0.05)
-      float random_detune = -0.05f + ((float)rand() / (float)RAND_MAX) * (0.1f);
+      float random_detune = -0.05f + rng_float(&synth->rng) * (0.1f);
       snprintf(param_name, sizeof(param_name), "osc%d.detune", i + 1);
-      synth_set_param(synth, param_name, random_detune);
+      synth_set_part_param(synth, p, param_name, random_detune);
 
       // Randomize gain (0.3 to 0.7)
-      float random_gain = 0.3f + ((float)rand() / (float)RAND_MAX) * (0.4f);
+      float random_gain = 0.3f + rng_float(&synth->rng) * (0.4f);
       snprintf(param_name, sizeof(param_name), "osc%d.gain", i + 1);
-      synth_set_param(synth, param_name, random_gain);
-      char waveform_param_name[16];
-      snprintf(waveform_param_name, sizeof(waveform_param_name), "osc%d.waveform", i + 1);
-      synth_set_param(synth, waveform_param_name, 0.0f); // Default waveform to sine
+      synth_set_part_param(synth, p, param_name, random_gain);
+
+      snprintf(param_name, sizeof(param_name), "osc%d.waveform", i + 1);
+      synth_set_part_param(synth, p, param_name, 0.0f); // Default waveform to sine
     }
   }
   
-  // Specific default parameters for Bass (osc[4])
-  
-  
-  synth_set_param(synth, "osc1.waveform", 0.0f);
-  synth_set_param(synth, "osc2.waveform", 0.0f);
-  synth_set_param(synth, "osc3.waveform", 0.0f);
-  synth_set_param(synth, "osc4.waveform", 0.0f);
-  
-  // Initialize global ADSR
-  adsr_init(&synth->adsr, samplerate);
-  
-  for (int v = 0; v < voices; ++v)
-    voice_init(&synth->voices[v], samplerate);
-  synth->timestamp_counter = 0;
-  
-  // Initialize active_melody_notes
-  for (int i = 0; i < MAX_MELODY_POLYPHONY; ++i) {
-      active_melody_notes[i].active = 0;
-  }
+  // synth_play_startup_melody(synth); // Start the melody at startup
 
-#ifndef __EMSCRIPTEN__
-  // Load default config at startup
-  synth_load_default_config(synth);
-#endif
-  
+  // Parts render on the audio thread plus one worker per spare core
+  worker_pool_init(&synth->workers, -1);
   return 1;
 }
 
-void synth_shutdown(Synth *synth) { 
-#ifndef __EMSCRIPTEN__
-  // Save current settings to default config before shutdown
-  synth_save_default_config(synth);
-#endif
-  midi_shutdown(&synth->midi); 
+// Stops the worker and convolver threads and frees every buffer, so a
+// host can create and destroy instances as often as it likes
+void synth_shutdown(Synth *synth) {
+  worker_pool_shutdown(&synth->workers);
+  fx_cleanup(&synth->fx);
+  send_bus_cleanup(&synth->bus);
+  smf_player_cleanup(&synth->song);
+  free(synth->programs);
+  synth->programs = NULL;
+  synth->program_count = 0;
+}
+
+void synth_seed(Synth *synth, unsigned int seed) {
+  synth->rng = rng_seed(seed);
+  synth->seq.rng = rng_seed(rng_next(&synth->rng));
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+    part_seed(&synth->parts[p], rng_next(&synth->rng));
 }
 
 void synth_set_bpm(Synth *synth, float bpm) {
-  fx_set_bpm(&synth->fx, bpm);
+  transport_set_bpm(&synth->transport, bpm);
 }
 
-void synth_audio_callback(void *userdata, Uint8 *stream, int len) {
-  Synth *synth = (Synth *)userdata;
-  const int frames = len / (sizeof(float) * 2);
-  float *out = (float *)stream;
-  memset(out, 0, sizeof(float) * frames * 2);
-  
-  synth_update_arpeggiator(synth, frames);
-  synth_update_startup_melody(synth, frames); // Update the startup melody playback
-
-  float *vbuf = (float *)calloc(frames * 2, sizeof(float));
-  if (!vbuf)
-    return; // or handle error
-  for (int v = 0; v < synth->max_voices; ++v) {
-    if (!synth->voices[v].active)
+Part *synth_edit_part(Synth *synth) {
+  return &synth->parts[synth->edit_part];
+}
+
+// Copy everything the GUI displays into the next snapshot slot
+static void synth_publish_snapshot(Synth *synth) {
+  SynthSnapshot *snap = snapshot_write_begin(&synth->snapshot);
+  const Mixer *mixer = &synth->mixer;
+
+  snap->cpu_usage = synth->cpu_usage;
+  snap->dsp_load = synth->dsp_load;
+  // Voices of the edit part, plus a count for every part
+  const Part *edit = &synth->parts[synth->edit_part];
+  int count = 0;
+  for (int v = 0; v < edit->max_voices && count < SNAPSHOT_MAX_VOICES; ++v) {
+    const Voice *voice = &edit->voices[v];
+    if (!voice->active)
       continue;
-    memset(vbuf, 0, sizeof(float) * frames * 2);
-    voice_render(&synth->voices[v], synth->osc, synth->lfos, synth->mixer.osc_gain, vbuf, frames);
-    for (int i = 0; i < frames * 2; ++i)
-      out[i] += vbuf[i];
+    snap->voices[count].note = voice->note;
+    snap->voices[count].level = voice->adsr.level;
+    snap->voices[count].phase = (int)voice->adsr.phase;
+    ++count;
+  }
+  snap->active_voices = count;
+  for (int p = 0; p < SYNTH_MAX_PARTS && p < SNAPSHOT_MAX_PARTS; ++p)
+    snap->part_voices[p] = part_active_voices(&synth->parts[p]);
+
+  snap->peak_level = mixer->peak_level;
+  snap->rms_level = mixer->rms_level;
+  snap->comp_gain_reduction = mixer->compressor.gain_reduction;
+  snap->limiter_gain_reduction = mixer->limiter.gain_reduction;
+  snap->lufs_momentary = mixer->loudness.momentary;
+  snap->lufs_short_term = mixer->loudness.short_term;
+  snap->lufs_integrated = mixer->loudness.integrated;
+  snap->true_peak = mixer->loudness.true_peak;
+  snap->conv_late_blocks = platform_atomic_get(&synth->fx.conv.late_blocks);
+  snap->midi_last_cc = synth->last_cc;
+  snap->midi_last_cc_value = synth->last_cc_value;
+  snap->transport_beat = synth->transport.beat;
+  snap->transport_bpm = synth->transport.bpm;
+  snap->transport_running = synth->transport.running;
+  snap->clock_following = synth->midi_clock.following;
+  snap->song_playing = synth->song.playing;
+  snap->song_beat = smf_player_beat(&synth->song);
+  snap->song_beats = synth->song.song ? synth->song.song->beats : 0.0;
+  snap->seq_running = synth->seq.running;
+  snap->seq_chord_index = synth->seq.chord_index;
+  snap->seq_chord_count = synth->seq.chord_count;
+  snap->seq_rhythm_step = synth->seq.rhythm_step;
+  snap->seq_step_count = synth->seq.step_count;
+
+  snapshot_publish(&synth->snapshot);
+}
+
+// Worker job: one part's pass, on a private copy of the transport. Render
+// up to the part's next event, fire it, and carry on, so notes start and
+// stop on their exact sample instead of the block boundary. The first part
+// also plays the startup melody and the chord progression.
+static void synth_render_part(void *ctx, int index) {
+  Synth *synth = (Synth *)ctx;
+  int p = synth->busy_parts[index];
+  Part *part = &synth->parts[p];
+  Transport t = synth->transport;
+  int frames = synth->pass_frames;
+
+  memset(part->out, 0, sizeof(float) * frames * 2);
+  for (int pos = 0; pos < frames;) {
+    part_fire_events(part, &t);
+    if (p == 0) {
+      synth_fire_startup_melody(synth, &t, part);
+      sequencer_fire(&synth->seq, &t, part);
+    }
+
+    int n = part_next_event(part, &t, frames - pos);
+    if (p == 0) {
+      n = synth_melody_next_event(synth, &t, n);
+      n = sequencer_next_event(&synth->seq, &t, n);
+    }
+    if (n < 1)
+      n = 1;
+
+    part_render_voices(part, part->out + pos * 2, n);
+    transport_advance(&t, n);
+    pos += n;
+  }
+}
+
+// Sum the rendered parts with level and pan, and feed their sends
+static void synth_mix_parts(Synth *synth, float *out, int frames) {
+  SendBus *bus = &synth->bus;
+  for (int b = 0; b < synth->busy_count; ++b) {
+    const Part *part = &synth->parts[synth->busy_parts[b]];
+    // Balance law: centre keeps both sides at unity, like the delay taps
+    float pan = fmaxf(-1.0f, fminf(1.0f, part->pan));
+    float gain_l = part->level * fminf(1.0f, 1.0f - pan);
+    float gain_r = part->level * fminf(1.0f, 1.0f + pan);
+    float reverb = fmaxf(0.0f, part->reverb_send);
+    float delay = fmaxf(0.0f, part->delay_send);
+    for (int i = 0; i < frames; ++i) {
+      float l = part->out[i * 2 + 0] * gain_l;
+      float r = part->out[i * 2 + 1] * gain_r;
+      out[i * 2 + 0] += l;
+      out[i * 2 + 1] += r;
+      bus->reverb_in[i * 2 + 0] += l * reverb;
+      bus->reverb_in[i * 2 + 1] += r * reverb;
+      bus->delay_in[i * 2 + 0] += l * delay;
+      bus->delay_in[i * 2 + 1] += r * delay;
+    }
+    if (reverb > 0.0f || delay > 0.0f)
+      bus->fed = 1;
+  }
+  send_bus_process(bus, out, frames);
+}
+
+static void synth_apply_midi(Synth *synth);
+static void synth_channel_message(Synth *synth, int status, int data1, int data2);
+
+// The transport jumped or stopped under an external clock: end the notes
+// that were waiting for a beat, and restart the arpeggiators and the chord
+// progression from the new position
+static void synth_locate(Synth *synth) {
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+    arpeggiator_locate(&synth->parts[p].arp, &synth->parts[p]);
+  sequencer_locate(&synth->seq, &synth->transport, &synth->parts[0]);
+}
+
+// Song events take the same path as MIDI input; the song's tempo drives
+// the transport, so the arpeggiators and delays play along
+static void synth_song_event(void *ctx, const SmfEvent *e) {
+  Synth *synth = (Synth *)ctx;
+  if (e->status == SMF_TEMPO)
+    transport_set_bpm(&synth->transport, e->bpm);
+  else
+    synth_channel_message(synth, e->status, e->data1, e->data2);
+}
+
+// The song started or jumped: the transport follows it to the same beat
+static void synth_song_locate(Synth *synth) {
+  transport_locate(&synth->transport, smf_player_beat(&synth->song));
+  synth_locate(synth);
+}
+
+void synth_render(Synth *synth, float *out, int frames) {
+  uint64_t callback_start = platform_ticks();
+  memset(out, 0, sizeof(float) * frames * 2);
+
+  synth_apply_midi(synth);
+
+  // Tempo and position from MIDI clock, then the clock we send on
+  if (midi_clock_follow(&synth->midi_clock, &synth->transport, callback_start) == MIDI_CLOCK_MOVED)
+    synth_locate(synth);
+  midi_clock_emit(&synth->midi_clock, &synth->transport, frames, callback_start);
+  if (smf_player_update(&synth->song, synth_song_event, synth) == SMF_PLAYER_MOVED)
+    synth_song_locate(synth);
+
+  // Tempo edits take effect at block boundaries; the delay taps follow it
+  fx_set_bpm(&synth->fx, synth->transport.bpm);
+
+  // Parts render side by side, one pass of up to PART_BLOCK frames at a
+  // time; idle parts are skipped. A pass also ends where the song has its
+  // next event, so song messages land on their exact sample.
+  for (int pos = 0; pos < frames;) {
+    if (smf_player_fire(&synth->song, synth_song_event, synth) == SMF_PLAYER_MOVED)
+      synth_song_locate(synth);
+    int n = frames - pos < PART_BLOCK ? frames - pos : PART_BLOCK;
+    n = smf_player_next_event(&synth->song, n);
+    if (n < 1)
+      n = 1;
+    synth->busy_count = 0;
+    for (int p = 0; p < SYNTH_MAX_PARTS; ++p) {
+      int first_part_busy = p == 0 && (synth->melody.playing || synth->seq.running ||
+                                       platform_atomic_get(&synth->seq.run_request));
+      if (first_part_busy || !part_is_idle(&synth->parts[p]))
+        synth->busy_parts[synth->busy_count++] = p;
+    }
+    synth->pass_frames = n;
+    worker_pool_run(&synth->workers, synth_render_part, synth, synth->busy_count);
+    synth_mix_parts(synth, out + pos * 2, n);
+    transport_advance(&synth->transport, n);
+    smf_player_advance(&synth->song, n);
+    pos += n;
   }
-  free(vbuf);
 
   mixer_apply(&synth->mixer, out, frames);
   ring_mod_process(&synth->ring_mod, out, frames);
   fx_process(&synth->fx, out, frames);
+  mixer_master(&synth->mixer, out, frames);
 
-  static clock_t last = 0;
   clock_t now = clock();
-  synth->cpu_usage = 100.0f * ((float)(now - last) / (float)CLOCKS_PER_SEC) /
+  synth->cpu_usage = 100.0f * ((float)(now - synth->cpu_clock) / (float)CLOCKS_PER_SEC) /
                      (frames / 48000.0f);
-  last = now;
+  synth->cpu_clock = now;
 
-  // Feed oscilloscope with proper audio samples
-  static int debug_counter = 0;
-  float max_sample = 0.0f;
-  
-  for (int n = 0; n < frames; ++n) {
-    float mixed_sample = 0.5f * (out[n * 2 + 0] + out[n * 2 + 1]);
-    mixed_sample *= 4.0f; // Increased amplitude for oscilloscope display
-	oscilloscope_feed(mixed_sample);
-    oscilloscope_update_fft(mixed_sample);
-    
-    // Track max amplitude for debugging
-    float abs_sample = fabsf(mixed_sample);
-    if (abs_sample > max_sample) max_sample = abs_sample;
-  }
-  
+  double elapsed = (double)(platform_ticks() - callback_start) /
+                   (double)platform_ticks_per_second();
+  synth->dsp_load = (float)(100.0 * elapsed / (frames / synth->sample_rate));
 
+  synth_publish_snapshot(synth);
 }
 
 int synth_active_voices(const Synth *synth) {
   int n = 0;
-  for (int i = 0; i < synth->max_voices; ++i)
-    if (synth->voices[i].active)
-      ++n;
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+    n += part_active_voices(&synth->parts[p]);
   return n;
 }
 
 float synth_cpu_usage(const Synth *synth) { return synth->cpu_usage; }
 
-void synth_handle_cc(Synth *synth, int cc, int value) {
-  midi_map_cc_to_param(synth, cc, value);
-}
-
-void synth_set_param(Synth *synth, const char *param, float value) {
-  if (strncmp(param, "osc", 3) == 0) {
-    int i = param[3] - '1';
-    if (i >= 0 && i < 4) {
-      // Handle gain parameter specially - route to mixer instead of oscillator
-      if (strncmp(param + 5, "gain", 4) == 0) {
-        // Set mixer gain for this oscillator
-        synth->mixer.osc_gain[i] = value;
-      } else {
-        // Set other oscillator parameters normally
-        osc_set_param(&synth->osc[i], param + 5, value);
-      }
-    }
-  } else if (strncmp(param, "fx.", 3) == 0) {
-    fx_set_param(&synth->fx, param + 3, value);
-  } else if (strncmp(param, "mixer.", 6) == 0) {
-    mixer_set_param(&synth->mixer, param + 6, value);
-  } else if (strncmp(param, "arp.", 4) == 0) {
-    arpeggiator_set_param(&synth->arp, param + 4, value, synth);
-  } else if (strncmp(param, "adsr.", 5) == 0) {
-    const char *sub_param = param + 5;
-    if (strcmp(sub_param, "attack") == 0) {
-      synth->adsr.attack = value;
-      // Update all voices
-      for (int v = 0; v < synth->max_voices; ++v) {
-        synth->voices[v].adsr.attack = value;
-      }
-    } else if (strcmp(sub_param, "decay") == 0) {
-      synth->adsr.decay = value;
-      for (int v = 0; v < synth->max_voices; ++v) {
-        synth->voices[v].adsr.decay = value;
-      }
-    } else if (strcmp(sub_param, "sustain") == 0) {
-      synth->adsr.sustain = value;
-      for (int v = 0; v < synth->max_voices; ++v) {
-        synth->voices[v].adsr.sustain = value;
-      }
-    } else if (strcmp(sub_param, "release") == 0) {
-      synth->adsr.release = value;
-      for (int v = 0; v < synth->max_voices; ++v) {
-        synth->voices[v].adsr.release = value;
-      }
-    }
-  } else if (strncmp(param, "lfo", 3) == 0) {
-    int lfo_num = param[3] - '1';
-    if (lfo_num >= 0 && lfo_num < 3) {
-      lfo_set_param(&synth->lfos[lfo_num], param + 5, value);
-    }
-  } else if (strncmp(param, "ring_mod.", 9) == 0) {
-    const char *sub_param = param + 9;
-    if (strcmp(sub_param, "frequency") == 0) {
-      ring_mod_set_frequency(&synth->ring_mod, value);
-    } else if (strcmp(sub_param, "mix") == 0) {
-      ring_mod_set_mix(&synth->ring_mod, value);
-    } else if (strcmp(sub_param, "enabled") == 0) {
-      ring_mod_set_enabled(&synth->ring_mod, (int)value);
+// A member channel note starts from the expression already sent on its
+// channel. The arpeggiator takes plain notes; per-note expression only
+// reaches voices played directly.
+static void synth_member_note_on(Synth *synth, int manager, int channel, int note, float velocity) {
+  const MpeChannel *c = &synth->mpe.channels[channel];
+  float bend = c->bend * synth->mpe.bend_range[mpe_zone(manager)];
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p) {
+    Part *part = &synth->parts[p];
+    if (!part_listens(part, manager))
+      continue;
+    if (part->arp.enabled) {
+      arpeggiator_note_on(&part->arp, note);
+      continue;
+    }
+    Voice *voice = part_channel_note_on(part, channel, note, velocity);
+    if (voice) {
+      voice->bend = bend;
+      voice->pressure = c->pressure;
+      voice->timbre = c->timbre;
     }
   }
 }
 
-void synth_note_on(Synth *synth, int note, float velocity) {
-  synth->timestamp_counter++; // Increment timestamp for new note
+static void synth_member_expression(Synth *synth, int manager, int channel) {
+  const MpeChannel *c = &synth->mpe.channels[channel];
+  float bend = c->bend * synth->mpe.bend_range[mpe_zone(manager)];
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+    if (part_listens(&synth->parts[p], manager))
+      part_channel_expression(&synth->parts[p], channel, bend, c->pressure, c->timbre);
+}
 
-  // Trigger LFO sync on note on
-  for (int l = 0; l < 3; ++l) {
-    lfo_note_on(&synth->lfos[l]);
+// RPN 0 sets the pitch bend range, RPN 6 on a manager channel is the MPE
+// Configuration Message
+static void synth_registered_param(Synth *synth, int channel, int rpn, int value) {
+  int manager = mpe_manager(&synth->mpe, channel);
+  if (rpn == 0 && manager >= 0) {
+    synth->mpe.bend_range[mpe_zone(manager)] = (float)value;
+  } else if (rpn == 0) {
+    for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+      if (part_listens(&synth->parts[p], channel))
+        synth->parts[p].bend_range = value > 24 ? 24.0f : (float)value;
+  } else if (rpn == 6 && (channel == MPE_LOWER_MANAGER || channel == MPE_UPPER_MANAGER)) {
+    mpe_set_zone(&synth->mpe, channel, value);
+    for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+      if (part_listens(&synth->parts[p], channel))
+        synth->parts[p].bend_range = 2.0f; // Manager default after an MCM
   }
+}
 
-  // 1. If note already playing, retrigger that voice
-  for (int v = 0; v < synth->max_voices; ++v) {
-    if (synth->voices[v].active && (int)synth->voices[v].note == note) {
-      voice_on(&synth->voices[v], note, velocity, synth->timestamp_counter);
+void synth_handle_cc(Synth *synth, int channel, int cc, int value) {
+  synth->last_cc = cc;
+  synth->last_cc_value = value;
+  int rpn = mpe_rpn_control(&synth->mpe, channel, cc, value);
+  if (rpn >= 0) {
+    synth_registered_param(synth, channel, rpn, value);
+    return;
+  }
+  // On a member channel CC 74 is the note's timbre; other controllers act
+  // on the whole zone
+  int manager = mpe_manager(&synth->mpe, channel);
+  if (manager >= 0) {
+    if (cc == MPE_TIMBRE_CC) {
+      synth->mpe.channels[channel].timbre = value / 127.0f;
+      synth_member_expression(synth, manager, channel);
       return;
     }
+    channel = manager;
   }
+  midi_map_dispatch(&synth->midi_map, synth, channel, cc, value);
+}
 
-  // 2. Otherwise, find a free voice and use it
-  for (int v = 0; v < synth->max_voices; ++v) {
-    if (!synth->voices[v].active) {
-      voice_on(&synth->voices[v], note, velocity, synth->timestamp_counter);
-      return;
+void synth_channel_param(Synth *synth, int channel, int id, float value) {
+  int heard = 0;
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p) {
+    if (part_listens(&synth->parts[p], channel)) {
+      param_set_part(synth, &synth->parts[p], id, value);
+      heard = 1;
     }
   }
+  // A channel no part listens on still reaches the edit part
+  if (!heard)
+    param_set(synth, id, value);
+}
 
-  // 3. If none free, steal the oldest note
-  unsigned long long min_timestamp = -1; // Max value for unsigned long long
-  int voice_to_steal_idx = -1;
+void synth_set_param(Synth *synth, const char *param, float value) {
+  synth_set_part_param(synth, synth->edit_part, param, value);
+}
 
-  for (int v = 0; v < synth->max_voices; ++v) {
-    // Only consider active voices for stealing
-    if (synth->voices[v].active) {
-      if (synth->voices[v].timestamp < min_timestamp) {
-        min_timestamp = synth->voices[v].timestamp;
-        voice_to_steal_idx = v;
-      }
-    }
+void synth_set_part_param(Synth *synth, int part, const char *param, float value) {
+  int id = param_lookup(param);
+  if (id != PARAM_NONE)
+    param_set_part(synth, &synth->parts[part], id, value);
+}
+
+void synth_note_on(Synth *synth, int note, float velocity) {
+  part_note_on(synth_edit_part(synth), note, velocity);
+}
+
+void synth_note_off(Synth *synth, int note) {
+  part_note_off(synth_edit_part(synth), note);
+}
+
+void synth_channel_note_on(Synth *synth, int channel, int note, float velocity) {
+  int manager = mpe_manager(&synth->mpe, channel);
+  if (manager >= 0) {
+    synth_member_note_on(synth, manager, channel, note, velocity);
+    return;
+  }
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p) {
+    Part *part = &synth->parts[p];
+    if (!part_listens(part, channel))
+      continue;
+    if (part->arp.enabled)
+      arpeggiator_note_on(&part->arp, note);
+    else
+      part_note_on(part, note, velocity);
   }
+}
 
-  // If a voice was found to steal (should always be one if max_voices > 0)
-  if (voice_to_steal_idx != -1) {
-    voice_on(&synth->voices[voice_to_steal_idx], note, velocity,
-             synth->timestamp_counter);
+void synth_channel_note_off(Synth *synth, int channel, int note) {
+  int manager = mpe_manager(&synth->mpe, channel);
+  int member = manager >= 0 ? channel : -1;
+  if (manager >= 0)
+    channel = manager;
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p) {
+    Part *part = &synth->parts[p];
+    if (!part_listens(part, channel))
+      continue;
+    if (part->arp.enabled)
+      arpeggiator_note_off(&part->arp, note);
+    else
+      part_channel_note_off(part, member, note);
   }
 }
 
-void synth_note_off(Synth *synth, int note) {
-  for (int v = 0; v < synth->max_voices; ++v) {
-    if (synth->voices[v].active && (int)synth->voices[v].note == note) {
-      voice_off(&synth->voices[v]);
-      
-      // Trigger LFO sync on note off
-      for (int l = 0; l < 3; ++l) {
-        lfo_note_off(&synth->lfos[l]);
-      }
-      return;
+void synth_channel_pitch_bend(Synth *synth, int channel, float bend) {
+  int manager = mpe_manager(&synth->mpe, channel);
+  if (manager >= 0) {
+    synth->mpe.channels[channel].bend = bend;
+    synth_member_expression(synth, manager, channel);
+    return;
+  }
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+    if (part_listens(&synth->parts[p], channel))
+      synth->parts[p].bend = bend * synth->parts[p].bend_range;
+}
+
+void synth_channel_pressure(Synth *synth, int channel, float pressure) {
+  int manager = mpe_manager(&synth->mpe, channel);
+  if (manager >= 0) {
+    synth->mpe.channels[channel].pressure = pressure;
+    synth_member_expression(synth, manager, channel);
+    return;
+  }
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+    if (part_listens(&synth->parts[p], channel))
+      synth->parts[p].pressure = pressure;
+}
+
+void synth_channel_poly_pressure(Synth *synth, int channel, int note, float pressure) {
+  int manager = mpe_manager(&synth->mpe, channel);
+  int member = manager >= 0 ? channel : -1;
+  if (manager >= 0)
+    channel = manager;
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p)
+    if (part_listens(&synth->parts[p], channel))
+      part_note_pressure(&synth->parts[p], member, note, pressure);
+}
+
+void synth_channel_program(Synth *synth, int channel, int program) {
+  if (program < 0 || program >= synth->program_count)
+    return; // Empty slot: keep the current sound
+  for (int p = 0; p < SYNTH_MAX_PARTS; ++p) {
+    Part *part = &synth->parts[p];
+    if (part_listens(part, channel)) {
+      part_apply_program(part, &synth->programs[program]);
+      part->program = program;
     }
   }
 }
 
-#include "cJSON.h" // Include cJSON header
+int synth_midi_message(Synth *synth, const unsigned char *msg, int len) {
+  // Clock messages are timestamped on arrival, before any queueing delay
+  if (msg && midi_clock_receive(&synth->midi_clock, msg, len, platform_ticks()))
+    return 1;
+  return midi_queue_push_message(&synth->midi_in, msg, len);
+}
 
-char* synth_save_preset_json(const Synth *synth) {
-    cJSON *root = cJSON_CreateObject();
+// Audio thread: one channel voice message, from MIDI input or a song
+static void synth_channel_message(Synth *synth, int status, int data1, int data2) {
+  int channel = status & 0x0F;
+  switch (status & 0xF0) {
+  case 0x80:
+    synth_channel_note_off(synth, channel, data1);
+    break;
+  case 0x90: // Velocity 0 is a note off
+    if (data2 == 0)
+      synth_channel_note_off(synth, channel, data1);
+    else
+      synth_channel_note_on(synth, channel, data1, data2 / 127.0f);
+    break;
+  case 0xA0:
+    synth_channel_poly_pressure(synth, channel, data1, data2 / 127.0f);
+    break;
+  case 0xB0:
+    synth_handle_cc(synth, channel, data1, data2);
+    break;
+  case 0xC0:
+    synth_channel_program(synth, channel, data1);
+    break;
+  case 0xD0:
+    synth_channel_pressure(synth, channel, data1 / 127.0f);
+    break;
+  case 0xE0: // 14 bits, centre 8192
+    synth_channel_pitch_bend(synth, channel, ((data2 << 7 | data1) - 8192) / 8192.0f);
+    break;
+  }
+}
+
+// Audio thread, block start: everything the MIDI threads queued since the
+// previous block
+static void synth_apply_midi(Synth *synth) {
+  MidiEvent e;
+  while (midi_queue_pop(&synth->midi_in, &e))
+    synth_channel_message(synth, e.status, e.data1, e.data2);
+}
 
+#include "cJSON.h" // Include cJSON header
+
+// Patch sections of one part: oscillators, envelope, LFOs and arpeggiator
+static void synth_save_patch(const Synth *synth, const Part *part, cJSON *root) {
     // Save Oscillator parameters
     cJSON *oscillators = cJSON_CreateArray();
     for (int i = 0; i < 4; ++i) {
         cJSON *osc = cJSON_CreateObject();
-        cJSON_AddNumberToObject(osc, "waveform", synth->osc[i].waveform);
-        cJSON_AddNumberToObject(osc, "pitch", synth->osc[i].pitch);
-        cJSON_AddNumberToObject(osc, "detune", synth->osc[i].detune);
-        cJSON_AddNumberToObject(osc, "gain", synth->osc[i].gain);
-        cJSON_AddNumberToObject(osc, "pan", synth->osc[i].pan);
-        cJSON_AddNumberToObject(osc, "pulse_width", synth->osc[i].pulse_width);
-        cJSON_AddNumberToObject(osc, "unison_voices", synth->osc[i].unison_voices);
-        cJSON_AddNumberToObject(osc, "unison_detune", synth->osc[i].unison_detune);
+        cJSON_AddNumberToObject(osc, "waveform", part->osc[i].waveform);
+        cJSON_AddNumberToObject(osc, "pitch", part->osc[i].pitch);
+        cJSON_AddNumberToObject(osc, "detune", part->osc[i].detune);
+        cJSON_AddNumberToObject(osc, "gain", part->osc[i].gain);
+        cJSON_AddNumberToObject(osc, "pan", part->osc[i].pan);
+        cJSON_AddNumberToObject(osc, "pulse_width", part->osc[i].pulse_width);
+        cJSON_AddNumberToObject(osc, "unison_voices", part->osc[i].unison_voices);
+        cJSON_AddNumberToObject(osc, "unison_detune", part->osc[i].unison_detune);
         cJSON_AddItemToArray(oscillators, osc);
     }
 cJSON_AddItemToObject(root, "oscillators", oscillators);
  
     // Save ADSR Envelope parameters
     cJSON *adsr = cJSON_CreateObject();
-    cJSON_AddNumberToObject(adsr, "attack", synth->adsr.attack);
-    cJSON_AddNumberToObject(adsr, "decay", synth->adsr.decay);
-    cJSON_AddNumberToObject(adsr, "sustain", synth->adsr.sustain);
-    cJSON_AddNumberToObject(adsr, "release", synth->adsr.release);
+    cJSON_AddNumberToObject(adsr, "attack", part->adsr.attack);
+    cJSON_AddNumberToObject(adsr, "decay", part->adsr.decay);
+    cJSON_AddNumberToObject(adsr, "sustain", part->adsr.sustain);
+    cJSON_AddNumberToObject(adsr, "release", part->adsr.release);
     cJSON_AddItemToObject(root, "adsr", adsr);
 
     // Save LFO parameters
     cJSON *lfos = cJSON_CreateArray();
     for (int i = 0; i < 3; ++i) {
         cJSON *lfo = cJSON_CreateObject();
-        cJSON_AddNumberToObject(lfo, "waveform", synth->lfos[i].waveform);
-        cJSON_AddNumberToObject(lfo, "frequency", synth->lfos[i].frequency);
-        cJSON_AddNumberToObject(lfo, "depth", synth->lfos[i].depth);
-        cJSON_AddNumberToObject(lfo, "phase", synth->lfos[i].phase);
-        cJSON_AddNumberToObject(lfo, "gain", synth->lfos[i].gain);
-        cJSON_AddNumberToObject(lfo, "target", synth->lfos[i].target);
-        cJSON_AddNumberToObject(lfo, "sync", synth->lfos[i].sync);
-        cJSON_AddBoolToObject(lfo, "enabled", synth->lfos[i].enabled);
+        cJSON_AddNumberToObject(lfo, "waveform", part->lfos[i].waveform);
+        cJSON_AddNumberToObject(lfo, "frequency", part->lfos[i].frequency);
+        cJSON_AddNumberToObject(lfo, "depth", part->lfos[i].depth);
+        cJSON_AddNumberToObject(lfo, "phase", part->lfos[i].phase);
+        cJSON_AddNumberToObject(lfo, "gain", part->lfos[i].gain);
+        cJSON_AddNumberToObject(lfo, "target", part->lfos[i].target);
+        cJSON_AddNumberToObject(lfo, "sync", part->lfos[i].sync);
+        cJSON_AddBoolToObject(lfo, "enabled", part->lfos[i].enabled);
         cJSON_AddItemToArray(lfos, lfo);
     }
     cJSON_AddItemToObject(root, "lfos", lfos);
 
+
+    // Save Arpeggiator parameters
+    cJSON *arp = cJSON_CreateObject();
+    cJSON_AddBoolToObject(arp, "enabled", part->arp.enabled);
+    cJSON_AddNumberToObject(arp, "mode", part->arp.mode);
+    cJSON_AddNumberToObject(arp, "tempo", synth->transport.bpm);
+    cJSON_AddNumberToObject(arp, "rate", part->arp.rate);
+    cJSON_AddBoolToObject(arp, "polyphonic", part->arp.polyphonic);
+    cJSON_AddBoolToObject(arp, "hold", part->arp.hold);
+    cJSON_AddNumberToObject(arp, "octave", part->arp.octave);
+    cJSON_AddNumberToObject(arp, "octaves", part->arp.octaves);
+    
+    // Chord generation parameters
+    cJSON_AddNumberToObject(arp, "chord_type", part->arp.chord_type);
+    cJSON_AddBoolToObject(arp, "add_6", part->arp.add_6);
+    cJSON_AddBoolToObject(arp, "add_m7", part->arp.add_m7);
+    cJSON_AddBoolToObject(arp, "add_M7", part->arp.add_M7);
+    cJSON_AddBoolToObject(arp, "add_9", part->arp.add_9);
+    cJSON_AddNumberToObject(arp, "voicing", part->arp.voicing);
+    
+    // Gate parameters
+    cJSON_AddNumberToObject(arp, "gate_length", part->arp.gate_length);
+
+    // Step lanes
+    cJSON_AddNumberToObject(arp, "swing", part->arp.swing);
+    cJSON_AddNumberToObject(arp, "pattern_length", part->arp.pattern_length);
+    cJSON *lanes = cJSON_CreateArray();
+    for (int i = 0; i < ARP_PATTERN_LEN; ++i) {
+        const ArpStep *step = &part->arp.lanes[i];
+        cJSON *lane = cJSON_CreateObject();
+        cJSON_AddNumberToObject(lane, "velocity", step->velocity);
+        cJSON_AddNumberToObject(lane, "gate", step->gate);
+        cJSON_AddNumberToObject(lane, "ratchet", step->ratchet);
+        cJSON_AddBoolToObject(lane, "tie", step->tie);
+        cJSON_AddNumberToObject(lane, "probability", step->probability);
+        cJSON_AddItemToArray(lanes, lane);
+    }
+    cJSON_AddItemToObject(arp, "lanes", lanes);
+    
+    cJSON_AddItemToObject(root, "arpeggiator", arp);
+}
+
+char* synth_save_preset_json(const Synth *synth) {
+    cJSON *root = cJSON_CreateObject();
+    const Part *edit = &synth->parts[synth->edit_part];
+
     // Save Mixer parameters
     cJSON *mixer = cJSON_CreateObject();
     cJSON_AddNumberToObject(mixer, "master_gain", synth->mixer.master);
@@ -492,7 +736,7 @@ cJSON_AddItemToObject(root, "oscillators", oscillators);
     cJSON_AddNumberToObject(mixer, "master_width", synth->mixer.master_width);
     cJSON *osc_gains = cJSON_CreateArray();
     for (int i = 0; i < 4; ++i) {
-        cJSON_AddItemToArray(osc_gains, cJSON_CreateNumber(synth->mixer.osc_gain[i]));
+        cJSON_AddItemToArray(osc_gains, cJSON_CreateNumber(edit->osc_gain[i]));
     }
     cJSON_AddItemToObject(mixer, "osc_gains", osc_gains);
     // Add compressor parameters
@@ -502,13 +746,18 @@ cJSON_AddItemToObject(root, "oscillators", oscillators);
     cJSON_AddNumberToObject(mixer, "comp_attack", synth->mixer.comp_attack);
     cJSON_AddNumberToObject(mixer, "comp_release", synth->mixer.comp_release);
     cJSON_AddNumberToObject(mixer, "comp_makeup_gain", synth->mixer.comp_makeup_gain);
+    cJSON_AddNumberToObject(mixer, "comp_detector", synth->mixer.comp_detector);
     cJSON_AddNumberToObject(mixer, "dc_filter_enabled", synth->mixer.dc_filter_enabled);
     cJSON_AddNumberToObject(mixer, "dc_filter_freq", synth->mixer.dc_filter_freq);
     cJSON_AddNumberToObject(mixer, "soft_clip_enabled", synth->mixer.soft_clip_enabled);
     cJSON_AddNumberToObject(mixer, "soft_clip_threshold", synth->mixer.soft_clip_threshold);
     cJSON_AddNumberToObject(mixer, "soft_clip_ratio", synth->mixer.soft_clip_ratio);
+    cJSON_AddNumberToObject(mixer, "limiter_enabled", synth->mixer.limiter_enabled);
+    cJSON_AddNumberToObject(mixer, "limiter_ceiling", synth->mixer.limiter_ceiling);
+    cJSON_AddNumberToObject(mixer, "limiter_release", synth->mixer.limiter_release);
     cJSON_AddNumberToObject(mixer, "auto_gain_enabled", synth->mixer.auto_gain_enabled);
     cJSON_AddNumberToObject(mixer, "auto_gain_target", synth->mixer.auto_gain_target);
+    cJSON_AddNumberToObject(mixer, "auto_gain_time", synth->mixer.auto_gain_seconds);
     cJSON_AddItemToObject(root, "mixer", mixer);
 
     // Save FX parameters
@@ -522,21 +771,31 @@ cJSON_AddItemToObject(root, "oscillators", oscillators);
     cJSON_AddNumberToObject(fx, "flanger_depth", synth->fx.flanger_depth);
     cJSON_AddNumberToObject(fx, "flanger_rate", synth->fx.flanger_rate);
     cJSON_AddNumberToObject(fx, "flanger_feedback", synth->fx.flanger_feedback);
+    cJSON_AddNumberToObject(fx, "chorus_depth", synth->fx.chorus_depth);
+    cJSON_AddNumberToObject(fx, "chorus_rate", synth->fx.chorus_rate);
+    cJSON_AddNumberToObject(fx, "chorus_mix", synth->fx.chorus_mix);
     cJSON_AddNumberToObject(fx, "delay_time", synth->fx.delay_time);
     cJSON_AddNumberToObject(fx, "delay_feedback", synth->fx.delay_feedback);
     cJSON_AddNumberToObject(fx, "delay_mix", synth->fx.delay_mix);
     cJSON_AddNumberToObject(fx, "multitap_enabled", synth->fx.multitap_enabled);
-    cJSON_AddNumberToObject(fx, "multitap_tap0", synth->fx.multitap_taps[0]);
-    cJSON_AddNumberToObject(fx, "multitap_tap0_level", synth->fx.multitap_levels[0]);
-    cJSON_AddNumberToObject(fx, "multitap_tap1", synth->fx.multitap_taps[1]);
-    cJSON_AddNumberToObject(fx, "multitap_tap1_level", synth->fx.multitap_levels[1]);
-    cJSON_AddNumberToObject(fx, "multitap_tap2", synth->fx.multitap_taps[2]);
-    cJSON_AddNumberToObject(fx, "multitap_tap2_level", synth->fx.multitap_levels[2]);
-    cJSON_AddNumberToObject(fx, "multitap_tap3", synth->fx.multitap_taps[3]);
-    cJSON_AddNumberToObject(fx, "multitap_tap3_level", synth->fx.multitap_levels[3]);
+    cJSON_AddNumberToObject(fx, "multitap_taps", synth->fx.num_taps);
+    for (int tap = 0; tap < MAX_DELAY_TAPS; ++tap) {
+        char key[32];
+        snprintf(key, sizeof(key), "multitap_tap%d", tap);
+        cJSON_AddNumberToObject(fx, key, synth->fx.multitap_taps[tap]);
+        snprintf(key, sizeof(key), "multitap_tap%d_level", tap);
+        cJSON_AddNumberToObject(fx, key, synth->fx.multitap_levels[tap]);
+        snprintf(key, sizeof(key), "multitap_tap%d_pan", tap);
+        cJSON_AddNumberToObject(fx, key, synth->fx.multitap_pan[tap]);
+        snprintf(key, sizeof(key), "multitap_tap%d_feedback", tap);
+        cJSON_AddNumberToObject(fx, key, synth->fx.multitap_feedback[tap]);
+    }
     cJSON_AddNumberToObject(fx, "reverb_size", synth->fx.reverb_size);
     cJSON_AddNumberToObject(fx, "reverb_mix", synth->fx.reverb_damping);
     cJSON_AddNumberToObject(fx, "reverb_damping", synth->fx.reverb_mix);
+    cJSON_AddNumberToObject(fx, "reverb_algorithm", synth->fx.reverb_algorithm);
+    cJSON_AddNumberToObject(fx, "convolution_mix", synth->fx.conv_mix);
+    cJSON_AddStringToObject(fx, "convolution_ir", synth->fx.conv_ir_path);
     cJSON_AddItemToObject(root, "fx", fx);
 
     // Save Ring Modulator parameters
@@ -546,45 +805,52 @@ cJSON_AddItemToObject(root, "oscillators", oscillators);
     cJSON_AddBoolToObject(ring_mod, "enabled", synth->ring_mod.enabled);
     cJSON_AddItemToObject(root, "ring_modulator", ring_mod);
 
-    // Save Arpeggiator parameters
-    cJSON *arp = cJSON_CreateObject();
-    cJSON_AddBoolToObject(arp, "enabled", synth->arp.enabled);
-    cJSON_AddNumberToObject(arp, "mode", synth->arp.mode);
-    cJSON_AddNumberToObject(arp, "tempo", synth->arp.tempo);
-    cJSON_AddNumberToObject(arp, "rate", synth->arp.rate);
-    cJSON_AddBoolToObject(arp, "polyphonic", synth->arp.polyphonic);
-    cJSON_AddBoolToObject(arp, "hold", synth->arp.hold);
-    cJSON_AddNumberToObject(arp, "octave", synth->arp.octave);
-    cJSON_AddNumberToObject(arp, "octaves", synth->arp.octaves);
-    
-    // Chord generation parameters
-    cJSON_AddNumberToObject(arp, "chord_type", synth->arp.chord_type);
-    cJSON_AddBoolToObject(arp, "add_6", synth->arp.add_6);
-    cJSON_AddBoolToObject(arp, "add_m7", synth->arp.add_m7);
-    cJSON_AddBoolToObject(arp, "add_M7", synth->arp.add_M7);
-    cJSON_AddBoolToObject(arp, "add_9", synth->arp.add_9);
-    cJSON_AddNumberToObject(arp, "voicing", synth->arp.voicing);
-    
-    // Gate parameters
-    cJSON_AddNumberToObject(arp, "gate_length", synth->arp.gate_length);
-    
-    cJSON_AddItemToObject(root, "arpeggiator", arp);
+    // Patch of the edit part, then every part with its mix settings
+    synth_save_patch(synth, edit, root);
+    cJSON *parts = cJSON_CreateArray();
+    for (int p = 0; p < SYNTH_MAX_PARTS; ++p) {
+        const Part *part = &synth->parts[p];
+        cJSON *entry = cJSON_CreateObject();
+        cJSON_AddNumberToObject(entry, "channel", part->channel);
+        cJSON_AddNumberToObject(entry, "level", part->level);
+        cJSON_AddNumberToObject(entry, "pan", part->pan);
+        cJSON_AddNumberToObject(entry, "reverb_send", part->reverb_send);
+        cJSON_AddNumberToObject(entry, "delay_send", part->delay_send);
+        cJSON_AddNumberToObject(entry, "bend_range", part->bend_range);
+        cJSON_AddNumberToObject(entry, "aftertouch", part->aftertouch);
+        cJSON *part_gains = cJSON_CreateArray();
+        for (int i = 0; i < 4; ++i) {
+            cJSON_AddItemToArray(part_gains, cJSON_CreateNumber(part->osc_gain[i]));
+        }
+        cJSON_AddItemToObject(entry, "osc_gains", part_gains);
+        synth_save_patch(synth, part, entry);
+        cJSON_AddItemToArray(parts, entry);
+    }
+    cJSON_AddItemToObject(root, "parts", parts);
+    cJSON_AddNumberToObject(root, "edit_part", synth->edit_part);
+
+    // Save shared send bus parameters
+    cJSON *bus = cJSON_CreateObject();
+    cJSON_AddNumberToObject(bus, "reverb_size", synth->bus.reverb_size);
+    cJSON_AddNumberToObject(bus, "reverb_damping", synth->bus.reverb_damping);
+    cJSON_AddNumberToObject(bus, "reverb_return", synth->bus.reverb_return);
+    cJSON_AddNumberToObject(bus, "delay_time", synth->bus.delay_time);
+    cJSON_AddNumberToObject(bus, "delay_feedback", synth->bus.delay_feedback);
+    cJSON_AddNumberToObject(bus, "delay_return", synth->bus.delay_return);
+    cJSON_AddItemToObject(root, "send_bus", bus);
 
     char *json_string = cJSON_Print(root);
     cJSON_Delete(root);
     return json_string;
 }
 
-void synth_load_preset_json(Synth *synth, const char *json_string) {
-    cJSON *root = cJSON_Parse(json_string);
-    if (!root) {
-        const char *error_ptr = cJSON_GetErrorPtr();
-        if (error_ptr != NULL) {
-            fprintf(stderr, "Error before: %s\n", error_ptr);
-        }
-        return;
-    }
+// Patch parameter by name for one part
+static void patch_set(Synth *synth, Part *part, const char *param, float value) {
+    param_set_part(synth, part, param_lookup(param), value);
+}
 
+// Patch sections of a preset, applied to one part
+static void synth_load_patch(Synth *synth, Part *part, cJSON *root) {
     // Load Oscillator parameters
     cJSON *oscillators = cJSON_GetObjectItemCaseSensitive(root, "oscillators");
     if (cJSON_IsArray(oscillators)) {
@@ -596,30 +862,182 @@ void synth_load_preset_json(Synth *synth, const char *json_string) {
                 if (cJSON_IsNumber(waveform)) {
                     char param_name[32];
                     snprintf(param_name, sizeof(param_name), "osc%d.waveform", i + 1);
-                    synth_set_param(synth, param_name, (float)waveform->valuedouble);
+                    patch_set(synth, part, param_name, (float)waveform->valuedouble);
                 }
                 cJSON *pitch = cJSON_GetObjectItemCaseSensitive(osc, "pitch");
                 if (cJSON_IsNumber(pitch)) {
                     char param_name[32];
                     snprintf(param_name, sizeof(param_name), "osc%d.pitch", i + 1);
-                    synth_set_param(synth, param_name, (float)pitch->valuedouble);
+                    patch_set(synth, part, param_name, (float)pitch->valuedouble);
                 }
                 cJSON *detune = cJSON_GetObjectItemCaseSensitive(osc, "detune");
                 if (cJSON_IsNumber(detune)) {
                     char param_name[32];
                     snprintf(param_name, sizeof(param_name), "osc%d.detune", i + 1);
-                    synth_set_param(synth, param_name, (float)detune->valuedouble);
+                    patch_set(synth, part, param_name, (float)detune->valuedouble);
                 }
                 cJSON *gain = cJSON_GetObjectItemCaseSensitive(osc, "gain");
                 if (cJSON_IsNumber(gain)) {
                     char param_name[32];
                     snprintf(param_name, sizeof(param_name), "osc%d.gain", i + 1);
-                    synth_set_param(synth, param_name, (float)gain->valuedouble);
+                    patch_set(synth, part, param_name, (float)gain->valuedouble);
+                }
+                static const char *osc_keys[] = {"pan", "pulse_width", "unison_voices", "unison_detune"};
+                for (int k = 0; k < 4; ++k) {
+                    cJSON *item = cJSON_GetObjectItemCaseSensitive(osc, osc_keys[k]);
+                    if (cJSON_IsNumber(item)) {
+                        char param_name[32];
+                        snprintf(param_name, sizeof(param_name), "osc%d.%s", i + 1, osc_keys[k]);
+                        patch_set(synth, part, param_name, (float)item->valuedouble);
+                    }
                 }
             }
         }
     }
 
+    // Load ADSR Envelope parameters
+    cJSON *adsr = cJSON_GetObjectItemCaseSensitive(root, "adsr");
+    if (cJSON_IsObject(adsr)) {
+        static const char *adsr_keys[] = {"attack", "decay", "sustain", "release"};
+        for (int k = 0; k < 4; ++k) {
+            cJSON *item = cJSON_GetObjectItemCaseSensitive(adsr, adsr_keys[k]);
+            if (cJSON_IsNumber(item)) {
+                char param_name[32];
+                snprintf(param_name, sizeof(param_name), "adsr.%s", adsr_keys[k]);
+                patch_set(synth, part, param_name, (float)item->valuedouble);
+            }
+        }
+    }
+
+    // Load LFO parameters
+    cJSON *lfos = cJSON_GetObjectItemCaseSensitive(root, "lfos");
+    if (cJSON_IsArray(lfos)) {
+        static const char *lfo_keys[] = {"waveform", "frequency", "depth", "phase", "gain", "target", "sync"};
+        int num_lfos = cJSON_GetArraySize(lfos);
+        for (int i = 0; i < num_lfos && i < 3; ++i) {
+            cJSON *lfo = cJSON_GetArrayItem(lfos, i);
+            if (!cJSON_IsObject(lfo))
+                continue;
+            char param_name[32];
+            for (int k = 0; k < 7; ++k) {
+                cJSON *item = cJSON_GetObjectItemCaseSensitive(lfo, lfo_keys[k]);
+                if (cJSON_IsNumber(item)) {
+                    snprintf(param_name, sizeof(param_name), "lfo%d.%s", i + 1, lfo_keys[k]);
+                    patch_set(synth, part, param_name, (float)item->valuedouble);
+                }
+            }
+            cJSON *enabled = cJSON_GetObjectItemCaseSensitive(lfo, "enabled");
+            if (cJSON_IsBool(enabled)) {
+                snprintf(param_name, sizeof(param_name), "lfo%d.enabled", i + 1);
+                patch_set(synth, part, param_name, (float)cJSON_IsTrue(enabled));
+            }
+        }
+    }
+
+    // Load Arpeggiator parameters
+    cJSON *arp = cJSON_GetObjectItemCaseSensitive(root, "arpeggiator");
+    if (cJSON_IsObject(arp)) {
+        cJSON *enabled = cJSON_GetObjectItemCaseSensitive(arp, "enabled");
+        if (cJSON_IsBool(enabled)) {
+            patch_set(synth, part, "arp.enabled", (float)cJSON_IsTrue(enabled));
+        }
+        cJSON *mode = cJSON_GetObjectItemCaseSensitive(arp, "mode");
+        if (cJSON_IsNumber(mode)) {
+            patch_set(synth, part, "arp.mode", (float)mode->valuedouble);
+        }
+        cJSON *tempo = cJSON_GetObjectItemCaseSensitive(arp, "tempo");
+        if (cJSON_IsNumber(tempo)) {
+            patch_set(synth, part, "arp.tempo", (float)tempo->valuedouble);
+        }
+        cJSON *rate = cJSON_GetObjectItemCaseSensitive(arp, "rate");
+        if (cJSON_IsNumber(rate)) {
+            patch_set(synth, part, "arp.rate", (float)rate->valuedouble);
+        }
+        cJSON *polyphonic = cJSON_GetObjectItemCaseSensitive(arp, "polyphonic");
+        if (cJSON_IsBool(polyphonic)) {
+            patch_set(synth, part, "arp.polyphonic", (float)cJSON_IsTrue(polyphonic));
+        }
+        cJSON *hold = cJSON_GetObjectItemCaseSensitive(arp, "hold");
+        if (cJSON_IsBool(hold)) {
+            patch_set(synth, part, "arp.hold", (float)cJSON_IsTrue(hold));
+        }
+        cJSON *octave = cJSON_GetObjectItemCaseSensitive(arp, "octave");
+        if (cJSON_IsNumber(octave)) {
+            patch_set(synth, part, "arp.octave", (float)octave->valuedouble);
+        }
+        cJSON *octaves = cJSON_GetObjectItemCaseSensitive(arp, "octaves");
+        if (cJSON_IsNumber(octaves)) {
+            patch_set(synth, part, "arp.octaves", (float)octaves->valuedouble);
+        }
+        
+        // Chord generation parameters
+        cJSON *chord_type = cJSON_GetObjectItemCaseSensitive(arp, "chord_type");
+        if (cJSON_IsNumber(chord_type)) {
+            patch_set(synth, part, "arp.chord_type", (float)chord_type->valuedouble);
+        }
+        cJSON *add_6 = cJSON_GetObjectItemCaseSensitive(arp, "add_6");
+        if (cJSON_IsBool(add_6)) {
+            patch_set(synth, part, "arp.add_6", (float)cJSON_IsTrue(add_6));
+        }
+        cJSON *add_m7 = cJSON_GetObjectItemCaseSensitive(arp, "add_m7");
+        if (cJSON_IsBool(add_m7)) {
+            patch_set(synth, part, "arp.add_m7", (float)cJSON_IsTrue(add_m7));
+        }
+        cJSON *add_M7 = cJSON_GetObjectItemCaseSensitive(arp, "add_M7");
+        if (cJSON_IsBool(add_M7)) {
+            patch_set(synth, part, "arp.add_M7", (float)cJSON_IsTrue(add_M7));
+        }
+        cJSON *add_9 = cJSON_GetObjectItemCaseSensitive(arp, "add_9");
+        if (cJSON_IsBool(add_9)) {
+            patch_set(synth, part, "arp.add_9", (float)cJSON_IsTrue(add_9));
+        }
+        cJSON *voicing = cJSON_GetObjectItemCaseSensitive(arp, "voicing");
+        if (cJSON_IsNumber(voicing)) {
+            patch_set(synth, part, "arp.voicing", (float)voicing->valuedouble);
+        }
+        cJSON *gate_length = cJSON_GetObjectItemCaseSensitive(arp, "gate_length");
+        if (cJSON_IsNumber(gate_length)) {
+            patch_set(synth, part, "arp.gate_length", (float)gate_length->valuedouble);
+        }
+        cJSON *swing = cJSON_GetObjectItemCaseSensitive(arp, "swing");
+        if (cJSON_IsNumber(swing)) {
+            patch_set(synth, part, "arp.swing", (float)swing->valuedouble);
+        }
+        cJSON *pattern_length = cJSON_GetObjectItemCaseSensitive(arp, "pattern_length");
+        if (cJSON_IsNumber(pattern_length)) {
+            patch_set(synth, part, "arp.pattern_length", (float)pattern_length->valuedouble);
+        }
+        cJSON *lanes = cJSON_GetObjectItemCaseSensitive(arp, "lanes");
+        if (cJSON_IsArray(lanes)) {
+            int num_lanes = cJSON_GetArraySize(lanes);
+            for (int i = 0; i < num_lanes && i < ARP_PATTERN_LEN; ++i) {
+                cJSON *lane = cJSON_GetArrayItem(lanes, i);
+                ArpStep *step = &part->arp.lanes[i];
+                cJSON *velocity = cJSON_GetObjectItemCaseSensitive(lane, "velocity");
+                if (cJSON_IsNumber(velocity)) step->velocity = (float)velocity->valuedouble;
+                cJSON *gate = cJSON_GetObjectItemCaseSensitive(lane, "gate");
+                if (cJSON_IsNumber(gate)) step->gate = (float)gate->valuedouble;
+                cJSON *ratchet = cJSON_GetObjectItemCaseSensitive(lane, "ratchet");
+                if (cJSON_IsNumber(ratchet)) step->ratchet = ratchet->valueint;
+                cJSON *tie = cJSON_GetObjectItemCaseSensitive(lane, "tie");
+                if (cJSON_IsBool(tie)) step->tie = cJSON_IsTrue(tie);
+                cJSON *probability = cJSON_GetObjectItemCaseSensitive(lane, "probability");
+                if (cJSON_IsNumber(probability)) step->probability = (float)probability->valuedouble;
+            }
+        }
+    }
+}
+
+void synth_load_preset_json(Synth *synth, const char *json_string) {
+    cJSON *root = cJSON_Parse(json_string);
+    if (!root) {
+        const char *error_ptr = cJSON_GetErrorPtr();
+        if (error_ptr != NULL) {
+            fprintf(stderr, "Error before: %s\n", error_ptr);
+        }
+        return;
+    }
+
     // Load Mixer parameters
     cJSON *mixer = cJSON_GetObjectItemCaseSensitive(root, "mixer");
     if (cJSON_IsObject(mixer)) {
@@ -659,6 +1077,34 @@ void synth_load_preset_json(Synth *synth, const char *json_string) {
         if (cJSON_IsNumber(comp_makeup_gain)) {
             synth_set_param(synth, "mixer.comp.makeup", (float)comp_makeup_gain->valuedouble);
         }
+        cJSON *comp_detector = cJSON_GetObjectItemCaseSensitive(mixer, "comp_detector");
+        if (cJSON_IsNumber(comp_detector)) {
+            synth_set_param(synth, "mixer.comp.detector", (float)comp_detector->valuedouble);
+        }
+        cJSON *limiter_enabled = cJSON_GetObjectItemCaseSensitive(mixer, "limiter_enabled");
+        if (cJSON_IsNumber(limiter_enabled)) {
+            synth_set_param(synth, "mixer.limiter.enabled", (float)limiter_enabled->valuedouble);
+        }
+        cJSON *limiter_ceiling = cJSON_GetObjectItemCaseSensitive(mixer, "limiter_ceiling");
+        if (cJSON_IsNumber(limiter_ceiling)) {
+            synth_set_param(synth, "mixer.limiter.ceiling", (float)limiter_ceiling->valuedouble);
+        }
+        cJSON *limiter_release = cJSON_GetObjectItemCaseSensitive(mixer, "limiter_release");
+        if (cJSON_IsNumber(limiter_release)) {
+            synth_set_param(synth, "mixer.limiter.release", (float)limiter_release->valuedouble);
+        }
+        cJSON *auto_gain_enabled = cJSON_GetObjectItemCaseSensitive(mixer, "auto_gain_enabled");
+        if (cJSON_IsNumber(auto_gain_enabled)) {
+            synth_set_param(synth, "mixer.auto.gain.enabled", (float)auto_gain_enabled->valuedouble);
+        }
+        cJSON *auto_gain_target = cJSON_GetObjectItemCaseSensitive(mixer, "auto_gain_target");
+        if (cJSON_IsNumber(auto_gain_target)) {
+            synth_set_param(synth, "mixer.auto.gain.target", (float)auto_gain_target->valuedouble);
+        }
+        cJSON *auto_gain_time = cJSON_GetObjectItemCaseSensitive(mixer, "auto_gain_time");
+        if (cJSON_IsNumber(auto_gain_time)) {
+            synth_set_param(synth, "mixer.auto.gain.time", (float)auto_gain_time->valuedouble);
+        }
     }
 
     // Load FX parameters
@@ -676,6 +1122,18 @@ void synth_load_preset_json(Synth *synth, const char *json_string) {
         if (cJSON_IsNumber(flanger_feedback)) {
             synth_set_param(synth, "flanger.feedback", (float)flanger_feedback->valuedouble);
         }
+        cJSON *chorus_depth = cJSON_GetObjectItemCaseSensitive(fx, "chorus_depth");
+        if (cJSON_IsNumber(chorus_depth)) {
+            synth_set_param(synth, "fx.chorus.depth", (float)chorus_depth->valuedouble);
+        }
+        cJSON *chorus_rate = cJSON_GetObjectItemCaseSensitive(fx, "chorus_rate");
+        if (cJSON_IsNumber(chorus_rate)) {
+            synth_set_param(synth, "fx.chorus.rate", (float)chorus_rate->valuedouble);
+        }
+        cJSON *chorus_mix = cJSON_GetObjectItemCaseSensitive(fx, "chorus_mix");
+        if (cJSON_IsNumber(chorus_mix)) {
+            synth_set_param(synth, "fx.chorus.mix", (float)chorus_mix->valuedouble);
+        }
         cJSON *delay_time = cJSON_GetObjectItemCaseSensitive(fx, "delay_time");
         if (cJSON_IsNumber(delay_time)) {
             synth_set_param(synth, "delay.time", (float)delay_time->valuedouble);
@@ -688,6 +1146,27 @@ void synth_load_preset_json(Synth *synth, const char *json_string) {
         if (cJSON_IsNumber(delay_mix)) {
             synth_set_param(synth, "delay.mix", (float)delay_mix->valuedouble);
         }
+        cJSON *multitap_enabled = cJSON_GetObjectItemCaseSensitive(fx, "multitap_enabled");
+        if (cJSON_IsNumber(multitap_enabled)) {
+            synth_set_param(synth, "fx.multitap.enabled", (float)multitap_enabled->valuedouble);
+        }
+        // Presets from before the tap count keep the four taps they had
+        cJSON *multitap_taps = cJSON_GetObjectItemCaseSensitive(fx, "multitap_taps");
+        synth_set_param(synth, "fx.multitap.taps",
+                        cJSON_IsNumber(multitap_taps) ? (float)multitap_taps->valuedouble : 4.0f);
+        // Tap beat, level, pan and feedback: multitap_tapN[_level|_pan|_feedback]
+        static const char *tap_suffixes[] = {"", "_level", "_pan", "_feedback"};
+        for (int tap = 0; tap < MAX_DELAY_TAPS; ++tap) {
+            for (int s = 0; s < 4; ++s) {
+                char key[40], param[40];
+                snprintf(key, sizeof(key), "multitap_tap%d%s", tap, tap_suffixes[s]);
+                snprintf(param, sizeof(param), "fx.multitap.tap%d%s", tap, tap_suffixes[s]);
+                cJSON *item = cJSON_GetObjectItemCaseSensitive(fx, key);
+                if (cJSON_IsNumber(item)) {
+                    synth_set_param(synth, param, (float)item->valuedouble);
+                }
+            }
+        }
         cJSON *reverb_size = cJSON_GetObjectItemCaseSensitive(fx, "reverb_size");
         if (cJSON_IsNumber(reverb_size)) {
             synth_set_param(synth, "reverb.size", (float)reverb_size->valuedouble);
@@ -700,6 +1179,18 @@ void synth_load_preset_json(Synth *synth, const char *json_string) {
         if (cJSON_IsNumber(reverb_mix)) {
             synth_set_param(synth, "reverb.mix", (float)reverb_mix->valuedouble);
         }
+        cJSON *reverb_algorithm = cJSON_GetObjectItemCaseSensitive(fx, "reverb_algorithm");
+        if (cJSON_IsNumber(reverb_algorithm)) {
+            synth_set_param(synth, "fx.reverb.algorithm", (float)reverb_algorithm->valuedouble);
+        }
+        cJSON *convolution_ir = cJSON_GetObjectItemCaseSensitive(fx, "convolution_ir");
+        if (cJSON_IsString(convolution_ir) && convolution_ir->valuestring[0]) {
+            fx_load_impulse_response(&synth->fx, convolution_ir->valuestring);
+        }
+        cJSON *convolution_mix = cJSON_GetObjectItemCaseSensitive(fx, "convolution_mix");
+        if (cJSON_IsNumber(convolution_mix)) {
+            synth_set_param(synth, "fx.convolution.mix", (float)convolution_mix->valuedouble);
+        }
     }
 
     // Load Ring Modulator parameters
@@ -719,76 +1210,128 @@ void synth_load_preset_json(Synth *synth, const char *json_string) {
         }
     }
 
-    // Load Arpeggiator parameters
-    cJSON *arp = cJSON_GetObjectItemCaseSensitive(root, "arpeggiator");
-    if (cJSON_IsObject(arp)) {
-        cJSON *enabled = cJSON_GetObjectItemCaseSensitive(arp, "enabled");
-        if (cJSON_IsBool(enabled)) {
-            synth_set_param(synth, "arp.enabled", (float)cJSON_IsTrue(enabled));
-        }
-        cJSON *mode = cJSON_GetObjectItemCaseSensitive(arp, "mode");
-        if (cJSON_IsNumber(mode)) {
-            synth_set_param(synth, "arp.mode", (float)mode->valuedouble);
-        }
-        cJSON *tempo = cJSON_GetObjectItemCaseSensitive(arp, "tempo");
-        if (cJSON_IsNumber(tempo)) {
-            synth_set_param(synth, "arp.tempo", (float)tempo->valuedouble);
-        }
-        cJSON *rate = cJSON_GetObjectItemCaseSensitive(arp, "rate");
-        if (cJSON_IsNumber(rate)) {
-            synth_set_param(synth, "arp.rate", (float)rate->valuedouble);
-        }
-        cJSON *polyphonic = cJSON_GetObjectItemCaseSensitive(arp, "polyphonic");
-        if (cJSON_IsBool(polyphonic)) {
-            synth_set_param(synth, "arp.polyphonic", (float)cJSON_IsTrue(polyphonic));
-        }
-        cJSON *hold = cJSON_GetObjectItemCaseSensitive(arp, "hold");
-        if (cJSON_IsBool(hold)) {
-            synth_set_param(synth, "arp.hold", (float)cJSON_IsTrue(hold));
-        }
-        cJSON *octave = cJSON_GetObjectItemCaseSensitive(arp, "octave");
-        if (cJSON_IsNumber(octave)) {
-            synth_set_param(synth, "arp.octave", (float)octave->valuedouble);
-        }
-        cJSON *octaves = cJSON_GetObjectItemCaseSensitive(arp, "octaves");
-        if (cJSON_IsNumber(octaves)) {
-            synth_set_param(synth, "arp.octaves", (float)octaves->valuedouble);
-        }
-        
-        // Chord generation parameters
-        cJSON *chord_type = cJSON_GetObjectItemCaseSensitive(arp, "chord_type");
-        if (cJSON_IsNumber(chord_type)) {
-            synth_set_param(synth, "arp.chord_type", (float)chord_type->valuedouble);
-        }
-        cJSON *add_6 = cJSON_GetObjectItemCaseSensitive(arp, "add_6");
-        if (cJSON_IsBool(add_6)) {
-            synth_set_param(synth, "arp.add_6", (float)cJSON_IsTrue(add_6));
-        }
-        cJSON *add_m7 = cJSON_GetObjectItemCaseSensitive(arp, "add_m7");
-        if (cJSON_IsBool(add_m7)) {
-            synth_set_param(synth, "arp.add_m7", (float)cJSON_IsTrue(add_m7));
-        }
-        cJSON *add_M7 = cJSON_GetObjectItemCaseSensitive(arp, "add_M7");
-        if (cJSON_IsBool(add_M7)) {
-            synth_set_param(synth, "arp.add_M7", (float)cJSON_IsTrue(add_M7));
-        }
-        cJSON *add_9 = cJSON_GetObjectItemCaseSensitive(arp, "add_9");
-        if (cJSON_IsBool(add_9)) {
-            synth_set_param(synth, "arp.add_9", (float)cJSON_IsTrue(add_9));
-        }
-        cJSON *voicing = cJSON_GetObjectItemCaseSensitive(arp, "voicing");
-        if (cJSON_IsNumber(voicing)) {
-            synth_set_param(synth, "arp.voicing", (float)voicing->valuedouble);
+    // Patch of the edit part, then the parts with their own patches
+    synth_load_patch(synth, synth_edit_part(synth), root);
+    cJSON *parts = cJSON_GetObjectItemCaseSensitive(root, "parts");
+    if (cJSON_IsArray(parts)) {
+        int num_parts = cJSON_GetArraySize(parts);
+        for (int p = 0; p < num_parts && p < SYNTH_MAX_PARTS; ++p) {
+            cJSON *entry = cJSON_GetArrayItem(parts, p);
+            if (!cJSON_IsObject(entry))
+                continue;
+            static const char *mix_keys[] = {"channel", "level", "pan", "reverb_send", "delay_send",
+                                             "bend_range", "aftertouch"};
+            for (int k = 0; k < 7; ++k) {
+                char param[32];
+                snprintf(param, sizeof(param), "part.%s", mix_keys[k]);
+                cJSON *item = cJSON_GetObjectItemCaseSensitive(entry, mix_keys[k]);
+                if (cJSON_IsNumber(item)) {
+                    synth_set_part_param(synth, p, param, (float)item->valuedouble);
+                }
+            }
+            cJSON *part_gains = cJSON_GetObjectItemCaseSensitive(entry, "osc_gains");
+            if (cJSON_IsArray(part_gains)) {
+                int num_gains = cJSON_GetArraySize(part_gains);
+                for (int i = 0; i < num_gains && i < 4; ++i) {
+                    cJSON *gain = cJSON_GetArrayItem(part_gains, i);
+                    if (cJSON_IsNumber(gain)) {
+                        char param_name[32];
+                        snprintf(param_name, sizeof(param_name), "mixer.osc%d", i + 1);
+                        synth_set_part_param(synth, p, param_name, (float)gain->valuedouble);
+                    }
+                }
+            }
+            synth_load_patch(synth, &synth->parts[p], entry);
         }
-        cJSON *gate_length = cJSON_GetObjectItemCaseSensitive(arp, "gate_length");
-        if (cJSON_IsNumber(gate_length)) {
-            synth_set_param(synth, "arp.gate_length", (float)gate_length->valuedouble);
+    }
+    cJSON *edit_part = cJSON_GetObjectItemCaseSensitive(root, "edit_part");
+    if (cJSON_IsNumber(edit_part)) {
+        synth_set_param(synth, "part.edit", (float)edit_part->valuedouble);
+    }
+
+    // Load shared send bus parameters
+    cJSON *bus = cJSON_GetObjectItemCaseSensitive(root, "send_bus");
+    if (cJSON_IsObject(bus)) {
+        static const char *bus_keys[][2] = {
+            {"reverb_size", "bus.reverb.size"}, {"reverb_damping", "bus.reverb.damping"},
+            {"reverb_return", "bus.reverb.return"}, {"delay_time", "bus.delay.time"},
+            {"delay_feedback", "bus.delay.feedback"}, {"delay_return", "bus.delay.return"}};
+        for (int k = 0; k < 6; ++k) {
+            cJSON *item = cJSON_GetObjectItemCaseSensitive(bus, bus_keys[k][0]);
+            if (cJSON_IsNumber(item)) {
+                synth_set_param(synth, bus_keys[k][1], (float)item->valuedouble);
+            }
         }
     }
 
     cJSON_Delete(root);
 }
 
+int synth_load_programs(Synth *synth, const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return 0; // No bank: program changes are ignored
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *text = size >= 0 ? (char *)malloc((size_t)size + 1) : NULL;
+    if (!text) {
+        fclose(fp);
+        return 0;
+    }
+    size_t got = fread(text, 1, (size_t)size, fp);
+    text[got] = '\0';
+    fclose(fp);
+
+    cJSON *root = cJSON_Parse(text);
+    free(text);
+    cJSON *list = cJSON_GetObjectItemCaseSensitive(root, "programs");
+    if (!cJSON_IsArray(list)) {
+        platform_log("Programs: '%s' has no \"programs\" array", path);
+        cJSON_Delete(root);
+        return 0;
+    }
+
+    PartProgram *programs = (PartProgram *)calloc(SYNTH_MAX_PROGRAMS, sizeof(PartProgram));
+    Part *scratch = (Part *)malloc(sizeof(Part));
+    if (!programs || !scratch) {
+        free(programs);
+        free(scratch);
+        cJSON_Delete(root);
+        return 0;
+    }
+
+    // Each entry holds the patch sections of a preset; they are applied to
+    // a scratch part so the bank is ready-made structs for the audio thread
+    int count = 0;
+    int num_entries = cJSON_GetArraySize(list);
+    for (int i = 0; i < num_entries && count < SYNTH_MAX_PROGRAMS; ++i) {
+        cJSON *entry = cJSON_GetArrayItem(list, i);
+        if (!cJSON_IsObject(entry))
+            continue;
+        // Tempo belongs to the song, not the program
+        cJSON_DeleteItemFromObjectCaseSensitive(
+            cJSON_GetObjectItemCaseSensitive(entry, "arpeggiator"), "tempo");
+        part_init(scratch, (int)synth->sample_rate, 0, 0);
+        synth_load_patch(synth, scratch, entry);
+        cJSON *gains = cJSON_GetObjectItemCaseSensitive(entry, "osc_gains");
+        for (int g = 0; g < 4 && g < cJSON_GetArraySize(gains); ++g) {
+            cJSON *gain = cJSON_GetArrayItem(gains, g);
+            if (cJSON_IsNumber(gain))
+                scratch->osc_gain[g] = (float)gain->valuedouble;
+        }
+        part_store_program(scratch, &programs[count++]);
+    }
+    free(scratch);
+    cJSON_Delete(root);
+
+    free(synth->programs);
+    synth->programs = programs;
+    synth->program_count = count;
+    platform_log("Programs: %d loaded from '%s'", count, path);
+    return 1;
+}
+
 void synth_save_default_config(const Synth *synth) {
     char *json_string = synth_save_preset_json(synth);
     if (!json_string) {
@@ -849,37 +1392,37 @@ void synth_randomize_parameters(Synth *synth) {
     // Randomize all oscillators (0-3)
     for (int i = 0; i < 4; i++) {
         // Randomize waveform (0-4: SINE, SAW, SQUARE, TRI, NOISE)
-        float random_waveform = (float)(rand() % 5);
+        float random_waveform = (float)(rng_next(&synth->rng) % 5);
         snprintf(param_name, sizeof(param_name), "osc%d.waveform", i + 1);
         synth_set_param(synth, param_name, random_waveform);
         
         // Randomize pitch (-24 to +24 semitones)
-        float random_pitch = -24.0f + ((float)rand() / (float)RAND_MAX) * 48.0f;
+        float random_pitch = -24.0f + rng_float(&synth->rng) * 48.0f;
         snprintf(param_name, sizeof(param_name), "osc%d.pitch", i + 1);
         synth_set_param(synth, param_name, random_pitch);
         
         // Randomize detune (-1.0 to +1.0 semitones)
-        float random_detune = -1.0f + ((float)rand() / (float)RAND_MAX) * 2.0f;
+        float random_detune = -1.0f + rng_float(&synth->rng) * 2.0f;
         snprintf(param_name, sizeof(param_name), "osc%d.detune", i + 1);
         synth_set_param(synth, param_name, random_detune);
         
         // Randomize gain (0.0 to 1.0)
-        float random_gain = (float)rand() / (float)RAND_MAX;
+        float random_gain = rng_float(&synth->rng);
         snprintf(param_name, sizeof(param_name), "osc%d.gain", i + 1);
         synth_set_param(synth, param_name, random_gain);
         
         // Randomize pulse width (0.0 to 1.0)
-        float random_pulse_width = (float)rand() / (float)RAND_MAX;
+        float random_pulse_width = rng_float(&synth->rng);
         snprintf(param_name, sizeof(param_name), "osc%d.pulse_width", i + 1);
         synth_set_param(synth, param_name, random_pulse_width);
         
         // Randomize unison voices (1-8)
-        int random_unison = 1 + (rand() % 8);
+        int random_unison = 1 + (rng_next(&synth->rng) % 8);
         snprintf(param_name, sizeof(param_name), "osc%d.unison_voices", i + 1);
         synth_set_param(synth, param_name, (float)random_unison);
         
         // Randomize unison detune (0.0 to 1.0)
-        float random_unison_detune = (float)rand() / (float)RAND_MAX;
+        float random_unison_detune = rng_float(&synth->rng);
         snprintf(param_name, sizeof(param_name), "osc%d.unison_detune", i + 1);
         synth_set_param(synth, param_name, random_unison_detune);
     }
@@ -891,37 +1434,37 @@ void synth_randomize_oscillator(Synth *synth, int osc_index) {
     char param_name[32];
     
     // Randomize waveform (0-4: SINE, SAW, SQUARE, TRI, NOISE)
-    float random_waveform = (float)(rand() % 5);
+    float random_waveform = (float)(rng_next(&synth->rng) % 5);
     snprintf(param_name, sizeof(param_name), "osc%d.waveform", osc_index + 1);
     synth_set_param(synth, param_name, random_waveform);
     
     // Randomize pitch (-24 to +24 semitones)
-    float random_pitch = -24.0f + ((float)rand() / (float)RAND_MAX) * 48.0f;
+    float random_pitch = -24.0f + rng_float(&synth->rng) * 48.0f;
     snprintf(param_name, sizeof(param_name), "osc%d.pitch", osc_index + 1);
     synth_set_param(synth, param_name, random_pitch);
     
     // Randomize detune (-1.0 to +1.0 semitones)
-    float random_detune = -1.0f + ((float)rand() / (float)RAND_MAX) * 2.0f;
+    float random_detune = -1.0f + rng_float(&synth->rng) * 2.0f;
     snprintf(param_name, sizeof(param_name), "osc%d.detune", osc_index + 1);
     synth_set_param(synth, param_name, random_detune);
     
     // Randomize gain (0.0 to 1.0)
-    float random_gain = (float)rand() / (float)RAND_MAX;
+    float random_gain = rng_float(&synth->rng);
     snprintf(param_name, sizeof(param_name), "osc%d.gain", osc_index + 1);
     synth_set_param(synth, param_name, random_gain);
     
     // Randomize pulse width (0.0 to 1.0)
-    float random_pulse_width = (float)rand() / (float)RAND_MAX;
+    float random_pulse_width = rng_float(&synth->rng);
     snprintf(param_name, sizeof(param_name), "osc%d.pulse_width", osc_index + 1);
     synth_set_param(synth, param_name, random_pulse_width);
     
     // Randomize unison voices (1-8)
-    int random_unison = 1 + (rand() % 8);
+    int random_unison = 1 + (rng_next(&synth->rng) % 8);
     snprintf(param_name, sizeof(param_name), "osc%d.unison_voices", osc_index + 1);
     synth_set_param(synth, param_name, (float)random_unison);
     
     // Randomize unison detune (0.0 to 1.0)
-    float random_unison_detune = (float)rand() / (float)RAND_MAX;
+    float random_unison_detune = rng_float(&synth->rng);
     snprintf(param_name, sizeof(param_name), "osc%d.unison_detune", osc_index + 1);
     synth_set_param(synth, param_name, random_unison_detune);
 }
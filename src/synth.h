@@ -3,12 +3,22 @@
 #include "adsr.h"
 #include "fx.h"
 #include "lfo.h"
+#include "midi_clock.h"
+#include "midi_map.h"
+#include "midi_queue.h"
 #include "mixer.h"
-#include "midi.h"
+#include "mpe.h"
 #include "osc.h"
+#include "part.h"
 #include "ring_modulator.h"
+#include "send_bus.h"
+#include "sequencer.h"
+#include "smf.h"
+#include "snapshot.h"
+#include "transport.h"
 #include "voice.h"
-#include <SDL2/SDL.h>
+#include "worker_pool.h"
+#include <time.h>
 
 typedef struct {
   int note;
@@ -22,21 +32,55 @@ typedef struct {
   float duration;
 } ChordProgression;
 
+#define MAX_MELODY_POLYPHONY 8
+#define SYNTH_MAX_PARTS 16            // One per MIDI channel
+#define SYNTH_MAX_PROGRAMS 128        // MIDI program change range
+#define SYNTH_PROGRAMS_FILE "programs.json" // Loaded by the app when present
+
+typedef struct {
+  int note;
+  unsigned long long off_frame;
+  int active;
+} ActiveMelodyNote;
+
+// Startup melody, played on the first part
+typedef struct {
+  int playing;
+  int index;                    // Next note of the melody
+  unsigned long long next_frame; // Transport frame of the next note
+  ActiveMelodyNote active[MAX_MELODY_POLYPHONY];
+} MelodyPlayer;
+
 typedef struct Synth {
-  Oscillator osc[4]; // osc[0-3] for main oscillators
-  LFO lfos[3]; // lfos[0] for pitch, lfos[1] for volume, lfos[2] for filter
+  Part parts[SYNTH_MAX_PARTS];  // Patches, part n listens on MIDI channel n + 1
+  int edit_part;                // Part the GUI, keyboard and plain params address
+  SendBus bus;                  // Reverb and delay shared by the part sends
+  WorkerPool workers;           // Renders parts in parallel
+  int busy_parts[SYNTH_MAX_PARTS]; // Parts with work in the current pass
+  int busy_count;
+  int pass_frames;              // Length of the current pass
   Mixer mixer;
   FX fx;
   RingModulator ring_mod;
-  Voice voices[64];
-  int max_voices;
-  Arpeggiator arp;
-  Midi midi;
+  Transport transport;          // Tempo and song position for everything in time
+  Sequencer seq;                // Chord progression, played on the first part
+  MelodyPlayer melody;
+  SmfPlayer song;               // MIDI file playback, see smf.h
+  MidiMap midi_map;             // CC routing, see midi_map.h
+  MidiQueue midi_in;            // From the MIDI threads, applied at block start
+  MidiClock midi_clock;         // Clock sync in and out, see midi_clock.h
+  Mpe mpe;                      // MPE zones and member channel expression
+  PartProgram *programs;        // Program change bank
+  int program_count;
+  int last_cc;                  // Most recent CC, for the GUI
+  int last_cc_value;
+  unsigned int rng;             // Random patches and part seeds
   float cpu_usage;
-  unsigned long long timestamp_counter;
-  
+  float dsp_load;               // Callback time as a percentage of the buffer
+  clock_t cpu_clock;            // Process time at the previous callback
+  SnapshotChannel snapshot;     // Meters for the GUI, published every block
+
   float sample_rate;
-  AdsrEnvelope adsr; // Global ADSR settings
   
   // Transition state
   int melody_finished;
@@ -45,21 +89,54 @@ typedef struct Synth {
 
 int synth_init(Synth *synth, int samplerate, int buffer_size, int voices);
 void synth_shutdown(Synth *synth);
-void synth_audio_callback(void *userdata, Uint8 *stream, int len);
+// Render interleaved stereo; the host calls this from its audio thread
+void synth_render(Synth *synth, float *out, int frames);
+// Reseed every random source, for repeatable offline renders
+void synth_seed(Synth *synth, unsigned int seed);
 int synth_active_voices(const Synth *synth);
 float synth_cpu_usage(const Synth *synth);
 void synth_set_bpm(Synth *synth, float bpm);
-void synth_handle_cc(Synth *synth, int cc, int value);
+// Audio thread. Registered parameters (pitch bend range, MPE
+// configuration) and member channel timbre are handled here, everything
+// else goes through the MIDI map.
+void synth_handle_cc(Synth *synth, int channel, int cc, int value);
+// MIDI notes go to every part listening on the channel (0-15), through
+// its arpeggiator when that is on. Notes on an MPE member channel go to
+// the parts listening on the zone's manager channel.
+void synth_channel_note_on(Synth *synth, int channel, int note, float velocity);
+void synth_channel_note_off(Synth *synth, int channel, int note);
+// Parameter by ID for every part listening on the channel (0-15)
+void synth_channel_param(Synth *synth, int channel, int id, float value);
+// Audio thread. bend is -1 to 1 of each part's bend range, or of the
+// zone's member bend range on an MPE member channel; pressures 0-1
+void synth_channel_pitch_bend(Synth *synth, int channel, float bend);
+void synth_channel_pressure(Synth *synth, int channel, float pressure);
+void synth_channel_poly_pressure(Synth *synth, int channel, int note, float pressure);
+// Switch listening parts to a program of the bank; empty slots are ignored
+void synth_channel_program(Synth *synth, int channel, int program);
+// Any thread: queue one raw MIDI 1.0 message for the next block. Clock,
+// start, stop, continue and song position go to the MIDI clock.
+int synth_midi_message(Synth *synth, const unsigned char *msg, int len);
+// Fill the program bank from a JSON file of patches; call before audio
+// starts. Returns 0 when the file is missing or invalid.
+int synth_load_programs(Synth *synth, const char *path);
+
 #ifdef __cplusplus
 extern "C" {
-  void synth_set_param(Synth *synth, const char *param, float value);
+#endif
+
+// Part-level names ("osc1.pitch", "arp.rate", ...) address the edit part
+void synth_set_param(Synth *synth, const char *param, float value);
+void synth_set_part_param(Synth *synth, int part, const char *param, float value);
+Part *synth_edit_part(Synth *synth);
+
+#ifdef __cplusplus
 }
 #endif
 
 void synth_note_on(Synth *synth, int note, float velocity);
 void synth_note_off(Synth *synth, int note);
 void synth_play_startup_melody(Synth *synth);
-void synth_update_startup_melody(Synth *synth, int frames);
 void synth_start_melody(Synth *synth);
 void synth_update_melody(Synth *synth, int frames);
 void synth_start_bach_progression(Synth *synth);
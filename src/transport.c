@@ -0,0 +1,55 @@
+#include "transport.h"
+#include <math.h>
+
+#define TRANSPORT_MIN_BPM 1.0f
+#define TRANSPORT_MAX_FRAMES 0x3fffffff // Far enough away to never be "next"
+
+void transport_init(Transport *t, float sample_rate) {
+  t->bpm = 120.0f;
+  t->sample_rate = sample_rate;
+  t->frame = 0;
+  t->beat = 0.0;
+  t->running = 1;
+}
+
+void transport_set_bpm(Transport *t, float bpm) {
+  t->bpm = bpm < TRANSPORT_MIN_BPM ? TRANSPORT_MIN_BPM : bpm;
+}
+
+double transport_frames_per_beat(const Transport *t) {
+  float bpm = t->bpm < TRANSPORT_MIN_BPM ? TRANSPORT_MIN_BPM : t->bpm;
+  return 60.0 * t->sample_rate / bpm;
+}
+
+void transport_advance(Transport *t, int frames) {
+  t->frame += (unsigned long long)frames;
+  if (t->running)
+    t->beat += frames / transport_frames_per_beat(t);
+}
+
+void transport_locate(Transport *t, double beat) {
+  t->beat = beat < 0.0 ? 0.0 : beat;
+}
+
+int transport_frames_until_beat(const Transport *t, double beat) {
+  double frames = (beat - t->beat) * transport_frames_per_beat(t);
+  if (frames > TRANSPORT_MAX_FRAMES)
+    return TRANSPORT_MAX_FRAMES;
+  // Round so an event lands on the nearest sample rather than the next
+  return (int)floor(frames + 0.5);
+}
+
+int transport_frames_until_frame(const Transport *t, unsigned long long frame) {
+  if (frame <= t->frame)
+    return 0;
+  unsigned long long frames = frame - t->frame;
+  return frames > TRANSPORT_MAX_FRAMES ? TRANSPORT_MAX_FRAMES : (int)frames;
+}
+
+int transport_bar(const Transport *t) {
+  return (int)floor(t->beat / TRANSPORT_BEATS_PER_BAR);
+}
+
+int transport_beat_in_bar(const Transport *t) {
+  return (int)floor(t->beat) % TRANSPORT_BEATS_PER_BAR;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Sample-counting musical clock shared by everything that plays in time
+// (arpeggiator, startup melody, multi-tap delay, chord progression). The
+// audio thread advances it by the frames it renders, so positions never
+// drift from the audio. Beat positions are in quarter notes (PPQ); events
+// are scheduled at a beat or a frame and fired at the exact sample offset
+// inside the render block.
+#define TRANSPORT_BEATS_PER_BAR 4
+
+typedef struct {
+  float bpm;                    // Tempo; the GUI edits this directly
+  float sample_rate;
+  unsigned long long frame;     // Frames rendered since init
+  double beat;                  // Quarter notes since init
+  int running;                  // Beats advance; an external clock stop holds them
+} Transport;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void transport_init(Transport *t, float sample_rate);
+void transport_set_bpm(Transport *t, float bpm);
+void transport_advance(Transport *t, int frames);
+// Jump to a song position; beat-scheduled events have to be moved by
+// their owners
+void transport_locate(Transport *t, double beat);
+
+double transport_frames_per_beat(const Transport *t);
+// Frames from now until 'beat' / 'frame' is reached, rounded to the nearest
+// sample; 0 or less means it is due now
+int transport_frames_until_beat(const Transport *t, double beat);
+int transport_frames_until_frame(const Transport *t, unsigned long long frame);
+
+// 0-based bar and beat within the bar, for display
+int transport_bar(const Transport *t);
+int transport_beat_in_bar(const Transport *t);
+
+#ifdef __cplusplus
+}
+#endif
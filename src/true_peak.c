@@ -0,0 +1,62 @@
+#include "true_peak.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// The windowed-sinc prototype is centred on tap 23, so branch 3 is a pure
+// delay of 5 samples and branches 0..2 fall between x[n-6] and x[n-5]
+#define TRUE_PEAK_FIR_CENTER 23
+
+void true_peak_init(TruePeak *tp) {
+  const int len = TRUE_PEAK_OVERSAMPLE * TRUE_PEAK_PHASE_TAPS - 1;
+  memset(tp, 0, sizeof(*tp));
+  for (int p = 0; p < TRUE_PEAK_OVERSAMPLE - 1; ++p) {
+    float sum = 0.0f;
+    for (int i = 0; i < TRUE_PEAK_PHASE_TAPS; ++i) {
+      int k = i * TRUE_PEAK_OVERSAMPLE + p;
+      double t = (double)(k - TRUE_PEAK_FIR_CENTER) / TRUE_PEAK_OVERSAMPLE;
+      double sinc = t == 0.0 ? 1.0 : sin(M_PI * t) / (M_PI * t);
+      double w = 0.42 - 0.5 * cos(2.0 * M_PI * k / (len - 1)) + 0.08 * cos(4.0 * M_PI * k / (len - 1));
+      tp->phase_fir[p][i] = k < len ? (float)(sinc * w) : 0.0f;
+      sum += tp->phase_fir[p][i];
+    }
+    // Unity gain at DC for every branch
+    float norm = 0.0f;
+    for (int i = 0; i < TRUE_PEAK_PHASE_TAPS; ++i) {
+      tp->phase_fir[p][i] /= sum;
+      norm += fabsf(tp->phase_fir[p][i]);
+    }
+    if (norm > tp->fir_norm)
+      tp->fir_norm = norm;
+  }
+}
+
+static float interval_peak(const TruePeak *tp, const float *h, float floor) {
+  float peak = fmaxf(fabsf(h[TRUE_PEAK_DELAY - 1]), fabsf(h[TRUE_PEAK_DELAY]));
+  float bound = 0.0f;
+  for (int i = 0; i < TRUE_PEAK_PHASE_TAPS; ++i)
+    bound = fmaxf(bound, fabsf(h[i]));
+  if (bound * tp->fir_norm <= floor)
+    return peak;
+  for (int p = 0; p < TRUE_PEAK_OVERSAMPLE - 1; ++p) {
+    const float *c = tp->phase_fir[p];
+    float acc = 0.0f;
+    for (int i = 0; i < TRUE_PEAK_PHASE_TAPS; ++i)
+      acc += h[i] * c[i];
+    peak = fmaxf(peak, fabsf(acc));
+  }
+  return peak;
+}
+
+float true_peak_push(TruePeak *tp, float left, float right, float floor) {
+  // Newest sample first, so x[n - i] is history[ch][pos + i]
+  int pos = (tp->pos - 1) & (TRUE_PEAK_HISTORY - 1);
+  tp->history[0][pos] = tp->history[0][pos + TRUE_PEAK_HISTORY] = left;
+  tp->history[1][pos] = tp->history[1][pos + TRUE_PEAK_HISTORY] = right;
+  tp->pos = pos;
+  return fmaxf(interval_peak(tp, &tp->history[0][pos], floor),
+               interval_peak(tp, &tp->history[1][pos], floor));
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// 4x oversampled true-peak detection for a stereo stream (ITU-R BS.1770
+// style). Each pushed frame reports the largest reconstructed value in the
+// interval between x[n - TRUE_PEAK_DELAY] and x[n - TRUE_PEAK_DELAY + 1].
+#define TRUE_PEAK_OVERSAMPLE 4
+#define TRUE_PEAK_PHASE_TAPS 12       // FIR taps per polyphase branch
+#define TRUE_PEAK_HISTORY 16          // Input history per channel (power of two)
+#define TRUE_PEAK_DELAY 6
+
+typedef struct {
+  // Interpolating branches for the three in-between phases
+  float phase_fir[TRUE_PEAK_OVERSAMPLE - 1][TRUE_PEAK_PHASE_TAPS];
+  float fir_norm;               // Largest sum of |taps|, bounds the interpolated peak
+  float history[2][TRUE_PEAK_HISTORY * 2]; // Mirrored so each FIR read is contiguous
+  int pos;
+} TruePeak;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void true_peak_init(TruePeak *tp);
+// Push one frame and return the interval peak of the louder channel. When
+// the history is too quiet for the result to exceed 'floor', the filters are
+// skipped and the sample peak is returned instead.
+float true_peak_push(TruePeak *tp, float left, float right, float floor);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,63 @@
 #pragma once
+#include <stdint.h>
+#include <string.h>
 
 // Fast trigonometric approximations for audio processing
 float fastsin(float x);
-float fastcos(float x);
\ No newline at end of file
+float fastcos(float x);
+
+// Fast log2/exp2 for gain computers working in the log domain.
+// Errors are about 1e-6 (log2 absolute) and 4e-6 (exp2 relative).
+static inline float fast_log2f(float x) {
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  int e = (int)((bits >> 23) & 0xFF) - 127;
+  bits = (bits & 0x007FFFFF) | 0x3F800000; // Mantissa in [1, 2)
+  float m;
+  memcpy(&m, &bits, sizeof(m));
+  if (m > 1.41421356f) { // Centre the mantissa on 1 for the series
+    m *= 0.5f;
+    ++e;
+  }
+  // ln(m) = 2 atanh(t), t = (m - 1) / (m + 1), |t| < 0.172
+  float t = (m - 1.0f) / (m + 1.0f);
+  float t2 = t * t;
+  float p = t * (2.0f + t2 * (0.66666667f + t2 * (0.4f + t2 * 0.28571429f)));
+  return (float)e + p * 1.44269504f;
+}
+
+static inline float fast_exp2f(float x) {
+  if (x < -126.0f)
+    x = -126.0f;
+  else if (x > 126.0f)
+    x = 126.0f;
+  // Round to nearest so the fractional part is in [-0.5, 0.5]
+  int xi = (int)(x + (x >= 0.0f ? 0.5f : -0.5f));
+  float f = (x - (float)xi) * 0.69314718f;
+  float p = 1.0f + f * (1.0f + f * (0.5f + f * (0.16666667f + f * (0.041666667f + f * 0.0083333333f))));
+  uint32_t bits = (uint32_t)(xi + 127) << 23;
+  float scale;
+  memcpy(&scale, &bits, sizeof(scale));
+  return p * scale;
+}
+
+// xorshift32. Every module that needs noise keeps its own state, so synth
+// instances and worker threads never share rand()'s hidden one. A zero
+// state would stay zero; rng_seed() maps it to a fixed constant.
+static inline unsigned int rng_seed(unsigned int seed) {
+  return seed ? seed : 0x9e3779b9u;
+}
+
+static inline unsigned int rng_next(unsigned int *state) {
+  unsigned int x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+// Uniform in [0, 1)
+static inline float rng_float(unsigned int *state) {
+  return (rng_next(state) >> 8) * (1.0f / 16777216.0f);
+}
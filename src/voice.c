@@ -1,12 +1,22 @@
 #include "voice.h"
+#include <math.h>
 #include <string.h>
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
 void voice_init(Voice *v, float samplerate) {
   v->active = 0;
   v->note = 0;
   v->velocity = 0;
   v->timestamp = 0;
   memset(v->phase_acc, 0, sizeof(v->phase_acc));
+  v->pressure = 0.0f;
+  v->channel = -1;
+  v->bend = 0.0f;
+  v->timbre = 1.0f;
+  v->tone[0] = v->tone[1] = 0.0f;
   adsr_init(&v->adsr, samplerate);
 }
 
@@ -17,6 +27,10 @@ void voice_on(Voice *v, float note, float velocity,
   v->velocity = velocity;
   v->timestamp = timestamp;
   memset(v->phase_acc, 0, sizeof(v->phase_acc));
+  v->pressure = 0.0f;
+  v->bend = 0.0f;
+  v->timbre = 1.0f;
+  v->tone[0] = v->tone[1] = 0.0f;
   adsr_gate_on(&v->adsr);
 }
 
@@ -25,7 +39,8 @@ void voice_off(Voice *v) {
   // Voice stays active until ADSR reaches IDLE state
 }
 
-void voice_render(Voice *v, const Oscillator *osc, const LFO *lfo, const float *osc_gains, float *stereo, int frames) {
+void voice_render(Voice *v, const Oscillator *osc, const LFO *lfo, const float *osc_gains,
+                  float bend, float gain, float *stereo, int frames) {
   // Get ADSR envelope value for this block
   float adsr_value = adsr_process(&v->adsr, frames);
   
@@ -34,7 +49,16 @@ void voice_render(Voice *v, const Oscillator *osc, const LFO *lfo, const float *
     v->active = 0;
     return;
   }
-  
+
+  // Per-note expression at control rate: pitch, and a one-pole low-pass
+  // from 100 Hz (timbre 0) to 20 kHz, bypassed when fully open
+  float note = v->note + (v->bend + bend);
+  float tone = 1.0f;
+  if (v->timbre < 1.0f) {
+    float cutoff = 100.0f * powf(200.0f, v->timbre > 0.0f ? v->timbre : 0.0f);
+    tone = 1.0f - expf(-2.0f * (float)M_PI * cutoff / v->adsr.sample_rate);
+  }
+
   for (int n = 0; n < frames; ++n) {
     float left = 0.0f;
     float right = 0.0f;
@@ -46,7 +70,7 @@ void voice_render(Voice *v, const Oscillator *osc, const LFO *lfo, const float *
     
     // Process each oscillator with gain and panning
     for (int o = 0; o < 4; ++o) {
-      float modified_note = v->note;
+      float modified_note = note;
       
       // Apply pitch LFO (only to main oscillators 0-3)
       if (o < 4 && lfo[0].enabled) {
@@ -72,8 +96,14 @@ void voice_render(Voice *v, const Oscillator *osc, const LFO *lfo, const float *
     }
     
     // Apply velocity and ADSR envelope
-    left *= v->velocity * adsr_value;
-    right *= v->velocity * adsr_value;
+    left *= v->velocity * adsr_value * gain;
+    right *= v->velocity * adsr_value * gain;
+    if (tone < 1.0f) {
+      v->tone[0] += tone * (left - v->tone[0]);
+      v->tone[1] += tone * (right - v->tone[1]);
+      left = v->tone[0];
+      right = v->tone[1];
+    }
     
     // Add to stereo buffer (no averaging - oscillator gains handle mixing)
     stereo[n * 2 + 0] += left; // Left channel
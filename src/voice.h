@@ -9,6 +9,12 @@ typedef struct Voice {
   float velocity;
   unsigned long long timestamp;
   float phase_acc[4];
+  float pressure;               // Poly aftertouch, 0-1
+  // Per-note expression (MPE), read once per block
+  int channel;                  // MPE member channel 0-15, -1 for part-wide notes
+  float bend;                   // Semitones, on top of the part's bend
+  float timbre;                 // 0-1, closes a low-pass below 1
+  float tone[2];                // Low-pass state, left and right
   AdsrEnvelope adsr;
 } Voice;
 
@@ -16,5 +22,8 @@ void voice_init(Voice *v, float samplerate);
 void voice_on(Voice *v, float note, float velocity,
               unsigned long long timestamp);
 void voice_off(Voice *v);
-void voice_render(Voice *v, const Oscillator *osc, const LFO *lfo, const float *osc_gains, float *stereo, int frames);
+// bend shifts the pitch in semitones, on top of the voice's own bend; gain
+// scales the output on top of velocity and envelope
+void voice_render(Voice *v, const Oscillator *osc, const LFO *lfo, const float *osc_gains,
+                  float bend, float gain, float *stereo, int frames);
 int voice_is_active(const Voice *v);
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "wav.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_FLOAT 3
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+static uint32_t read_u32(const unsigned char *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(const unsigned char *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static float decode_sample(const unsigned char *p, int format, int bits) {
+  if (format == WAV_FORMAT_FLOAT) {
+    float f;
+    uint32_t u = read_u32(p);
+    memcpy(&f, &u, sizeof(f));
+    return f;
+  }
+  switch (bits) {
+  case 16:
+    return (float)(int16_t)read_u16(p) / 32768.0f;
+  case 24: {
+    int32_t v = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 |
+                          (uint32_t)p[2] << 24) >> 8;
+    return (float)v / 8388608.0f;
+  }
+  case 32:
+    return (float)(int32_t)read_u32(p) / 2147483648.0f;
+  default:
+    return 0.0f;
+  }
+}
+
+int wav_load(const char *path, WavData *wav) {
+  memset(wav, 0, sizeof(WavData));
+
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return 0;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  if (size < 12) {
+    fclose(f);
+    return 0;
+  }
+  unsigned char *data = malloc((size_t)size);
+  if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+    free(data);
+    fclose(f);
+    return 0;
+  }
+  fclose(f);
+
+  if (memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4)) {
+    free(data);
+    return 0;
+  }
+
+  int format = 0, channels = 0, rate = 0, bits = 0;
+  const unsigned char *pcm = NULL;
+  uint32_t pcm_bytes = 0;
+
+  // Walk chunks; chunks are word aligned
+  long off = 12;
+  while (off + 8 <= size) {
+    const unsigned char *chunk = data + off;
+    uint32_t len = read_u32(chunk + 4);
+    long body = off + 8;
+    if (len > (uint32_t)(size - body))
+      len = (uint32_t)(size - body);
+
+    if (!memcmp(chunk, "fmt ", 4) && len >= 16) {
+      format = read_u16(data + body);
+      channels = read_u16(data + body + 2);
+      rate = (int)read_u32(data + body + 4);
+      bits = read_u16(data + body + 14);
+      if (format == WAV_FORMAT_EXTENSIBLE && len >= 26)
+        format = read_u16(data + body + 24); // First two bytes of the subformat GUID
+    } else if (!memcmp(chunk, "data", 4)) {
+      pcm = data + body;
+      pcm_bytes = len;
+    }
+    off = body + len + (len & 1);
+  }
+
+  int supported = (format == WAV_FORMAT_PCM &&
+                   (bits == 16 || bits == 24 || bits == 32)) ||
+                  (format == WAV_FORMAT_FLOAT && bits == 32);
+  if (!pcm || !supported || channels <= 0 || rate <= 0) {
+    free(data);
+    return 0;
+  }
+
+  int stride = bits / 8;
+  int frames = (int)(pcm_bytes / (uint32_t)(stride * channels));
+  wav->samples = malloc(sizeof(float) * (size_t)frames * channels);
+  if (!wav->samples) {
+    free(data);
+    return 0;
+  }
+  for (int i = 0; i < frames * channels; ++i)
+    wav->samples[i] = decode_sample(pcm + (size_t)i * stride, format, bits);
+
+  wav->frames = frames;
+  wav->channels = channels;
+  wav->sample_rate = rate;
+  free(data);
+  return 1;
+}
+
+void wav_free(WavData *wav) {
+  free(wav->samples);
+  memset(wav, 0, sizeof(WavData));
+}
+
+static void write_u32(unsigned char *p, uint32_t v) {
+  p[0] = (unsigned char)v;
+  p[1] = (unsigned char)(v >> 8);
+  p[2] = (unsigned char)(v >> 16);
+  p[3] = (unsigned char)(v >> 24);
+}
+
+static void write_u16(unsigned char *p, uint16_t v) {
+  p[0] = (unsigned char)v;
+  p[1] = (unsigned char)(v >> 8);
+}
+
+#define WAV_HEADER_SIZE 46            // RIFF, an 18-byte fmt chunk and the data header
+// Largest data chunk whose RIFF size, with header and pad byte, fits 32 bits
+#define WAV_MAX_DATA (UINT32_MAX - (WAV_HEADER_SIZE - 8) - 1)
+
+// Header for 'frames' frames; float files carry the extension size field
+// they need, PCM files the same layout with it zero
+static void wav_header(unsigned char *h, int channels, int sample_rate, int bits,
+                       uint32_t frames) {
+  uint32_t block = (uint32_t)(channels * bits / 8);
+  uint32_t data = frames * block;
+  memcpy(h, "RIFF", 4);
+  write_u32(h + 4, WAV_HEADER_SIZE - 8 + data + (data & 1));
+  memcpy(h + 8, "WAVE", 4);
+  memcpy(h + 12, "fmt ", 4);
+  write_u32(h + 16, 18);
+  write_u16(h + 20, bits == 32 ? WAV_FORMAT_FLOAT : WAV_FORMAT_PCM);
+  write_u16(h + 22, (uint16_t)channels);
+  write_u32(h + 24, (uint32_t)sample_rate);
+  write_u32(h + 28, (uint32_t)sample_rate * block);
+  write_u16(h + 32, (uint16_t)block);
+  write_u16(h + 34, (uint16_t)bits);
+  write_u16(h + 36, 0);
+  memcpy(h + 38, "data", 4);
+  write_u32(h + 42, data);
+}
+
+int wav_write_open(WavWriter *w, const char *path, int channels, int sample_rate, int bits) {
+  memset(w, 0, sizeof(WavWriter));
+  if ((bits != 16 && bits != 24 && bits != 32) || channels <= 0 || sample_rate <= 0)
+    return 0;
+  w->file = fopen(path, "wb");
+  if (!w->file)
+    return 0;
+  w->channels = channels;
+  w->sample_rate = sample_rate;
+  w->bits = bits;
+
+  // Written again with the real sizes on close
+  unsigned char h[WAV_HEADER_SIZE];
+  wav_header(h, channels, sample_rate, bits, 0);
+  if (fwrite(h, 1, sizeof(h), w->file) != sizeof(h)) {
+    fclose(w->file);
+    w->file = NULL;
+    return 0;
+  }
+  return 1;
+}
+
+int wav_write(WavWriter *w, const float *samples, int frames) {
+  unsigned char buf[4096];
+  int stride = w->bits / 8;
+  uint64_t data = ((uint64_t)w->frames + (uint64_t)frames) * (uint64_t)(w->channels * stride);
+  if (frames < 0 || data > WAV_MAX_DATA)
+    return 0; // The sizes in the header could not describe the file
+  int count = frames * w->channels;
+  int per_chunk = (int)sizeof(buf) / stride;
+  for (int i = 0; i < count;) {
+    int n = count - i < per_chunk ? count - i : per_chunk;
+    for (int k = 0; k < n; ++k) {
+      float x = samples[i + k];
+      unsigned char *p = buf + k * stride;
+      if (w->bits == 32) {
+        uint32_t u;
+        memcpy(&u, &x, sizeof(u));
+        write_u32(p, u);
+        continue;
+      }
+      x = x > 1.0f ? 1.0f : (x < -1.0f ? -1.0f : x);
+      if (w->bits == 16) {
+        write_u16(p, (uint16_t)(int16_t)lrintf(x * 32767.0f));
+      } else {
+        int32_t v = (int32_t)lrintf(x * 8388607.0f);
+        p[0] = (unsigned char)v;
+        p[1] = (unsigned char)(v >> 8);
+        p[2] = (unsigned char)(v >> 16);
+      }
+    }
+    if (fwrite(buf, (size_t)stride, (size_t)n, w->file) != (size_t)n)
+      return 0;
+    i += n;
+  }
+  w->frames += (unsigned int)frames;
+  return 1;
+}
+
+int wav_write_close(WavWriter *w) {
+  if (!w->file)
+    return 0;
+  int ok = 1;
+  uint32_t data = w->frames * (uint32_t)(w->channels * w->bits / 8);
+  if (data & 1)
+    ok = fputc(0, w->file) != EOF; // Chunks are word aligned
+
+  // Patch the sizes now that the length is known
+  unsigned char h[WAV_HEADER_SIZE];
+  wav_header(h, w->channels, w->sample_rate, w->bits, w->frames);
+  if (ok)
+    ok = fseek(w->file, 0, SEEK_SET) == 0 && fwrite(h, 1, sizeof(h), w->file) == sizeof(h);
+  if (fclose(w->file) != 0)
+    ok = 0;
+  memset(w, 0, sizeof(WavWriter));
+  return ok;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <stdio.h>
+
+// Minimal RIFF/WAVE reader: 16/24/32-bit PCM and 32-bit float,
+// any channel count, returned as interleaved float samples
+typedef struct {
+  float *samples;     // Interleaved, frames * channels
+  int frames;
+  int channels;
+  int sample_rate;
+} WavData;
+
+// Streaming writer for offline renders: 16 or 24-bit PCM, or 32-bit
+// float. The sizes in the header are filled in on close.
+typedef struct {
+  FILE *file;
+  int channels;
+  int sample_rate;
+  int bits;                     // 32 writes float
+  unsigned int frames;
+} WavWriter;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns 1 on success, 0 on failure (wav is left zeroed)
+int wav_load(const char *path, WavData *wav);
+void wav_free(WavData *wav);
+
+// Returns 1 on success, 0 when the file cannot be created or bits is not
+// 16, 24 or 32
+int wav_write_open(WavWriter *w, const char *path, int channels, int sample_rate, int bits);
+// Interleaved samples, clipped to -1..1 for PCM. Returns 0 on a write error
+// or when the data would pass the 4 GiB a WAV header can describe; nothing
+// of that block is written then, and the file can still be closed.
+int wav_write(WavWriter *w, const float *samples, int frames);
+// Returns 0 when the file could not be finished
+int wav_write_close(WavWriter *w);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,89 @@
+#include "worker_pool.h"
+#include <string.h>
+
+static void worker_pool_drain(WorkerPool *pool) {
+  int i;
+  while ((i = platform_atomic_add(&pool->next, 1)) < pool->job_count)
+    pool->job(pool->ctx, i);
+}
+
+static int worker_thread(void *data) {
+  WorkerPool *pool = (WorkerPool *)data;
+  // Workers stand in for the audio thread, so they get its priority
+  platform_thread_set_realtime();
+  for (;;) {
+    platform_sem_wait(pool->start);
+    if (platform_atomic_get(&pool->quit))
+      break;
+    worker_pool_drain(pool);
+    platform_sem_post(pool->done);
+  }
+  return 0;
+}
+
+int worker_pool_init(WorkerPool *pool, int threads) {
+  memset(pool, 0, sizeof(WorkerPool));
+#ifdef __EMSCRIPTEN__
+  (void)threads;
+  return 1; // No threads in the browser build
+#else
+  if (threads < 0)
+    threads = platform_cpu_count() - 1;
+  if (threads > WORKER_MAX_THREADS)
+    threads = WORKER_MAX_THREADS;
+  if (threads <= 0)
+    return 1;
+
+  pool->start = platform_sem_create(0);
+  pool->done = platform_sem_create(0);
+  if (!pool->start || !pool->done) {
+    platform_log("Worker pool: semaphores failed");
+    worker_pool_shutdown(pool);
+    return 0;
+  }
+  for (int i = 0; i < threads; ++i) {
+    pool->threads[i] = platform_thread_create(worker_thread, "synth-worker", pool);
+    if (!pool->threads[i]) {
+      platform_log("Worker pool: thread %d failed", i);
+      break;
+    }
+    pool->thread_count++;
+  }
+  return pool->thread_count == threads;
+#endif
+}
+
+void worker_pool_run(WorkerPool *pool, WorkerJob job, void *ctx, int count) {
+  if (pool->thread_count == 0 || count <= 1) {
+    for (int i = 0; i < count; ++i)
+      job(ctx, i);
+    return;
+  }
+
+  pool->job = job;
+  pool->ctx = ctx;
+  pool->job_count = count;
+  platform_atomic_set(&pool->next, 0);
+
+  // No point waking more threads than there are jobs left for them
+  int wake = count - 1 < pool->thread_count ? count - 1 : pool->thread_count;
+  for (int i = 0; i < wake; ++i)
+    platform_sem_post(pool->start);
+  worker_pool_drain(pool);
+  for (int i = 0; i < wake; ++i)
+    platform_sem_wait(pool->done);
+}
+
+void worker_pool_shutdown(WorkerPool *pool) {
+  platform_atomic_set(&pool->quit, 1);
+  for (int i = 0; i < pool->thread_count; ++i)
+    platform_sem_post(pool->start);
+  for (int i = 0; i < pool->thread_count; ++i)
+    platform_thread_join(pool->threads[i]);
+  pool->thread_count = 0;
+  if (pool->start)
+    platform_sem_destroy(pool->start);
+  if (pool->done)
+    platform_sem_destroy(pool->done);
+  pool->start = pool->done = NULL;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "platform.h"
+
+// Small fork-join pool for the audio callback. worker_pool_run() hands out
+// job indices through an atomic counter; the calling thread takes jobs too
+// and returns once every job has finished. The threads sleep on a
+// semaphore between runs, so an idle pool costs nothing.
+#define WORKER_MAX_THREADS 8
+
+typedef void (*WorkerJob)(void *ctx, int index);
+
+typedef struct {
+  PlatformThread *threads[WORKER_MAX_THREADS];
+  int thread_count;
+  PlatformSem *start;           // One post per thread per run
+  PlatformSem *done;            // One post per thread when it runs dry
+  PlatformAtomic next;          // Next job index to claim
+  PlatformAtomic quit;
+
+  // Current run, written before the start posts
+  WorkerJob job;
+  void *ctx;
+  int job_count;
+} WorkerPool;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// threads < 0 picks one per extra CPU core. Returns 1 on success; on
+// failure the pool runs every job on the calling thread.
+int worker_pool_init(WorkerPool *pool, int threads);
+void worker_pool_run(WorkerPool *pool, WorkerJob job, void *ctx, int count);
+void worker_pool_shutdown(WorkerPool *pool);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+#include <stdio.h>
+
+// Minimal assertions: a failed check reports its line and the test carries
+// on, so one run lists every failure. main() returns check_result().
+static int check_failures;
+
+#define CHECK(cond)                                                          \
+  do {                                                                       \
+    if (!(cond)) {                                                           \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      check_failures++;                                                      \
+    }                                                                        \
+  } while (0)
+
+// Also prints both values, for measurements
+#define CHECK_NEAR(actual, expected, tolerance)                              \
+  do {                                                                       \
+    double check_a = (actual), check_e = (expected);                         \
+    if (!(check_a >= check_e - (tolerance) && check_a <= check_e + (tolerance))) { \
+      fprintf(stderr, "%s:%d: check failed: %s = %g, expected %g\n", __FILE__, \
+              __LINE__, #actual, check_a, check_e);                          \
+      check_failures++;                                                      \
+    }                                                                        \
+  } while (0)
+
+static inline int check_result(void) {
+  if (check_failures)
+    fprintf(stderr, "%d check(s) failed\n", check_failures);
+  return check_failures ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+// The true-peak limiter and the hard clip are the last stage of the output:
+// nothing the effects add after the bus, like a resonant filter or a delay
+// close to self-oscillation, may pass the ceiling.
+#include "check.h"
+#include "synth.h"
+#include "true_peak.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE 48000
+#define BLOCK 512
+
+// Loud, resonant and fed back: well over 0 dBFS before the limiter
+static void start(Synth *synth, float limiter) {
+  memset(synth, 0, sizeof(Synth));
+  synth_init(synth, RATE, BLOCK, 16);
+  synth_seed(synth, 1);
+  synth_set_param(synth, "mixer.limiter.enabled", limiter);
+  synth_set_param(synth, "mixer.limiter.ceiling", -1.0f);
+  synth_set_param(synth, "arp.enabled", 0.0f);
+  synth_set_param(synth, "mixer.master", 1.0f);
+  synth_set_param(synth, "fx.filter.enabled", 1.0f);
+  synth_set_param(synth, "fx.filter.cutoff", 800.0f);
+  synth_set_param(synth, "fx.filter.resonance", 0.95f);
+  synth_set_param(synth, "fx.filter.drive", 4.0f);
+  synth_set_param(synth, "fx.filter.mix", 1.0f);
+  synth_set_param(synth, "fx.delay.time", 0.05f);
+  synth_set_param(synth, "fx.delay.feedback", 0.9f);
+  synth_set_param(synth, "fx.delay.mix", 1.0f);
+  synth_set_param(synth, "fx.reverb.mix", 0.6f);
+  for (int note = 48; note <= 72; note += 4)
+    synth_note_on(synth, note, 1.0f);
+}
+
+// Sample and true peak of a few seconds of output, in dBFS
+static void measure(Synth *synth, float *sample_peak_db, float *true_peak_db) {
+  static float out[BLOCK * 2];
+  TruePeak tp;
+  true_peak_init(&tp);
+  float sample_peak = 0.0f, true_peak = 0.0f;
+  for (int b = 0; b < 3 * RATE / BLOCK; ++b) {
+    synth_render(synth, out, BLOCK);
+    for (int n = 0; n < BLOCK; ++n) {
+      sample_peak = fmaxf(sample_peak, fmaxf(fabsf(out[n * 2]), fabsf(out[n * 2 + 1])));
+      true_peak = fmaxf(true_peak, true_peak_push(&tp, out[n * 2], out[n * 2 + 1], 0.0f));
+    }
+  }
+  *sample_peak_db = 20.0f * log10f(fmaxf(sample_peak, 1e-9f));
+  *true_peak_db = 20.0f * log10f(fmaxf(true_peak, 1e-9f));
+}
+
+int main(void) {
+  Synth *synth = malloc(sizeof(Synth));
+  float sample_peak, true_peak;
+
+  start(synth, 1.0f);
+  measure(synth, &sample_peak, &true_peak);
+  CHECK(sample_peak <= -1.0f + 0.05f);
+  CHECK(true_peak <= -1.0f + 0.1f);
+  CHECK(true_peak > -6.0f); // The limiter was really working
+  synth_shutdown(synth);
+
+  // Without the limiter the clip still holds the output to 0 dBFS
+  start(synth, 0.0f);
+  measure(synth, &sample_peak, &true_peak);
+  CHECK(sample_peak <= 0.0f);
+  CHECK(sample_peak > -1.0f);
+  synth_shutdown(synth);
+
+  free(synth);
+  return check_result();
+}
@@ -0,0 +1,181 @@
+// MIDI clock: the delay-locked loop turns a jittery clock into a steady
+// tempo, start/stop/song position move the transport, and clock out starts
+// with start at the top and with song position and continue elsewhere
+#include "check.h"
+#include "midi_clock.h"
+#include <math.h>
+#include <string.h>
+
+#define RATE 48000
+#define BLOCK 256
+#define BPM 133.0
+
+// Simulated time: clocks arrive between audio blocks with +-1 ms of jitter
+typedef struct {
+  MidiClock clock;
+  Transport transport;
+  double now, next_clock;
+  long long clocks;
+  unsigned int rng;
+  int moved;
+} Sim;
+
+static uint64_t ticks(double seconds) {
+  return (uint64_t)(seconds * (double)platform_ticks_per_second());
+}
+
+static double jitter(Sim *sim) {
+  sim->rng = sim->rng * 1664525u + 1013904223u;
+  return ((sim->rng >> 8) / 16777216.0 - 0.5) * 0.002;
+}
+
+static void receive(Sim *sim, unsigned char b0, unsigned char b1, unsigned char b2, int len) {
+  unsigned char msg[3] = {b0, b1, b2};
+  CHECK(midi_clock_receive(&sim->clock, msg, len, ticks(sim->next_clock - 0.0001)) == 1);
+}
+
+static void sim_init(Sim *sim) {
+  memset(sim, 0, sizeof(Sim));
+  midi_clock_init(&sim->clock);
+  transport_init(&sim->transport, RATE);
+  sim->now = sim->next_clock = 1.0;
+  sim->rng = 1;
+}
+
+// Run for 'beats' of the incoming clock, following it block by block
+static void run(Sim *sim, double beats, int send_clocks) {
+  double period = 60.0 / (BPM * MIDI_CLOCK_PPQN);
+  double end = sim->next_clock + beats * 60.0 / BPM;
+  while (sim->now < end) {
+    double block_end = sim->now + (double)BLOCK / RATE;
+    for (; send_clocks && sim->next_clock < block_end; sim->next_clock += period, sim->clocks++)
+      midi_clock_receive(&sim->clock, (const unsigned char[]){0xF8}, 1,
+                         ticks(sim->next_clock + jitter(sim)));
+    if (!send_clocks)
+      sim->next_clock = block_end;
+    sim->now = block_end;
+    if (midi_clock_follow(&sim->clock, &sim->transport, ticks(sim->now)) == MIDI_CLOCK_MOVED)
+      sim->moved++;
+    transport_advance(&sim->transport, BLOCK);
+  }
+}
+
+// Where the sender is, in beats, at the end of the last block
+static double sender_beat(const Sim *sim, long long start_clock, double start_beat) {
+  double period = 60.0 / (BPM * MIDI_CLOCK_PPQN);
+  double last = sim->next_clock - period; // Time of the last clock sent
+  return start_beat + (sim->clocks - 1 - start_clock) / (double)MIDI_CLOCK_PPQN +
+         (sim->now - last) / (period * MIDI_CLOCK_PPQN);
+}
+
+static void test_follow(void) {
+  static Sim sim;
+  sim_init(&sim);
+
+  // Tempo only: locks within a few beats, then holds steady through jitter
+  run(&sim, 8.0, 1);
+  CHECK_NEAR(sim.transport.bpm, BPM, 1.0);
+  float low = 1000.0f, high = 0.0f;
+  for (int i = 0; i < 64; ++i) {
+    run(&sim, 0.25, 1);
+    low = fminf(low, sim.transport.bpm);
+    high = fmaxf(high, sim.transport.bpm);
+  }
+  CHECK_NEAR(low, BPM, 0.25);
+  CHECK_NEAR(high, BPM, 0.25);
+
+  // Start: from the top, then within a small fraction of a beat of the sender
+  receive(&sim, 0xFA, 0, 0, 1);
+  long long start = sim.clocks;
+  run(&sim, 16.0, 1);
+  CHECK(sim.transport.running);
+  CHECK(sim.moved >= 1);
+  CHECK_NEAR(sim.transport.beat, sender_beat(&sim, start, 0.0), 0.05);
+
+  // Stop holds the position
+  receive(&sim, 0xFC, 0, 0, 1);
+  run(&sim, 2.0, 1);
+  CHECK(!sim.transport.running);
+  double held = sim.transport.beat;
+  run(&sim, 2.0, 1);
+  CHECK(sim.transport.beat == held);
+
+  // Song position to bar 9 (sixteenth 128), then continue from there
+  receive(&sim, 0xF2, 128 & 0x7F, 128 >> 7, 3);
+  receive(&sim, 0xFB, 0, 0, 1);
+  start = sim.clocks;
+  run(&sim, 8.0, 1);
+  CHECK(sim.transport.running);
+  CHECK_NEAR(sim.transport.beat, sender_beat(&sim, start, 32.0), 0.05);
+
+  // The clock stops arriving: free-run at the last tempo
+  run(&sim, 4.0, 0);
+  CHECK(!sim.clock.following);
+  CHECK(sim.transport.running);
+  CHECK_NEAR(sim.transport.bpm, BPM, 0.25);
+
+  // Stopped when the clock goes away: stays stopped
+  run(&sim, 8.0, 1);
+  CHECK(sim.clock.following);
+  receive(&sim, 0xFC, 0, 0, 1);
+  run(&sim, 1.0, 1);
+  run(&sim, 4.0, 0);
+  CHECK(!sim.clock.following);
+  CHECK(!sim.transport.running);
+}
+
+// Messages clock out queues while the transport plays from 'beat'
+static int emit(unsigned char out[][3], int max, double beat) {
+  static MidiClock clock;
+  Transport t;
+  midi_clock_init(&clock);
+  clock.send = 1;
+  transport_init(&t, RATE);
+  transport_set_bpm(&t, 120.0f);
+  transport_locate(&t, beat);
+
+  int count = 0;
+  uint64_t now = 0;
+  unsigned char msg[3];
+  for (int b = 0; b < 8 * 24000 / BLOCK; ++b) {
+    midi_clock_emit(&clock, &t, BLOCK, now);
+    int len;
+    while (count < max && (len = midi_clock_pop_out(&clock, UINT64_MAX, msg)) > 0) {
+      memset(out[count], 0, 3);
+      memcpy(out[count], msg, (size_t)len);
+      count++;
+    }
+    transport_advance(&t, BLOCK);
+    now += ticks((double)BLOCK / RATE);
+  }
+  return count;
+}
+
+static void test_send(void) {
+  unsigned char out[1024][3];
+
+  // From the top: start, then clocks
+  int count = emit(out, 1024, 0.0);
+  CHECK(count > 2);
+  CHECK(out[0][0] == 0xFA);
+  CHECK(out[1][0] == 0xF8);
+
+  // Mid-bar: nothing until the next bar line (beat 8, sixteenth 32), then
+  // song position and continue rather than start
+  count = emit(out, 1024, 6.5);
+  CHECK(count > 3);
+  CHECK(out[0][0] == 0xF2);
+  CHECK(((out[0][2] << 7) | out[0][1]) == 32);
+  CHECK(out[1][0] == 0xFB);
+  CHECK(out[2][0] == 0xF8);
+  int starts = 0;
+  for (int i = 0; i < count; ++i)
+    starts += out[i][0] == 0xFA;
+  CHECK(starts == 0);
+}
+
+int main(void) {
+  test_follow();
+  test_send();
+  return check_result();
+}
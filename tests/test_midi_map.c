@@ -0,0 +1,89 @@
+// CC routing: 14-bit MSB/LSB pairs, several targets on one controller and
+// per-channel mappings, checked on the fields the registry setters write
+#include "check.h"
+#include "synth.h"
+#include <string.h>
+
+#define RATE 48000
+#define BLOCK 512
+
+static void test_14bit(Synth *synth) {
+  MidiMap *map = &synth->midi_map;
+  midi_map_clear(map);
+  // Scaled so the value is the raw 14-bit number
+  CHECK(midi_map_add(map, 0, 1, "fx.filter.cutoff", 0.0f, 16383.0f, 1));
+  CHECK(map->cc[0][1].mode == MIDI_CC_14BIT_MSB);
+  CHECK(map->cc[0][33].mode == MIDI_CC_14BIT_LSB);
+
+  // The MSB alone counts as the pair with LSB 0; the LSB refines it
+  midi_map_dispatch(map, synth, 0, 1, 64);
+  CHECK_NEAR(synth->fx.filter_cutoff, 64 * 128, 0.01);
+  midi_map_dispatch(map, synth, 0, 33, 5);
+  CHECK_NEAR(synth->fx.filter_cutoff, 64 * 128 + 5, 0.01);
+  midi_map_dispatch(map, synth, 0, 33, 127);
+  CHECK_NEAR(synth->fx.filter_cutoff, 64 * 128 + 127, 0.01);
+  midi_map_dispatch(map, synth, 0, 1, 127);
+  midi_map_dispatch(map, synth, 0, 33, 127);
+  CHECK_NEAR(synth->fx.filter_cutoff, 16383.0, 0.01);
+
+  // Each channel pairs its LSB with its own MSB
+  midi_map_dispatch(map, synth, 0, 1, 10);
+  midi_map_dispatch(map, synth, 1, 1, 20);
+  midi_map_dispatch(map, synth, 0, 33, 1);
+  CHECK_NEAR(synth->fx.filter_cutoff, 10 * 128 + 1, 0.01);
+
+  // The LSB controller takes no targets of its own; CCs from 32 up cannot
+  // lead a pair and fall back to 7 bits
+  CHECK(!midi_map_add(map, 0, 33, "fx.delay.mix", 0.0f, 1.0f, 0));
+  CHECK(midi_map_add(map, 0, 40, "fx.chorus.rate", 0.0f, 127.0f, 1));
+  CHECK(map->cc[0][40].mode == MIDI_CC_7BIT);
+  midi_map_dispatch(map, synth, 0, 40, 100);
+  CHECK_NEAR(synth->fx.chorus_rate, 100.0, 1e-3);
+}
+
+static void test_targets(Synth *synth) {
+  MidiMap *map = &synth->midi_map;
+  midi_map_clear(map);
+
+  // One controller, several parameters, each with its own range
+  CHECK(midi_map_add(map, 0, 20, "fx.delay.mix", 0.0f, 1.0f, 0));
+  CHECK(midi_map_add(map, 0, 20, "fx.reverb.mix", 1.0f, 0.0f, 0)); // Inverted
+  CHECK(midi_map_add(map, 0, 20, "mixer.master", 0.5f, 2.0f, 0));
+  CHECK(midi_map_add(map, 0, 20, "fx.chorus.mix", 0.25f, 0.75f, 0));
+  CHECK(!midi_map_add(map, 0, 20, "fx.flanger.depth", 0.0f, 1.0f, 0)); // Full
+  CHECK(map->cc[5][20].count == MIDI_MAP_MAX_TARGETS);
+
+  midi_map_dispatch(map, synth, 0, 20, 127);
+  CHECK_NEAR(synth->fx.delay_mix, 1.0, 1e-6);
+  CHECK_NEAR(synth->fx.reverb_mix, 0.0, 1e-6);
+  CHECK_NEAR(synth->mixer.master, 2.0, 1e-6);
+  CHECK_NEAR(synth->fx.chorus_mix, 0.75, 1e-6);
+  midi_map_dispatch(map, synth, 0, 20, 0);
+  CHECK_NEAR(synth->fx.delay_mix, 0.0, 1e-6);
+  CHECK_NEAR(synth->fx.reverb_mix, 1.0, 1e-6);
+  CHECK_NEAR(synth->mixer.master, 0.5, 1e-6);
+  CHECK_NEAR(synth->fx.chorus_mix, 0.25, 1e-6);
+
+  // A mapping for channel 3 only
+  CHECK(midi_map_add(map, 3, 21, "fx.flanger.rate", 0.0f, 10.0f, 0));
+  synth->fx.flanger_rate = 1.0f;
+  midi_map_dispatch(map, synth, 0, 21, 127);
+  CHECK_NEAR(synth->fx.flanger_rate, 1.0, 1e-6);
+  midi_map_dispatch(map, synth, 2, 21, 127);
+  CHECK_NEAR(synth->fx.flanger_rate, 10.0, 1e-6);
+
+  // Unknown names and out of range controllers are refused
+  CHECK(!midi_map_add(map, 0, 22, "fx.no.such.param", 0.0f, 1.0f, 0));
+  CHECK(!midi_map_add(map, 0, 128, "fx.delay.mix", 0.0f, 1.0f, 0));
+  CHECK(!midi_map_add(map, 17, 22, "fx.delay.mix", 0.0f, 1.0f, 0));
+}
+
+int main(void) {
+  static Synth synth;
+  memset(&synth, 0, sizeof(Synth));
+  synth_init(&synth, RATE, BLOCK, 16);
+  test_14bit(&synth);
+  test_targets(&synth);
+  synth_shutdown(&synth);
+  return check_result();
+}
@@ -0,0 +1,123 @@
+// The MIDI queue: message parsing and counters, overflow, and several
+// producer threads against the consumer without loss or reordering
+#include "check.h"
+#include "midi_queue.h"
+#include <string.h>
+
+#define PRODUCERS 4
+#define PER_PRODUCER 16000      // Fits the 14 bits of two data bytes
+
+static MidiQueue queue;
+static PlatformAtomic go;
+
+static int push(const unsigned char *msg, int len) {
+  return midi_queue_push_message(&queue, msg, len);
+}
+
+// Producer n sends CC messages on channel n counting 0, 1, 2...; a full
+// queue is retried, so each count is queued exactly once
+static int producer(void *data) {
+  int channel = (int)(size_t)data;
+  while (!platform_atomic_get(&go))
+    ;
+  for (int k = 0; k < PER_PRODUCER; ++k) {
+    unsigned char msg[3] = {(unsigned char)(0xB0 | channel), (unsigned char)(k >> 7),
+                            (unsigned char)(k & 0x7F)};
+    while (!push(msg, 3))
+      platform_sleep_ms(0);
+  }
+  return 0;
+}
+
+static void test_parsing(void) {
+  MidiEvent e;
+  midi_queue_init(&queue);
+  const unsigned char note_on[] = {0x93, 60, 100};
+  const unsigned char program[] = {0xC5, 7};
+  const unsigned char sysex[] = {0xF0, 0x7E, 0xF7};
+  const unsigned char clock[] = {0xF8};
+  const unsigned char truncated[] = {0x90, 60};
+  const unsigned char stray[] = {60, 100};
+  const unsigned char bad_data[] = {0xB0, 7, 0x80};
+  CHECK(push(note_on, 3) == 1);
+  CHECK(push(program, 2) == 1);
+  CHECK(push(sysex, 3) == 0);
+  CHECK(push(clock, 1) == 0);
+  CHECK(push(truncated, 2) == 0);
+  CHECK(push(stray, 2) == 0);
+  CHECK(push(bad_data, 3) == 0);
+  CHECK(platform_atomic_get(&queue.received) == 2);
+  CHECK(platform_atomic_get(&queue.ignored) == 1); // Real-time bytes are not counted
+  CHECK(platform_atomic_get(&queue.malformed) == 3);
+
+  CHECK(midi_queue_pop(&queue, &e) == 1);
+  CHECK(e.status == 0x93 && e.data1 == 60 && e.data2 == 100);
+  CHECK(midi_queue_pop(&queue, &e) == 1);
+  CHECK(e.status == 0xC5 && e.data1 == 7 && e.data2 == 0);
+  CHECK(midi_queue_pop(&queue, &e) == 0);
+}
+
+static void test_overflow(void) {
+  MidiEvent e;
+  midi_queue_init(&queue);
+  for (int i = 0; i < MIDI_QUEUE_SIZE + 10; ++i) {
+    unsigned char msg[3] = {0x90, (unsigned char)(i & 0x7F), 1};
+    push(msg, 3);
+  }
+  CHECK(platform_atomic_get(&queue.received) == MIDI_QUEUE_SIZE);
+  CHECK(platform_atomic_get(&queue.dropped) == 10);
+
+  // The oldest messages are kept, in order, and the queue is usable after
+  int popped = 0, ordered = 1;
+  while (midi_queue_pop(&queue, &e))
+    ordered &= e.data1 == (popped++ & 0x7F);
+  CHECK(popped == MIDI_QUEUE_SIZE);
+  CHECK(ordered);
+  const unsigned char note_off[] = {0x80, 1, 0};
+  CHECK(push(note_off, 3) == 1);
+  CHECK(midi_queue_pop(&queue, &e) == 1 && e.status == 0x80);
+}
+
+static void test_producers(void) {
+  PlatformThread *threads[PRODUCERS];
+  int next[PRODUCERS] = {0};
+  int popped = 0, ordered = 1;
+  MidiEvent e;
+
+  midi_queue_init(&queue);
+  platform_atomic_set(&go, 0);
+  for (int i = 0; i < PRODUCERS; ++i) {
+    threads[i] = platform_thread_create(producer, "producer", (void *)(size_t)i);
+    CHECK(threads[i] != NULL);
+    if (!threads[i])
+      return;
+  }
+  platform_atomic_set(&go, 1);
+
+  while (popped < PRODUCERS * PER_PRODUCER) {
+    if (!midi_queue_pop(&queue, &e))
+      continue;
+    int channel = e.status & 0x0F;
+    int k = (e.data1 << 7) | e.data2;
+    if ((e.status & 0xF0) != 0xB0 || channel >= PRODUCERS || k != next[channel]) {
+      ordered = 0;
+      break;
+    }
+    next[channel]++;
+    popped++;
+  }
+  for (int i = 0; i < PRODUCERS; ++i)
+    platform_thread_join(threads[i]);
+
+  CHECK(ordered);
+  CHECK(popped == PRODUCERS * PER_PRODUCER);
+  CHECK(platform_atomic_get(&queue.received) == PRODUCERS * PER_PRODUCER);
+  CHECK(midi_queue_pop(&queue, &e) == 0);
+}
+
+int main(void) {
+  test_parsing();
+  test_overflow();
+  test_producers();
+  return check_result();
+}
@@ -0,0 +1,65 @@
+// Multi-tap delay: the tap count selects how many of the MAX_DELAY_TAPS
+// taps sound, each at its beat offset and level
+#include "check.h"
+#include "synth.h"
+#include <math.h>
+#include <string.h>
+
+#define RATE 48000
+#define BLOCK 256
+#define SECONDS 3
+
+static float out[RATE * SECONDS * 2];
+
+// Impulse response of the delay at 120 BPM, left channel into 'out'
+static void impulse_response(FX *fx) {
+  memset(out, 0, sizeof(out));
+  out[0] = out[1] = 1.0f;
+  for (int start = 0; start < RATE * SECONDS; start += BLOCK)
+    fx_process(fx, out + start * 2, BLOCK);
+}
+
+// Only the multi-tap delay, set up through the param registry
+static void setup(Synth *synth, float taps) {
+  memset(synth, 0, sizeof(Synth));
+  synth_init(synth, RATE, BLOCK, 16);
+  synth_set_param(synth, "fx.reverb.mix", 0.0f);
+  synth_set_param(synth, "fx.multitap.enabled", 1.0f);
+  synth_set_param(synth, "fx.delay.mix", 1.0f);
+  synth_set_param(synth, "fx.multitap.taps", taps);
+  synth_set_param(synth, "fx.multitap.tap7", 2.5f);        // 60000 frames
+  synth_set_param(synth, "fx.multitap.tap7_level", 0.5f);
+}
+
+int main(void) {
+  static Synth synth;
+  FX *fx = &synth.fx;
+
+  // Default four taps: quarter, dotted eighth, eighth, triplet
+  setup(&synth, 4.0f);
+  CHECK(fx->num_taps == 4);
+  impulse_response(fx);
+  CHECK_NEAR(out[24000 * 2], 0.7, 1e-4);
+  CHECK_NEAR(out[18000 * 2], 0.5, 1e-4);
+  CHECK_NEAR(out[12000 * 2], 0.4, 1e-4);
+  CHECK(fabsf(out[60000 * 2]) < 1e-6f); // Tap 8 is off
+  synth_shutdown(&synth);
+
+  // All eight: the last tap sounds too
+  setup(&synth, 8.0f);
+  CHECK(fx->num_taps == MAX_DELAY_TAPS);
+  impulse_response(fx);
+  CHECK_NEAR(out[24000 * 2], 0.7, 1e-4);
+  CHECK_NEAR(out[60000 * 2], 0.5, 1e-4);
+  synth_shutdown(&synth);
+
+  // Out of range counts are clamped
+  setup(&synth, 0.0f);
+  CHECK(fx->num_taps == 1);
+  synth_shutdown(&synth);
+  setup(&synth, 99.0f);
+  CHECK(fx->num_taps == MAX_DELAY_TAPS);
+  synth_shutdown(&synth);
+
+  return check_result();
+}
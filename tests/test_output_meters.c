@@ -0,0 +1,61 @@
+// The loudness, true-peak, peak and RMS meters the GUI shows must read the
+// signal that actually goes out, after the effects and the limiter
+#include "check.h"
+#include "loudness.h"
+#include "snapshot.h"
+#include "synth.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE 48000
+#define BLOCK 512
+
+int main(void) {
+  static float out[BLOCK * 2];
+  Synth *synth = malloc(sizeof(Synth));
+  memset(synth, 0, sizeof(Synth));
+  synth_init(synth, RATE, BLOCK, 16);
+  synth_seed(synth, 1);
+  synth_set_param(synth, "arp.enabled", 0.0f);
+  synth_set_param(synth, "mixer.master", 1.0f);
+  synth_set_param(synth, "mixer.limiter.enabled", 1.0f);
+  synth_set_param(synth, "mixer.limiter.ceiling", -1.0f);
+  synth_set_param(synth, "fx.delay.feedback", 0.9f);
+  synth_set_param(synth, "fx.delay.mix", 1.0f);
+  synth_set_param(synth, "fx.reverb.mix", 0.6f);
+  for (int note = 48; note <= 72; note += 4)
+    synth_note_on(synth, note, 1.0f);
+
+  // A second meter on the output buffer itself
+  LoudnessMeter reference;
+  loudness_init(&reference, RATE);
+  float peak = 0.0f, sum = 0.0f;
+  for (int b = 0; b < 4 * RATE / BLOCK; ++b) {
+    synth_render(synth, out, BLOCK);
+    loudness_process(&reference, out, BLOCK);
+    peak = 0.0f;
+    sum = 0.0f;
+    for (int n = 0; n < BLOCK * 2; ++n) {
+      peak = fmaxf(peak, fabsf(out[n]));
+      sum += out[n] * out[n];
+    }
+  }
+
+  const SynthSnapshot *snap = snapshot_read(&synth->snapshot);
+  CHECK(snap != NULL);
+  if (snap) {
+    CHECK_NEAR(snap->true_peak, reference.true_peak, 0.01);
+    CHECK(snap->true_peak <= -1.0f + 0.1f);
+    CHECK_NEAR(snap->lufs_integrated, reference.integrated, 0.01);
+    CHECK_NEAR(snap->lufs_short_term, reference.short_term, 0.01);
+    CHECK_NEAR(snap->lufs_momentary, reference.momentary, 0.01);
+    CHECK_NEAR(snap->peak_level, 20.0f * log10f(peak), 0.01);
+    // Both channels measured together here, so the louder one bounds it
+    CHECK(snap->rms_level >= 10.0f * log10f(sum / BLOCK / 2) - 0.01f);
+  }
+
+  synth_shutdown(synth);
+  free(synth);
+  return check_result();
+}
@@ -0,0 +1,188 @@
+// Standard MIDI File parsing: tracks merged in order, running status, the
+// tempo map applied to every event, and damaged data
+#include "check.h"
+#include "smf.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE 48000.0f
+
+// Format 1, 480 ticks per quarter note. The tempo track plays 120 BPM,
+// then 240 BPM from beat 2. The note track starts a note at 0, ends it
+// at beat 1 with running status (velocity 0), has a controller at beat 2
+// and plays a second note from beat 4 to beat 5.
+static const unsigned char song[] = {
+  'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0x01, 0xE0,
+  'M', 'T', 'r', 'k', 0, 0, 0, 19,
+  0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,       // 500000 us per quarter
+  0x87, 0x40, 0xFF, 0x51, 0x03, 0x03, 0xD0, 0x90, // +960: 250000 us
+  0x00, 0xFF, 0x2F, 0x00,
+  'M', 'T', 'r', 'k', 0, 0, 0, 26,
+  0x00, 0x90, 60, 100,
+  0x83, 0x60, 60, 0,                              // +480, running status
+  0x83, 0x60, 0xB0, 7, 90,                        // +480: CC 7 at beat 2
+  0x87, 0x40, 0x91, 64, 80,                       // +960: beat 4, channel 2
+  0x83, 0x60, 0x81, 64, 0,                        // +480: beat 5
+  0x00, 0xFF, 0x2F, 0x00,
+};
+
+static void test_tempo_map(void) {
+  Smf smf;
+  CHECK(smf_parse(song, sizeof(song), RATE, &smf) == 1);
+  CHECK(smf.format == 1);
+  CHECK(smf.tracks == 2);
+  CHECK(smf.tempo_count == 2);
+  CHECK(smf.count == 7);
+  if (smf.count != 7) {
+    smf_free(&smf);
+    return;
+  }
+
+  // 24000 frames per beat up to beat 2, 12000 after
+  CHECK_NEAR(smf_frame_at_beat(&smf, 1.0), 24000.0, 1e-6);
+  CHECK_NEAR(smf_frame_at_beat(&smf, 2.0), 48000.0, 1e-6);
+  CHECK_NEAR(smf_frame_at_beat(&smf, 4.0), 72000.0, 1e-6);
+  CHECK_NEAR(smf_beat_at_frame(&smf, 60000.0), 3.0, 1e-9);
+  for (double beat = 0.0; beat < 6.0; beat += 0.37)
+    CHECK_NEAR(smf_beat_at_frame(&smf, smf_frame_at_beat(&smf, beat)), beat, 1e-9);
+  CHECK_NEAR(smf.beats, 5.0, 1e-9);
+  CHECK(smf.length == 84000);
+
+  // Merged by frame; at beat 2 the tempo change comes before the controller
+  const SmfEvent *e = smf.events;
+  CHECK(e[0].status == SMF_TEMPO && e[0].frame == 0);
+  CHECK_NEAR(e[0].bpm, 120.0, 1e-3);
+  CHECK(e[1].status == 0x90 && e[1].data1 == 60 && e[1].data2 == 100 && e[1].frame == 0);
+  CHECK(e[2].status == 0x90 && e[2].data2 == 0 && e[2].frame == 24000);
+  CHECK(e[3].status == SMF_TEMPO && e[3].frame == 48000);
+  CHECK_NEAR(e[3].bpm, 240.0, 1e-3);
+  CHECK(e[4].status == 0xB0 && e[4].data1 == 7 && e[4].data2 == 90 && e[4].frame == 48000);
+  CHECK(e[5].status == 0x91 && e[5].data1 == 64 && e[5].frame == 72000);
+  CHECK(e[6].status == 0x81 && e[6].frame == 84000);
+
+  CHECK(smf_find(&smf, 0) == 0);
+  CHECK(smf_find(&smf, 1) == 2);
+  CHECK(smf_find(&smf, 48000) == 3);
+  CHECK(smf_find(&smf, 90000) == smf.count);
+  smf_free(&smf);
+}
+
+// A note off and a note on at the same tick in different tracks: the
+// note off goes first, so the restarted note is not cut off
+static void test_same_tick_order(void) {
+  static const unsigned char data[] = {
+    'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0, 96,
+    'M', 'T', 'r', 'k', 0, 0, 0, 8,
+    0x60, 0x90, 60, 100, 0x00, 0xFF, 0x2F, 0x00,          // On at 96
+    'M', 'T', 'r', 'k', 0, 0, 0, 12,
+    0x00, 0x90, 60, 100, 0x60, 0x80, 60, 0, 0x00, 0xFF, 0x2F, 0x00, // On at 0, off at 96
+  };
+  Smf smf;
+  CHECK(smf_parse(data, sizeof(data), RATE, &smf) == 1);
+  CHECK(smf.count == 3);
+  if (smf.count == 3) {
+    CHECK(smf.events[1].status == 0x80);
+    CHECK(smf.events[2].status == 0x90);
+    CHECK(smf.events[1].frame == smf.events[2].frame);
+  }
+  smf_free(&smf);
+}
+
+static void test_damaged(void) {
+  Smf smf;
+  unsigned char data[sizeof(song)];
+
+  // Not a MIDI file, an unsupported format, a zero division
+  memcpy(data, song, sizeof(song));
+  data[0] = 'X';
+  CHECK(smf_parse(data, sizeof(data), RATE, &smf) == 0);
+  memcpy(data, song, sizeof(song));
+  data[9] = 2;
+  CHECK(smf_parse(data, sizeof(data), RATE, &smf) == 0);
+  memcpy(data, song, sizeof(song));
+  data[12] = data[13] = 0;
+  CHECK(smf_parse(data, sizeof(data), RATE, &smf) == 0);
+  CHECK(smf_parse(song, 10, RATE, &smf) == 0);
+
+  // Cut inside the second note: the events before the damage are kept
+  CHECK(smf_parse(song, sizeof(song) - 12, RATE, &smf) == 1);
+  CHECK(smf.count == 5);
+  smf_free(&smf);
+}
+
+// Messages the player sent, newest last
+typedef struct {
+  SmfEvent sent[64];
+  int count;
+} Sink;
+
+static void sink_send(void *ctx, const SmfEvent *e) {
+  Sink *sink = (Sink *)ctx;
+  if (sink->count < 64)
+    sink->sent[sink->count++] = *e;
+}
+
+static int sink_find(const Sink *sink, int status, int data1) {
+  for (int i = 0; i < sink->count; ++i)
+    if (sink->sent[i].status == status && sink->sent[i].data1 == data1)
+      return i;
+  return -1;
+}
+
+// The chase state kept per bar, and what a seek and a loop wrap resend
+static void test_chase(void) {
+  static SmfPlayer player;
+  smf_player_init(&player);
+  Smf *smf = (Smf *)malloc(sizeof(Smf));
+  CHECK(smf && smf_parse(song, sizeof(song), RATE, smf) == 1);
+  if (!smf || smf->count != 7) {
+    free(smf);
+    return;
+  }
+
+  // Bar 2 starts at beat 4, after the controller at beat 2
+  CHECK(smf->bar_count == 2);
+  CHECK(smf->bars[0].next == 0 && smf->bars[0].cc[0][7] == -1);
+  CHECK(smf->bars[1].next == 5 && smf->bars[1].cc[0][7] == 90);
+
+  Sink sink = {0};
+  platform_atomic_set_ptr(&player.pending, smf);
+  smf_player_play(&player, 1);
+  smf_player_update(&player, sink_send, &sink);
+
+  // A seek to beat 3 catches up from bar 1: 240 BPM and the controller
+  smf_player_seek(&player, 3.0);
+  sink.count = 0;
+  CHECK(smf_player_update(&player, sink_send, &sink) == SMF_PLAYER_MOVED);
+  CHECK(sink.count == 2);
+  CHECK(sink.sent[0].status == SMF_TEMPO);
+  CHECK_NEAR(sink.sent[0].bpm, 240.0, 1e-3);
+  int cc = sink_find(&sink, 0xB0, 7);
+  CHECK(cc >= 0 && sink.sent[cc].data2 == 90);
+
+  // Looping bar 2: the wrap resends the bar's state and releases the note
+  player.loop = 1;
+  player.loop_start = 2;
+  int wraps = 0;
+  for (int pass = 0; pass < 64 && player.playing; ++pass) {
+    sink.count = 0;
+    if (smf_player_fire(&player, sink_send, &sink) == SMF_PLAYER_MOVED) {
+      wraps++;
+      CHECK(player.position == 72000);
+      CHECK(sink_find(&sink, 0xB0, 7) >= 0);
+      CHECK(sink_find(&sink, 0x81, 64) >= 0 || sink_find(&sink, 0x91, 64) >= 0);
+    }
+    smf_player_advance(&player, smf_player_next_event(&player, 4096));
+  }
+  CHECK(wraps > 0);
+  CHECK(player.playing);
+  smf_player_cleanup(&player);
+}
+
+int main(void) {
+  test_tempo_map();
+  test_same_tick_order();
+  test_damaged();
+  test_chase();
+  return check_result();
+}